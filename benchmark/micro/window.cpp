@@ -46,3 +46,84 @@ virtual string BenchmarkInfo() {
 	                          GetQuery().c_str(), WINDOW_ROW_COUNT);
 }
 FINISH_BENCHMARK(Window)
+
+DUCKDB_BENCHMARK(WindowPartitioned, "[micro]")
+virtual void Load(DuckDBBenchmarkState *state) {
+	// fixed seed random numbers
+	std::uniform_int_distribution<> distribution(1, 10000);
+	std::mt19937 gen;
+	gen.seed(42);
+
+	state->conn.Query("CREATE TABLE integers(i INTEGER, j INTEGER);");
+	Appender appender(state->conn, "integers"); // insert the elements into the database
+	for (size_t i = 0; i < WINDOW_ROW_COUNT; i++) {
+		appender.BeginRow();
+		appender.Append<int32_t>(distribution(gen));
+		appender.Append<int32_t>(i % 1000);
+		appender.EndRow();
+	}
+	appender.Close();
+	state->conn.Query("PRAGMA threads=4");
+}
+
+virtual string GetQuery() {
+	return "SELECT ROW_NUMBER() OVER(partition by j order by i), SUM(i) OVER(partition by j order by i rows between 10 "
+	       "preceding and current row), LAG(i) OVER(partition by j order by i) FROM integers";
+}
+
+virtual string VerifyResult(QueryResult *result) {
+	if (!result->success) {
+		return result->error;
+	}
+	auto &materialized = (MaterializedQueryResult &)*result;
+	if (materialized.collection.count != WINDOW_ROW_COUNT) {
+		return "Incorrect amount of rows in result";
+	}
+	return string();
+}
+
+virtual string BenchmarkInfo() {
+	return StringUtil::Format("Runs the following query: \"%s\""
+	                          " on %d rows in 1000 partitions with 4 threads",
+	                          GetQuery().c_str(), WINDOW_ROW_COUNT);
+}
+FINISH_BENCHMARK(WindowPartitioned)
+
+DUCKDB_BENCHMARK(WindowStreaming, "[micro]")
+virtual void Load(DuckDBBenchmarkState *state) {
+	// fixed seed random numbers
+	std::uniform_int_distribution<> distribution(1, 10000);
+	std::mt19937 gen;
+	gen.seed(42);
+
+	state->conn.Query("CREATE TABLE integers(i INTEGER);");
+	Appender appender(state->conn, "integers"); // insert the elements into the database
+	for (size_t i = 0; i < WINDOW_ROW_COUNT; i++) {
+		appender.BeginRow();
+		appender.Append<int32_t>(distribution(gen));
+		appender.EndRow();
+	}
+}
+
+virtual string GetQuery() {
+	return "SELECT ROW_NUMBER() OVER (), SUM(i) OVER (ROWS UNBOUNDED PRECEDING), AVG(i) OVER (ROWS BETWEEN 100 "
+	       "PRECEDING AND CURRENT ROW), LAG(i) OVER () FROM integers";
+}
+
+virtual string VerifyResult(QueryResult *result) {
+	if (!result->success) {
+		return result->error;
+	}
+	auto &materialized = (MaterializedQueryResult &)*result;
+	if (materialized.collection.count != WINDOW_ROW_COUNT) {
+		return "Incorrect amount of rows in result";
+	}
+	return string();
+}
+
+virtual string BenchmarkInfo() {
+	return StringUtil::Format("Runs the following query: \"%s\""
+	                          " on %d rows without materializing the input",
+	                          GetQuery().c_str(), WINDOW_ROW_COUNT);
+}
+FINISH_BENCHMARK(WindowStreaming)
@@ -1,7 +1,9 @@
 #include <string>
 #include <vector>
 #include <bitset>
-#include <fstream>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <cstring>
 #include <iostream>
 #include <sstream>
@@ -9,12 +11,20 @@
 #include "parquet-extension.hpp"
 
 #ifndef DUCKDB_AMALGAMATION
+#include "duckdb/common/algorithm.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/operator/comparison_operators.hpp"
 #include "duckdb/function/table_function.hpp"
+#include "duckdb/function/function_set.hpp"
+#include "duckdb/parallel/task_context.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 #include "duckdb/parser/parsed_data/create_copy_function_info.hpp"
 #include "duckdb/main/client_context.hpp"
 #include "duckdb/main/connection.hpp"
 #include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/hash.hpp"
 #include "duckdb/common/types/time.hpp"
 #include "duckdb/common/types/timestamp.hpp"
 #include "duckdb/common/serializer/buffered_file_writer.hpp"
@@ -285,14 +295,12 @@ static Int96 timestamp_t_to_impala_timestamp(timestamp_t &ts) {
 }
 
 struct ParquetScanColumnData {
-	idx_t chunk_offset;
-
 	idx_t page_offset;
 	idx_t page_value_count = 0;
 
 	idx_t dict_size;
 
-	ResizeableBuffer buf;
+	ByteBuffer buf;                    // points into the buffer of the row group
 	ResizeableBuffer decompressed_buf; // only used for compressed files
 	ResizeableBuffer dict;
 	ResizeableBuffer offset_buf;
@@ -302,74 +310,151 @@ struct ParquetScanColumnData {
 
 	Encoding::type page_encoding;
 	// these point into buf or decompressed_buf
+	unique_ptr<RleBpDecoder> repeated_decoder;
 	unique_ptr<RleBpDecoder> defined_decoder;
 	unique_ptr<RleBpDecoder> dict_decoder;
 
 	unique_ptr<ChunkCollection> string_collection;
+
+	// the column chunks of nested columns are decoded entirely when the row group is prepared: the repetition and
+	// definition levels are required to determine how many values make up the rows of the output
+	vector<uint8_t> repeat_levels;
+	vector<uint8_t> define_levels;
+	ChunkCollection values;
+	//! The index of the next triple (repetition level, definition level, value) to assemble
+	idx_t value_position;
 };
 
-struct ParquetScanFunctionData : public TableFunctionData {
+enum class ParquetNodeType : uint8_t { LEAF, STRUCT, LIST };
+
+//! A node of the schema of a Parquet file. Every leaf of the schema is stored as a column chunk in the row groups,
+//! nested values are assembled from the repetition and definition levels of the leaves (the "Dremel" encoding).
+struct ParquetSchemaNode {
+	ParquetNodeType node_type;
+	string name;
+	SQLType sql_type;
+	//! The value of this node is NULL if the definition level is lower than this (for leaves: the maximum level)
+	uint8_t define_level;
+	//! The repetition level of a new value of this node (for leaves: the maximum level)
+	uint8_t repeat_level;
+	//! LIST: the list is empty if the definition level is lower than this
+	uint8_t element_define_level;
+	//! LIST: the repetition level of the elements after the first element of a list
+	uint8_t element_repeat_level;
+	//! The index of the first leaf of this node in the column chunks of a row group and the amount of leaves; the
+	//! leaves of a node are stored consecutively
+	idx_t leaf_index;
+	idx_t leaf_count;
+	vector<unique_ptr<ParquetSchemaNode>> children;
+};
+
+//! The state of a scan over a set of row groups of a single Parquet file
+struct ParquetReaderState {
+	ParquetReaderState(string file_name, shared_ptr<FileMetaData> file_meta_data, vector<idx_t> row_groups)
+	    : file_name(move(file_name)), file_meta_data(move(file_meta_data)), row_groups(move(row_groups)),
+	      current_group(-1), group_offset(0), finished(false) {
+	}
+
+	string file_name;
+	//! The file is opened when the scan starts
+	unique_ptr<FileHandle> handle;
+	//! The column chunks of the current row group that are scanned
+	ResizeableBuffer group_buffer;
+
+	shared_ptr<FileMetaData> file_meta_data;
+	//! The indexes of the row groups of the file that are scanned
+	vector<idx_t> row_groups;
+	//! The index in row_groups of the row group that is currently being scanned
 	int64_t current_group;
 	int64_t group_offset;
 
-	ifstream pfile;
-
-	FileMetaData file_meta_data;
-	vector<SQLType> sql_types;
 	vector<ParquetScanColumnData> column_data;
 	bool finished;
+
+	RowGroup &GetGroup() {
+		return file_meta_data->row_groups[row_groups[current_group]];
+	}
 };
 
-class ParquetScanFunction : public TableFunction {
+//! A range of bytes of a Parquet file that is read with a single read
+struct ParquetReadRange {
+	idx_t start;
+	idx_t end;
+	//! The offset of the range in the buffer of the row group
+	idx_t buffer_offset;
+};
+
+struct ParquetScanFunctionData : public TableFunctionData {
+	//! The files that are scanned
+	vector<string> files;
+	//! The meta data of the files, read when the file is first needed
+	vector<shared_ptr<FileMetaData>> file_meta_data;
+	vector<SQLType> sql_types;
+	vector<string> names;
+	//! The schema of the top-level columns and the leaves of the schema
+	vector<unique_ptr<ParquetSchemaNode>> columns;
+	vector<ParquetSchemaNode *> leaves;
+
+	//! The sequential scan: the index of the next file and the state of the file that is being scanned
+	idx_t file_index = 0;
+	unique_ptr<ParquetReaderState> current_reader;
+};
+
+//! A part of a parallel Parquet scan: a single row group of a file
+class ParquetScanTaskInfo : public OperatorTaskInfo {
 public:
-	ParquetScanFunction()
-	    : TableFunction("parquet_scan", {SQLType::VARCHAR}, parquet_scan_bind, parquet_scan_function, nullptr) {
-		supports_projection = true;
+	ParquetScanTaskInfo(string file_name, shared_ptr<FileMetaData> file_meta_data, idx_t row_group)
+	    : state(move(file_name), move(file_meta_data), vector<idx_t>{row_group}) {
 	}
 
-private:
-	static unique_ptr<FunctionData> parquet_scan_bind(ClientContext &context, vector<Value> inputs,
-	                                                  vector<SQLType> &return_types, vector<string> &names) {
+	ParquetReaderState state;
+};
 
-		auto file_name = inputs[0].GetValue<string>();
-		auto res = make_unique<ParquetScanFunctionData>();
+class ParquetScanFunction : public TableFunction {
+	//! Column chunks of a row group that are at most this many bytes apart are read with a single read
+	static constexpr idx_t MAX_READ_GAP = 1024 * 1024;
 
-		auto &pfile = res->pfile;
-		auto &file_meta_data = res->file_meta_data;
+public:
+	ParquetScanFunction(SQLType argument)
+	    : TableFunction("parquet_scan", {argument}, parquet_scan_bind, parquet_scan_function, nullptr) {
+		supports_projection = true;
+		filter_pushdown = true;
+		parallel_tasks = parquet_scan_parallel_tasks;
+		parallel_function = parquet_scan_parallel;
+	}
 
-		pfile.open(file_name, std::ios::binary);
+private:
+	static void read_file_meta_data(FileSystem &fs, const string &file_name, FileMetaData &file_meta_data) {
+		auto handle = fs.OpenFile(file_name.c_str(), FileFlags::READ);
+		auto file_size = fs.GetFileSize(*handle);
+		if (file_size < 12) {
+			throw runtime_error("File \"" + file_name + "\" is too small to be a Parquet file");
+		}
 
 		ResizeableBuffer buf;
-		buf.resize(4);
-		memset(buf.ptr, '\0', 4);
+		buf.resize(8);
 		// check for magic bytes at start of file
-		pfile.read(buf.ptr, 4);
+		handle->Read(buf.ptr, 4, 0);
 		if (strncmp(buf.ptr, "PAR1", 4) != 0) {
 			throw runtime_error("File not found or missing magic bytes");
 		}
 
-		// check for magic bytes at end of file
-		pfile.seekg(-4, ios_base::end);
-		pfile.read(buf.ptr, 4);
-		if (strncmp(buf.ptr, "PAR1", 4) != 0) {
+		// the file ends with the four-byte footer length followed by the magic bytes
+		handle->Read(buf.ptr, 8, file_size - 8);
+		if (strncmp(buf.ptr + 4, "PAR1", 4) != 0) {
 			throw runtime_error("No magic bytes found at end of file");
 		}
-
-		// read four-byte footer length from just before the end magic bytes
-		pfile.seekg(-8, ios_base::end);
-		pfile.read(buf.ptr, 4);
-		int32_t footer_len = *(uint32_t *)buf.ptr;
+		uint32_t footer_len = *(uint32_t *)buf.ptr;
 		if (footer_len == 0) {
 			throw runtime_error("Footer length can't be 0");
 		}
+		if (footer_len + 12 > (uint64_t)file_size) {
+			throw runtime_error("Footer length exceeds the file size. File corrupt?");
+		}
 
 		// read footer into buffer and de-thrift
 		buf.resize(footer_len);
-		pfile.seekg(-(footer_len + 8), ios_base::end);
-		pfile.read(buf.ptr, footer_len);
-		if (!pfile) {
-			throw runtime_error("Could not read footer");
-		}
+		handle->Read(buf.ptr, footer_len, file_size - footer_len - 8);
 
 		thrift_unpack((const uint8_t *)buf.ptr, (uint32_t *)&footer_len, &file_meta_data);
 
@@ -377,64 +462,223 @@ private:
 			throw runtime_error("Encrypted Parquet files are not supported");
 		}
 		// check if we like this schema
-		if (file_meta_data.schema.size() < 2) {
+		if (file_meta_data.schema.size() < 2 || file_meta_data.schema[0].num_children < 1) {
 			throw runtime_error("Need at least one column in the file");
 		}
-		if (file_meta_data.schema[0].num_children != (int32_t)(file_meta_data.schema.size() - 1)) {
-			throw runtime_error("Only flat tables are supported (no nesting)");
+	}
+
+	static SQLType _leaf_type(SchemaElement &s_ele) {
+		switch (s_ele.type) {
+		case Type::BOOLEAN:
+			return SQLType::BOOLEAN;
+		case Type::INT32:
+			return SQLType::INTEGER;
+		case Type::INT64:
+			return SQLType::BIGINT;
+		case Type::INT96: // always a timestamp?
+			return SQLType::TIMESTAMP;
+		case Type::FLOAT:
+			return SQLType::FLOAT;
+		case Type::DOUBLE:
+			return SQLType::DOUBLE;
+			//			case parquet::format::Type::FIXED_LEN_BYTE_ARRAY: {
+			// TODO some decimals yuck
+		case Type::BYTE_ARRAY:
+			return SQLType::VARCHAR;
+		default:
+			throw NotImplementedException("Invalid type");
+		}
+	}
+
+	//! Whether the schema element is a list (or map) in the logical type annotation of the three-level list format:
+	//! <list-repetition> group <name> (LIST) { repeated group list { <element-repetition> <element-type> element; } }
+	static bool _is_annotated_list(FileMetaData &file_meta_data, idx_t schema_idx) {
+		auto &s_ele = file_meta_data.schema[schema_idx];
+		if (!s_ele.__isset.converted_type || s_ele.num_children != 1 || schema_idx + 1 >= file_meta_data.schema.size()) {
+			return false;
+		}
+		if (s_ele.converted_type != ConvertedType::LIST && s_ele.converted_type != ConvertedType::MAP &&
+		    s_ele.converted_type != ConvertedType::MAP_KEY_VALUE) {
+			return false;
 		}
+		return file_meta_data.schema[schema_idx + 1].repetition_type == FieldRepetitionType::REPEATED;
+	}
 
-		// skip the first column its the root and otherwise useless
-		for (uint64_t col_idx = 1; col_idx < file_meta_data.schema.size(); col_idx++) {
-			auto &s_ele = file_meta_data.schema[col_idx];
-			if (!s_ele.__isset.type || s_ele.num_children > 0) {
-				throw runtime_error("Only flat tables are supported (no nesting)");
+	//! Parses the schema element at schema_idx (and its children) into a schema node. define_level and repeat_level
+	//! are the levels of the parent. If as_element is set, a repeated element is parsed as the element of the list
+	//! formed by the repetition (i.e. as a required field with the levels of the list elements).
+	static unique_ptr<ParquetSchemaNode> _parse_schema_node(FileMetaData &file_meta_data, idx_t &schema_idx,
+	                                                        uint8_t define_level, uint8_t repeat_level,
+	                                                        idx_t &leaf_index, bool as_element = false) {
+		if (schema_idx >= file_meta_data.schema.size()) {
+			throw runtime_error("Schema of the file is incomplete. File corrupt?");
+		}
+		auto &s_ele = file_meta_data.schema[schema_idx];
+		auto node = make_unique<ParquetSchemaNode>();
+		node->name = s_ele.name;
+		node->leaf_index = leaf_index;
+		node->repeat_level = repeat_level;
+		node->element_define_level = 0;
+		node->element_repeat_level = 0;
+
+		if (s_ele.repetition_type == FieldRepetitionType::REPEATED && !as_element) {
+			// a repeated field without a list annotation: a list of required elements that is never NULL
+			node->node_type = ParquetNodeType::LIST;
+			node->define_level = define_level;
+			node->element_define_level = define_level + 1;
+			node->element_repeat_level = repeat_level + 1;
+			node->children.push_back(
+			    _parse_schema_node(file_meta_data, schema_idx, define_level + 1, repeat_level + 1, leaf_index, true));
+		} else if (_is_annotated_list(file_meta_data, schema_idx)) {
+			node->node_type = ParquetNodeType::LIST;
+			node->define_level = define_level + (s_ele.repetition_type == FieldRepetitionType::OPTIONAL ? 1 : 0);
+			node->element_define_level = node->define_level + 1;
+			node->element_repeat_level = repeat_level + 1;
+			schema_idx++;
+			auto &repeated_ele = file_meta_data.schema[schema_idx];
+			// the backwards-compatibility rules of the format: the repeated field is the element itself if it has
+			// multiple fields or if it is named "array" or "<name>_tuple" (two-level lists), otherwise its single
+			// field is the element (three-level lists)
+			if (repeated_ele.num_children == 1 && repeated_ele.name != "array" &&
+			    repeated_ele.name != s_ele.name + "_tuple") {
+				schema_idx++;
+				node->children.push_back(_parse_schema_node(file_meta_data, schema_idx, node->element_define_level,
+				                                            node->element_repeat_level, leaf_index));
+			} else {
+				node->children.push_back(_parse_schema_node(file_meta_data, schema_idx, node->element_define_level,
+				                                            node->element_repeat_level, leaf_index, true));
 			}
-			// if this is REQUIRED, there are no defined levels in file, seems unused
-			// if field is REPEATED, no bueno
-			if (s_ele.repetition_type != FieldRepetitionType::OPTIONAL) {
-				throw runtime_error("Only OPTIONAL fields support");
+		} else {
+			node->define_level = define_level + (s_ele.repetition_type == FieldRepetitionType::OPTIONAL ? 1 : 0);
+			schema_idx++;
+			if (s_ele.num_children > 0) {
+				node->node_type = ParquetNodeType::STRUCT;
+				for (int32_t child_idx = 0; child_idx < s_ele.num_children; child_idx++) {
+					node->children.push_back(_parse_schema_node(file_meta_data, schema_idx, node->define_level,
+					                                            repeat_level, leaf_index));
+				}
+			} else {
+				if (!s_ele.__isset.type) {
+					throw runtime_error("Schema element \"" + s_ele.name + "\" has neither a type nor children");
+				}
+				node->node_type = ParquetNodeType::LEAF;
+				node->sql_type = _leaf_type(s_ele);
+				leaf_index++;
 			}
+		}
+		node->leaf_count = leaf_index - node->leaf_index;
 
-			names.push_back(s_ele.name);
-			SQLType type;
-			switch (s_ele.type) {
-			case Type::BOOLEAN:
-				type = SQLType::BOOLEAN;
-				break;
-			case Type::INT32:
-				type = SQLType::INTEGER;
-				break;
-			case Type::INT64:
-				type = SQLType::BIGINT;
-				break;
-			case Type::INT96: // always a timestamp?
-				type = SQLType::TIMESTAMP;
-				break;
-			case Type::FLOAT:
-				type = SQLType::FLOAT;
-				break;
-			case Type::DOUBLE:
-				type = SQLType::DOUBLE;
-				break;
-				//			case parquet::format::Type::FIXED_LEN_BYTE_ARRAY: {
-				// TODO some decimals yuck
-			case Type::BYTE_ARRAY:
-				type = SQLType::VARCHAR;
-				break;
+		switch (node->node_type) {
+		case ParquetNodeType::LIST:
+			node->sql_type = SQLType(SQLTypeId::LIST);
+			node->sql_type.child_type.push_back(make_pair("", node->children[0]->sql_type));
+			break;
+		case ParquetNodeType::STRUCT:
+			node->sql_type = SQLType(SQLTypeId::STRUCT);
+			for (auto &child : node->children) {
+				node->sql_type.child_type.push_back(make_pair(child->name, child->sql_type));
+			}
+			break;
+		default:
+			break;
+		}
+		return node;
+	}
 
-			default:
-				throw NotImplementedException("Invalid type");
-				break;
+	static void _get_leaves(ParquetSchemaNode &node, vector<ParquetSchemaNode *> &leaves) {
+		if (node.node_type == ParquetNodeType::LEAF) {
+			leaves.push_back(&node);
+		}
+		for (auto &child : node.children) {
+			_get_leaves(*child, leaves);
+		}
+	}
+
+	static void read_schema(FileMetaData &file_meta_data, vector<unique_ptr<ParquetSchemaNode>> &columns,
+	                        vector<ParquetSchemaNode *> &leaves) {
+		// skip the first element, it is the root and otherwise useless
+		idx_t schema_idx = 1;
+		idx_t leaf_index = 0;
+		for (int32_t col_idx = 0; col_idx < file_meta_data.schema[0].num_children; col_idx++) {
+			columns.push_back(_parse_schema_node(file_meta_data, schema_idx, 0, 0, leaf_index));
+		}
+		if (schema_idx != file_meta_data.schema.size()) {
+			throw runtime_error("Schema of the file has unexpected elements. File corrupt?");
+		}
+		for (auto &column : columns) {
+			_get_leaves(*column, leaves);
+		}
+		for (auto &group : file_meta_data.row_groups) {
+			if (group.columns.size() != leaves.size()) {
+				throw runtime_error("Row group does not contain a column chunk for every leaf of the schema");
+			}
+		}
+	}
+
+	//! Returns the meta data of the specified file, reading it if it has not been read yet
+	static shared_ptr<FileMetaData> get_file_meta_data(ClientContext &context, ParquetScanFunctionData &data,
+	                                                   idx_t file_idx) {
+		if (data.file_meta_data[file_idx]) {
+			return data.file_meta_data[file_idx];
+		}
+		auto &file_name = data.files[file_idx];
+		auto file_meta_data = make_shared<FileMetaData>();
+		read_file_meta_data(FileSystem::GetFileSystem(context), file_name, *file_meta_data);
+		// all files have to have the same schema as the first file, including the levels of the leaves
+		vector<unique_ptr<ParquetSchemaNode>> columns;
+		vector<ParquetSchemaNode *> leaves;
+		read_schema(*file_meta_data, columns, leaves);
+		bool schema_matches = columns.size() == data.columns.size() && leaves.size() == data.leaves.size();
+		for (idx_t col_idx = 0; schema_matches && col_idx < columns.size(); col_idx++) {
+			schema_matches = columns[col_idx]->name == data.names[col_idx] &&
+			                 SQLTypeToString(columns[col_idx]->sql_type) == SQLTypeToString(data.sql_types[col_idx]);
+		}
+		for (idx_t leaf_idx = 0; schema_matches && leaf_idx < leaves.size(); leaf_idx++) {
+			schema_matches = leaves[leaf_idx]->define_level == data.leaves[leaf_idx]->define_level &&
+			                 leaves[leaf_idx]->repeat_level == data.leaves[leaf_idx]->repeat_level;
+		}
+		if (!schema_matches) {
+			throw runtime_error("Schema of file \"" + file_name + "\" does not match the schema of file \"" +
+			                    data.files[0] + "\"");
+		}
+		data.file_meta_data[file_idx] = file_meta_data;
+		return file_meta_data;
+	}
+
+	static unique_ptr<FunctionData> parquet_scan_bind(ClientContext &context, vector<Value> inputs,
+	                                                  vector<SQLType> &return_types, vector<string> &names) {
+		auto res = make_unique<ParquetScanFunctionData>();
+
+		// the input is either a single file name or a list of file names, each of which can be a glob pattern
+		vector<string> patterns;
+		if (inputs[0].type == TypeId::LIST) {
+			for (auto &child : inputs[0].list_value) {
+				patterns.push_back(child.GetValue<string>());
+			}
+		} else {
+			patterns.push_back(inputs[0].GetValue<string>());
+		}
+		auto &fs = FileSystem::GetFileSystem(context);
+		for (auto &pattern : patterns) {
+			auto files = fs.Glob(pattern);
+			if (files.empty()) {
+				throw IOException("No files found that match the pattern \"%s\"", pattern.c_str());
 			}
+			res->files.insert(res->files.end(), files.begin(), files.end());
+		}
 
-			return_types.push_back(type);
-			res->sql_types.push_back(type);
+		// the schema is determined by the first file
+		res->file_meta_data.resize(res->files.size());
+		auto file_meta_data = make_shared<FileMetaData>();
+		read_file_meta_data(fs, res->files[0], *file_meta_data);
+		read_schema(*file_meta_data, res->columns, res->leaves);
+		for (auto &column : res->columns) {
+			return_types.push_back(column->sql_type);
+			names.push_back(column->name);
 		}
-		res->group_offset = 0;
-		res->current_group = -1;
-		res->column_data.resize(return_types.size());
-		res->finished = false;
+		res->file_meta_data[0] = file_meta_data;
+		res->sql_types = return_types;
+		res->names = names;
 		return move(res);
 	}
 
@@ -470,14 +714,37 @@ private:
 	static const uint8_t GZIP_COMPRESSION_DEFLATE = 0x08;
 	static const unsigned char GZIP_FLAG_UNSUPPORTED = 0x1 | 0x2 | 0x4 | 0x10 | 0x20;
 
-	static bool _prepare_page_buffers(ParquetScanFunctionData &data, idx_t col_idx) {
-		auto &col_data = data.column_data[col_idx];
-		auto &chunk = data.file_meta_data.row_groups[data.current_group].columns[col_idx];
+	//! Returns the amount of bits required to store the levels up to max_level
+	static uint8_t _level_bit_width(uint8_t max_level) {
+		uint8_t bit_width = 0;
+		while (max_level > 0) {
+			bit_width++;
+			max_level >>= 1;
+		}
+		return bit_width;
+	}
+
+	//! Returns a decoder for the RLE encoded levels at the start of the payload, moving the payload behind the levels
+	static unique_ptr<RleBpDecoder> _read_levels(ParquetScanColumnData &col_data, uint8_t max_level) {
+		// read length of level payload, always
+		uint32_t level_length = col_data.payload.read<uint32_t>();
+		col_data.payload.available(level_length);
+		auto decoder = make_unique<RleBpDecoder>((const uint8_t *)col_data.payload.ptr, level_length,
+		                                         _level_bit_width(max_level));
+		col_data.payload.inc(level_length);
+		return decoder;
+	}
+
+	static bool _prepare_page_buffers(ParquetScanFunctionData &data, ParquetReaderState &state, idx_t leaf_idx) {
+		auto &col_data = state.column_data[leaf_idx];
+		auto &chunk = state.GetGroup().columns[leaf_idx];
+		auto &leaf = *data.leaves[leaf_idx];
 
 		// clean up a bit to avoid nasty surprises
 		col_data.payload.ptr = nullptr;
 		col_data.payload.len = 0;
 		col_data.dict_decoder = nullptr;
+		col_data.repeated_decoder = nullptr;
 		col_data.defined_decoder = nullptr;
 
 		auto page_header_len = col_data.buf.len;
@@ -485,7 +752,7 @@ private:
 			throw runtime_error("Ran out of bytes to read header from. File corrupt?");
 		}
 		PageHeader page_hdr;
-		thrift_unpack((const uint8_t *)col_data.buf.ptr + col_data.chunk_offset, (uint32_t *)&page_header_len,
+		thrift_unpack((const uint8_t *)col_data.buf.ptr, (uint32_t *)&page_header_len,
 		              &page_hdr);
 
 		// the payload starts behind the header, obvsl.
@@ -577,11 +844,11 @@ private:
 			}
 
 			col_data.dict_size = page_hdr.dictionary_page_header.num_values;
-			auto dict_byte_size = col_data.dict_size * GetTypeIdSize(GetInternalType(data.sql_types[col_idx]));
+			auto dict_byte_size = col_data.dict_size * GetTypeIdSize(GetInternalType(leaf.sql_type));
 
 			col_data.dict.resize(dict_byte_size);
 
-			switch (data.sql_types[col_idx].id) {
+			switch (leaf.sql_type.id) {
 			case SQLTypeId::BOOLEAN:
 			case SQLTypeId::INTEGER:
 			case SQLTypeId::BIGINT:
@@ -649,7 +916,7 @@ private:
 				col_data.string_collection->Verify();
 			} break;
 			default:
-				throw runtime_error(SQLTypeToString(data.sql_types[col_idx]));
+				throw runtime_error(SQLTypeToString(leaf.sql_type));
 			}
 			// important, move to next page which should be a data page
 			return false;
@@ -666,18 +933,18 @@ private:
 			col_data.page_value_count = page_hdr.data_page_header.num_values;
 			col_data.page_encoding = page_hdr.data_page_header.encoding;
 
-			// we have to first decode the define levels
-			switch (page_hdr.data_page_header.definition_level_encoding) {
-			case Encoding::RLE: {
-				// read length of define payload, always
-				uint32_t def_length = col_data.payload.read<uint32_t>();
-				col_data.payload.available(def_length);
-				col_data.defined_decoder =
-				    make_unique<RleBpDecoder>((const uint8_t *)col_data.payload.ptr, def_length, 1);
-				col_data.payload.inc(def_length);
-			} break;
-			default:
-				throw runtime_error("Definition levels have unsupported/invalid encoding");
+			// we have to first decode the repetition and definition levels, which are omitted if their maximum is 0
+			if (leaf.repeat_level > 0) {
+				if (page_hdr.data_page_header.repetition_level_encoding != Encoding::RLE) {
+					throw runtime_error("Repetition levels have unsupported/invalid encoding");
+				}
+				col_data.repeated_decoder = _read_levels(col_data, leaf.repeat_level);
+			}
+			if (leaf.define_level > 0) {
+				if (page_hdr.data_page_header.definition_level_encoding != Encoding::RLE) {
+					throw runtime_error("Definition levels have unsupported/invalid encoding");
+				}
+				col_data.defined_decoder = _read_levels(col_data, leaf.define_level);
 			}
 
 			switch (page_hdr.data_page_header.encoding) {
@@ -707,272 +974,783 @@ private:
 		return true;
 	}
 
-	static void _prepare_chunk_buffer(ParquetScanFunctionData &data, idx_t col_idx) {
-		auto &chunk = data.file_meta_data.row_groups[data.current_group].columns[col_idx];
+	//! Returns the byte range of a column chunk in the file
+	static void _get_chunk_range(ColumnChunk &chunk, idx_t &chunk_start, idx_t &chunk_len) {
 		if (chunk.__isset.file_path) {
 			throw runtime_error("Only inlined data files are supported (no references)");
 		}
 
-		if (chunk.meta_data.path_in_schema.size() != 1) {
-			throw runtime_error("Only flat tables are supported (no nesting)");
-		}
-
 		// ugh. sometimes there is an extra offset for the dict. sometimes it's wrong.
-		auto chunk_start = chunk.meta_data.data_page_offset;
+		chunk_start = chunk.meta_data.data_page_offset;
 		if (chunk.meta_data.__isset.dictionary_page_offset && chunk.meta_data.dictionary_page_offset >= 4) {
 			// this assumes the data pages follow the dict pages directly.
 			chunk_start = chunk.meta_data.dictionary_page_offset;
 		}
-		auto chunk_len = chunk.meta_data.total_compressed_size;
+		chunk_len = chunk.meta_data.total_compressed_size;
+	}
 
-		// read entire chunk into RAM
-		data.pfile.seekg(chunk_start);
-		data.column_data[col_idx].buf.resize(chunk_len);
-		data.pfile.read(data.column_data[col_idx].buf.ptr, chunk_len);
-		if (!data.pfile) {
-			throw runtime_error("Could not read chunk. File corrupt?");
+	//! Returns the byte ranges of the row group that contain the column chunks of the scanned columns. Column chunks
+	//! that are close to each other are read with a single read: reading a small gap is cheaper than another read.
+	static vector<ParquetReadRange> _get_read_ranges(ParquetScanFunctionData &data, RowGroup &group) {
+		vector<pair<idx_t, idx_t>> chunks;
+		for (auto file_col_idx : data.column_ids) {
+			if (file_col_idx == COLUMN_IDENTIFIER_ROW_ID) {
+				continue;
+			}
+			auto &column = *data.columns[file_col_idx];
+			// all leaves of a scanned nested column are read, even if the query only uses some fields of a STRUCT: the
+			// scan only receives the projected top-level columns (column_ids), not the fields extracted from them.
+			// Pruning unused struct fields would require the planner to push struct_extract into the scan, and is not
+			// supported.
+			for (idx_t leaf_idx = column.leaf_index; leaf_idx < column.leaf_index + column.leaf_count; leaf_idx++) {
+				idx_t chunk_start, chunk_len;
+				_get_chunk_range(group.columns[leaf_idx], chunk_start, chunk_len);
+				chunks.push_back(make_pair(chunk_start, chunk_start + chunk_len));
+			}
+		}
+		sort(chunks.begin(), chunks.end());
+
+		vector<ParquetReadRange> ranges;
+		idx_t buffer_offset = 0;
+		for (auto &chunk : chunks) {
+			if (!ranges.empty() && chunk.first <= ranges.back().end + MAX_READ_GAP) {
+				// extend the previous range
+				auto &range = ranges.back();
+				if (chunk.second > range.end) {
+					buffer_offset += chunk.second - range.end;
+					range.end = chunk.second;
+				}
+			} else {
+				ranges.push_back(ParquetReadRange{chunk.first, chunk.second, buffer_offset});
+				buffer_offset += chunk.second - chunk.first;
+			}
 		}
+		return ranges;
 	}
 
-	static void parquet_scan_function(ClientContext &context, vector<Value> &input, DataChunk &output,
-	                                  FunctionData *dataptr) {
-		auto &data = *((ParquetScanFunctionData *)dataptr);
-
-		if (data.finished) {
-			return;
+	//! Read the column chunks of the scanned columns of the current row group into memory
+	static void _prepare_row_group(ParquetScanFunctionData &data, ParquetReaderState &state) {
+		auto &group = state.GetGroup();
+		auto ranges = _get_read_ranges(data, group);
+		idx_t buffer_size = 0;
+		for (auto &range : ranges) {
+			buffer_size += range.end - range.start;
+		}
+		state.group_buffer.resize(buffer_size);
+		for (auto &range : ranges) {
+			state.handle->Read(state.group_buffer.ptr + range.buffer_offset, range.end - range.start, range.start);
 		}
 
-		// see if we have to switch to the next row group in the parquet file
-		if (data.current_group < 0 ||
-		    data.group_offset >= data.file_meta_data.row_groups[data.current_group].num_rows) {
-
-			data.current_group++;
-			data.group_offset = 0;
-
-			if ((idx_t)data.current_group == data.file_meta_data.row_groups.size()) {
-				data.finished = true;
-				return;
+		// let the file system load the next row group in the background while this row group is decoded
+		if (state.current_group + 1 < (int64_t)state.row_groups.size()) {
+			auto &next_group = state.file_meta_data->row_groups[state.row_groups[state.current_group + 1]];
+			for (auto &range : _get_read_ranges(data, next_group)) {
+				state.handle->file_system.Prefetch(*state.handle, range.start, range.end - range.start);
 			}
+		}
 
-			for (idx_t out_col_idx = 0; out_col_idx < output.column_count(); out_col_idx++) {
-				auto file_col_idx = data.column_ids[out_col_idx];
-
-				// this is a special case where we are not interested in the actual contents of the file
-				if (file_col_idx == COLUMN_IDENTIFIER_ROW_ID) {
-					continue;
+		for (auto file_col_idx : data.column_ids) {
+			// this is a special case where we are not interested in the actual contents of the file
+			if (file_col_idx == COLUMN_IDENTIFIER_ROW_ID) {
+				continue;
+			}
+			auto &column = *data.columns[file_col_idx];
+			for (idx_t leaf_idx = column.leaf_index; leaf_idx < column.leaf_index + column.leaf_count; leaf_idx++) {
+				idx_t chunk_start, chunk_len;
+				_get_chunk_range(group.columns[leaf_idx], chunk_start, chunk_len);
+				auto &col_data = state.column_data[leaf_idx];
+				for (auto &range : ranges) {
+					if (chunk_start >= range.start && chunk_start + chunk_len <= range.end) {
+						col_data.buf = ByteBuffer(
+						    state.group_buffer.ptr + range.buffer_offset + (chunk_start - range.start), chunk_len);
+						break;
+					}
 				}
-
-				_prepare_chunk_buffer(data, file_col_idx);
 				// trigger the reading of a new page below
-				data.column_data[file_col_idx].page_value_count = 0;
+				col_data.page_value_count = 0;
+				col_data.page_offset = 0;
+				if (column.node_type != ParquetNodeType::LEAF) {
+					_read_nested_leaf(data, state, leaf_idx);
+				}
 			}
 		}
+	}
 
-		auto current_group = data.file_meta_data.row_groups[data.current_group];
-		output.SetCardinality(std::min((int64_t)STANDARD_VECTOR_SIZE, current_group.num_rows - data.group_offset));
-
-		if (output.size() == 0) {
-			return;
-		}
-
-		for (idx_t out_col_idx = 0; out_col_idx < output.column_count(); out_col_idx++) {
-			auto file_col_idx = data.column_ids[out_col_idx];
-			if (file_col_idx == COLUMN_IDENTIFIER_ROW_ID) {
-				Value constant_42 = Value::BIGINT(42);
-				output.data[out_col_idx].Reference(constant_42);
-				continue;
+	//! Read the next count values of a leaf into the target vector, starting at target_offset. If they are set, the
+	//! repetition and definition levels of the values are written to repeat_out and define_out.
+	static void _read_leaf(ParquetScanFunctionData &data, ParquetReaderState &state, idx_t leaf_idx, idx_t count,
+	                       Vector &target, idx_t target_offset, uint8_t *repeat_out, uint8_t *define_out) {
+		auto &col_data = state.column_data[leaf_idx];
+		auto &leaf = *data.leaves[leaf_idx];
+
+		// we might need to read multiple pages to fill the target
+		idx_t output_offset = target_offset;
+		while (output_offset < target_offset + count) {
+			// do this unpack business only if we run out of stuff from the current page
+			if (col_data.page_offset >= col_data.page_value_count) {
+
+				// read dictionaries and data page headers so that we are ready to go for scan
+				if (!_prepare_page_buffers(data, state, leaf_idx)) {
+					continue;
+				}
+				col_data.page_offset = 0;
 			}
 
-			auto &col_data = data.column_data[file_col_idx];
+			auto current_batch_size =
+			    std::min(col_data.page_value_count - col_data.page_offset, target_offset + count - output_offset);
 
-			// we might need to read multiple pages to fill the data chunk
-			idx_t output_offset = 0;
-			while (output_offset < output.size()) {
-				// do this unpack business only if we run out of stuff from the current page
-				if (col_data.page_offset >= col_data.page_value_count) {
+			assert(current_batch_size > 0);
 
-					// read dictionaries and data page headers so that we are ready to go for scan
-					if (!_prepare_page_buffers(data, file_col_idx)) {
-						continue;
+			auto level_offset = output_offset - target_offset;
+			if (col_data.repeated_decoder) {
+				col_data.repeated_decoder->GetBatch<uint8_t>((char *)repeat_out + level_offset, current_batch_size);
+			} else if (repeat_out) {
+				memset(repeat_out + level_offset, 0, current_batch_size);
+			}
+			// a value is only present if its definition level is the maximum level, lower levels indicate that the
+			// value or one of its parents is NULL (or an empty list)
+			col_data.defined_buf.resize(current_batch_size);
+			if (col_data.defined_decoder) {
+				col_data.defined_decoder->GetBatch<uint8_t>(col_data.defined_buf.ptr, current_batch_size);
+				if (define_out) {
+					memcpy(define_out + level_offset, col_data.defined_buf.ptr, current_batch_size);
+				}
+				if (leaf.define_level > 1) {
+					for (idx_t i = 0; i < current_batch_size; i++) {
+						col_data.defined_buf.ptr[i] = (uint8_t)col_data.defined_buf.ptr[i] == leaf.define_level;
 					}
-					col_data.page_offset = 0;
 				}
+			} else {
+				memset(col_data.defined_buf.ptr, 1, current_batch_size);
+				if (define_out) {
+					memset(define_out + level_offset, 0, current_batch_size);
+				}
+			}
 
-				auto current_batch_size =
-				    std::min(col_data.page_value_count - col_data.page_offset, output.size() - output_offset);
+			switch (col_data.page_encoding) {
+			case Encoding::RLE_DICTIONARY:
+			case Encoding::PLAIN_DICTIONARY: {
 
-				assert(current_batch_size > 0);
+				idx_t null_count = 0;
+				for (idx_t i = 0; i < current_batch_size; i++) {
+					if (!col_data.defined_buf.ptr[i]) {
+						null_count++;
+					}
+				}
 
-				col_data.defined_buf.resize(current_batch_size);
-				col_data.defined_decoder->GetBatch<uint8_t>(col_data.defined_buf.ptr, current_batch_size);
+				col_data.offset_buf.resize(current_batch_size * sizeof(uint32_t));
+				col_data.dict_decoder->GetBatch<uint32_t>(col_data.offset_buf.ptr, current_batch_size - null_count);
 
-				switch (col_data.page_encoding) {
-				case Encoding::RLE_DICTIONARY:
-				case Encoding::PLAIN_DICTIONARY: {
+				// TODO ensure we had seen a dict page IN THIS CHUNK before getting here
 
-					idx_t null_count = 0;
-					for (idx_t i = 0; i < current_batch_size; i++) {
-						if (!col_data.defined_buf.ptr[i]) {
-							null_count++;
-						}
+				switch (leaf.sql_type.id) {
+				case SQLTypeId::BOOLEAN:
+					_fill_from_dict<bool>(col_data, current_batch_size, target, output_offset);
+					break;
+				case SQLTypeId::INTEGER:
+					_fill_from_dict<int32_t>(col_data, current_batch_size, target, output_offset);
+					break;
+				case SQLTypeId::BIGINT:
+					_fill_from_dict<int64_t>(col_data, current_batch_size, target, output_offset);
+					break;
+				case SQLTypeId::FLOAT:
+					_fill_from_dict<float>(col_data, current_batch_size, target, output_offset);
+					break;
+				case SQLTypeId::DOUBLE:
+					_fill_from_dict<double>(col_data, current_batch_size, target, output_offset);
+					break;
+				case SQLTypeId::TIMESTAMP:
+					_fill_from_dict<timestamp_t>(col_data, current_batch_size, target,
+					                             output_offset);
+					break;
+				case SQLTypeId::VARCHAR: {
+					if (!col_data.string_collection) {
+						throw runtime_error("Did not see a dictionary for strings. Corrupt file?");
 					}
 
-					col_data.offset_buf.resize(current_batch_size * sizeof(uint32_t));
-					col_data.dict_decoder->GetBatch<uint32_t>(col_data.offset_buf.ptr, current_batch_size - null_count);
+					// the strings can be anywhere in the collection so just reference it all
+					for (auto &chunk : col_data.string_collection->chunks) {
+						StringVector::AddHeapReference(target, chunk->data[0]);
+					}
 
-					// TODO ensure we had seen a dict page IN THIS CHUNK before getting here
+					auto out_data_ptr = FlatVector::GetData<string_t>(target);
+					for (idx_t i = 0; i < current_batch_size; i++) {
+						if (col_data.defined_buf.ptr[i]) {
+							auto offset = col_data.offset_buf.read<uint32_t>();
+							if (offset >= col_data.string_collection->count) {
+								throw runtime_error("string dictionary offset out of bounds");
+							}
+							auto &chunk = col_data.string_collection->chunks[offset / STANDARD_VECTOR_SIZE];
+							auto &vec = chunk->data[0];
 
-					switch (data.sql_types[file_col_idx].id) {
-					case SQLTypeId::BOOLEAN:
-						_fill_from_dict<bool>(col_data, current_batch_size, output.data[out_col_idx], output_offset);
-						break;
-					case SQLTypeId::INTEGER:
-						_fill_from_dict<int32_t>(col_data, current_batch_size, output.data[out_col_idx], output_offset);
-						break;
-					case SQLTypeId::BIGINT:
-						_fill_from_dict<int64_t>(col_data, current_batch_size, output.data[out_col_idx], output_offset);
-						break;
-					case SQLTypeId::FLOAT:
-						_fill_from_dict<float>(col_data, current_batch_size, output.data[out_col_idx], output_offset);
-						break;
-					case SQLTypeId::DOUBLE:
-						_fill_from_dict<double>(col_data, current_batch_size, output.data[out_col_idx], output_offset);
-						break;
-					case SQLTypeId::TIMESTAMP:
-						_fill_from_dict<timestamp_t>(col_data, current_batch_size, output.data[out_col_idx],
-						                             output_offset);
-						break;
-					case SQLTypeId::VARCHAR: {
-						if (!col_data.string_collection) {
-							throw runtime_error("Did not see a dictionary for strings. Corrupt file?");
+							out_data_ptr[i + output_offset] =
+							    FlatVector::GetData<string_t>(vec)[offset % STANDARD_VECTOR_SIZE];
+						} else {
+							FlatVector::SetNull(target, i + output_offset, true);
 						}
+					}
+				} break;
+				default:
+					throw runtime_error(SQLTypeToString(leaf.sql_type));
+				}
 
-						// the strings can be anywhere in the collection so just reference it all
-						for (auto &chunk : col_data.string_collection->chunks) {
-							StringVector::AddHeapReference(output.data[out_col_idx], chunk->data[0]);
+				break;
+			}
+			case Encoding::PLAIN:
+				assert(col_data.payload.ptr);
+				switch (leaf.sql_type.id) {
+				case SQLTypeId::BOOLEAN: {
+					// bit packed this
+					auto target_ptr = FlatVector::GetData<bool>(target);
+					int byte_pos = 0;
+					for (idx_t i = 0; i < current_batch_size; i++) {
+						if (!col_data.defined_buf.ptr[i]) {
+							FlatVector::SetNull(target, i + output_offset, true);
+							continue;
 						}
-
-						auto out_data_ptr = FlatVector::GetData<string_t>(output.data[out_col_idx]);
-						for (idx_t i = 0; i < current_batch_size; i++) {
-							if (col_data.defined_buf.ptr[i]) {
-								auto offset = col_data.offset_buf.read<uint32_t>();
-								if (offset >= col_data.string_collection->count) {
-									throw runtime_error("string dictionary offset out of bounds");
-								}
-								auto &chunk = col_data.string_collection->chunks[offset / STANDARD_VECTOR_SIZE];
-								auto &vec = chunk->data[0];
-
-								out_data_ptr[i + output_offset] =
-								    FlatVector::GetData<string_t>(vec)[offset % STANDARD_VECTOR_SIZE];
-							} else {
-								FlatVector::SetNull(output.data[out_col_idx], i + output_offset, true);
-							}
+						col_data.payload.available(1);
+						target_ptr[i + output_offset] = (*col_data.payload.ptr >> byte_pos) & 1;
+						byte_pos++;
+						if (byte_pos == 8) {
+							byte_pos = 0;
+							col_data.payload.inc(1);
 						}
-					} break;
-					default:
-						throw runtime_error(SQLTypeToString(data.sql_types[file_col_idx]));
 					}
-
 					break;
 				}
-				case Encoding::PLAIN:
-					assert(col_data.payload.ptr);
-					switch (data.sql_types[file_col_idx].id) {
-					case SQLTypeId::BOOLEAN: {
-						// bit packed this
-						auto target_ptr = FlatVector::GetData<bool>(output.data[out_col_idx]);
-						int byte_pos = 0;
-						for (idx_t i = 0; i < current_batch_size; i++) {
-							if (!col_data.defined_buf.ptr[i]) {
-								FlatVector::SetNull(output.data[out_col_idx], i + output_offset, true);
-								continue;
-							}
-							col_data.payload.available(1);
-							target_ptr[i + output_offset] = (*col_data.payload.ptr >> byte_pos) & 1;
-							byte_pos++;
-							if (byte_pos == 8) {
-								byte_pos = 0;
-								col_data.payload.inc(1);
-							}
+				case SQLTypeId::INTEGER:
+					_fill_from_plain<int32_t>(col_data, current_batch_size, target,
+					                          output_offset);
+					break;
+				case SQLTypeId::BIGINT:
+					_fill_from_plain<int64_t>(col_data, current_batch_size, target,
+					                          output_offset);
+					break;
+				case SQLTypeId::FLOAT:
+					_fill_from_plain<float>(col_data, current_batch_size, target, output_offset);
+					break;
+				case SQLTypeId::DOUBLE:
+					_fill_from_plain<double>(col_data, current_batch_size, target, output_offset);
+					break;
+				case SQLTypeId::TIMESTAMP: {
+					for (idx_t i = 0; i < current_batch_size; i++) {
+						if (col_data.defined_buf.ptr[i]) {
+							((timestamp_t *)FlatVector::GetData(target))[i + output_offset] =
+							    impala_timestamp_to_timestamp_t(col_data.payload.read<Int96>());
+						} else {
+							FlatVector::SetNull(target, i + output_offset, true);
 						}
-						break;
 					}
-					case SQLTypeId::INTEGER:
-						_fill_from_plain<int32_t>(col_data, current_batch_size, output.data[out_col_idx],
-						                          output_offset);
-						break;
-					case SQLTypeId::BIGINT:
-						_fill_from_plain<int64_t>(col_data, current_batch_size, output.data[out_col_idx],
-						                          output_offset);
-						break;
-					case SQLTypeId::FLOAT:
-						_fill_from_plain<float>(col_data, current_batch_size, output.data[out_col_idx], output_offset);
-						break;
-					case SQLTypeId::DOUBLE:
-						_fill_from_plain<double>(col_data, current_batch_size, output.data[out_col_idx], output_offset);
-						break;
-					case SQLTypeId::TIMESTAMP: {
-						for (idx_t i = 0; i < current_batch_size; i++) {
-							if (col_data.defined_buf.ptr[i]) {
-								((timestamp_t *)FlatVector::GetData(output.data[out_col_idx]))[i + output_offset] =
-								    impala_timestamp_to_timestamp_t(col_data.payload.read<Int96>());
-							} else {
-								FlatVector::SetNull(output.data[out_col_idx], i + output_offset, true);
-							}
-						}
 
-						break;
-					}
-					case SQLTypeId::VARCHAR: {
-						for (idx_t i = 0; i < current_batch_size; i++) {
-							if (col_data.defined_buf.ptr[i]) {
-								uint32_t str_len = col_data.payload.read<uint32_t>();
-								col_data.payload.available(str_len);
-								FlatVector::GetData<string_t>(output.data[out_col_idx])[i + output_offset] =
-								    StringVector::AddString(output.data[out_col_idx], col_data.payload.ptr, str_len);
-								col_data.payload.inc(str_len);
-							} else {
-								FlatVector::SetNull(output.data[out_col_idx], i + output_offset, true);
-							}
+					break;
+				}
+				case SQLTypeId::VARCHAR: {
+					for (idx_t i = 0; i < current_batch_size; i++) {
+						if (col_data.defined_buf.ptr[i]) {
+							uint32_t str_len = col_data.payload.read<uint32_t>();
+							col_data.payload.available(str_len);
+							FlatVector::GetData<string_t>(target)[i + output_offset] =
+							    StringVector::AddString(target, col_data.payload.ptr, str_len);
+							col_data.payload.inc(str_len);
+						} else {
+							FlatVector::SetNull(target, i + output_offset, true);
 						}
-						break;
 					}
-					default:
-						throw runtime_error(SQLTypeToString(data.sql_types[file_col_idx]));
-					}
-
 					break;
-
+				}
 				default:
-					throw runtime_error("Data page has unsupported/invalid encoding");
+					throw runtime_error(SQLTypeToString(leaf.sql_type));
 				}
 
-				output_offset += current_batch_size;
-				col_data.page_offset += current_batch_size;
+				break;
+
+			default:
+				throw runtime_error("Data page has unsupported/invalid encoding");
 			}
-		}
-		data.group_offset += output.size();
-	}
-};
 
-class MyTransport : public TTransport {
-public:
-	MyTransport(Serializer &serializer) : serializer(serializer) {
+			output_offset += current_batch_size;
+			col_data.page_offset += current_batch_size;
+		}
 	}
 
-	bool isOpen() const override {
-		return true;
+	//! Decode the entire column chunk of a leaf of a nested column of the current row group
+	static void _read_nested_leaf(ParquetScanFunctionData &data, ParquetReaderState &state, idx_t leaf_idx) {
+		auto &col_data = state.column_data[leaf_idx];
+		idx_t value_count = state.GetGroup().columns[leaf_idx].meta_data.num_values;
+		col_data.repeat_levels.resize(value_count);
+		col_data.define_levels.resize(value_count);
+		col_data.value_position = 0;
+
+		// we hand-roll the chunk collection: all chunks but the last one are full
+		vector<TypeId> types = {GetInternalType(data.leaves[leaf_idx]->sql_type)};
+		col_data.values.chunks.clear();
+		col_data.values.count = 0;
+		col_data.values.types = types;
+		for (idx_t offset = 0; offset < value_count; offset += STANDARD_VECTOR_SIZE) {
+			auto count = std::min((idx_t)STANDARD_VECTOR_SIZE, value_count - offset);
+			auto chunk = make_unique<DataChunk>();
+			chunk->Initialize(types);
+			_read_leaf(data, state, leaf_idx, count, chunk->data[0], 0, col_data.repeat_levels.data() + offset,
+			           col_data.define_levels.data() + offset);
+			chunk->SetCardinality(count);
+			col_data.values.count += count;
+			col_data.values.chunks.push_back(move(chunk));
+		}
 	}
 
-	void open() override {
+	//! Copy the next count values of a decoded leaf of a nested column into the result
+	static void _assemble_leaf(ParquetScanColumnData &col_data, idx_t count, Vector &result) {
+		idx_t result_offset = 0;
+		while (result_offset < count) {
+			auto chunk_idx = col_data.value_position / STANDARD_VECTOR_SIZE;
+			auto chunk_offset = col_data.value_position % STANDARD_VECTOR_SIZE;
+			if (chunk_idx >= col_data.values.chunks.size()) {
+				throw runtime_error("Column chunk contains fewer values than expected. File corrupt?");
+			}
+			auto &chunk = *col_data.values.chunks[chunk_idx];
+			auto copy_count = std::min(count - result_offset, chunk.size() - chunk_offset);
+			VectorOperations::Copy(chunk.data[0], result, chunk_offset + copy_count, chunk_offset, result_offset);
+			result_offset += copy_count;
+			col_data.value_position += copy_count;
+		}
 	}
 
-	void close() override {
+	static void _assemble_struct(ParquetScanFunctionData &data, ParquetReaderState &state, ParquetSchemaNode &node,
+	                             idx_t count, Vector &result) {
+		// the first leaf determines which structs are NULL: every struct corresponds to a value of the leaf, followed
+		// by the values of the lists inside the struct (which have a higher repetition level)
+		auto &first_leaf = state.column_data[node.leaf_index];
+		auto position = first_leaf.value_position;
+		for (idx_t i = 0; i < count; i++) {
+			if (position >= first_leaf.define_levels.size()) {
+				throw runtime_error("Column chunk contains fewer values than expected. File corrupt?");
+			}
+			if (first_leaf.define_levels[position] < node.define_level) {
+				FlatVector::SetNull(result, i, true);
+			}
+			position++;
+			while (position < first_leaf.repeat_levels.size() &&
+			       first_leaf.repeat_levels[position] > node.repeat_level) {
+				position++;
+			}
+		}
+		for (auto &child : node.children) {
+			auto child_vector = make_unique<Vector>(GetInternalType(child->sql_type));
+			_assemble_node(data, state, *child, count, *child_vector);
+			StructVector::AddEntry(result, child->name, move(child_vector));
+		}
 	}
 
-	void write_virt(const uint8_t *buf, uint32_t len) override {
-		serializer.WriteData((const_data_ptr_t)buf, len);
-	}
+	static void _assemble_list(ParquetScanFunctionData &data, ParquetReaderState &state, ParquetSchemaNode &node,
+	                           idx_t count, Vector &result) {
+		auto &element = *node.children[0];
+		auto list_data = FlatVector::GetData<list_entry_t>(result);
+		auto child_collection = make_unique<ChunkCollection>();
+
+		DataChunk elements;
+		vector<TypeId> types = {GetInternalType(element.sql_type)};
+		elements.Initialize(types);
+		// the elements of consecutive lists are read together, pending_elements have not been read yet
+		idx_t element_count = 0;
+		idx_t pending_elements = 0;
+		auto read_elements = [&]() {
+			while (pending_elements > 0) {
+				auto read_count = std::min((idx_t)STANDARD_VECTOR_SIZE, pending_elements);
+				elements.Reset();
+				_assemble_node(data, state, element, read_count, elements.data[0]);
+				elements.SetCardinality(read_count);
+				child_collection->Append(elements);
+				pending_elements -= read_count;
+			}
+		};
+
+		// the first leaf determines the lists: a list starts with a value of the leaf with a repetition level lower
+		// than the level of the elements, every following value with the repetition level of the elements starts
+		// another element of the list
+		auto &first_leaf = state.column_data[node.leaf_index];
+		auto position = first_leaf.value_position;
+		for (idx_t i = 0; i < count; i++) {
+			if (position >= first_leaf.define_levels.size()) {
+				throw runtime_error("Column chunk contains fewer values than expected. File corrupt?");
+			}
+			auto define_level = first_leaf.define_levels[position];
+			position++;
+			list_data[i].offset = element_count;
+			if (define_level < node.element_define_level) {
+				// a NULL or empty list: it is stored as a single value in every leaf of the list, which is skipped
+				read_elements();
+				for (idx_t leaf_idx = node.leaf_index; leaf_idx < node.leaf_index + node.leaf_count; leaf_idx++) {
+					state.column_data[leaf_idx].value_position++;
+				}
+				list_data[i].length = 0;
+				if (define_level < node.define_level) {
+					FlatVector::SetNull(result, i, true);
+				}
+				continue;
+			}
+			idx_t length = 1;
+			while (position < first_leaf.repeat_levels.size() &&
+			       first_leaf.repeat_levels[position] >= node.element_repeat_level) {
+				if (first_leaf.repeat_levels[position] == node.element_repeat_level) {
+					length++;
+				}
+				position++;
+			}
+			list_data[i].length = length;
+			element_count += length;
+			pending_elements += length;
+		}
+		read_elements();
+		ListVector::SetEntry(result, move(child_collection));
+	}
+
+	//! Assemble the next count values of a node of a nested column from the decoded leaves
+	static void _assemble_node(ParquetScanFunctionData &data, ParquetReaderState &state, ParquetSchemaNode &node,
+	                           idx_t count, Vector &result) {
+		switch (node.node_type) {
+		case ParquetNodeType::LEAF:
+			_assemble_leaf(state.column_data[node.leaf_index], count, result);
+			break;
+		case ParquetNodeType::STRUCT:
+			_assemble_struct(data, state, node, count, result);
+			break;
+		case ParquetNodeType::LIST:
+			_assemble_list(data, state, node, count, result);
+			break;
+		}
+	}
+
+	//! Scan the next chunk of the row groups of the reader, the output is empty if all row groups have been scanned
+	static void parquet_scan_reader(ClientContext &context, ParquetScanFunctionData &data, ParquetReaderState &state,
+	                                DataChunk &output) {
+		if (state.finished) {
+			return;
+		}
+		if (!state.handle) {
+			auto &fs = FileSystem::GetFileSystem(context);
+			state.handle = fs.OpenFile(state.file_name.c_str(), FileFlags::READ);
+			state.column_data.resize(data.leaves.size());
+		}
+
+		// see if we have to switch to the next row group in the parquet file
+		while (state.current_group < 0 || state.group_offset >= state.GetGroup().num_rows) {
+			state.current_group++;
+			state.group_offset = 0;
+
+			if ((idx_t)state.current_group == state.row_groups.size()) {
+				state.finished = true;
+				return;
+			}
+
+			_prepare_row_group(data, state);
+		}
+
+		auto &current_group = state.GetGroup();
+		output.SetCardinality(std::min((int64_t)STANDARD_VECTOR_SIZE, current_group.num_rows - state.group_offset));
+
+		if (output.size() == 0) {
+			return;
+		}
+
+		for (idx_t out_col_idx = 0; out_col_idx < output.column_count(); out_col_idx++) {
+			auto file_col_idx = data.column_ids[out_col_idx];
+			if (file_col_idx == COLUMN_IDENTIFIER_ROW_ID) {
+				Value constant_42 = Value::BIGINT(42);
+				output.data[out_col_idx].Reference(constant_42);
+				continue;
+			}
+
+			auto &column = *data.columns[file_col_idx];
+			if (column.node_type == ParquetNodeType::LEAF) {
+				// flat columns are decoded directly into the output
+				_read_leaf(data, state, column.leaf_index, output.size(), output.data[out_col_idx], 0, nullptr,
+				           nullptr);
+			} else {
+				_assemble_node(data, state, column, output.size(), output.data[out_col_idx]);
+			}
+		}
+		state.group_offset += output.size();
+	}
+
+	template <class T>
+	static bool _check_statistics(T min_value, T max_value, T constant, ExpressionType comparison_type) {
+		switch (comparison_type) {
+		case ExpressionType::COMPARE_EQUAL:
+			return constant >= min_value && constant <= max_value;
+		case ExpressionType::COMPARE_GREATERTHAN:
+			return max_value > constant;
+		case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+			return max_value >= constant;
+		case ExpressionType::COMPARE_LESSTHAN:
+			return min_value < constant;
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+			return min_value <= constant;
+		default:
+			return true;
+		}
+	}
+
+	template <class T>
+	static bool _check_plain_statistics(const string &min, const string &max, T constant,
+	                                    ExpressionType comparison_type) {
+		if (min.size() != sizeof(T) || max.size() != sizeof(T)) {
+			return true;
+		}
+		T min_value, max_value;
+		memcpy(&min_value, min.c_str(), sizeof(T));
+		memcpy(&max_value, max.c_str(), sizeof(T));
+		if (min_value != min_value || max_value != max_value) {
+			// NaN bounds cannot be used to skip anything
+			return true;
+		}
+		return _check_statistics<T>(min_value, max_value, constant, comparison_type);
+	}
+
+	//! Returns false if the statistics of the row group show that none of its rows can pass the pushed down filters
+	static bool _row_group_may_match(ParquetScanFunctionData &data, RowGroup &group) {
+		for (auto &filter : data.table_filters) {
+			// only the statistics of flat columns can be used
+			auto &column = *data.columns[filter.column_index];
+			if (column.node_type != ParquetNodeType::LEAF || !group.columns[column.leaf_index].__isset.meta_data) {
+				continue;
+			}
+			auto &meta_data = group.columns[column.leaf_index].meta_data;
+			if (!meta_data.__isset.statistics) {
+				continue;
+			}
+			auto &stats = meta_data.statistics;
+			if (filter.comparison_type == ExpressionType::OPERATOR_IS_NULL) {
+				if (stats.__isset.null_count && stats.null_count == 0) {
+					// there are no NULL values in the row group
+					return false;
+				}
+				continue;
+			}
+			if (stats.__isset.null_count && stats.null_count == group.num_rows) {
+				// all values are NULL: neither IS NOT NULL nor a comparison is ever true
+				return false;
+			}
+			if (filter.comparison_type == ExpressionType::OPERATOR_IS_NOT_NULL) {
+				continue;
+			}
+			string min, max;
+			if (stats.__isset.min_value && stats.__isset.max_value) {
+				min = stats.min_value;
+				max = stats.max_value;
+			} else if (stats.__isset.min && stats.__isset.max && meta_data.type != Type::BYTE_ARRAY) {
+				// the deprecated min/max use a signed byte-wise comparison for strings, so only use them for numbers
+				min = stats.min;
+				max = stats.max;
+			} else {
+				continue;
+			}
+			auto &sql_type = data.sql_types[filter.column_index];
+			if (filter.constant.type != GetInternalType(sql_type)) {
+				continue;
+			}
+			bool may_match = true;
+			switch (sql_type.id) {
+			case SQLTypeId::INTEGER:
+				may_match = _check_plain_statistics<int32_t>(min, max, filter.constant.value_.integer,
+				                                             filter.comparison_type);
+				break;
+			case SQLTypeId::BIGINT:
+				may_match = _check_plain_statistics<int64_t>(min, max, filter.constant.value_.bigint,
+				                                             filter.comparison_type);
+				break;
+			case SQLTypeId::FLOAT:
+				may_match = _check_plain_statistics<float>(min, max, filter.constant.value_.float_,
+				                                           filter.comparison_type);
+				break;
+			case SQLTypeId::DOUBLE:
+				may_match = _check_plain_statistics<double>(min, max, filter.constant.value_.double_,
+				                                            filter.comparison_type);
+				break;
+			case SQLTypeId::VARCHAR:
+				may_match = _check_statistics<string>(min, max, filter.constant.str_value, filter.comparison_type);
+				break;
+			default:
+				break;
+			}
+			if (!may_match) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//! Returns the row groups of the file that have to be scanned
+	static vector<idx_t> _get_row_groups(ParquetScanFunctionData &data, FileMetaData &file_meta_data) {
+		vector<idx_t> row_groups;
+		for (idx_t i = 0; i < file_meta_data.row_groups.size(); i++) {
+			if (_row_group_may_match(data, file_meta_data.row_groups[i])) {
+				row_groups.push_back(i);
+			}
+		}
+		return row_groups;
+	}
+
+	template <class T, class OP>
+	static void _filter_column(Vector &vector, T constant, SelectionVector &sel, idx_t &count) {
+		auto vector_data = FlatVector::GetData<T>(vector);
+		auto &nullmask = FlatVector::Nullmask(vector);
+		idx_t result_count = 0;
+		for (idx_t i = 0; i < count; i++) {
+			auto idx = sel.get_index(i);
+			if (!nullmask[idx] && OP::Operation(vector_data[idx], constant)) {
+				sel.set_index(result_count++, idx);
+			}
+		}
+		count = result_count;
+	}
+
+	template <class T>
+	static void _filter_column(Vector &vector, T constant, ExpressionType comparison_type, SelectionVector &sel,
+	                           idx_t &count) {
+		switch (comparison_type) {
+		case ExpressionType::COMPARE_EQUAL:
+			_filter_column<T, Equals>(vector, constant, sel, count);
+			break;
+		case ExpressionType::COMPARE_GREATERTHAN:
+			_filter_column<T, GreaterThan>(vector, constant, sel, count);
+			break;
+		case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+			_filter_column<T, GreaterThanEquals>(vector, constant, sel, count);
+			break;
+		case ExpressionType::COMPARE_LESSTHAN:
+			_filter_column<T, LessThan>(vector, constant, sel, count);
+			break;
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+			_filter_column<T, LessThanEquals>(vector, constant, sel, count);
+			break;
+		default:
+			break;
+		}
+	}
+
+	//! Removes the rows from the chunk that cannot pass the pushed down filters, the filters are executed again on
+	//! top of the scan so this is only an optimization
+	static void _apply_filters(ParquetScanFunctionData &data, DataChunk &output) {
+		SelectionVector sel(STANDARD_VECTOR_SIZE);
+		for (idx_t i = 0; i < output.size(); i++) {
+			sel.set_index(i, i);
+		}
+		idx_t count = output.size();
+		for (auto &filter : data.table_filters) {
+			for (idx_t out_col_idx = 0; out_col_idx < output.column_count(); out_col_idx++) {
+				auto &vector = output.data[out_col_idx];
+				if (data.column_ids[out_col_idx] != filter.column_index ||
+				    vector.vector_type != VectorType::FLAT_VECTOR || vector.type != filter.constant.type) {
+					continue;
+				}
+				switch (vector.type) {
+				case TypeId::INT32:
+					_filter_column<int32_t>(vector, filter.constant.value_.integer, filter.comparison_type, sel,
+					                        count);
+					break;
+				case TypeId::INT64:
+					_filter_column<int64_t>(vector, filter.constant.value_.bigint, filter.comparison_type, sel,
+					                        count);
+					break;
+				case TypeId::FLOAT:
+					_filter_column<float>(vector, filter.constant.value_.float_, filter.comparison_type, sel, count);
+					break;
+				case TypeId::DOUBLE:
+					_filter_column<double>(vector, filter.constant.value_.double_, filter.comparison_type, sel,
+					                       count);
+					break;
+				case TypeId::VARCHAR:
+					_filter_column<string_t>(vector, string_t(filter.constant.str_value), filter.comparison_type, sel,
+					                         count);
+					break;
+				default:
+					break;
+				}
+			}
+		}
+		if (count < output.size()) {
+			output.Slice(sel, count);
+		}
+	}
+
+	//! Scan the next chunk of the reader that contains rows that can pass the pushed down filters
+	static void parquet_scan_filtered(ClientContext &context, ParquetScanFunctionData &data, ParquetReaderState &state,
+	                                  DataChunk &output) {
+		while (true) {
+			parquet_scan_reader(context, data, state, output);
+			if (output.size() == 0 || data.table_filters.empty()) {
+				return;
+			}
+			_apply_filters(data, output);
+			if (output.size() > 0) {
+				return;
+			}
+			output.Reset();
+		}
+	}
+
+	static void parquet_scan_function(ClientContext &context, vector<Value> &input, DataChunk &output,
+	                                  FunctionData *dataptr) {
+		auto &data = *((ParquetScanFunctionData *)dataptr);
+		while (true) {
+			if (!data.current_reader) {
+				if (data.file_index >= data.files.size()) {
+					// all files have been scanned
+					return;
+				}
+				// move on to the next file, scanning all of its row groups that can contain matching rows
+				auto file_meta_data = get_file_meta_data(context, data, data.file_index);
+				auto row_groups = _get_row_groups(data, *file_meta_data);
+				data.current_reader =
+				    make_unique<ParquetReaderState>(data.files[data.file_index], move(file_meta_data), move(row_groups));
+				data.file_index++;
+			}
+			parquet_scan_filtered(context, data, *data.current_reader, output);
+			if (output.size() > 0) {
+				return;
+			}
+			data.current_reader.reset();
+		}
+	}
+
+	static void parquet_scan_parallel_tasks(ClientContext &context, vector<Value> &input, FunctionData *dataptr,
+	                                        std::function<void(unique_ptr<OperatorTaskInfo>)> callback) {
+		auto &data = *((ParquetScanFunctionData *)dataptr);
+		// every row group of every file is scanned by a separate task, skipping row groups without matching rows
+		for (idx_t file_idx = 0; file_idx < data.files.size(); file_idx++) {
+			auto file_meta_data = get_file_meta_data(context, data, file_idx);
+			for (auto group_idx : _get_row_groups(data, *file_meta_data)) {
+				callback(make_unique<ParquetScanTaskInfo>(data.files[file_idx], file_meta_data, group_idx));
+			}
+		}
+	}
+
+	static void parquet_scan_parallel(ClientContext &context, vector<Value> &input, DataChunk &output,
+	                                  FunctionData *dataptr, OperatorTaskInfo &task_info) {
+		auto &data = *((ParquetScanFunctionData *)dataptr);
+		auto &info = (ParquetScanTaskInfo &)task_info;
+		parquet_scan_filtered(context, data, info.state, output);
+	}
+};
+
+class MyTransport : public TTransport {
+public:
+	MyTransport(Serializer &serializer) : serializer(serializer) {
+	}
+
+	bool isOpen() const override {
+		return true;
+	}
+
+	void open() override {
+	}
+
+	void close() override {
+	}
+
+	void write_virt(const uint8_t *buf, uint32_t len) override {
+		serializer.WriteData((const_data_ptr_t)buf, len);
+	}
 
 private:
 	Serializer &serializer;
@@ -1014,202 +1792,574 @@ static void VarintEncode(uint32_t val, Serializer &ser) {
 	} while (val != 0);
 }
 
-static uint8_t GetVarintSize(uint32_t val) {
-	uint8_t res = 0;
-	do {
-		uint8_t byte = val & 127;
-		val >>= 7;
-		if (val != 0) {
-			byte |= 128;
-		}
-		res++;
-	} while (val != 0);
-	return res;
-}
+//! Converts a value to the physical type of its Parquet column
+struct ParquetCastOperator {
+	template <class SRC, class TGT> static TGT Operation(SRC input) {
+		return (TGT)input;
+	}
+};
 
-template <class SRC, class TGT>
+struct ParquetTimestampOperator {
+	template <class SRC, class TGT> static TGT Operation(SRC input) {
+		return timestamp_t_to_impala_timestamp(input);
+	}
+};
+
+template <class SRC, class TGT, class OP = ParquetCastOperator>
 static void _write_plain(Vector &col, idx_t length, nullmask_t &nullmask, Serializer &ser) {
 	auto *ptr = FlatVector::GetData<SRC>(col);
 	for (idx_t r = 0; r < length; r++) {
 		if (!nullmask[r]) {
-			ser.Write<TGT>((TGT)ptr[r]);
+			ser.Write<TGT>(OP::template Operation<SRC, TGT>(ptr[r]));
+		}
+	}
+}
+
+//! Writes the non-null values of a column of the buffer with the PLAIN encoding
+static void _write_plain_column(ChunkCollection &buffer, idx_t col_idx, SQLType sql_type, Serializer &ser) {
+	if (sql_type.id == SQLTypeId::BOOLEAN) {
+		// booleans are bit-packed over the entire page, not per chunk
+		uint8_t byte = 0;
+		uint8_t byte_pos = 0;
+		for (auto &chunk : buffer.chunks) {
+			auto &input_column = chunk->data[col_idx];
+			auto &nullmask = FlatVector::Nullmask(input_column);
+			auto *ptr = FlatVector::GetData<bool>(input_column);
+			for (idx_t r = 0; r < chunk->size(); r++) {
+				if (nullmask[r]) {
+					continue;
+				}
+				byte |= (ptr[r] & 1) << byte_pos;
+				byte_pos++;
+				if (byte_pos == 8) {
+					ser.Write<uint8_t>(byte);
+					byte = 0;
+					byte_pos = 0;
+				}
+			}
+		}
+		// flush last byte if req
+		if (byte_pos > 0) {
+			ser.Write<uint8_t>(byte);
+		}
+		return;
+	}
+	for (auto &chunk : buffer.chunks) {
+		auto &input = *chunk;
+		auto &input_column = input.data[col_idx];
+		auto &nullmask = FlatVector::Nullmask(input_column);
+		switch (sql_type.id) {
+		case SQLTypeId::TINYINT:
+			_write_plain<int8_t, int32_t>(input_column, input.size(), nullmask, ser);
+			break;
+		case SQLTypeId::SMALLINT:
+			_write_plain<int16_t, int32_t>(input_column, input.size(), nullmask, ser);
+			break;
+		case SQLTypeId::INTEGER:
+			_write_plain<int32_t, int32_t>(input_column, input.size(), nullmask, ser);
+			break;
+		case SQLTypeId::BIGINT:
+			_write_plain<int64_t, int64_t>(input_column, input.size(), nullmask, ser);
+			break;
+		case SQLTypeId::FLOAT:
+			_write_plain<float, float>(input_column, input.size(), nullmask, ser);
+			break;
+		case SQLTypeId::DOUBLE:
+			_write_plain<double, double>(input_column, input.size(), nullmask, ser);
+			break;
+		case SQLTypeId::TIMESTAMP:
+			_write_plain<timestamp_t, Int96, ParquetTimestampOperator>(input_column, input.size(), nullmask, ser);
+			break;
+		case SQLTypeId::VARCHAR: {
+			auto *ptr = FlatVector::GetData<string_t>(input_column);
+			for (idx_t r = 0; r < input.size(); r++) {
+				if (!nullmask[r]) {
+					ser.Write<uint32_t>(ptr[r].GetSize());
+					ser.WriteData((const_data_ptr_t)ptr[r].GetData(), ptr[r].GetSize());
+				}
+			}
+			break;
+		}
+			// TODO date blob etc.
+		default:
+			throw NotImplementedException(SQLTypeToString(sql_type));
 		}
 	}
 }
 
+//! Encodes values with the RLE/bit-packing hybrid encoding, the inverse of the RleBpDecoder. Runs of equal values are
+//! written as RLE runs, all other values are bit-packed in groups of 8 values.
+class RleBpEncoder {
+public:
+	//! The minimum length of a run of equal values to be written as a RLE run
+	static constexpr idx_t MINIMUM_RUN_LENGTH = 8;
+
+	RleBpEncoder(uint32_t bit_width) : bit_width(bit_width), byte_width((bit_width + 7) / 8) {
+	}
+
+	void Encode(const uint32_t *values, idx_t count, Serializer &ser) {
+		idx_t literal_start = 0;
+		idx_t i = 0;
+		while (i < count) {
+			idx_t run_length = 1;
+			while (i + run_length < count && values[i + run_length] == values[i]) {
+				run_length++;
+			}
+			// a RLE run can only start after a complete group of bit-packed values
+			idx_t literal_padding = (8 - (i - literal_start) % 8) % 8;
+			if (run_length < literal_padding + MINIMUM_RUN_LENGTH) {
+				i += run_length;
+				continue;
+			}
+			i += literal_padding;
+			run_length -= literal_padding;
+			WriteLiterals(values + literal_start, i - literal_start, ser);
+			WriteRun(values[i], run_length, ser);
+			i += run_length;
+			literal_start = i;
+		}
+		WriteLiterals(values + literal_start, count - literal_start, ser);
+	}
+
+private:
+	void WriteRun(uint32_t value, idx_t run_length, Serializer &ser) {
+		VarintEncode(run_length << 1, ser);
+		for (idx_t i = 0; i < byte_width; i++) {
+			ser.Write<uint8_t>((value >> (i * 8)) & 0xFF);
+		}
+	}
+
+	void WriteLiterals(const uint32_t *values, idx_t count, Serializer &ser) {
+		if (count == 0) {
+			return;
+		}
+		// the last group is padded with zeros
+		idx_t group_count = (count + 7) / 8;
+		VarintEncode((group_count << 1) | 1, ser);
+		uint64_t bits = 0;
+		idx_t bit_count = 0;
+		for (idx_t i = 0; i < group_count * 8; i++) {
+			bits |= (uint64_t)(i < count ? values[i] : 0) << bit_count;
+			bit_count += bit_width;
+			while (bit_count >= 8) {
+				ser.Write<uint8_t>(bits & 0xFF);
+				bits >>= 8;
+				bit_count -= 8;
+			}
+		}
+	}
+
+	uint32_t bit_width;
+	idx_t byte_width;
+};
+
+//! The maximum amount of entries in the dictionary of a column chunk
+static constexpr idx_t PARQUET_MAX_DICTIONARY_SIZE = 65536;
+
+//! Builds the dictionary of a column of the buffer, written PLAIN into the serializer, and the dictionary index of
+//! every non-null value. Values are compared by their bit pattern (KEY) so e.g. -0.0 and 0.0 remain distinct. Returns
+//! the amount of dictionary entries, or 0 if the column has more than max_size distinct values.
+template <class SRC, class TGT, class OP = ParquetCastOperator, class KEY = SRC>
+static idx_t _write_dictionary(ChunkCollection &buffer, idx_t col_idx, idx_t max_size, Serializer &dictionary,
+                               vector<uint32_t> &indexes) {
+	static_assert(sizeof(SRC) == sizeof(KEY), "Dictionary keys must have the size of the values");
+	unordered_map<KEY, uint32_t> index_map;
+	for (auto &chunk : buffer.chunks) {
+		auto &input_column = chunk->data[col_idx];
+		auto &nullmask = FlatVector::Nullmask(input_column);
+		auto *ptr = FlatVector::GetData<SRC>(input_column);
+		for (idx_t r = 0; r < chunk->size(); r++) {
+			if (nullmask[r]) {
+				continue;
+			}
+			KEY key;
+			memcpy(&key, &ptr[r], sizeof(KEY));
+			auto entry = index_map.find(key);
+			if (entry != index_map.end()) {
+				indexes.push_back(entry->second);
+				continue;
+			}
+			if (index_map.size() >= max_size) {
+				return 0;
+			}
+			uint32_t index = index_map.size();
+			index_map[key] = index;
+			dictionary.Write<TGT>(OP::template Operation<SRC, TGT>(ptr[r]));
+			indexes.push_back(index);
+		}
+	}
+	return index_map.size();
+}
+
+struct ParquetStringHash {
+	size_t operator()(const string_t &value) const {
+		return Hash<string_t>(value);
+	}
+};
+
+struct ParquetStringEquality {
+	bool operator()(const string_t &a, const string_t &b) const {
+		return Equals::Operation<string_t>(a, b);
+	}
+};
+
+static idx_t _write_string_dictionary(ChunkCollection &buffer, idx_t col_idx, idx_t max_size, Serializer &dictionary,
+                                      vector<uint32_t> &indexes) {
+	unordered_map<string_t, uint32_t, ParquetStringHash, ParquetStringEquality> index_map;
+	for (auto &chunk : buffer.chunks) {
+		auto &input_column = chunk->data[col_idx];
+		auto &nullmask = FlatVector::Nullmask(input_column);
+		auto *ptr = FlatVector::GetData<string_t>(input_column);
+		for (idx_t r = 0; r < chunk->size(); r++) {
+			if (nullmask[r]) {
+				continue;
+			}
+			auto entry = index_map.find(ptr[r]);
+			if (entry != index_map.end()) {
+				indexes.push_back(entry->second);
+				continue;
+			}
+			if (index_map.size() >= max_size) {
+				return 0;
+			}
+			uint32_t index = index_map.size();
+			index_map[ptr[r]] = index;
+			dictionary.Write<uint32_t>(ptr[r].GetSize());
+			dictionary.WriteData((const_data_ptr_t)ptr[r].GetData(), ptr[r].GetSize());
+			indexes.push_back(index);
+		}
+	}
+	return index_map.size();
+}
+
+//! Tries to dictionary encode a column of the buffer, returns the amount of dictionary entries or 0 if the column
+//! should be written PLAIN. A dictionary is only used if it contains at most half as many entries as there are values.
+static idx_t _write_dictionary(ChunkCollection &buffer, idx_t col_idx, SQLType sql_type, idx_t value_count,
+                               Serializer &dictionary, vector<uint32_t> &indexes) {
+	idx_t max_size = std::min(PARQUET_MAX_DICTIONARY_SIZE, value_count / 2);
+	if (max_size == 0) {
+		return 0;
+	}
+	indexes.reserve(value_count);
+	switch (sql_type.id) {
+	case SQLTypeId::TINYINT:
+		return _write_dictionary<int8_t, int32_t>(buffer, col_idx, max_size, dictionary, indexes);
+	case SQLTypeId::SMALLINT:
+		return _write_dictionary<int16_t, int32_t>(buffer, col_idx, max_size, dictionary, indexes);
+	case SQLTypeId::INTEGER:
+		return _write_dictionary<int32_t, int32_t>(buffer, col_idx, max_size, dictionary, indexes);
+	case SQLTypeId::BIGINT:
+		return _write_dictionary<int64_t, int64_t>(buffer, col_idx, max_size, dictionary, indexes);
+	case SQLTypeId::FLOAT:
+		return _write_dictionary<float, float, ParquetCastOperator, uint32_t>(buffer, col_idx, max_size, dictionary,
+		                                                                      indexes);
+	case SQLTypeId::DOUBLE:
+		return _write_dictionary<double, double, ParquetCastOperator, uint64_t>(buffer, col_idx, max_size,
+		                                                                        dictionary, indexes);
+	case SQLTypeId::TIMESTAMP:
+		return _write_dictionary<timestamp_t, Int96, ParquetTimestampOperator>(buffer, col_idx, max_size, dictionary,
+		                                                                       indexes);
+	case SQLTypeId::VARCHAR:
+		return _write_string_dictionary(buffer, col_idx, max_size, dictionary, indexes);
+	default:
+		// booleans are already bit-packed, dictionaries would not make them any smaller
+		return 0;
+	}
+}
+
+//! Compresses a page with GZIP: a gzip header, the raw deflate stream and the gzip footer (CRC-32 and size)
+static unique_ptr<data_t[]> _gzip_compress(const_data_ptr_t data, idx_t size, idx_t &compressed_size) {
+	static const idx_t GZIP_HEADER_SIZE = 10;
+	static const idx_t GZIP_FOOTER_SIZE = 8;
+
+	struct MiniZStream {
+		~MiniZStream() {
+			if (init) {
+				mz_deflateEnd(&stream);
+			}
+		}
+
+		mz_stream stream;
+		bool init = false;
+	} s;
+	auto &stream = s.stream;
+	memset(&stream, 0, sizeof(mz_stream));
+	auto mz_ret = mz_deflateInit2(&stream, MZ_DEFAULT_LEVEL, MZ_DEFLATED, -MZ_DEFAULT_WINDOW_BITS, 1, 0);
+	if (mz_ret != MZ_OK) {
+		throw Exception("Failed to initialize miniz");
+	}
+	s.init = true;
+
+	auto max_deflated_size = mz_deflateBound(&stream, size);
+	auto compressed_buf = unique_ptr<data_t[]>(new data_t[GZIP_HEADER_SIZE + max_deflated_size + GZIP_FOOTER_SIZE]);
+	// magic, deflate, no flags, no modification time, no extra flags, unknown OS
+	const data_t gzip_hdr[GZIP_HEADER_SIZE] = {0x1F, 0x8B, 0x08, 0, 0, 0, 0, 0, 0, 0xFF};
+	memcpy(compressed_buf.get(), gzip_hdr, GZIP_HEADER_SIZE);
+
+	stream.next_in = (const unsigned char *)data;
+	stream.avail_in = size;
+	stream.next_out = (unsigned char *)compressed_buf.get() + GZIP_HEADER_SIZE;
+	stream.avail_out = max_deflated_size;
+	mz_ret = mz_deflate(&stream, MZ_FINISH);
+	if (mz_ret != MZ_STREAM_END) {
+		throw runtime_error("Compression failure: " + string(mz_error(mz_ret)));
+	}
+	compressed_size = GZIP_HEADER_SIZE + max_deflated_size - stream.avail_out;
+
+	auto footer = compressed_buf.get() + compressed_size;
+	uint32_t crc = mz_crc32(MZ_CRC32_INIT, (const unsigned char *)data, size);
+	uint32_t input_size = size;
+	for (idx_t i = 0; i < 4; i++) {
+		footer[i] = (crc >> (i * 8)) & 0xFF;
+		footer[4 + i] = (input_size >> (i * 8)) & 0xFF;
+	}
+	compressed_size += GZIP_FOOTER_SIZE;
+	return compressed_buf;
+}
+
+//! Compresses the page data with the codec and writes the page header followed by the (compressed) data into the
+//! serializer. Returns the uncompressed size of the page including its header.
+static idx_t _write_page(PageHeader &hdr, BufferedSerializer &page, CompressionCodec::type codec, TProtocol &protocol,
+                         BufferedSerializer &ser) {
+	hdr.uncompressed_page_size = page.blob.size;
+
+	const_data_ptr_t data = page.blob.data.get();
+	idx_t compressed_size = page.blob.size;
+	unique_ptr<data_t[]> compressed_buf;
+	switch (codec) {
+	case CompressionCodec::UNCOMPRESSED:
+		break;
+	case CompressionCodec::SNAPPY: {
+		size_t snappy_size = snappy::MaxCompressedLength(page.blob.size);
+		compressed_buf = unique_ptr<data_t[]>(new data_t[snappy_size]);
+		snappy::RawCompress((const char *)page.blob.data.get(), page.blob.size, (char *)compressed_buf.get(),
+		                    &snappy_size);
+		compressed_size = snappy_size;
+		data = compressed_buf.get();
+		break;
+	}
+	case CompressionCodec::GZIP:
+		compressed_buf = _gzip_compress(page.blob.data.get(), page.blob.size, compressed_size);
+		data = compressed_buf.get();
+		break;
+	default:
+		throw NotImplementedException("Unsupported compression codec");
+	}
+	hdr.compressed_page_size = compressed_size;
+
+	auto header_start = ser.blob.size;
+	hdr.write(&protocol);
+	auto header_size = ser.blob.size - header_start;
+	ser.WriteData(data, compressed_size);
+	return header_size + hdr.uncompressed_page_size;
+}
+
+//! Computes the min/max statistics of a numeric column of the buffer, stored in the physical type of the column
+template <class SRC, class TGT>
+static void _write_plain_statistics(ChunkCollection &buffer, idx_t col_idx, Statistics &stats) {
+	bool has_value = false;
+	TGT min_value = TGT(), max_value = TGT();
+	for (auto &chunk : buffer.chunks) {
+		auto &input_column = chunk->data[col_idx];
+		auto &nullmask = FlatVector::Nullmask(input_column);
+		auto *ptr = FlatVector::GetData<SRC>(input_column);
+		for (idx_t r = 0; r < chunk->size(); r++) {
+			if (nullmask[r]) {
+				continue;
+			}
+			auto value = (TGT)ptr[r];
+			if (value != value) {
+				// NaN values are not ordered: do not write min/max statistics
+				return;
+			}
+			if (!has_value || value < min_value) {
+				min_value = value;
+			}
+			if (!has_value || value > max_value) {
+				max_value = value;
+			}
+			has_value = true;
+		}
+	}
+	if (!has_value) {
+		return;
+	}
+	stats.__set_min_value(string((const char *)&min_value, sizeof(TGT)));
+	stats.__set_max_value(string((const char *)&max_value, sizeof(TGT)));
+	// the deprecated fields are still used by older readers, for numbers they have the same meaning
+	stats.__set_min(stats.min_value);
+	stats.__set_max(stats.max_value);
+}
+
+static void _write_string_statistics(ChunkCollection &buffer, idx_t col_idx, Statistics &stats) {
+	bool has_value = false;
+	string_t min_value, max_value;
+	for (auto &chunk : buffer.chunks) {
+		auto &input_column = chunk->data[col_idx];
+		auto &nullmask = FlatVector::Nullmask(input_column);
+		auto *ptr = FlatVector::GetData<string_t>(input_column);
+		for (idx_t r = 0; r < chunk->size(); r++) {
+			if (nullmask[r]) {
+				continue;
+			}
+			if (!has_value || LessThan::Operation(ptr[r], min_value)) {
+				min_value = ptr[r];
+			}
+			if (!has_value || GreaterThan::Operation(ptr[r], max_value)) {
+				max_value = ptr[r];
+			}
+			has_value = true;
+		}
+	}
+	if (!has_value) {
+		return;
+	}
+	// only set the new min_value/max_value: the deprecated min/max use a signed comparison for strings
+	stats.__set_min_value(string(min_value.GetData(), min_value.GetSize()));
+	stats.__set_max_value(string(max_value.GetData(), max_value.GetSize()));
+}
+
+//! Writes the statistics of a column of the buffer into the column meta data, these are used to skip row groups
+static void _write_statistics(ChunkCollection &buffer, idx_t col_idx, SQLType sql_type, ColumnMetaData &meta_data) {
+	auto &stats = meta_data.statistics;
+	int64_t null_count = 0;
+	for (auto &chunk : buffer.chunks) {
+		auto &nullmask = FlatVector::Nullmask(chunk->data[col_idx]);
+		for (idx_t r = 0; r < chunk->size(); r++) {
+			null_count += nullmask[r];
+		}
+	}
+	stats.__set_null_count(null_count);
+	switch (sql_type.id) {
+	case SQLTypeId::TINYINT:
+		_write_plain_statistics<int8_t, int32_t>(buffer, col_idx, stats);
+		break;
+	case SQLTypeId::SMALLINT:
+		_write_plain_statistics<int16_t, int32_t>(buffer, col_idx, stats);
+		break;
+	case SQLTypeId::INTEGER:
+		_write_plain_statistics<int32_t, int32_t>(buffer, col_idx, stats);
+		break;
+	case SQLTypeId::BIGINT:
+		_write_plain_statistics<int64_t, int64_t>(buffer, col_idx, stats);
+		break;
+	case SQLTypeId::FLOAT:
+		_write_plain_statistics<float, float>(buffer, col_idx, stats);
+		break;
+	case SQLTypeId::DOUBLE:
+		_write_plain_statistics<double, double>(buffer, col_idx, stats);
+		break;
+	case SQLTypeId::VARCHAR:
+		_write_string_statistics(buffer, col_idx, stats);
+		break;
+	default:
+		break;
+	}
+	meta_data.__isset.statistics = true;
+}
+
+//! The default amount of rows in a row group of a written file
+static constexpr idx_t PARQUET_DEFAULT_ROW_GROUP_SIZE = 100000;
+
 struct ParquetWriteBindData : public FunctionData {
 	vector<SQLType> sql_types;
 	string file_name;
 	vector<string> column_names;
-	// TODO compression flag to test the param passing stuff
+	//! The compression codec of the pages (CODEC option)
+	CompressionCodec::type codec = CompressionCodec::SNAPPY;
+	//! The amount of rows in a row group (ROW_GROUP_SIZE option)
+	idx_t row_group_size = PARQUET_DEFAULT_ROW_GROUP_SIZE;
 };
 
-struct ParquetWriteGlobalState : public GlobalFunctionData {
-public:
-	void Flush(ChunkCollection &buffer) {
-		if (buffer.count == 0) {
-			return;
-		}
-		std::lock_guard<std::mutex> glock(lock);
+//! A row group of the written file. Row groups are encoded in parallel but written to the file in order.
+struct ParquetWriteRowGroup {
+	ParquetWriteRowGroup(unique_ptr<ChunkCollection> buffer) : buffer(move(buffer)), finished(false) {
+	}
 
-		// set up a new row group for this chunk collection
-		RowGroup row_group;
-		row_group.num_rows = 0;
-		row_group.file_offset = writer->GetTotalWritten();
-		row_group.__isset.file_offset = true;
-		row_group.columns.resize(buffer.column_count());
+	//! The buffered rows of the row group, released once the row group is encoded
+	unique_ptr<ChunkCollection> buffer;
+	//! The encoded column chunks, the offsets in the meta data of the row group are relative to the start of the data
+	BufferedSerializer data;
+	RowGroup row_group;
+	//! The error that occurred while encoding the row group (if any)
+	string error;
+	std::atomic<bool> finished;
+};
 
-		// iterate over each of the columns of the chunk collection and write them
-		for (idx_t i = 0; i < buffer.column_count(); i++) {
-			// we start off by writing everything into a temporary buffer
-			// this is necessary to (1) know the total written size, and (2) to compress it with snappy afterwards
-			BufferedSerializer temp_writer;
-
-			// set up some metadata
-			PageHeader hdr;
-			hdr.compressed_page_size = 0;
-			hdr.uncompressed_page_size = 0;
-			hdr.type = PageType::DATA_PAGE;
-			hdr.__isset.data_page_header = true;
-
-			hdr.data_page_header.num_values = buffer.count;
-			hdr.data_page_header.encoding = Encoding::PLAIN;
-			hdr.data_page_header.definition_level_encoding = Encoding::RLE;
-			hdr.data_page_header.repetition_level_encoding = Encoding::BIT_PACKED;
-
-			// record the current offset of the writer into the file
-			// this is the starting position of the current page
-			auto start_offset = writer->GetTotalWritten();
-
-			// write the definition levels (i.e. the inverse of the nullmask)
-			// we always bit pack everything
-
-			// first figure out how many bytes we need (1 byte per 8 rows, rounded up)
-			auto define_byte_count = (buffer.count + 7) / 8;
-			// we need to set up the count as a varint, plus an added marker for the RLE scheme
-			// for this marker we shift the count left 1 and set low bit to 1 to indicate bit packed literals
-			uint32_t define_header = (define_byte_count << 1) | 1;
-			uint32_t define_size = GetVarintSize(define_header) + define_byte_count;
-
-			// we write the actual definitions into the temp_writer for now
-			temp_writer.Write<uint32_t>(define_size);
-			VarintEncode(define_header, temp_writer);
-
-			for (auto &chunk : buffer.chunks) {
-				auto defined = FlatVector::Nullmask(chunk->data[i]);
-				// flip the nullmask to go from nulls -> defines
-				defined.flip();
-				// write the bits of the nullmask
-				auto chunk_define_byte_count = (chunk->size() + 7) / 8;
-				temp_writer.WriteData((const_data_ptr_t)&defined, chunk_define_byte_count);
-			}
-
-			// now write the actual payload: we write this as PLAIN values (for now? possibly for ever?)
-			for (auto &chunk : buffer.chunks) {
-				auto &input = *chunk;
-				auto &input_column = input.data[i];
-				auto &nullmask = FlatVector::Nullmask(input_column);
-
-				// write actual payload data
-				switch (sql_types[i].id) {
-				case SQLTypeId::BOOLEAN: {
-					auto *ptr = FlatVector::GetData<bool>(input_column);
-					uint8_t byte = 0;
-					uint8_t byte_pos = 0;
-					for (idx_t r = 0; r < input.size(); r++) {
-						if (!nullmask[r]) { // only encode if non-null
-							byte |= (ptr[r] & 1) << byte_pos;
-							byte_pos++;
-
-							temp_writer.Write<uint8_t>(byte);
-							if (byte_pos == 8) {
-								temp_writer.Write<uint8_t>(byte);
-								byte = 0;
-								byte_pos = 0;
-							}
-						}
-					}
-					// flush last byte if req
-					if (byte_pos > 0) {
-						temp_writer.Write<uint8_t>(byte);
-					}
-					break;
-				}
-				case SQLTypeId::TINYINT:
-					_write_plain<int8_t, int32_t>(input_column, input.size(), nullmask, temp_writer);
-					break;
-				case SQLTypeId::SMALLINT:
-					_write_plain<int16_t, int32_t>(input_column, input.size(), nullmask, temp_writer);
-					break;
-				case SQLTypeId::INTEGER:
-					_write_plain<int32_t, int32_t>(input_column, input.size(), nullmask, temp_writer);
-					break;
-				case SQLTypeId::BIGINT:
-					_write_plain<int64_t, int64_t>(input_column, input.size(), nullmask, temp_writer);
-					break;
-				case SQLTypeId::FLOAT:
-					_write_plain<float, float>(input_column, input.size(), nullmask, temp_writer);
-					break;
-				case SQLTypeId::DOUBLE:
-					_write_plain<double, double>(input_column, input.size(), nullmask, temp_writer);
-					break;
-				case SQLTypeId::TIMESTAMP: {
-					auto *ptr = FlatVector::GetData<timestamp_t>(input_column);
-					for (idx_t r = 0; r < input.size(); r++) {
-						if (!nullmask[r]) {
-							temp_writer.Write<Int96>(timestamp_t_to_impala_timestamp(ptr[r]));
-						}
-					}
-					break;
-				}
-				case SQLTypeId::VARCHAR: {
-					auto *ptr = FlatVector::GetData<string_t>(input_column);
-					for (idx_t r = 0; r < input.size(); r++) {
-						if (!nullmask[r]) {
-							temp_writer.Write<uint32_t>(ptr[r].GetSize());
-							temp_writer.WriteData((const_data_ptr_t)ptr[r].GetData(), ptr[r].GetSize());
-						}
-					}
-					break;
-				}
-					// TODO date blob etc.
-				default:
-					throw NotImplementedException(SQLTypeToString((sql_types[i])));
-				}
-			}
+struct ParquetWriteGlobalState;
 
-			// now that we have finished writing the data we know the uncompressed size
-			hdr.uncompressed_page_size = temp_writer.blob.size;
+class ParquetEncodeTask : public Task {
+public:
+	ParquetEncodeTask(ParquetWriteGlobalState &state, ParquetWriteRowGroup &row_group)
+	    : state(state), row_group(row_group) {
+	}
 
-			// we perform snappy compression (FIXME: this should be a flag, possibly also include gzip?)
-			size_t compressed_size = snappy::MaxCompressedLength(temp_writer.blob.size);
-			auto compressed_buf = unique_ptr<data_t[]>(new data_t[compressed_size]);
-			snappy::RawCompress((const char *)temp_writer.blob.data.get(), temp_writer.blob.size,
-			                    (char *)compressed_buf.get(), &compressed_size);
+	ParquetWriteGlobalState &state;
+	ParquetWriteRowGroup &row_group;
 
-			hdr.compressed_page_size = compressed_size;
+public:
+	void Execute() override;
+};
 
-			// now finally write the data to the actual file
-			hdr.write(protocol.get());
-			writer->WriteData(compressed_buf.get(), compressed_size);
+struct ParquetWriteGlobalState : public GlobalFunctionData {
+public:
+	ParquetWriteGlobalState(ClientContext &context, ParquetWriteBindData &bind_data)
+	    : sql_types(bind_data.sql_types), codec(bind_data.codec), scheduler(TaskScheduler::GetScheduler(context)),
+	      pending_tasks(0) {
+		producer = scheduler.CreateProducer();
+		// bound the amount of buffered row groups while the oldest row group is still being encoded
+		max_row_groups = std::max(scheduler.NumberOfThreads(), 1) * 2;
+	}
 
-			auto &column_chunk = row_group.columns[i];
-			column_chunk.__isset.meta_data = true;
-			column_chunk.meta_data.data_page_offset = start_offset;
-			column_chunk.meta_data.total_compressed_size = writer->GetTotalWritten() - start_offset;
-			column_chunk.meta_data.codec = CompressionCodec::SNAPPY;
-			column_chunk.meta_data.path_in_schema.push_back(file_meta_data.schema[i + 1].name);
-			column_chunk.meta_data.num_values = buffer.count;
-			column_chunk.meta_data.type = file_meta_data.schema[i + 1].type;
+	~ParquetWriteGlobalState() override {
+		// the tasks refer to the row groups of this state: wait until all of them have finished
+		WaitForTasks([&]() { return pending_tasks == 0; });
+	}
+
+	//! Encodes the buffer as a new row group of the file. With multiple threads the row group is encoded by a task
+	//! while the next row group is buffered, finished row groups are written to the file in order.
+	void Flush(unique_ptr<ChunkCollection> buffer) {
+		if (buffer->count == 0) {
+			return;
+		}
+		std::lock_guard<std::mutex> glock(lock);
+		auto row_group = make_unique<ParquetWriteRowGroup>(move(buffer));
+		if (scheduler.NumberOfThreads() <= 1) {
+			EncodeRowGroup(*row_group);
+			row_group->finished = true;
+		} else {
+			{
+				std::lock_guard<std::mutex> guard(task_lock);
+				pending_tasks++;
+			}
+			scheduler.ScheduleTask(*producer, make_unique<ParquetEncodeTask>(*this, *row_group));
 		}
-		row_group.num_rows += buffer.count;
+		row_groups.push_back(move(row_group));
+		WriteRowGroups(row_groups.size() > max_row_groups ? row_groups.size() - max_row_groups : 0);
+	}
 
-		// append the row group to the file meta data
-		file_meta_data.row_groups.push_back(row_group);
-		file_meta_data.num_rows += buffer.count;
+	void EncodeRowGroup(ParquetWriteRowGroup &row_group) {
+		auto &buffer = *row_group.buffer;
+		TCompactProtocolFactoryT<MyTransport> tproto_factory;
+		auto row_group_protocol = tproto_factory.getProtocol(make_shared<MyTransport>(row_group.data));
+
+		row_group.row_group.num_rows = buffer.count;
+		row_group.row_group.file_offset = 0;
+		row_group.row_group.__isset.file_offset = true;
+		row_group.row_group.total_byte_size = 0;
+		row_group.row_group.columns.resize(buffer.column_count());
+		for (idx_t i = 0; i < buffer.column_count(); i++) {
+			auto &column_chunk = row_group.row_group.columns[i];
+			WriteColumn(buffer, i, row_group.data, *row_group_protocol, column_chunk);
+			row_group.row_group.total_byte_size += column_chunk.meta_data.total_uncompressed_size;
+		}
+		row_group.buffer.reset();
 	}
 
 	void Finalize() {
+		std::lock_guard<std::mutex> glock(lock);
+		WriteRowGroups(row_groups.size());
+
 		auto start_offset = writer->GetTotalWritten();
 		file_meta_data.write(protocol.get());
 
@@ -1223,14 +2373,193 @@ public:
 		writer.reset();
 	}
 
+private:
+	//! Writes a column of the buffer as a column chunk into the serializer. Columns with few distinct values are
+	//! written as a dictionary page followed by a data page of RLE/bit-packed dictionary indexes, other columns as a
+	//! single PLAIN data page.
+	void WriteColumn(ChunkCollection &buffer, idx_t col_idx, BufferedSerializer &ser, TProtocol &row_group_protocol,
+	                 ColumnChunk &column_chunk) {
+		auto &sql_type = sql_types[col_idx];
+		auto &meta_data = column_chunk.meta_data;
+		auto start_offset = ser.blob.size;
+		idx_t uncompressed_size = 0;
+
+		// the definition levels are the inverse of the nullmask
+		vector<uint32_t> define_levels;
+		define_levels.reserve(buffer.count);
+		idx_t value_count = 0;
+		for (auto &chunk : buffer.chunks) {
+			auto &nullmask = FlatVector::Nullmask(chunk->data[col_idx]);
+			for (idx_t r = 0; r < chunk->size(); r++) {
+				define_levels.push_back(nullmask[r] ? 0 : 1);
+				value_count += !nullmask[r];
+			}
+		}
+
+		BufferedSerializer page;
+		BufferedSerializer levels;
+		RleBpEncoder(1).Encode(define_levels.data(), define_levels.size(), levels);
+		page.Write<uint32_t>(levels.blob.size);
+		page.WriteData(levels.blob.data.get(), levels.blob.size);
+
+		BufferedSerializer dictionary;
+		vector<uint32_t> indexes;
+		auto dictionary_size = _write_dictionary(buffer, col_idx, sql_type, value_count, dictionary, indexes);
+		Encoding::type encoding;
+		if (dictionary_size > 0) {
+			PageHeader dictionary_hdr;
+			dictionary_hdr.type = PageType::DICTIONARY_PAGE;
+			dictionary_hdr.__isset.dictionary_page_header = true;
+			dictionary_hdr.dictionary_page_header.num_values = dictionary_size;
+			dictionary_hdr.dictionary_page_header.encoding = Encoding::PLAIN_DICTIONARY;
+
+			meta_data.dictionary_page_offset = ser.blob.size;
+			meta_data.__isset.dictionary_page_offset = true;
+			uncompressed_size += _write_page(dictionary_hdr, dictionary, codec, row_group_protocol, ser);
+
+			// the indexes are prefixed with their bit width
+			uint32_t bit_width = 1;
+			while (((idx_t)1 << bit_width) < dictionary_size) {
+				bit_width++;
+			}
+			page.Write<uint8_t>(bit_width);
+			RleBpEncoder(bit_width).Encode(indexes.data(), indexes.size(), page);
+			encoding = Encoding::PLAIN_DICTIONARY;
+		} else {
+			_write_plain_column(buffer, col_idx, sql_type, page);
+			encoding = Encoding::PLAIN;
+		}
+
+		PageHeader hdr;
+		hdr.type = PageType::DATA_PAGE;
+		hdr.__isset.data_page_header = true;
+		hdr.data_page_header.num_values = buffer.count;
+		hdr.data_page_header.encoding = encoding;
+		hdr.data_page_header.definition_level_encoding = Encoding::RLE;
+		hdr.data_page_header.repetition_level_encoding = Encoding::BIT_PACKED;
+
+		meta_data.data_page_offset = ser.blob.size;
+		uncompressed_size += _write_page(hdr, page, codec, row_group_protocol, ser);
+
+		column_chunk.__isset.meta_data = true;
+		column_chunk.file_offset = start_offset;
+		meta_data.total_compressed_size = ser.blob.size - start_offset;
+		meta_data.total_uncompressed_size = uncompressed_size;
+		meta_data.codec = codec;
+		meta_data.encodings.push_back(Encoding::RLE);
+		meta_data.encodings.push_back(encoding);
+		meta_data.path_in_schema.push_back(file_meta_data.schema[col_idx + 1].name);
+		meta_data.num_values = buffer.count;
+		meta_data.type = file_meta_data.schema[col_idx + 1].type;
+		_write_statistics(buffer, col_idx, sql_type, meta_data);
+	}
+
+	//! Writes the row groups at the front of the queue to the file, waiting for at least min_count of them to finish
+	//! and then writing the ones that have finished already
+	void WriteRowGroups(idx_t min_count) {
+		idx_t written = 0;
+		while (!row_groups.empty()) {
+			auto &row_group = *row_groups.front();
+			if (written >= min_count && !row_group.finished) {
+				break;
+			}
+			WaitForTasks([&]() -> bool { return row_group.finished; });
+			WriteRowGroup(row_group);
+			row_groups.pop_front();
+			written++;
+		}
+	}
+
+	//! Mark the row group as encoded and wake up any thread waiting for it
+	void FinishRowGroup(ParquetWriteRowGroup &row_group) {
+		// notify while holding the lock: a waiting destructor cannot destroy the state before we are done with it
+		std::lock_guard<std::mutex> guard(task_lock);
+		row_group.finished = true;
+		pending_tasks--;
+		task_finished.notify_all();
+	}
+
+	//! Wait until the condition holds, encoding row groups of this writer while waiting. Once no tasks of this writer
+	//! are left to execute, block until the tasks executed by other threads have finished.
+	void WaitForTasks(const std::function<bool()> &condition) {
+		unique_ptr<Task> task;
+		while (true) {
+			{
+				std::lock_guard<std::mutex> guard(task_lock);
+				if (condition()) {
+					return;
+				}
+			}
+			// help encoding the row groups, this is not necessarily the task we are waiting for
+			if (!scheduler.GetTaskFromProducer(*producer, task)) {
+				break;
+			}
+			task->Execute();
+			task.reset();
+		}
+		std::unique_lock<std::mutex> guard(task_lock);
+		task_finished.wait(guard, condition);
+	}
+
+	void WriteRowGroup(ParquetWriteRowGroup &row_group) {
+		if (!row_group.error.empty()) {
+			throw Exception(row_group.error);
+		}
+		// the offsets of the encoded row group are relative to its start in the file
+		auto file_offset = writer->GetTotalWritten();
+		auto &group = row_group.row_group;
+		group.file_offset = file_offset;
+		for (auto &column_chunk : group.columns) {
+			column_chunk.file_offset += file_offset;
+			column_chunk.meta_data.data_page_offset += file_offset;
+			if (column_chunk.meta_data.__isset.dictionary_page_offset) {
+				column_chunk.meta_data.dictionary_page_offset += file_offset;
+			}
+		}
+		writer->WriteData(row_group.data.blob.data.get(), row_group.data.blob.size);
+
+		// append the row group to the file meta data
+		file_meta_data.row_groups.push_back(group);
+		file_meta_data.num_rows += group.num_rows;
+	}
+
 public:
 	unique_ptr<BufferedFileWriter> writer;
 	shared_ptr<TProtocol> protocol;
 	FileMetaData file_meta_data;
 	vector<SQLType> sql_types;
+	CompressionCodec::type codec;
 	std::mutex lock;
+
+private:
+	TaskScheduler &scheduler;
+	//! The producer token of the encoding tasks of this writer
+	unique_ptr<ProducerToken> producer;
+	//! The row groups that have not been written to the file yet, in the order of the file
+	std::deque<unique_ptr<ParquetWriteRowGroup>> row_groups;
+	//! The maximum amount of row groups that are encoded at the same time
+	idx_t max_row_groups;
+	//! Lock protecting pending_tasks and the finished flags of the row groups that are encoded by tasks
+	std::mutex task_lock;
+	//! Signaled when an encoding task has finished
+	std::condition_variable task_finished;
+	//! The amount of encoding tasks that have not finished yet
+	idx_t pending_tasks;
+
+	friend class ParquetEncodeTask;
 };
 
+void ParquetEncodeTask::Execute() {
+	try {
+		state.EncodeRowGroup(row_group);
+	} catch (std::exception &ex) {
+		row_group.error = ex.what();
+	} catch (...) {
+		row_group.error = "Unknown exception while writing Parquet file";
+	}
+	state.FinishRowGroup(row_group);
+}
+
 struct ParquetWriteLocalState : public LocalFunctionData {
 	ParquetWriteLocalState() {
 		buffer = make_unique<ChunkCollection>();
@@ -1245,12 +2574,44 @@ unique_ptr<FunctionData> parquet_write_bind(ClientContext &context, CopyInfo &in
 	bind_data->sql_types = sql_types;
 	bind_data->column_names = names;
 	bind_data->file_name = info.file_path;
+	// check all the options in the copy info
+	for (auto &option : info.options) {
+		auto loption = StringUtil::Lower(option.first);
+		auto &set = option.second;
+		if (loption == "row_group_size") {
+			if (set.size() != 1 || set[0].is_null) {
+				throw BinderException("ROW_GROUP_SIZE expects a single integer argument");
+			}
+			auto row_group_size = set[0].CastAs(TypeId::INT64).value_.bigint;
+			if (row_group_size <= 0) {
+				throw BinderException("ROW_GROUP_SIZE must be positive");
+			}
+			bind_data->row_group_size = row_group_size;
+		} else if (loption == "codec" || loption == "compression") {
+			if (set.size() != 1 || set[0].type != TypeId::VARCHAR) {
+				throw BinderException("CODEC expects a single string argument");
+			}
+			auto codec = StringUtil::Lower(set[0].str_value);
+			if (codec == "uncompressed") {
+				bind_data->codec = CompressionCodec::UNCOMPRESSED;
+			} else if (codec == "snappy") {
+				bind_data->codec = CompressionCodec::SNAPPY;
+			} else if (codec == "gzip") {
+				bind_data->codec = CompressionCodec::GZIP;
+			} else {
+				throw BinderException("Unsupported codec \"%s\" for Parquet, try uncompressed, snappy or gzip",
+				                      set[0].str_value.c_str());
+			}
+		} else {
+			throw NotImplementedException("Unrecognized option for Parquet: %s", option.first.c_str());
+		}
+	}
 	return move(bind_data);
 }
 
 unique_ptr<GlobalFunctionData> parquet_write_initialize_global(ClientContext &context, FunctionData &bind_data) {
-	auto global_state = make_unique<ParquetWriteGlobalState>();
 	auto &parquet_bind = (ParquetWriteBindData &)bind_data;
+	auto global_state = make_unique<ParquetWriteGlobalState>(context, parquet_bind);
 
 	// initialize the file writer
 	global_state->writer = make_unique<BufferedFileWriter>(context.db.GetFileSystem(), parquet_bind.file_name.c_str(),
@@ -1277,22 +2638,39 @@ unique_ptr<GlobalFunctionData> parquet_write_initialize_global(ClientContext &co
 		schema_element.__isset.repetition_type = true;
 		schema_element.name = parquet_bind.column_names[i];
 	}
-	global_state->sql_types = parquet_bind.sql_types;
 	return move(global_state);
 }
 
 void parquet_write_sink(ClientContext &context, FunctionData &bind_data, GlobalFunctionData &gstate,
                         LocalFunctionData &lstate, DataChunk &input) {
+	auto &parquet_bind = (ParquetWriteBindData &)bind_data;
 	auto &global_state = (ParquetWriteGlobalState &)gstate;
 	auto &local_state = (ParquetWriteLocalState &)lstate;
 
-	// append data to the local (buffered) chunk collection
-	local_state.buffer->Append(input);
-	if (local_state.buffer->count > 100000) {
-		// if the chunk collection exceeds a certain size we flush it to the parquet file
-		global_state.Flush(*local_state.buffer);
-		// and reset the buffer
-		local_state.buffer = make_unique<ChunkCollection>();
+	// append data to the local (buffered) chunk collection, splitting the input at the row group boundaries
+	idx_t offset = 0;
+	while (offset < input.size()) {
+		auto &buffer = *local_state.buffer;
+		idx_t append_count = std::min(input.size() - offset, parquet_bind.row_group_size - buffer.count);
+		if (append_count == input.size()) {
+			buffer.Append(input);
+		} else {
+			SelectionVector sel(STANDARD_VECTOR_SIZE);
+			for (idx_t i = 0; i < append_count; i++) {
+				sel.set_index(i, offset + i);
+			}
+			auto types = input.GetTypes();
+			DataChunk slice;
+			slice.InitializeEmpty(types);
+			slice.Slice(input, sel, append_count);
+			buffer.Append(slice);
+		}
+		offset += append_count;
+		if (buffer.count >= parquet_bind.row_group_size) {
+			// the buffer contains a full row group: flush it to the parquet file and reset the buffer
+			global_state.Flush(move(local_state.buffer));
+			local_state.buffer = make_unique<ChunkCollection>();
+		}
 	}
 }
 
@@ -1301,7 +2679,8 @@ void parquet_write_combine(ClientContext &context, FunctionData &bind_data, Glob
 	auto &global_state = (ParquetWriteGlobalState &)gstate;
 	auto &local_state = (ParquetWriteLocalState &)lstate;
 	// flush any data left in the local state to the file
-	global_state.Flush(*local_state.buffer);
+	global_state.Flush(move(local_state.buffer));
+	local_state.buffer = make_unique<ChunkCollection>();
 }
 
 void parquet_write_finalize(ClientContext &context, FunctionData &bind_data, GlobalFunctionData &gstate) {
@@ -1315,9 +2694,11 @@ unique_ptr<LocalFunctionData> parquet_write_initialize_local(ClientContext &cont
 }
 
 void ParquetExtension::Load(DuckDB &db) {
-	ParquetScanFunction scan_fun;
-	CreateTableFunctionInfo cinfo(scan_fun);
-	cinfo.name = "read_parquet";
+	// parquet_scan accepts a file name or glob pattern, or a list of them
+	TableFunctionSet scan_set("read_parquet");
+	scan_set.AddFunction(ParquetScanFunction(SQLType::VARCHAR));
+	scan_set.AddFunction(ParquetScanFunction(SQLType::LIST));
+	CreateTableFunctionInfo cinfo(scan_set);
 	CreateTableFunctionInfo pq_scan = cinfo;
 	pq_scan.name = "parquet_scan";
 
@@ -32,6 +32,8 @@ string PhysicalOperatorToString(PhysicalOperatorType type) {
 		return "AGGREGATE";
 	case PhysicalOperatorType::WINDOW:
 		return "WINDOW";
+	case PhysicalOperatorType::STREAMING_WINDOW:
+		return "STREAMING_WINDOW";
 	case PhysicalOperatorType::UNNEST:
 		return "UNNEST";
 	case PhysicalOperatorType::DISTINCT:
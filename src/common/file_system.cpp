@@ -1,5 +1,6 @@
 #include "duckdb/common/file_system.hpp"
 
+#include "duckdb/common/algorithm.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/helper.hpp"
 #include "duckdb/common/string_util.hpp"
@@ -142,6 +143,32 @@ int64_t FileSystem::Read(FileHandle &handle, void *buffer, int64_t nr_bytes) {
 	return bytes_read;
 }
 
+void FileSystem::Read(FileHandle &handle, void *buffer, int64_t nr_bytes, idx_t location) {
+	int fd = ((UnixFileHandle &)handle).fd;
+	auto read_buffer = (char *)buffer;
+	while (nr_bytes > 0) {
+		// pread does not use the file pointer, so multiple threads can read from the same handle concurrently
+		int64_t bytes_read = pread(fd, read_buffer, nr_bytes, location);
+		if (bytes_read == -1) {
+			throw IOException("Could not read from file \"%s\": %s", handle.path.c_str(), strerror(errno));
+		}
+		if (bytes_read == 0) {
+			throw IOException("Could not read sufficient bytes from file \"%s\"", handle.path.c_str());
+		}
+		read_buffer += bytes_read;
+		nr_bytes -= bytes_read;
+		location += bytes_read;
+	}
+}
+
+void FileSystem::Prefetch(FileHandle &handle, idx_t location, idx_t nr_bytes) {
+#ifdef POSIX_FADV_WILLNEED
+	int fd = ((UnixFileHandle &)handle).fd;
+	// this is only a hint: errors are ignored
+	posix_fadvise(fd, location, nr_bytes, POSIX_FADV_WILLNEED);
+#endif
+}
+
 int64_t FileSystem::Write(FileHandle &handle, void *buffer, int64_t nr_bytes) {
 	int fd = ((UnixFileHandle &)handle).fd;
 	int64_t bytes_written = write(fd, buffer, nr_bytes);
@@ -421,6 +448,32 @@ int64_t FileSystem::Read(FileHandle &handle, void *buffer, int64_t nr_bytes) {
 	return bytes_read;
 }
 
+void FileSystem::Read(FileHandle &handle, void *buffer, int64_t nr_bytes, idx_t location) {
+	HANDLE hFile = ((WindowsFileHandle &)handle).fd;
+	auto read_buffer = (char *)buffer;
+	while (nr_bytes > 0) {
+		// read at the offset specified in the OVERLAPPED structure
+		OVERLAPPED ov = {};
+		ov.Offset = location & 0xFFFFFFFF;
+		ov.OffsetHigh = location >> 32;
+		DWORD bytes_read;
+		auto rc = ReadFile(hFile, read_buffer, (DWORD)nr_bytes, &bytes_read, &ov);
+		if (rc == 0) {
+			auto error = GetLastErrorAsString();
+			throw IOException("Could not read from file \"%s\": %s", handle.path.c_str(), error.c_str());
+		}
+		if (bytes_read == 0) {
+			throw IOException("Could not read sufficient bytes from file \"%s\"", handle.path.c_str());
+		}
+		read_buffer += bytes_read;
+		nr_bytes -= bytes_read;
+		location += bytes_read;
+	}
+}
+
+void FileSystem::Prefetch(FileHandle &handle, idx_t location, idx_t nr_bytes) {
+}
+
 int64_t FileSystem::Write(FileHandle &handle, void *buffer, int64_t nr_bytes) {
 	HANDLE hFile = ((WindowsFileHandle &)handle).fd;
 	DWORD bytes_read;
@@ -569,16 +622,6 @@ void FileSystem::MoveFile(const string &source, const string &target) {
 }
 #endif
 
-void FileSystem::Read(FileHandle &handle, void *buffer, int64_t nr_bytes, idx_t location) {
-	// seek to the location
-	SetFilePointer(handle, location);
-	// now read from the location
-	int64_t bytes_read = Read(handle, buffer, nr_bytes);
-	if (bytes_read != nr_bytes) {
-		throw IOException("Could not read sufficient bytes from file \"%s\"", handle.path.c_str());
-	}
-}
-
 void FileSystem::Write(FileHandle &handle, void *buffer, int64_t nr_bytes, idx_t location) {
 	// seek to the location
 	SetFilePointer(handle, location);
@@ -594,6 +637,138 @@ string FileSystem::JoinPath(const string &a, const string &b) {
 	return a + PathSeparator() + b;
 }
 
+static bool HasGlob(const string &str) {
+	return str.find_first_of("*?[") != string::npos;
+}
+
+//! Match a single path component against a glob pattern
+static bool GlobMatch(const char *str, const char *pattern) {
+	const char *star_pattern = nullptr, *star_string = nullptr;
+	while (*str) {
+		if (*pattern == '*') {
+			// remember the star so we can backtrack to it, initially it matches nothing
+			star_pattern = ++pattern;
+			star_string = str;
+			continue;
+		}
+		bool matches = false;
+		if (*pattern == '?') {
+			matches = true;
+			pattern++;
+		} else if (*pattern == '[') {
+			// character class, e.g. [abc], [a-z] or [!abc]
+			auto class_end = strchr(pattern + 1, ']');
+			if (class_end) {
+				auto p = pattern + 1;
+				bool negate = *p == '!';
+				if (negate) {
+					p++;
+				}
+				bool in_class = false;
+				for (; p < class_end; p++) {
+					if (p + 2 < class_end && p[1] == '-') {
+						in_class = in_class || (*str >= p[0] && *str <= p[2]);
+						p += 2;
+					} else {
+						in_class = in_class || *str == *p;
+					}
+				}
+				matches = in_class != negate;
+				pattern = class_end + 1;
+			} else {
+				// unterminated class: match the bracket literally
+				matches = *str == '[';
+				pattern++;
+			}
+		} else if (*pattern) {
+			matches = *pattern == *str;
+			pattern++;
+		}
+		if (matches) {
+			str++;
+		} else if (star_pattern) {
+			// let the last star consume one more character and try again
+			pattern = star_pattern;
+			str = ++star_string;
+		} else {
+			return false;
+		}
+	}
+	while (*pattern == '*') {
+		pattern++;
+	}
+	return !*pattern;
+}
+
+vector<string> FileSystem::Glob(const string &path) {
+	if (!HasGlob(path)) {
+		if (FileExists(path)) {
+			return {path};
+		}
+		return {};
+	}
+	// split the path into its components
+	vector<string> components;
+	idx_t last_pos = 0;
+	for (idx_t i = 0; i <= path.size(); i++) {
+		if (i == path.size() || path[i] == '/' || path[i] == PathSeparator()[0]) {
+			components.push_back(path.substr(last_pos, i - last_pos));
+			last_pos = i + 1;
+		}
+	}
+	// absolute paths start with an empty component
+	vector<string> previous_directories;
+	if (components[0].empty()) {
+		previous_directories.push_back(string());
+	}
+	vector<string> result;
+	for (idx_t i = 0; i < components.size(); i++) {
+		bool is_last = i + 1 == components.size();
+		auto &component = components[i];
+		if (component.empty() && i == 0) {
+			continue;
+		}
+		vector<string> matches;
+		if (!HasGlob(component)) {
+			// no wildcards in this component: append it to all matches so far
+			if (previous_directories.empty()) {
+				matches.push_back(component);
+			} else {
+				for (auto &directory : previous_directories) {
+					matches.push_back(directory + "/" + component);
+				}
+			}
+			if (is_last) {
+				for (auto &match : matches) {
+					if (FileExists(match)) {
+						result.push_back(match);
+					}
+				}
+			}
+		} else {
+			if (previous_directories.empty()) {
+				previous_directories.push_back(".");
+			}
+			for (auto &directory : previous_directories) {
+				ListFiles(directory.empty() ? "/" : directory, [&](string name, bool is_directory) {
+					if (is_directory == is_last || !GlobMatch(name.c_str(), component.c_str())) {
+						return;
+					}
+					auto full_path = directory == "." && path.substr(0, 2) != "./" ? name : directory + "/" + name;
+					if (is_last) {
+						result.push_back(full_path);
+					} else {
+						matches.push_back(full_path);
+					}
+				});
+			}
+		}
+		previous_directories = move(matches);
+	}
+	sort(result.begin(), result.end());
+	return result;
+}
+
 void FileHandle::Read(void *buffer, idx_t nr_bytes, idx_t location) {
 	file_system.Read(*this, buffer, nr_bytes, location);
 }
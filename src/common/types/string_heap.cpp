@@ -63,7 +63,7 @@ void StringHeap::MergeHeap(StringHeap &other) {
 	other.tail->prev = move(chunk);
 	this->chunk = move(other.chunk);
 	if (!tail) {
-		tail = this->chunk.get();
+		tail = other.tail;
 	}
 	other.tail = nullptr;
 }
@@ -73,7 +73,7 @@ void Vector::Slice(Vector &other, idx_t offset) {
 	Reference(other);
 	if (offset > 0) {
 		data = data + GetTypeIdSize(type) * offset;
-		nullmask <<= offset;
+		nullmask >>= offset;
 	}
 }
 
@@ -92,6 +92,7 @@ void Vector::Slice(const SelectionVector &sel, idx_t count) {
 		auto &current_sel = DictionaryVector::SelVector(*this);
 		auto sliced_dictionary = current_sel.Slice(sel, count);
 		buffer = make_unique<DictionaryBuffer>(move(sliced_dictionary));
+		ClearDictionarySize();
 		return;
 	}
 	auto child_ref = make_buffer<VectorChildBuffer>();
@@ -113,6 +114,7 @@ void Vector::Slice(const SelectionVector &sel, idx_t count, SelCache &cache) {
 		if (entry != cache.cache.end()) {
 			// cached entry exists: use that
 			this->buffer = entry->second;
+			ClearDictionarySize();
 		} else {
 			Slice(sel, count);
 			cache.cache[target_data] = this->buffer;
@@ -122,6 +124,18 @@ void Vector::Slice(const SelectionVector &sel, idx_t count, SelCache &cache) {
 	}
 }
 
+void Vector::ClearDictionarySize() {
+	assert(vector_type == VectorType::DICTIONARY_VECTOR);
+	if (DictionaryVector::DictionarySize(*this) == INVALID_INDEX) {
+		return;
+	}
+	// the new selection vector might not reference every entry of the dictionary anymore
+	// the child buffer can be shared with other vectors, so create a new child buffer instead of modifying it
+	auto child_ref = make_buffer<VectorChildBuffer>();
+	child_ref->data.Reference(DictionaryVector::Child(*this));
+	auxiliary = move(child_ref);
+}
+
 void Vector::Initialize(TypeId new_type, bool zero_data) {
 	if (new_type != TypeId::INVALID) {
 		type = new_type;
@@ -574,8 +588,12 @@ void Vector::Serialize(idx_t count, Serializer &serializer) {
 			auto strings = (string_t *)vdata.data;
 			for (idx_t i = 0; i < count; i++) {
 				auto idx = vdata.sel->get_index(i);
-				auto source = (*vdata.nullmask)[idx] ? NullValue<const char *>() : strings[idx].GetData();
-				serializer.WriteString(source);
+				if ((*vdata.nullmask)[idx]) {
+					serializer.WriteString(NullValue<const char *>());
+				} else {
+					// write the string together with its length: strings (e.g. BLOBs) can contain NULL bytes
+					serializer.WriteString(string(strings[idx].GetData(), strings[idx].GetSize()));
+				}
 			}
 			break;
 		}
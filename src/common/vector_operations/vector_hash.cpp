@@ -34,14 +34,39 @@ static inline void tight_loop_hash(T *__restrict ldata, hash_t *__restrict resul
 	}
 }
 
+//! Hash every entry of the dictionary of a dictionary vector once, returns false if this is not possible
+template <class T> static bool hash_dictionary(Vector &input, idx_t count, hash_t dictionary_hashes[]) {
+	if (!DictionaryVector::CanExecuteOnDictionary(input, count)) {
+		return false;
+	}
+	auto dictionary_size = DictionaryVector::DictionarySize(input);
+	auto &child = DictionaryVector::Child(input);
+	auto child_data = FlatVector::GetData<T>(child);
+	auto &child_nullmask = FlatVector::Nullmask(child);
+	for (idx_t i = 0; i < dictionary_size; i++) {
+		dictionary_hashes[i] = HashOp::Operation(child_data[i], child_nullmask[i]);
+	}
+	return true;
+}
+
 template <bool HAS_RSEL, class T>
 static inline void templated_loop_hash(Vector &input, Vector &result, const SelectionVector *rsel, idx_t count) {
+	hash_t dictionary_hashes[STANDARD_VECTOR_SIZE];
 	if (input.vector_type == VectorType::CONSTANT_VECTOR) {
 		result.vector_type = VectorType::CONSTANT_VECTOR;
 
 		auto ldata = ConstantVector::GetData<T>(input);
 		auto result_data = ConstantVector::GetData<hash_t>(result);
 		*result_data = HashOp::Operation(*ldata, ConstantVector::IsNull(input));
+	} else if (hash_dictionary<T>(input, count, dictionary_hashes)) {
+		// dictionary vector: look up the hashes of the dictionary entries
+		result.vector_type = VectorType::FLAT_VECTOR;
+		auto &dictionary_sel = DictionaryVector::SelVector(input);
+		auto result_data = FlatVector::GetData<hash_t>(result);
+		for (idx_t i = 0; i < count; i++) {
+			auto ridx = HAS_RSEL ? rsel->get_index(i) : i;
+			result_data[ridx] = dictionary_hashes[dictionary_sel.get_index(ridx)];
+		}
 	} else {
 		result.vector_type = VectorType::FLAT_VECTOR;
 
@@ -147,12 +172,34 @@ static inline void tight_loop_combine_hash(T *__restrict ldata, hash_t *__restri
 
 template <bool HAS_RSEL, class T>
 void templated_loop_combine_hash(Vector &input, Vector &hashes, const SelectionVector *rsel, idx_t count) {
+	hash_t dictionary_hashes[STANDARD_VECTOR_SIZE];
 	if (input.vector_type == VectorType::CONSTANT_VECTOR && hashes.vector_type == VectorType::CONSTANT_VECTOR) {
 		auto ldata = ConstantVector::GetData<T>(input);
 		auto hash_data = ConstantVector::GetData<hash_t>(hashes);
 
 		auto other_hash = HashOp::Operation(*ldata, ConstantVector::IsNull(input));
 		*hash_data = combine_hash(*hash_data, other_hash);
+	} else if (hash_dictionary<T>(input, count, dictionary_hashes)) {
+		// dictionary vector: combine with the hashes of the dictionary entries
+		auto &dictionary_sel = DictionaryVector::SelVector(input);
+		if (hashes.vector_type == VectorType::CONSTANT_VECTOR) {
+			// mix constant with dictionary, first get the constant value
+			auto constant_hash = *ConstantVector::GetData<hash_t>(hashes);
+			// now re-initialize the hashes vector to an empty flat vector
+			hashes.Initialize(hashes.type);
+			auto hash_data = FlatVector::GetData<hash_t>(hashes);
+			for (idx_t i = 0; i < count; i++) {
+				auto ridx = HAS_RSEL ? rsel->get_index(i) : i;
+				hash_data[ridx] = combine_hash(constant_hash, dictionary_hashes[dictionary_sel.get_index(ridx)]);
+			}
+		} else {
+			assert(hashes.vector_type == VectorType::FLAT_VECTOR);
+			auto hash_data = FlatVector::GetData<hash_t>(hashes);
+			for (idx_t i = 0; i < count; i++) {
+				auto ridx = HAS_RSEL ? rsel->get_index(i) : i;
+				hash_data[ridx] = combine_hash(hash_data[ridx], dictionary_hashes[dictionary_sel.get_index(ridx)]);
+			}
+		}
 	} else {
 		VectorData idata;
 		input.Orrify(count, idata);
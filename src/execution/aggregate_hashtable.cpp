@@ -8,6 +8,9 @@
 #include "duckdb/common/vector_operations/unary_executor.hpp"
 #include "duckdb/common/operator/comparison_operators.hpp"
 #include "duckdb/common/algorithm.hpp"
+#include "duckdb/common/serializer/buffered_deserializer.hpp"
+#include "duckdb/common/serializer/buffered_serializer.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 
 #include <cmath>
 #include <map>
@@ -591,9 +594,13 @@ void SuperLargeHashTable::FindOrCreateGroups(DataChunk &groups, Vector &addresse
 }
 
 idx_t SuperLargeHashTable::Scan(idx_t &scan_position, DataChunk &groups, DataChunk &result) {
+	return Scan(scan_position, capacity * tuple_size, groups, result);
+}
+
+idx_t SuperLargeHashTable::Scan(idx_t &scan_position, idx_t scan_end, DataChunk &groups, DataChunk &result) {
 	data_ptr_t ptr;
 	data_ptr_t start = data + scan_position;
-	data_ptr_t end = data + capacity * tuple_size;
+	data_ptr_t end = data + min<idx_t>(scan_end, capacity * tuple_size);
 	if (start >= end) {
 		return 0;
 	}
@@ -630,3 +637,389 @@ idx_t SuperLargeHashTable::Scan(idx_t &scan_position, DataChunk &groups, DataChu
 	scan_position = ptr - data;
 	return entry;
 }
+
+void SuperLargeHashTable::InitializeParallelScan(idx_t range_size, const std::function<void(idx_t, idx_t)> &callback) {
+	assert(range_size > 0);
+	if (entries == 0) {
+		return;
+	}
+	for (idx_t range_start = 0; range_start < capacity; range_start += range_size) {
+		idx_t range_end = min<idx_t>(range_start + range_size, capacity);
+		callback(range_start * tuple_size, range_end * tuple_size);
+	}
+}
+
+idx_t SuperLargeHashTable::ScanGroups(idx_t &scan_position, DataChunk &groups, Vector &addresses) {
+	auto data_pointers = FlatVector::GetData<data_ptr_t>(addresses);
+
+	data_ptr_t ptr = data + scan_position;
+	data_ptr_t end = data + capacity * tuple_size;
+
+	groups.Reset();
+	// scan the table for full cells starting from the scan position
+	idx_t found_entries = 0;
+	for (; ptr < end && found_entries < STANDARD_VECTOR_SIZE; ptr += tuple_size) {
+		if (*ptr == FULL_CELL) {
+			// found entry
+			data_pointers[found_entries++] = ptr + FLAG_SIZE;
+		}
+	}
+	scan_position = ptr - data;
+	if (found_entries == 0) {
+		return 0;
+	}
+	// fetch the group columns; this moves the addresses forward to the start of the payload
+	groups.SetCardinality(found_entries);
+	for (idx_t i = 0; i < groups.column_count(); i++) {
+		VectorOperations::Gather::Set(addresses, groups.data[i], found_entries);
+	}
+	groups.Verify();
+	return found_entries;
+}
+
+void SuperLargeHashTable::ClearMoved() {
+	// the aggregate states are now owned by another HT: release the data without calling any destructors
+	owned_data.reset();
+	data = nullptr;
+	capacity = 0;
+	entries = 0;
+	Resize(STANDARD_VECTOR_SIZE);
+}
+
+void SuperLargeHashTable::Combine(SuperLargeHashTable &other) {
+	assert(other.group_types == group_types);
+	assert(other.tuple_size == tuple_size);
+	if (other.entries == 0) {
+		return;
+	}
+
+	DataChunk groups;
+	groups.Initialize(group_types);
+
+	Vector source_addresses(TypeId::POINTER);
+	Vector target_addresses(TypeId::POINTER);
+
+	idx_t scan_position = 0;
+	while (true) {
+		idx_t found_entries = other.ScanGroups(scan_position, groups, source_addresses);
+		if (found_entries == 0) {
+			break;
+		}
+		// find or create the groups in this HT
+		FindOrCreateGroups(groups, target_addresses);
+		// now merge the aggregate states of the other HT into the states of this HT
+		for (idx_t aggr_idx = 0; aggr_idx < aggregates.size(); aggr_idx++) {
+			auto &aggr = aggregates[aggr_idx];
+			assert(aggr.function.combine && !aggr.distinct);
+			aggr.function.combine(source_addresses, target_addresses, found_entries);
+
+			// move to the next aggregate
+			VectorOperations::AddInPlace(source_addresses, aggr.payload_size, found_entries);
+			VectorOperations::AddInPlace(target_addresses, aggr.payload_size, found_entries);
+		}
+	}
+	other.ClearMoved();
+}
+
+void SuperLargeHashTable::Partition(vector<unique_ptr<SuperLargeHashTable>> &partition_hts, idx_t radix_bits) {
+	assert(radix_bits > 0 && radix_bits <= PARTITION_BIT_END);
+	idx_t partition_count = (idx_t)1 << radix_bits;
+	hash_t partition_mask = partition_count - 1;
+	idx_t partition_shift = PARTITION_BIT_END - radix_bits;
+	if (partition_hts.size() < partition_count) {
+		partition_hts.resize(partition_count);
+	}
+	if (entries == 0) {
+		return;
+	}
+	// size new partitions so the expected amount of groups per partition fits without resizing
+	idx_t partition_capacity = NextPowerOfTwo(2 * (entries / partition_count + STANDARD_VECTOR_SIZE));
+
+	DataChunk groups;
+	groups.Initialize(group_types);
+	DataChunk partition_groups;
+	partition_groups.InitializeEmpty(group_types);
+
+	Vector addresses(TypeId::POINTER);
+	Vector new_addresses(TypeId::POINTER);
+	Vector hashes(TypeId::HASH);
+	auto source_pointers = FlatVector::GetData<data_ptr_t>(addresses);
+
+	vector<SelectionVector> partition_sel(partition_count);
+	vector<idx_t> partition_entries(partition_count);
+	for (idx_t i = 0; i < partition_count; i++) {
+		partition_sel[i].Initialize(STANDARD_VECTOR_SIZE);
+	}
+
+	idx_t scan_position = 0;
+	while (true) {
+		idx_t found_entries = ScanGroups(scan_position, groups, addresses);
+		if (found_entries == 0) {
+			break;
+		}
+		// compute the partition of each of the groups from the radix of the hash
+		groups.Hash(hashes);
+		hashes.Normalify(found_entries);
+		auto hash_data = FlatVector::GetData<hash_t>(hashes);
+		fill(partition_entries.begin(), partition_entries.end(), 0);
+		for (idx_t i = 0; i < found_entries; i++) {
+			auto partition = (hash_data[i] >> partition_shift) & partition_mask;
+			partition_sel[partition].set_index(partition_entries[partition]++, i);
+		}
+		// move the groups and their aggregate states into the partitions
+		for (idx_t partition = 0; partition < partition_count; partition++) {
+			idx_t count = partition_entries[partition];
+			if (count == 0) {
+				continue;
+			}
+			auto &partition_ht = partition_hts[partition];
+			if (!partition_ht) {
+				partition_ht = make_unique<SuperLargeHashTable>(partition_capacity, group_types, payload_types,
+				                                                aggregates, parallel);
+			}
+			assert(partition_ht->tuple_size == tuple_size);
+			auto &sel = partition_sel[partition];
+			partition_groups.Slice(groups, sel, count);
+			partition_ht->FindOrCreateGroups(partition_groups, new_addresses);
+
+			// NB: both address vectors point to the payload start
+			auto new_address_data = FlatVector::GetData<data_ptr_t>(new_addresses);
+			for (idx_t i = 0; i < count; i++) {
+				memcpy(new_address_data[i], source_pointers[sel.get_index(i)], payload_width);
+			}
+		}
+	}
+	ClearMoved();
+}
+
+void SuperLargeHashTable::Spill(BufferManager &buffer_manager, vector<unique_ptr<AggregateSpill>> &spills,
+                                idx_t radix_bits) {
+	assert(radix_bits > 0 && radix_bits <= PARTITION_BIT_END);
+	idx_t partition_count = (idx_t)1 << radix_bits;
+	hash_t partition_mask = partition_count - 1;
+	idx_t partition_shift = PARTITION_BIT_END - radix_bits;
+	if (spills.size() < partition_count) {
+		spills.resize(partition_count);
+	}
+	if (entries == 0) {
+		return;
+	}
+	// first compute the partition of every group, so the groups can be appended to the spills in full vectors
+	auto partition_indices = unique_ptr<uint32_t[]>(new uint32_t[entries]);
+	auto cell_pointers = unique_ptr<data_ptr_t[]>(new data_ptr_t[entries]);
+	vector<idx_t> partition_offsets(partition_count + 1, 0);
+
+	DataChunk groups;
+	groups.Initialize(group_types);
+	Vector addresses(TypeId::POINTER);
+	Vector hashes(TypeId::HASH);
+	auto pointers = FlatVector::GetData<data_ptr_t>(addresses);
+
+	idx_t entry_idx = 0;
+	idx_t scan_position = 0;
+	while (true) {
+		idx_t found_entries = ScanGroups(scan_position, groups, addresses);
+		if (found_entries == 0) {
+			break;
+		}
+		groups.Hash(hashes);
+		hashes.Normalify(found_entries);
+		auto hash_data = FlatVector::GetData<hash_t>(hashes);
+		for (idx_t i = 0; i < found_entries; i++) {
+			auto partition = (hash_data[i] >> partition_shift) & partition_mask;
+			partition_indices[entry_idx] = partition;
+			partition_offsets[partition + 1]++;
+			// the addresses point to the payload: store the start of the groups instead
+			cell_pointers[entry_idx] = pointers[i] - group_width;
+			entry_idx++;
+		}
+	}
+	assert(entry_idx == entries);
+	// order the cells by partition
+	for (idx_t partition = 0; partition < partition_count; partition++) {
+		partition_offsets[partition + 1] += partition_offsets[partition];
+	}
+	auto sorted_pointers = unique_ptr<data_ptr_t[]>(new data_ptr_t[entries]);
+	vector<idx_t> partition_positions(partition_offsets.begin(), partition_offsets.end() - 1);
+	for (idx_t i = 0; i < entries; i++) {
+		sorted_pointers[partition_positions[partition_indices[i]]++] = cell_pointers[i];
+	}
+	partition_indices.reset();
+	cell_pointers.reset();
+
+	// now append the groups and states of every partition to its spill
+	for (idx_t partition = 0; partition < partition_count; partition++) {
+		idx_t partition_end = partition_offsets[partition + 1];
+		for (idx_t offset = partition_offsets[partition]; offset < partition_end; offset += STANDARD_VECTOR_SIZE) {
+			idx_t count = min<idx_t>(STANDARD_VECTOR_SIZE, partition_end - offset);
+			memcpy(pointers, sorted_pointers.get() + offset, count * sizeof(data_ptr_t));
+			// fetch the group columns; this moves the addresses forward to the start of the payload
+			groups.Reset();
+			groups.SetCardinality(count);
+			for (idx_t i = 0; i < groups.column_count(); i++) {
+				VectorOperations::Gather::Set(addresses, groups.data[i], count);
+			}
+			auto &spill = spills[partition];
+			if (!spill) {
+				spill = make_unique<AggregateSpill>(buffer_manager, aggregates, payload_width);
+			}
+			spill->Append(groups, addresses);
+		}
+	}
+	ClearMoved();
+	// the spilled groups hold their own copy of the strings
+	string_heap.Destroy();
+}
+
+void SuperLargeHashTable::Combine(AggregateSpill &spill) {
+	assert(spill.payload_width == payload_width);
+	DataChunk groups;
+	groups.InitializeEmpty(group_types);
+	Vector source_addresses(TypeId::POINTER);
+	Vector target_addresses(TypeId::POINTER);
+	for (idx_t chunk_idx = 0; chunk_idx < spill.ChunkCount(); chunk_idx++) {
+		auto handle = spill.LoadChunk(chunk_idx, groups, source_addresses);
+		idx_t count = groups.size();
+		FindOrCreateGroups(groups, target_addresses);
+		for (idx_t aggr_idx = 0; aggr_idx < aggregates.size(); aggr_idx++) {
+			auto &aggr = aggregates[aggr_idx];
+			assert(aggr.function.combine && !aggr.distinct);
+			aggr.function.combine(source_addresses, target_addresses, count);
+
+			// move to the next aggregate
+			VectorOperations::AddInPlace(source_addresses, aggr.payload_size, count);
+			VectorOperations::AddInPlace(target_addresses, aggr.payload_size, count);
+		}
+	}
+	spill.ClearMoved();
+}
+
+//===--------------------------------------------------------------------===//
+// AggregateSpill
+//===--------------------------------------------------------------------===//
+AggregateSpill::AggregateSpill(BufferManager &buffer_manager, vector<AggregateObject> aggregates_p,
+                               idx_t payload_width)
+    : buffer_manager(buffer_manager), aggregates(move(aggregates_p)), payload_width(payload_width), count(0),
+      block_offset(0) {
+}
+
+AggregateSpill::~AggregateSpill() {
+	bool has_destructor = false;
+	for (auto &aggr : aggregates) {
+		if (aggr.function.destructor) {
+			has_destructor = true;
+		}
+	}
+	if (has_destructor) {
+		// the states were never combined into a HT: call the destructors of the aggregates
+		Vector state_vector(TypeId::POINTER);
+		for (idx_t chunk_idx = 0; chunk_idx < chunks.size(); chunk_idx++) {
+			auto &chunk = chunks[chunk_idx];
+			auto handle = buffer_manager.Pin(blocks[chunk.block_idx]);
+			auto states = handle->node->buffer + chunk.offset + chunk.groups_size;
+			auto state_pointers = FlatVector::GetData<data_ptr_t>(state_vector);
+			for (idx_t i = 0; i < chunk.count; i++) {
+				state_pointers[i] = states + i * payload_width;
+			}
+			for (auto &aggr : aggregates) {
+				if (aggr.function.destructor) {
+					aggr.function.destructor(state_vector, chunk.count);
+				}
+				VectorOperations::AddInPlace(state_vector, aggr.payload_size, chunk.count);
+			}
+		}
+	}
+	ClearMoved();
+}
+
+void AggregateSpill::Append(DataChunk &groups, Vector &addresses) {
+	idx_t append_count = groups.size();
+	if (append_count == 0) {
+		return;
+	}
+	BufferedSerializer serializer;
+	groups.Serialize(serializer);
+
+	SpilledChunk chunk;
+	chunk.groups_size = serializer.blob.size;
+	chunk.count = append_count;
+	idx_t chunk_size = chunk.groups_size + append_count * payload_width;
+	unique_ptr<BufferHandle> handle;
+	if (blocks.size() > 0) {
+		handle = buffer_manager.Pin(blocks.back());
+	}
+	if (!handle || block_offset + chunk_size > handle->node->size) {
+		// the chunk does not fit in the last buffer: allocate a new buffer
+		auto alloc_size = std::max<idx_t>(Storage::BLOCK_ALLOC_SIZE, chunk_size + Storage::BLOCK_HEADER_SIZE);
+		handle = buffer_manager.Allocate(alloc_size);
+		blocks.push_back(handle->block_id);
+		block_offset = 0;
+	}
+	chunk.block_idx = blocks.size() - 1;
+	chunk.offset = block_offset;
+
+	// write the serialized groups followed by the aggregate states
+	auto target = handle->node->buffer + block_offset;
+	memcpy(target, serializer.blob.data.get(), chunk.groups_size);
+	target += chunk.groups_size;
+	addresses.Normalify(append_count);
+	auto state_pointers = FlatVector::GetData<data_ptr_t>(addresses);
+	for (idx_t i = 0; i < append_count; i++) {
+		memcpy(target + i * payload_width, state_pointers[i], payload_width);
+	}
+	block_offset += chunk_size;
+	chunks.push_back(chunk);
+	count += append_count;
+}
+
+void AggregateSpill::Merge(AggregateSpill &other) {
+	assert(other.payload_width == payload_width);
+	if (other.chunks.size() == 0) {
+		return;
+	}
+	idx_t block_base = blocks.size();
+	for (auto &block_id : other.blocks) {
+		blocks.push_back(block_id);
+	}
+	for (auto &chunk : other.chunks) {
+		chunks.push_back(chunk);
+		chunks.back().block_idx += block_base;
+	}
+	// appends continue in the last buffer of the other spill
+	block_offset = other.block_offset;
+	count += other.count;
+
+	other.blocks.clear();
+	other.chunks.clear();
+	other.block_offset = 0;
+	other.count = 0;
+}
+
+unique_ptr<BufferHandle> AggregateSpill::LoadChunk(idx_t chunk_idx, DataChunk &groups, Vector &addresses) {
+	assert(chunk_idx < chunks.size());
+	auto &chunk = chunks[chunk_idx];
+	auto handle = buffer_manager.Pin(blocks[chunk.block_idx]);
+	auto source = handle->node->buffer + chunk.offset;
+
+	BufferedDeserializer deserializer(source, chunk.groups_size);
+	DataChunk loaded_groups;
+	loaded_groups.Deserialize(deserializer);
+	groups.Reference(loaded_groups);
+
+	auto states = source + chunk.groups_size;
+	auto state_pointers = FlatVector::GetData<data_ptr_t>(addresses);
+	for (idx_t i = 0; i < chunk.count; i++) {
+		state_pointers[i] = states + i * payload_width;
+	}
+	return handle;
+}
+
+void AggregateSpill::ClearMoved() {
+	for (auto &block_id : blocks) {
+		buffer_manager.DestroyBuffer(block_id);
+	}
+	blocks.clear();
+	chunks.clear();
+	block_offset = 0;
+	count = 0;
+}
@@ -34,6 +34,11 @@ void ExpressionExecutor::Execute(BoundFunctionExpression &expr, ExpressionState
 		for (idx_t i = 0; i < expr.children.size(); i++) {
 			assert(state->child_types[i] == expr.children[i]->return_type);
 			Execute(*expr.children[i], state->child_states[i].get(), sel, count, arguments.data[i]);
+			if (expr.function.has_side_effects) {
+				// functions with side effects have to be executed once for every row: constant and dictionary
+				// vectors would make the executors call them only once per distinct value
+				arguments.data[i].Normalify(count);
+			}
 #ifdef DEBUG
 			if (expr.arguments[i].id == SQLTypeId::VARCHAR) {
 				arguments.data[i].UTFVerify(count);
@@ -0,0 +1,580 @@
+#include "duckdb/execution/external_sort.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/serializer/buffered_deserializer.hpp"
+#include "duckdb/common/serializer/buffered_serializer.hpp"
+#include "duckdb/common/types/interval.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace duckdb {
+
+//===--------------------------------------------------------------------===//
+// Key Normalization
+//===--------------------------------------------------------------------===//
+static idx_t GetKeyValueWidth(TypeId type) {
+	switch (type) {
+	case TypeId::BOOL:
+	case TypeId::INT8:
+		return sizeof(int8_t);
+	case TypeId::INT16:
+		return sizeof(int16_t);
+	case TypeId::INT32:
+		return sizeof(int32_t);
+	case TypeId::INT64:
+		return sizeof(int64_t);
+	case TypeId::INT128:
+		return sizeof(hugeint_t);
+	case TypeId::FLOAT:
+		return sizeof(float);
+	case TypeId::DOUBLE:
+		return sizeof(double);
+	case TypeId::INTERVAL:
+		return 3 * sizeof(int64_t);
+	case TypeId::VARCHAR:
+		// the prefix of the string followed by its (capped) length
+		return SortLayout::STRING_PREFIX_SIZE + 1;
+	default:
+		throw NotImplementedException("Unimplemented type for ORDER BY");
+	}
+}
+
+SortLayout::SortLayout(vector<TypeId> types_p, vector<OrderType> order_types_p,
+                       vector<OrderByNullType> null_order_types_p)
+    : types(move(types_p)), order_types(move(order_types_p)), null_order_types(move(null_order_types_p)),
+      key_width(0) {
+	for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+		auto width = 1 + GetKeyValueWidth(types[col_idx]);
+		key_offsets.push_back(key_width);
+		key_widths.push_back(width);
+		if (types[col_idx] == TypeId::VARCHAR) {
+			string_columns.push_back(col_idx);
+		}
+		key_width += width;
+	}
+	// pad the key so the row index is aligned
+	key_width = ((key_width + sizeof(idx_t) - 1) / sizeof(idx_t)) * sizeof(idx_t);
+	entry_size = key_width + sizeof(idx_t);
+}
+
+//! Stores the lowest "width" bytes of an unsigned integer big-endian
+static inline void EncodeBigEndian(uint64_t value, data_ptr_t target, idx_t width) {
+	for (idx_t i = 0; i < width; i++) {
+		target[i] = (data_t)(value >> (8 * (width - 1 - i)));
+	}
+}
+
+template <class T> static void EncodeValue(T value, data_ptr_t target);
+
+template <> void EncodeValue(int8_t value, data_ptr_t target) {
+	target[0] = (data_t)value ^ 0x80;
+}
+
+template <> void EncodeValue(int16_t value, data_ptr_t target) {
+	EncodeBigEndian((uint16_t)value ^ 0x8000, target, sizeof(int16_t));
+}
+
+template <> void EncodeValue(int32_t value, data_ptr_t target) {
+	EncodeBigEndian((uint32_t)value ^ 0x80000000, target, sizeof(int32_t));
+}
+
+template <> void EncodeValue(int64_t value, data_ptr_t target) {
+	EncodeBigEndian((uint64_t)value ^ 0x8000000000000000ULL, target, sizeof(int64_t));
+}
+
+template <> void EncodeValue(hugeint_t value, data_ptr_t target) {
+	EncodeValue<int64_t>(value.upper, target);
+	EncodeBigEndian(value.lower, target + sizeof(int64_t), sizeof(uint64_t));
+}
+
+template <> void EncodeValue(float value, data_ptr_t target) {
+	uint32_t bits;
+	// -0 and 0 compare equal
+	value = value == 0 ? 0 : value;
+	memcpy(&bits, &value, sizeof(uint32_t));
+	// negative numbers have all their bits flipped, positive numbers only the sign bit
+	bits = (bits & 0x80000000) ? ~bits : bits ^ 0x80000000;
+	EncodeBigEndian(bits, target, sizeof(uint32_t));
+}
+
+template <> void EncodeValue(double value, data_ptr_t target) {
+	uint64_t bits;
+	value = value == 0 ? 0 : value;
+	memcpy(&bits, &value, sizeof(uint64_t));
+	bits = (bits & 0x8000000000000000ULL) ? ~bits : bits ^ 0x8000000000000000ULL;
+	EncodeBigEndian(bits, target, sizeof(uint64_t));
+}
+
+template <> void EncodeValue(interval_t value, data_ptr_t target) {
+	// intervals are compared by their normalized months, days and msecs
+	int64_t extra_months_d = value.days / Interval::DAYS_PER_MONTH;
+	int64_t extra_months_ms = value.msecs / Interval::MSECS_PER_MONTH;
+	int64_t days = value.days - extra_months_d * Interval::DAYS_PER_MONTH;
+	int64_t msecs = value.msecs - extra_months_ms * Interval::MSECS_PER_MONTH;
+	int64_t extra_days_ms = msecs / Interval::MSECS_PER_DAY;
+	msecs -= extra_days_ms * Interval::MSECS_PER_DAY;
+
+	EncodeValue<int64_t>(value.months + extra_months_d + extra_months_ms, target);
+	EncodeValue<int64_t>(days + extra_days_ms, target + sizeof(int64_t));
+	EncodeValue<int64_t>(msecs, target + 2 * sizeof(int64_t));
+}
+
+template <> void EncodeValue(string_t value, data_ptr_t target) {
+	auto prefix_size = std::min<idx_t>(value.GetSize(), SortLayout::STRING_PREFIX_SIZE);
+	memcpy(target, value.GetData(), prefix_size);
+	memset(target + prefix_size, 0, SortLayout::STRING_PREFIX_SIZE - prefix_size);
+	// the length orders strings with equal (zero-padded) prefixes that fit in the prefix, e.g. "abc" and "abc\0". Any
+	// length larger than the prefix is stored as STRING_PREFIX_SIZE + 1: ties between those are broken by comparing the
+	// full strings
+	target[SortLayout::STRING_PREFIX_SIZE] =
+	    (data_t)std::min<idx_t>(value.GetSize(), SortLayout::STRING_PREFIX_SIZE + 1);
+}
+
+template <class T>
+static void templated_encode_keys(VectorData &vdata, idx_t count, data_ptr_t target, idx_t entry_size, idx_t width,
+                                  bool nulls_first) {
+	auto data = (T *)vdata.data;
+	for (idx_t i = 0; i < count; i++) {
+		auto idx = vdata.sel->get_index(i);
+		auto key = target + i * entry_size;
+		if ((*vdata.nullmask)[idx]) {
+			key[0] = nulls_first ? 0 : 1;
+			memset(key + 1, 0, width - 1);
+		} else {
+			key[0] = nulls_first ? 1 : 0;
+			EncodeValue<T>(data[idx], key + 1);
+		}
+	}
+}
+
+void SortLayout::EncodeKeys(DataChunk &sort_chunk, data_ptr_t target, idx_t row_offset) {
+	auto count = sort_chunk.size();
+	for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+		VectorData vdata;
+		sort_chunk.data[col_idx].Orrify(count, vdata);
+
+		auto key_target = target + key_offsets[col_idx];
+		auto width = key_widths[col_idx];
+		bool nulls_first = null_order_types[col_idx] == OrderByNullType::NULLS_FIRST;
+		switch (types[col_idx]) {
+		case TypeId::BOOL:
+		case TypeId::INT8:
+			templated_encode_keys<int8_t>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		case TypeId::INT16:
+			templated_encode_keys<int16_t>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		case TypeId::INT32:
+			templated_encode_keys<int32_t>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		case TypeId::INT64:
+			templated_encode_keys<int64_t>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		case TypeId::INT128:
+			templated_encode_keys<hugeint_t>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		case TypeId::FLOAT:
+			templated_encode_keys<float>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		case TypeId::DOUBLE:
+			templated_encode_keys<double>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		case TypeId::INTERVAL:
+			templated_encode_keys<interval_t>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		case TypeId::VARCHAR:
+			templated_encode_keys<string_t>(vdata, count, key_target, entry_size, width, nulls_first);
+			break;
+		default:
+			throw NotImplementedException("Unimplemented type for ORDER BY");
+		}
+		if (order_types[col_idx] != OrderType::ASCENDING) {
+			// descending order: invert all the bytes of the column (including the NULL byte)
+			for (idx_t i = 0; i < count; i++) {
+				auto key = key_target + i * entry_size;
+				for (idx_t byte_idx = 0; byte_idx < width; byte_idx++) {
+					key[byte_idx] = ~key[byte_idx];
+				}
+			}
+		}
+	}
+	// zero-initialize the padding and set the row indices
+	auto padding_offset = key_offsets.back() + key_widths.back();
+	for (idx_t i = 0; i < count; i++) {
+		auto entry = target + i * entry_size;
+		memset(entry + padding_offset, 0, key_width - padding_offset);
+		SetRowIndex(entry, row_offset + i);
+	}
+}
+
+//===--------------------------------------------------------------------===//
+// Sort
+//===--------------------------------------------------------------------===//
+static int CompareStrings(const SortRowSource &left_source, idx_t left_row, const SortRowSource &right_source,
+                          idx_t right_row, idx_t col_idx) {
+	idx_t left_chunk_row, right_chunk_row;
+	auto &left_chunk = left_source.Locate(left_row, left_chunk_row);
+	auto &right_chunk = right_source.Locate(right_row, right_chunk_row);
+	auto left_str = FlatVector::GetData<string_t>(left_chunk.data[left_source.sort_column_offset + col_idx]);
+	auto right_str = FlatVector::GetData<string_t>(right_chunk.data[right_source.sort_column_offset + col_idx]);
+	// the prefixes are equal, so we only need to compare the remainder of the strings. The strings can contain NULL
+	// bytes (e.g. BLOBs), so we compare the bytes up to the shortest length and break ties on the length.
+	auto &left_value = left_str[left_chunk_row];
+	auto &right_value = right_str[right_chunk_row];
+	auto left_size = left_value.GetSize() - SortLayout::STRING_PREFIX_SIZE;
+	auto right_size = right_value.GetSize() - SortLayout::STRING_PREFIX_SIZE;
+	auto cmp = memcmp(left_value.GetData() + SortLayout::STRING_PREFIX_SIZE,
+	                  right_value.GetData() + SortLayout::STRING_PREFIX_SIZE, std::min(left_size, right_size));
+	if (cmp != 0) {
+		return cmp;
+	}
+	return left_size < right_size ? -1 : (left_size > right_size ? 1 : 0);
+}
+
+int SortLayout::Compare(data_ptr_t left, data_ptr_t right, const SortRowSource &left_source,
+                        const SortRowSource &right_source) {
+	idx_t position = 0;
+	for (auto &col_idx : string_columns) {
+		// compare the keys up to and including the prefix and the length of the string
+		idx_t end = key_offsets[col_idx] + key_widths[col_idx];
+		auto cmp = memcmp(left + position, right + position, end - position);
+		if (cmp != 0) {
+			return cmp;
+		}
+		position = end;
+		// the prefixes and lengths are equal: if the strings are not longer than the prefix they are equal
+		bool descending = order_types[col_idx] != OrderType::ASCENDING;
+		data_t length = descending ? ~left[end - 1] : left[end - 1];
+		if (length <= STRING_PREFIX_SIZE) {
+			continue;
+		}
+		cmp = CompareStrings(left_source, GetRowIndex(left), right_source, GetRowIndex(right), col_idx);
+		if (cmp != 0) {
+			return descending ? -cmp : cmp;
+		}
+	}
+	if (position == key_width) {
+		return 0;
+	}
+	return memcmp(left + position, right + position, key_width - position);
+}
+
+//! LSD radix sort of the sort entries, one byte of the key at a time
+static void RadixSortEntries(data_ptr_t entries, idx_t count, idx_t key_width, idx_t entry_size) {
+	auto temp = unique_ptr<data_t[]>(new data_t[count * entry_size]);
+	data_ptr_t source = entries;
+	data_ptr_t target = temp.get();
+	idx_t counts[256];
+	for (idx_t byte_idx = key_width; byte_idx > 0; byte_idx--) {
+		auto offset = byte_idx - 1;
+		memset(counts, 0, sizeof(counts));
+		for (idx_t i = 0; i < count; i++) {
+			counts[source[i * entry_size + offset]]++;
+		}
+		if (counts[source[offset]] == count) {
+			// all entries have the same byte here: skip this byte
+			continue;
+		}
+		idx_t total = 0;
+		for (idx_t i = 0; i < 256; i++) {
+			auto bucket_count = counts[i];
+			counts[i] = total;
+			total += bucket_count;
+		}
+		for (idx_t i = 0; i < count; i++) {
+			auto entry = source + i * entry_size;
+			memcpy(target + counts[entry[offset]]++ * entry_size, entry, entry_size);
+		}
+		std::swap(source, target);
+	}
+	if (source != entries) {
+		memcpy(entries, source, count * entry_size);
+	}
+}
+
+void SortLayout::SortEntries(data_ptr_t entries, idx_t count, const SortRowSource &source) {
+	if (count <= 1) {
+		return;
+	}
+	if (IsFixedSize()) {
+		RadixSortEntries(entries, count, key_width, entry_size);
+		return;
+	}
+	// keys with strings might require tie-breaking: sort pointers to the entries with a comparison sort
+	vector<data_ptr_t> pointers;
+	pointers.reserve(count);
+	for (idx_t i = 0; i < count; i++) {
+		pointers.push_back(entries + i * entry_size);
+	}
+	std::sort(pointers.begin(), pointers.end(),
+	          [&](data_ptr_t left, data_ptr_t right) { return Compare(left, right, source, source) < 0; });
+	auto sorted = unique_ptr<data_t[]>(new data_t[count * entry_size]);
+	for (idx_t i = 0; i < count; i++) {
+		memcpy(sorted.get() + i * entry_size, pointers[i], entry_size);
+	}
+	memcpy(entries, sorted.get(), count * entry_size);
+}
+
+//===--------------------------------------------------------------------===//
+// Sorted Run
+//===--------------------------------------------------------------------===//
+SortedRun::SortedRun(BufferManager &buffer_manager, SortLayout &layout, ChunkCollection &source,
+                     idx_t sort_column_offset, bool spill)
+    : buffer_manager(buffer_manager), layout(layout), count(source.count), sort_column_offset(sort_column_offset) {
+	// normalize the sort keys of all rows
+	auto sorted_entries = unique_ptr<data_t[]>(new data_t[count * layout.entry_size]);
+	DataChunk sort_chunk;
+	sort_chunk.InitializeEmpty(layout.types);
+	for (idx_t chunk_idx = 0; chunk_idx < source.chunks.size(); chunk_idx++) {
+		auto &chunk = *source.chunks[chunk_idx];
+		for (idx_t col_idx = 0; col_idx < layout.types.size(); col_idx++) {
+			sort_chunk.data[col_idx].Reference(chunk.data[sort_column_offset + col_idx]);
+		}
+		sort_chunk.SetCardinality(chunk);
+		idx_t row_offset = chunk_idx * STANDARD_VECTOR_SIZE;
+		layout.EncodeKeys(sort_chunk, sorted_entries.get() + row_offset * layout.entry_size, row_offset);
+	}
+	// sort the entries
+	SortRowSource row_source;
+	row_source.collection = &source;
+	row_source.sort_column_offset = sort_column_offset;
+	layout.SortEntries(sorted_entries.get(), count, row_source);
+
+	if (spill) {
+		Spill(source, sorted_entries.get());
+	} else {
+		data = move(source);
+		entries = move(sorted_entries);
+	}
+}
+
+SortedRun::~SortedRun() {
+	for (auto &block_id : blocks) {
+		buffer_manager.DestroyBuffer(block_id);
+	}
+}
+
+bool SortedRun::CanSpill(const vector<TypeId> &types) {
+	for (auto &type : types) {
+		if (!TypeIsConstantSize(type) && type != TypeId::VARCHAR) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void SortedRun::Spill(ChunkCollection &source, data_ptr_t sorted_entries) {
+	auto order = unique_ptr<idx_t[]>(new idx_t[count]);
+	for (idx_t i = 0; i < count; i++) {
+		order[i] = layout.GetRowIndex(sorted_entries + i * layout.entry_size);
+	}
+	// materialize the rows in sorted order, and write them to buffers together with their sort entries
+	unique_ptr<BufferHandle> handle;
+	idx_t block_offset = 0;
+	DataChunk chunk;
+	chunk.Initialize(source.types);
+	BufferedSerializer serializer;
+	for (idx_t start = 0; start < count; start += STANDARD_VECTOR_SIZE) {
+		chunk.Reset();
+		source.MaterializeSortedChunk(chunk, order.get(), start);
+		serializer.Reset();
+		chunk.Serialize(serializer);
+
+		RunChunk run_chunk;
+		run_chunk.count = chunk.size();
+		auto entries_size = run_chunk.count * layout.entry_size;
+		run_chunk.size = entries_size + serializer.blob.size;
+		if (!handle || block_offset + run_chunk.size > handle->node->size) {
+			// the chunk does not fit in the current buffer: allocate a new buffer
+			auto alloc_size = std::max<idx_t>(Storage::BLOCK_ALLOC_SIZE, run_chunk.size + Storage::BLOCK_HEADER_SIZE);
+			handle = buffer_manager.Allocate(alloc_size);
+			blocks.push_back(handle->block_id);
+			block_offset = 0;
+		}
+		run_chunk.block_idx = blocks.size() - 1;
+		run_chunk.offset = block_offset;
+
+		auto target = handle->node->buffer + block_offset;
+		memcpy(target, sorted_entries + start * layout.entry_size, entries_size);
+		// the row indices now refer to the rows of the chunk
+		for (idx_t i = 0; i < run_chunk.count; i++) {
+			layout.SetRowIndex(target + i * layout.entry_size, i);
+		}
+		memcpy(target + entries_size, serializer.blob.data.get(), serializer.blob.size);
+		block_offset += run_chunk.size;
+		chunks.push_back(run_chunk);
+	}
+}
+
+void SortedRun::LoadChunk(idx_t chunk_idx, DataChunk &result, data_ptr_t target_entries) {
+	assert(IsSpilled());
+	auto &run_chunk = chunks[chunk_idx];
+	auto handle = buffer_manager.Pin(blocks[run_chunk.block_idx]);
+	auto source = handle->node->buffer + run_chunk.offset;
+	auto entries_size = run_chunk.count * layout.entry_size;
+	memcpy(target_entries, source, entries_size);
+
+	BufferedDeserializer deserializer(source + entries_size, run_chunk.size - entries_size);
+	result.Destroy();
+	result.Deserialize(deserializer);
+}
+
+//===--------------------------------------------------------------------===//
+// Merge
+//===--------------------------------------------------------------------===//
+SortedRunMerger::SortedRunMerger(SortLayout &layout, vector<unique_ptr<SortedRun>> &runs) : layout(layout) {
+	for (auto &run : runs) {
+		auto cursor = make_unique<RunCursor>();
+		cursor->run = run.get();
+		cursor->source.sort_column_offset = run->sort_column_offset;
+		cursor->chunk_idx = 0;
+		if (run->IsSpilled()) {
+			cursor->source.chunk = &cursor->chunk;
+			cursor->chunk_entries = unique_ptr<data_t[]>(new data_t[STANDARD_VECTOR_SIZE * layout.entry_size]);
+			if (!LoadNextChunk(*cursor)) {
+				continue;
+			}
+		} else {
+			cursor->source.collection = &run->data;
+			cursor->entry = run->entries.get();
+			cursor->remaining = run->count;
+			if (cursor->remaining == 0) {
+				continue;
+			}
+		}
+		heap.push_back(cursors.size());
+		cursors.push_back(move(cursor));
+	}
+	std::make_heap(heap.begin(), heap.end(), [&](idx_t left, idx_t right) { return CursorGreaterThan(left, right); });
+}
+
+bool SortedRunMerger::LoadNextChunk(RunCursor &cursor) {
+	if (cursor.chunk_idx >= cursor.run->chunks.size()) {
+		return false;
+	}
+	cursor.remaining = cursor.run->chunks[cursor.chunk_idx].count;
+	cursor.run->LoadChunk(cursor.chunk_idx, cursor.chunk, cursor.chunk_entries.get());
+	cursor.entry = cursor.chunk_entries.get();
+	cursor.chunk_idx++;
+	return true;
+}
+
+bool SortedRunMerger::CursorGreaterThan(idx_t left, idx_t right) {
+	auto &left_cursor = *cursors[left];
+	auto &right_cursor = *cursors[right];
+	return layout.Compare(left_cursor.entry, right_cursor.entry, left_cursor.source, right_cursor.source) > 0;
+}
+
+template <class T>
+static void templated_gather_values(DataChunk *source_chunks[], idx_t source_rows[], idx_t col_idx, Vector &target,
+                                    idx_t count) {
+	auto target_data = FlatVector::GetData<T>(target);
+	for (idx_t i = 0; i < count; i++) {
+		auto &source = source_chunks[i]->data[col_idx];
+		if (FlatVector::IsNull(source, source_rows[i])) {
+			FlatVector::SetNull(target, i, true);
+		} else {
+			target_data[i] = FlatVector::GetData<T>(source)[source_rows[i]];
+		}
+	}
+}
+
+void SortedRunMerger::Scan(DataChunk &result) {
+	auto greater_than = [&](idx_t left, idx_t right) { return CursorGreaterThan(left, right); };
+	idx_t result_count = 0;
+	idx_t exhausted_cursor = INVALID_INDEX;
+	while (result_count < STANDARD_VECTOR_SIZE && !heap.empty()) {
+		auto &cursor = *cursors[heap.front()];
+		// if only a single run remains we can output its entries directly
+		idx_t take = heap.size() == 1 ? std::min<idx_t>(cursor.remaining, STANDARD_VECTOR_SIZE - result_count) : 1;
+		for (idx_t i = 0; i < take; i++) {
+			idx_t chunk_row;
+			source_chunks[result_count] = &cursor.source.Locate(layout.GetRowIndex(cursor.entry), chunk_row);
+			source_rows[result_count] = chunk_row;
+			result_count++;
+			cursor.entry += layout.entry_size;
+		}
+		cursor.remaining -= take;
+		if (cursor.remaining > 0) {
+			// restore the heap property
+			std::pop_heap(heap.begin(), heap.end(), greater_than);
+			std::push_heap(heap.begin(), heap.end(), greater_than);
+			continue;
+		}
+		std::pop_heap(heap.begin(), heap.end(), greater_than);
+		auto cursor_idx = heap.back();
+		heap.pop_back();
+		if (cursor.run->IsSpilled() && cursor.chunk_idx < cursor.run->chunks.size()) {
+			// the loaded chunk of this run is exhausted, but the rows we output still refer to it
+			// we load the next chunk after gathering the output
+			exhausted_cursor = cursor_idx;
+			break;
+		}
+	}
+	// gather the output rows
+	for (idx_t col_idx = 0; col_idx < result.column_count(); col_idx++) {
+		auto &target = result.data[col_idx];
+		switch (target.type) {
+		case TypeId::BOOL:
+		case TypeId::INT8:
+			templated_gather_values<int8_t>(source_chunks, source_rows, col_idx, target, result_count);
+			break;
+		case TypeId::INT16:
+			templated_gather_values<int16_t>(source_chunks, source_rows, col_idx, target, result_count);
+			break;
+		case TypeId::INT32:
+			templated_gather_values<int32_t>(source_chunks, source_rows, col_idx, target, result_count);
+			break;
+		case TypeId::INT64:
+			templated_gather_values<int64_t>(source_chunks, source_rows, col_idx, target, result_count);
+			break;
+		case TypeId::INT128:
+			templated_gather_values<hugeint_t>(source_chunks, source_rows, col_idx, target, result_count);
+			break;
+		case TypeId::FLOAT:
+			templated_gather_values<float>(source_chunks, source_rows, col_idx, target, result_count);
+			break;
+		case TypeId::DOUBLE:
+			templated_gather_values<double>(source_chunks, source_rows, col_idx, target, result_count);
+			break;
+		case TypeId::INTERVAL:
+			templated_gather_values<interval_t>(source_chunks, source_rows, col_idx, target, result_count);
+			break;
+		case TypeId::VARCHAR:
+			templated_gather_values<string_t>(source_chunks, source_rows, col_idx, target, result_count);
+			// the loaded chunks of spilled runs are replaced: keep their strings alive
+			for (auto &cursor : cursors) {
+				if (cursor->run->IsSpilled()) {
+					StringVector::AddHeapReference(target, cursor->chunk.data[col_idx]);
+				}
+			}
+			break;
+		case TypeId::LIST:
+		case TypeId::STRUCT:
+			for (idx_t i = 0; i < result_count; i++) {
+				auto &source = source_chunks[i]->data[col_idx];
+				if (FlatVector::IsNull(source, source_rows[i])) {
+					FlatVector::SetNull(target, i, true);
+				} else {
+					target.SetValue(i, source.GetValue(source_rows[i]));
+				}
+			}
+			break;
+		default:
+			throw NotImplementedException("Unimplemented type for merging sorted runs");
+		}
+	}
+	result.SetCardinality(result_count);
+
+	if (exhausted_cursor != INVALID_INDEX) {
+		LoadNextChunk(*cursors[exhausted_cursor]);
+		heap.push_back(exhausted_cursor);
+		std::push_heap(heap.begin(), heap.end(), greater_than);
+	}
+}
+
+} // namespace duckdb
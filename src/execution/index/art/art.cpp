@@ -327,6 +327,10 @@ bool ART::Insert(unique_ptr<Node> &node, unique_ptr<Key> value, unsigned depth,
 	return true;
 }
 
+void ART::Clear(IndexLock &lock) {
+	tree = nullptr;
+}
+
 //===--------------------------------------------------------------------===//
 // Delete
 //===--------------------------------------------------------------------===//
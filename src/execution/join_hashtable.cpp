@@ -8,6 +8,8 @@
 #include "duckdb/common/vector_operations/unary_executor.hpp"
 #include "duckdb/common/operator/comparison_operators.hpp"
 
+#include <atomic>
+
 using namespace std;
 
 namespace duckdb {
@@ -258,6 +260,50 @@ idx_t JoinHashTable::PrepareKeys(DataChunk &keys, unique_ptr<VectorData[]> &key_
 	return added_count;
 }
 
+void JoinHashTable::ReserveEntries(idx_t entry_count, data_ptr_t key_locations[],
+                                   vector<unique_ptr<BufferHandle>> &handles) {
+	vector<BlockAppendEntry> append_entries;
+	idx_t remaining = entry_count;
+	{
+		// first append to the last block (if any)
+		lock_guard<mutex> append_lock(ht_lock);
+		if (blocks.size() != 0) {
+			auto &last_block = blocks.back();
+			if (last_block.count < last_block.capacity) {
+				// last block has space: pin the buffer of this block
+				auto handle = buffer_manager.Pin(last_block.block_id);
+				// now append to the block
+				idx_t append_count = AppendToBlock(last_block, *handle, append_entries, remaining);
+				remaining -= append_count;
+				handles.push_back(move(handle));
+			}
+		}
+		while (remaining > 0) {
+			// now for the remaining data, allocate new buffers to store the data and append there
+			auto handle = buffer_manager.Allocate(block_capacity * entry_size);
+
+			HTDataBlock new_block;
+			new_block.count = 0;
+			new_block.capacity = block_capacity;
+			new_block.block_id = handle->block_id;
+
+			idx_t append_count = AppendToBlock(new_block, *handle, append_entries, remaining);
+			remaining -= append_count;
+			handles.push_back(move(handle));
+			blocks.push_back(new_block);
+		}
+	}
+	// now set up the key_locations based on the append entries
+	idx_t append_idx = 0;
+	for (auto &append_entry : append_entries) {
+		idx_t next = append_idx + append_entry.count;
+		for (; append_idx < next; append_idx++) {
+			key_locations[append_idx] = append_entry.baseptr;
+			append_entry.baseptr += entry_size;
+		}
+	}
+}
+
 void JoinHashTable::Build(DataChunk &keys, DataChunk &payload) {
 	assert(!finalized);
 	assert(keys.size() == payload.size());
@@ -297,48 +343,9 @@ void JoinHashTable::Build(DataChunk &keys, DataChunk &payload) {
 	count += added_count;
 
 	vector<unique_ptr<BufferHandle>> handles;
-	vector<BlockAppendEntry> append_entries;
 	data_ptr_t key_locations[STANDARD_VECTOR_SIZE];
 	// first allocate space of where to serialize the keys and payload columns
-	idx_t remaining = added_count;
-	{
-		// first append to the last block (if any)
-		lock_guard<mutex> append_lock(ht_lock);
-		if (blocks.size() != 0) {
-			auto &last_block = blocks.back();
-			if (last_block.count < last_block.capacity) {
-				// last block has space: pin the buffer of this block
-				auto handle = buffer_manager.Pin(last_block.block_id);
-				// now append to the block
-				idx_t append_count = AppendToBlock(last_block, *handle, append_entries, remaining);
-				remaining -= append_count;
-				handles.push_back(move(handle));
-			}
-		}
-		while (remaining > 0) {
-			// now for the remaining data, allocate new buffers to store the data and append there
-			auto handle = buffer_manager.Allocate(block_capacity * entry_size);
-
-			HTDataBlock new_block;
-			new_block.count = 0;
-			new_block.capacity = block_capacity;
-			new_block.block_id = handle->block_id;
-
-			idx_t append_count = AppendToBlock(new_block, *handle, append_entries, remaining);
-			remaining -= append_count;
-			handles.push_back(move(handle));
-			blocks.push_back(new_block);
-		}
-	}
-	// now set up the key_locations based on the append entries
-	idx_t append_idx = 0;
-	for (auto &append_entry : append_entries) {
-		idx_t next = append_idx + append_entry.count;
-		for (; append_idx < next; append_idx++) {
-			key_locations[append_idx] = append_entry.baseptr;
-			append_entry.baseptr += entry_size;
-		}
-	}
+	ReserveEntries(added_count, key_locations, handles);
 
 	// hash the keys and obtain an entry in the list
 	// note that we only hash the keys used in the equality comparison
@@ -362,7 +369,7 @@ void JoinHashTable::Build(DataChunk &keys, DataChunk &payload) {
 	SerializeVector(hash_values, payload.size(), *current_sel, added_count, key_locations);
 }
 
-void JoinHashTable::InsertHashes(Vector &hashes, idx_t count, data_ptr_t key_locations[]) {
+void JoinHashTable::InsertHashes(Vector &hashes, idx_t count, data_ptr_t key_locations[], bool parallel) {
 	assert(hashes.type == TypeId::HASH);
 
 	// use bitmask to get position in array
@@ -373,6 +380,21 @@ void JoinHashTable::InsertHashes(Vector &hashes, idx_t count, data_ptr_t key_loc
 	assert(hashes.vector_type == VectorType::FLAT_VECTOR);
 	auto pointers = (data_ptr_t *)hash_map->node->buffer;
 	auto indices = FlatVector::GetData<hash_t>(hashes);
+	if (parallel) {
+		// other threads are inserting into the pointer table concurrently: swap in the pointers atomically
+		static_assert(sizeof(std::atomic<data_ptr_t>) == sizeof(data_ptr_t), "atomic pointers must be lock-free");
+		auto atomic_pointers = (std::atomic<data_ptr_t> *)pointers;
+		for (idx_t i = 0; i < count; i++) {
+			auto prev_pointer = (data_ptr_t *)(key_locations[i] + pointer_offset);
+			auto &head = atomic_pointers[indices[i]];
+			auto current = head.load(std::memory_order_relaxed);
+			do {
+				*prev_pointer = current;
+			} while (!head.compare_exchange_weak(current, key_locations[i], std::memory_order_release,
+			                                     std::memory_order_relaxed));
+		}
+		return;
+	}
 	for (idx_t i = 0; i < count; i++) {
 		auto index = indices[i];
 		// set prev in current key to the value (NOTE: this will be nullptr if
@@ -385,8 +407,19 @@ void JoinHashTable::InsertHashes(Vector &hashes, idx_t count, data_ptr_t key_loc
 	}
 }
 
-void JoinHashTable::Finalize() {
-	// the build has finished, now iterate over all the nodes and construct the final hash table
+void JoinHashTable::Merge(JoinHashTable &other) {
+	lock_guard<mutex> append_lock(ht_lock);
+	assert(!finalized && !other.finalized);
+	// the blocks are now owned by this HT
+	blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+	other.blocks.clear();
+	string_heap.MergeHeap(other.string_heap);
+	count += other.count;
+	has_null = has_null || other.has_null;
+	other.count = 0;
+}
+
+void JoinHashTable::InitializePointerTable() {
 	// select a HT that has at least 50% empty space
 	idx_t capacity = NextPowerOfTwo(std::max(count * 2, (idx_t)(Storage::BLOCK_ALLOC_SIZE / sizeof(data_ptr_t)) + 1));
 	// size needs to be a power of 2
@@ -397,33 +430,141 @@ void JoinHashTable::Finalize() {
 	hash_map = buffer_manager.Allocate(capacity * sizeof(data_ptr_t));
 	memset(hash_map->node->buffer, 0, capacity * sizeof(data_ptr_t));
 
+	// as we insert the blocks we pin them and keep them pinned until the HT is destroyed
+	// this is so that we can keep pointers around to the blocks
+	// FIXME: if we cannot keep everything pinned in memory, we could switch to an out-of-memory merge join or so
+	pinned_handles.resize(blocks.size());
+}
+
+void JoinHashTable::InsertBlock(idx_t block_idx, bool parallel) {
+	auto &block = blocks[block_idx];
+	auto handle = buffer_manager.Pin(block.block_id);
+
 	Vector hashes(TypeId::HASH);
 	auto hash_data = FlatVector::GetData<hash_t>(hashes);
 	data_ptr_t key_locations[STANDARD_VECTOR_SIZE];
-	// now construct the actual hash table; scan the nodes
-	// as we can the nodes we pin all the blocks of the HT and keep them pinned until the HT is destroyed
-	// this is so that we can keep pointers around to the blocks
-	// FIXME: if we cannot keep everything pinned in memory, we could switch to an out-of-memory merge join or so
+	data_ptr_t dataptr = handle->node->buffer;
+	idx_t entry = 0;
+	while (entry < block.count) {
+		// fetch the next vector of entries from the blocks
+		idx_t next = std::min((idx_t)STANDARD_VECTOR_SIZE, block.count - entry);
+		for (idx_t i = 0; i < next; i++) {
+			hash_data[i] = *((hash_t *)(dataptr + pointer_offset));
+			key_locations[i] = dataptr;
+			dataptr += entry_size;
+		}
+		// now insert into the hash table
+		InsertHashes(hashes, next, key_locations, parallel);
+
+		entry += next;
+	}
+	pinned_handles[block_idx] = move(handle);
+}
+
+void JoinHashTable::Finalize() {
+	// the build has finished, now iterate over all the nodes and construct the final hash table
+	InitializePointerTable();
+	for (idx_t block_idx = 0; block_idx < blocks.size(); block_idx++) {
+		InsertBlock(block_idx, false);
+	}
+	finalized = true;
+}
+
+idx_t JoinHashTable::RequiredMemory() {
+	idx_t capacity = NextPowerOfTwo(std::max(count * 2, (idx_t)(Storage::BLOCK_ALLOC_SIZE / sizeof(data_ptr_t)) + 1));
+	return blocks.size() * block_capacity * entry_size + capacity * sizeof(data_ptr_t);
+}
+
+idx_t JoinHashTable::RadixPartition(hash_t hash, idx_t radix_bits) {
+	// the lower bits of the hash are used to find the position in the pointer table, use the upper bits of the lower
+	// 32 bits here: the hashes of 32-bit values do not fill the upper half of the hash
+	assert(radix_bits <= PARTITION_BIT_END);
+	return radix_bits == 0 ? 0 : (hash >> (PARTITION_BIT_END - radix_bits)) & (((idx_t)1 << radix_bits) - 1);
+}
+
+void JoinHashTable::AppendEntries(data_ptr_t entries[], idx_t entry_count) {
+	vector<unique_ptr<BufferHandle>> handles;
+	data_ptr_t key_locations[STANDARD_VECTOR_SIZE];
+	ReserveEntries(entry_count, key_locations, handles);
+	for (idx_t i = 0; i < entry_count; i++) {
+		memcpy(key_locations[i], entries[i], entry_size);
+	}
+	count += entry_count;
+}
+
+void JoinHashTable::Partition(vector<unique_ptr<JoinHashTable>> &partitions, idx_t radix_bits) {
+	assert(!finalized);
+	assert(partitions.size() == (idx_t)1 << radix_bits);
+	auto partition_counts = unique_ptr<idx_t[]>(new idx_t[partitions.size() + 1]);
+	idx_t partition_indices[STANDARD_VECTOR_SIZE];
+	data_ptr_t entries[STANDARD_VECTOR_SIZE];
+	data_ptr_t partitioned_entries[STANDARD_VECTOR_SIZE];
 	for (auto &block : blocks) {
 		auto handle = buffer_manager.Pin(block.block_id);
 		data_ptr_t dataptr = handle->node->buffer;
 		idx_t entry = 0;
 		while (entry < block.count) {
-			// fetch the next vector of entries from the blocks
+			// compute the partitions of the next vector of entries
 			idx_t next = std::min((idx_t)STANDARD_VECTOR_SIZE, block.count - entry);
+			memset(partition_counts.get(), 0, sizeof(idx_t) * (partitions.size() + 1));
 			for (idx_t i = 0; i < next; i++) {
-				hash_data[i] = *((hash_t *)(dataptr + pointer_offset));
-				key_locations[i] = dataptr;
+				auto hash = *((hash_t *)(dataptr + pointer_offset));
+				partition_indices[i] = RadixPartition(hash, radix_bits);
+				partition_counts[partition_indices[i] + 1]++;
+				entries[i] = dataptr;
 				dataptr += entry_size;
 			}
-			// now insert into the hash table
-			InsertHashes(hashes, next, key_locations);
-
+			// group the entries by partition and copy them over to the partitions
+			for (idx_t partition_idx = 0; partition_idx < partitions.size(); partition_idx++) {
+				partition_counts[partition_idx + 1] += partition_counts[partition_idx];
+			}
+			for (idx_t i = 0; i < next; i++) {
+				partitioned_entries[partition_counts[partition_indices[i]]++] = entries[i];
+			}
+			idx_t partition_start = 0;
+			for (idx_t partition_idx = 0; partition_idx < partitions.size(); partition_idx++) {
+				idx_t partition_end = partition_counts[partition_idx];
+				if (partition_end > partition_start) {
+					partitions[partition_idx]->AppendEntries(partitioned_entries + partition_start,
+					                                         partition_end - partition_start);
+				}
+				partition_start = partition_end;
+			}
 			entry += next;
 		}
-		pinned_handles.push_back(move(handle));
+		// all entries of the block have been copied: we can get rid of it
+		handle.reset();
+		buffer_manager.DestroyBuffer(block.block_id);
+	}
+	blocks.clear();
+	for (auto &partition : partitions) {
+		// the MARK join needs to know whether or not there were any NULL values in the entire build side
+		partition->has_null = has_null;
+	}
+}
+
+void JoinHashTable::ComputeRadixPartitions(DataChunk &keys, idx_t radix_bits, idx_t partition_indices[]) {
+	// rows with NULL keys never find a match, we assign them to the first partition
+	memset(partition_indices, 0, sizeof(idx_t) * keys.size());
+
+	unique_ptr<VectorData[]> key_data;
+	const SelectionVector *current_sel;
+	SelectionVector sel(STANDARD_VECTOR_SIZE);
+	idx_t added_count = PrepareKeys(keys, key_data, current_sel, sel);
+	if (added_count == 0) {
+		return;
+	}
+	Vector hashes(TypeId::HASH);
+	Hash(keys, *current_sel, added_count, hashes);
+
+	VectorData hdata;
+	hashes.Orrify(keys.size(), hdata);
+	auto hash_data = (hash_t *)hdata.data;
+	for (idx_t i = 0; i < added_count; i++) {
+		auto rindex = current_sel->get_index(i);
+		auto hindex = hdata.sel->get_index(rindex);
+		partition_indices[rindex] = RadixPartition(hash_data[hindex], radix_bits);
 	}
-	finalized = true;
 }
 
 unique_ptr<ScanStructure> JoinHashTable::Probe(DataChunk &keys) {
@@ -1031,7 +1172,7 @@ void JoinHashTable::ScanFullOuter(DataChunk &result, JoinHTScanState &state) {
 	// scan the HT starting from the current position and check which rows from the build side did not find a match
 	data_ptr_t key_locations[STANDARD_VECTOR_SIZE];
 	idx_t found_entries = 0;
-	for (; state.block_position < blocks.size(); state.block_position++) {
+	for (; state.block_position < blocks.size(); state.block_position++, state.position = 0) {
 		auto &block = blocks[state.block_position];
 		auto &handle = pinned_handles[state.block_position];
 		auto baseptr = handle->node->buffer;
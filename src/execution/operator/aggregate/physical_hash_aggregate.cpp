@@ -5,6 +5,12 @@
 #include "duckdb/planner/expression/bound_aggregate_expression.hpp"
 #include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include "duckdb/catalog/catalog_entry/aggregate_function_catalog_entry.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parallel/task_context.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+#include <atomic>
 
 using namespace duckdb;
 using namespace std;
@@ -30,6 +36,7 @@ PhysicalHashAggregate::PhysicalHashAggregate(vector<TypeId> types, vector<unique
 		group_types.push_back(expr->return_type);
 	}
 	all_combinable = true;
+	any_distinct = false;
 	for (auto &expr : expressions) {
 		assert(expr->expression_class == ExpressionClass::BOUND_AGGREGATE);
 		assert(expr->IsAggregate());
@@ -48,6 +55,9 @@ PhysicalHashAggregate::PhysicalHashAggregate(vector<TypeId> types, vector<unique
 		if (!aggr.function.combine) {
 			all_combinable = false;
 		}
+		if (aggr.distinct) {
+			any_distinct = true;
+		}
 		aggregates.push_back(move(expr));
 	}
 }
@@ -57,35 +67,56 @@ PhysicalHashAggregate::PhysicalHashAggregate(vector<TypeId> types, vector<unique
 //===--------------------------------------------------------------------===//
 class HashAggregateGlobalState : public GlobalOperatorState {
 public:
-	HashAggregateGlobalState(vector<TypeId> &group_types, vector<TypeId> &payload_types,
-	                         vector<BoundAggregateExpression *> &bindings)
-	    : is_empty(true) {
-		ht = make_unique<SuperLargeHashTable>(1024, group_types, payload_types, bindings);
+	HashAggregateGlobalState(PhysicalHashAggregate &op, idx_t radix_bits, idx_t spill_threshold)
+	    : is_empty(true), radix_bits(radix_bits), partitions((idx_t)1 << radix_bits),
+	      partition_locks((idx_t)1 << radix_bits), combine_count(0), spill_threshold(spill_threshold) {
+		if (!op.UseThreadLocalHT()) {
+			// the aggregates cannot be combined: all threads aggregate into the same HT
+			ht = make_unique<SuperLargeHashTable>(1024, op.group_types, op.payload_types, op.bindings);
+		}
 	}
 
 	//! The lock for updating the global aggregate state
 	std::mutex lock;
-	//! The aggregate HT
+	//! The aggregate HT. This is either the HT shared by all threads, or the HT that small thread-local HTs are
+	//! combined into
 	unique_ptr<SuperLargeHashTable> ht;
 	//! Whether or not any tuples were added to the HT
 	bool is_empty;
+	//! The amount of radix bits used to partition large thread-local HTs (0 if partitioning is disabled)
+	idx_t radix_bits;
+	//! The radix partitioned HTs, each partition is combined separately from the others
+	vector<unique_ptr<SuperLargeHashTable>> partitions;
+	//! The locks for combining into each of the partitions
+	vector<std::mutex> partition_locks;
+	//! The amount of thread-local HTs that were combined, used to spread the threads over the partitions
+	std::atomic<idx_t> combine_count;
+	//! The HTs to scan after the sink has been finalized
+	vector<unique_ptr<SuperLargeHashTable>> finalized_hts;
+	//! The size in bytes above which thread-local HTs are spilled to disk (INVALID_INDEX if spilling is disabled)
+	idx_t spill_threshold;
+	//! The spilled groups of all threads, radix partitioned with SPILL_RADIX_BITS
+	vector<unique_ptr<AggregateSpill>> spills;
+	//! The spilled partitions to re-aggregate and scan after the sink has been finalized
+	vector<unique_ptr<AggregateSpill>> finalized_spills;
 };
 
 class HashAggregateLocalState : public LocalSinkState {
 public:
-	HashAggregateLocalState(vector<unique_ptr<Expression>> &groups, vector<BoundAggregateExpression *> &aggregates,
-	                        vector<TypeId> &group_types, vector<TypeId> &payload_types)
-	    : group_executor(groups) {
-		for (auto &aggr : aggregates) {
+	HashAggregateLocalState(PhysicalHashAggregate &op) : group_executor(op.groups) {
+		for (auto &aggr : op.bindings) {
 			if (aggr->children.size()) {
 				for (idx_t i = 0; i < aggr->children.size(); ++i) {
 					payload_executor.AddExpression(*aggr->children[i]);
 				}
 			}
 		}
-		group_chunk.Initialize(group_types);
-		if (payload_types.size() > 0) {
-			payload_chunk.Initialize(payload_types);
+		group_chunk.Initialize(op.group_types);
+		if (op.payload_types.size() > 0) {
+			payload_chunk.Initialize(op.payload_types);
+		}
+		if (op.UseThreadLocalHT()) {
+			ht = make_unique<SuperLargeHashTable>(1024, op.group_types, op.payload_types, op.bindings);
 		}
 	}
 
@@ -97,14 +128,32 @@ public:
 	DataChunk group_chunk;
 	//! The payload chunk
 	DataChunk payload_chunk;
+	//! The thread-local aggregate HT (if any)
+	unique_ptr<SuperLargeHashTable> ht;
+	//! The groups of the thread-local HT that were spilled to disk
+	vector<unique_ptr<AggregateSpill>> spills;
 };
 
 unique_ptr<GlobalOperatorState> PhysicalHashAggregate::GetGlobalState(ClientContext &context) {
-	return make_unique<HashAggregateGlobalState>(group_types, payload_types, bindings);
+	idx_t radix_bits = 0;
+	idx_t spill_threshold = INVALID_INDEX;
+	if (UseThreadLocalHT()) {
+		// use at least twice as many partitions as there are threads, so the combines can be spread evenly
+		idx_t thread_count = TaskScheduler::GetScheduler(context).NumberOfThreads();
+		while (thread_count > 1 && ((idx_t)1 << radix_bits) < 2 * thread_count && radix_bits < MAX_RADIX_BITS) {
+			radix_bits++;
+		}
+		auto &buffer_manager = BufferManager::GetBufferManager(context);
+		if (!is_implicit_aggr && buffer_manager.GetMaxMemory() != (idx_t)-1 && buffer_manager.HasTemporaryDirectory()) {
+			// the thread-local HTs together can use up to a quarter of the memory limit before they are spilled
+			spill_threshold = max<idx_t>(buffer_manager.GetMaxMemory() / (4 * thread_count), Storage::BLOCK_ALLOC_SIZE);
+		}
+	}
+	return make_unique<HashAggregateGlobalState>(*this, radix_bits, spill_threshold);
 }
 
 unique_ptr<LocalSinkState> PhysicalHashAggregate::GetLocalSinkState(ExecutionContext &context) {
-	return make_unique<HashAggregateLocalState>(groups, bindings, group_types, payload_types);
+	return make_unique<HashAggregateLocalState>(*this);
 }
 
 void PhysicalHashAggregate::Sink(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate,
@@ -137,9 +186,150 @@ void PhysicalHashAggregate::Sink(ExecutionContext &context, GlobalOperatorState
 	payload_chunk.Verify();
 	assert(payload_chunk.column_count() == 0 || group_chunk.size() == payload_chunk.size());
 
+	if (sink.ht) {
+		// thread-local HT: no locking required, the HTs are combined when the thread is finished
+		sink.ht->AddChunk(group_chunk, payload_chunk);
+		if (sink.ht->SizeInBytes() > gstate.spill_threshold) {
+			// the HT exceeds its share of the memory limit: move its groups to disk
+			sink.ht->Spill(BufferManager::GetBufferManager(context.client), sink.spills, SPILL_RADIX_BITS);
+		}
+		return;
+	}
 	lock_guard<mutex> glock(gstate.lock);
 	gstate.ht->AddChunk(group_chunk, payload_chunk);
-	gstate.is_empty = false;
+}
+
+void PhysicalHashAggregate::Combine(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate) {
+	auto &gstate = (HashAggregateGlobalState &)state;
+	auto &sink = (HashAggregateLocalState &)lstate;
+
+	if (sink.spills.size() > 0) {
+		// the thread has spilled groups: spill the remaining groups as well and hand the spills to the global state
+		sink.ht->Spill(BufferManager::GetBufferManager(context.client), sink.spills, SPILL_RADIX_BITS);
+		sink.ht.reset();
+		lock_guard<mutex> glock(gstate.lock);
+		gstate.spills.resize(sink.spills.size());
+		for (idx_t partition_idx = 0; partition_idx < sink.spills.size(); partition_idx++) {
+			auto &local_spill = sink.spills[partition_idx];
+			if (!local_spill) {
+				continue;
+			}
+			auto &spill = gstate.spills[partition_idx];
+			if (!spill) {
+				spill = move(local_spill);
+			} else {
+				spill->Merge(*local_spill);
+			}
+		}
+		return;
+	}
+	if (!sink.ht || sink.ht->Size() == 0) {
+		// shared HT or no groups: nothing to combine
+		return;
+	}
+	if (gstate.radix_bits == 0 || sink.ht->Size() < RADIX_PARTITION_THRESHOLD) {
+		// small HT: combining it directly into the global HT is cheaper than partitioning it
+		lock_guard<mutex> glock(gstate.lock);
+		if (!gstate.ht) {
+			gstate.ht = move(sink.ht);
+		} else {
+			gstate.ht->Combine(*sink.ht);
+		}
+		return;
+	}
+	// large HT: radix partition the HT without holding any locks
+	vector<unique_ptr<SuperLargeHashTable>> local_partitions;
+	sink.ht->Partition(local_partitions, gstate.radix_bits);
+	sink.ht.reset();
+
+	// now combine each partition into the corresponding global partition
+	// every thread starts at a different partition, so concurrent combines rarely wait on the same lock
+	idx_t partition_count = local_partitions.size();
+	idx_t offset = gstate.combine_count++;
+	for (idx_t i = 0; i < partition_count; i++) {
+		idx_t partition_idx = (offset + i) % partition_count;
+		auto &local_partition = local_partitions[partition_idx];
+		if (!local_partition) {
+			continue;
+		}
+		lock_guard<mutex> plock(gstate.partition_locks[partition_idx]);
+		auto &partition = gstate.partitions[partition_idx];
+		if (!partition) {
+			partition = move(local_partition);
+		} else {
+			partition->Combine(*local_partition);
+		}
+	}
+}
+
+void PhysicalHashAggregate::Finalize(ClientContext &context, unique_ptr<GlobalOperatorState> state) {
+	auto &gstate = (HashAggregateGlobalState &)*state;
+
+	if (gstate.spills.size() > 0) {
+		// groups were spilled to disk: spill the groups that are still in memory as well, the spilled partitions are
+		// then re-aggregated one at a time while scanning
+		auto &buffer_manager = BufferManager::GetBufferManager(context);
+		if (gstate.ht) {
+			gstate.ht->Spill(buffer_manager, gstate.spills, SPILL_RADIX_BITS);
+			gstate.ht.reset();
+		}
+		for (auto &partition : gstate.partitions) {
+			if (partition) {
+				partition->Spill(buffer_manager, gstate.spills, SPILL_RADIX_BITS);
+			}
+		}
+		gstate.partitions.clear();
+		for (auto &spill : gstate.spills) {
+			if (spill && spill->count > 0) {
+				gstate.finalized_spills.push_back(move(spill));
+			}
+		}
+		gstate.spills.clear();
+		gstate.is_empty = gstate.finalized_spills.size() == 0;
+		PhysicalSink::Finalize(context, move(state));
+		return;
+	}
+
+	bool any_partition = false;
+	for (auto &partition : gstate.partitions) {
+		if (partition) {
+			any_partition = true;
+		}
+	}
+	if (any_partition && gstate.ht) {
+		// some thread-local HTs were partitioned: the groups of the small HTs have to be moved into the partitions
+		vector<unique_ptr<SuperLargeHashTable>> small_partitions;
+		gstate.ht->Partition(small_partitions, gstate.radix_bits);
+		gstate.ht.reset();
+		for (idx_t partition_idx = 0; partition_idx < small_partitions.size(); partition_idx++) {
+			auto &small_partition = small_partitions[partition_idx];
+			if (!small_partition) {
+				continue;
+			}
+			auto &partition = gstate.partitions[partition_idx];
+			if (!partition) {
+				partition = move(small_partition);
+			} else {
+				partition->Combine(*small_partition);
+			}
+		}
+	}
+	// gather the HTs that have to be scanned
+	if (gstate.ht) {
+		gstate.finalized_hts.push_back(move(gstate.ht));
+	}
+	for (auto &partition : gstate.partitions) {
+		if (partition) {
+			gstate.finalized_hts.push_back(move(partition));
+		}
+	}
+	gstate.partitions.clear();
+	for (auto &ht : gstate.finalized_hts) {
+		if (ht->Size() > 0) {
+			gstate.is_empty = false;
+		}
+	}
+	PhysicalSink::Finalize(context, move(state));
 }
 
 //===--------------------------------------------------------------------===//
@@ -148,7 +338,8 @@ void PhysicalHashAggregate::Sink(ExecutionContext &context, GlobalOperatorState
 class PhysicalHashAggregateState : public PhysicalOperatorState {
 public:
 	PhysicalHashAggregateState(vector<TypeId> &group_types, vector<TypeId> &aggregate_types, PhysicalOperator *child)
-	    : PhysicalOperatorState(child), ht_scan_position(0) {
+	    : PhysicalOperatorState(child), initialized(false), ht_index(0), ht_end(0), ht_scan_position(0),
+	      ht_scan_end(INVALID_INDEX) {
 		group_chunk.Initialize(group_types);
 		if (aggregate_types.size() > 0) {
 			aggregate_chunk.Initialize(aggregate_types);
@@ -159,18 +350,103 @@ public:
 	DataChunk group_chunk;
 	//! Materialized aggregates
 	DataChunk aggregate_chunk;
+	//! Whether or not the scan has been initialized
+	bool initialized;
+	//! The index of the HT that is currently being scanned
+	idx_t ht_index;
+	//! The index of the HT at which the scan ends (exclusive)
+	idx_t ht_end;
 	//! The current position to scan the HT for output tuples
 	idx_t ht_scan_position;
+	//! The position at which the scan of the final HT ends (INVALID_INDEX to scan the entire HT)
+	idx_t ht_scan_end;
+	//! The HT holding the re-aggregated groups of the spilled partition that is currently being scanned
+	unique_ptr<SuperLargeHashTable> spill_ht;
 };
 
+class HashAggregateScanTaskInfo : public OperatorTaskInfo {
+public:
+	HashAggregateScanTaskInfo(idx_t ht_index, idx_t scan_start, idx_t scan_end)
+	    : ht_index(ht_index), scan_start(scan_start), scan_end(scan_end) {
+	}
+
+	//! The HT to scan
+	idx_t ht_index;
+	//! The range of the HT to scan
+	idx_t scan_start;
+	idx_t scan_end;
+};
+
+void PhysicalHashAggregate::ParallelScanInfo(ClientContext &context,
+                                             std::function<void(unique_ptr<OperatorTaskInfo>)> callback) {
+	auto &gstate = (HashAggregateGlobalState &)*sink_state;
+	if (gstate.is_empty && is_implicit_aggr) {
+		// the empty implicit aggregate emits a single row: do not split it up
+		return;
+	}
+	if (gstate.finalized_spills.size() > 0) {
+		// generate one task per spilled partition, each task re-aggregates and scans its partition
+		for (idx_t partition_idx = 0; partition_idx < gstate.finalized_spills.size(); partition_idx++) {
+			callback(make_unique<HashAggregateScanTaskInfo>(partition_idx, 0, INVALID_INDEX));
+		}
+		return;
+	}
+	// generate one task per range of the HTs
+	idx_t range_size = context.force_parallelism ? STANDARD_VECTOR_SIZE : PARALLEL_SCAN_CELL_COUNT;
+	for (idx_t ht_index = 0; ht_index < gstate.finalized_hts.size(); ht_index++) {
+		gstate.finalized_hts[ht_index]->InitializeParallelScan(range_size, [&](idx_t scan_start, idx_t scan_end) {
+			callback(make_unique<HashAggregateScanTaskInfo>(ht_index, scan_start, scan_end));
+		});
+	}
+}
+
 void PhysicalHashAggregate::GetChunkInternal(ExecutionContext &context, DataChunk &chunk,
                                              PhysicalOperatorState *state_) {
 	auto &gstate = (HashAggregateGlobalState &)*sink_state;
 	auto &state = (PhysicalHashAggregateState &)*state_;
 
+	if (!state.initialized) {
+		auto &task = context.task;
+		auto task_info = task.task_info.find(this);
+		if (task_info != task.task_info.end()) {
+			// task specific limitations: scan only the range of the HT indicated by the task
+			auto &info = (HashAggregateScanTaskInfo &)*task_info->second;
+			state.ht_index = info.ht_index;
+			state.ht_end = info.ht_index + 1;
+			state.ht_scan_position = info.scan_start;
+			state.ht_scan_end = info.scan_end;
+		} else {
+			// no task specific limitations: scan all of the HTs
+			state.ht_end = gstate.finalized_spills.size() > 0 ? gstate.finalized_spills.size()
+			                                                   : gstate.finalized_hts.size();
+		}
+		state.initialized = true;
+	}
+
 	state.group_chunk.Reset();
 	state.aggregate_chunk.Reset();
-	idx_t elements_found = gstate.ht->Scan(state.ht_scan_position, state.group_chunk, state.aggregate_chunk);
+	idx_t elements_found = 0;
+	while (state.ht_index < state.ht_end) {
+		SuperLargeHashTable *ht;
+		if (gstate.finalized_spills.size() > 0) {
+			if (!state.spill_ht) {
+				// re-aggregate the groups of the spilled partition in memory
+				state.spill_ht = make_unique<SuperLargeHashTable>(1024, group_types, payload_types, bindings);
+				state.spill_ht->Combine(*gstate.finalized_spills[state.ht_index]);
+			}
+			ht = state.spill_ht.get();
+		} else {
+			ht = gstate.finalized_hts[state.ht_index].get();
+		}
+		elements_found = ht->Scan(state.ht_scan_position, state.ht_scan_end, state.group_chunk, state.aggregate_chunk);
+		if (elements_found > 0) {
+			break;
+		}
+		// finished scanning this HT: move to the next one
+		state.ht_index++;
+		state.ht_scan_position = 0;
+		state.spill_ht.reset();
+	}
 
 	// special case hack to sort out aggregating from empty intermediates
 	// for aggregations without groups
@@ -0,0 +1,498 @@
+#include "duckdb/execution/operator/aggregate/physical_streaming_window.hpp"
+
+#include "duckdb/common/types/chunk_collection.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/execution/window_segment_tree.hpp"
+#include "duckdb/planner/expression/bound_window_expression.hpp"
+
+using namespace std;
+
+namespace duckdb {
+
+//! The maximum amount of preceding rows in the frame of an aggregate that is computed while streaming. The segment
+//! tree over the buffered rows is rebuilt for every chunk, larger frames are cheaper to compute over the materialized
+//! input.
+static constexpr idx_t STREAMING_WINDOW_MAX_AGGREGATE_LOOKBACK = 4 * STANDARD_VECTOR_SIZE;
+
+//! Evaluates a constant, non-negative offset of a frame boundary or of LAG
+static bool GetStreamingOffset(Expression *expr, idx_t &offset) {
+	if (!expr || !expr->IsFoldable() || !TypeIsIntegral(expr->return_type)) {
+		return false;
+	}
+	auto value = ExpressionExecutor::EvaluateScalar(*expr);
+	if (value.is_null) {
+		return false;
+	}
+	auto offset_value = value.GetValue<int64_t>();
+	if (offset_value < 0) {
+		return false;
+	}
+	offset = offset_value;
+	return true;
+}
+
+//! The frame of a window function over the rows of the input in their original order
+struct StreamingWindowFrame {
+	//! Whether or not the frame starts at the first row of the input
+	bool unbounded_start = false;
+	//! The amount of rows before the current row at which the frame starts
+	idx_t start_offset = 0;
+	//! The amount of rows before the current row at which the frame ends (0 = the frame ends at the current row)
+	idx_t end_offset = 0;
+
+	//! Binds the frame of the window expression, returns false if the frame needs rows after the current row
+	bool Bind(BoundWindowExpression &wexpr) {
+		switch (wexpr.start) {
+		case WindowBoundary::UNBOUNDED_PRECEDING:
+			unbounded_start = true;
+			break;
+		case WindowBoundary::EXPR_PRECEDING:
+			if (!GetStreamingOffset(wexpr.start_expr.get(), start_offset)) {
+				return false;
+			}
+			break;
+		case WindowBoundary::CURRENT_ROW_ROWS:
+			break;
+		default:
+			return false;
+		}
+		switch (wexpr.end) {
+		case WindowBoundary::EXPR_PRECEDING:
+			return GetStreamingOffset(wexpr.end_expr.get(), end_offset);
+		case WindowBoundary::CURRENT_ROW_ROWS:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	//! Computes the frame [begin, end) of the given row of the input
+	void GetFrame(idx_t row, idx_t &begin, idx_t &end) {
+		begin = unbounded_start || row < start_offset ? 0 : row - start_offset;
+		end = row + 1 < end_offset ? 0 : row + 1 - end_offset;
+	}
+};
+
+bool PhysicalStreamingWindow::IsStreamingFunction(Expression &expr) {
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_WINDOW) {
+		return false;
+	}
+	auto &wexpr = (BoundWindowExpression &)expr;
+	if (wexpr.partitions.size() > 0 || wexpr.orders.size() > 0) {
+		// the input has to be sorted first
+		return false;
+	}
+	if (wexpr.return_type == TypeId::LIST || wexpr.return_type == TypeId::STRUCT) {
+		return false;
+	}
+	switch (wexpr.type) {
+	case ExpressionType::WINDOW_ROW_NUMBER:
+	case ExpressionType::WINDOW_RANK:
+	case ExpressionType::WINDOW_RANK_DENSE:
+	case ExpressionType::WINDOW_PERCENT_RANK:
+	case ExpressionType::WINDOW_CUME_DIST:
+		// without an ORDER BY all rows are peers of each other
+		return true;
+	case ExpressionType::WINDOW_LAG: {
+		idx_t offset = 1;
+		return !wexpr.offset_expr || GetStreamingOffset(wexpr.offset_expr.get(), offset);
+	}
+	case ExpressionType::WINDOW_FIRST_VALUE:
+	case ExpressionType::WINDOW_LAST_VALUE: {
+		StreamingWindowFrame frame;
+		return frame.Bind(wexpr);
+	}
+	case ExpressionType::WINDOW_AGGREGATE: {
+		StreamingWindowFrame frame;
+		if (!frame.Bind(wexpr)) {
+			return false;
+		}
+		if (frame.unbounded_start) {
+			// a running aggregate can only be kept up to the current row
+			return frame.end_offset == 0;
+		}
+		return frame.start_offset <= STREAMING_WINDOW_MAX_AGGREGATE_LOOKBACK;
+	}
+	default:
+		return false;
+	}
+}
+
+//===--------------------------------------------------------------------===//
+// Window State
+//===--------------------------------------------------------------------===//
+//! The state of a window expression that is computed while streaming over the input
+struct StreamingWindowState {
+	explicit StreamingWindowState(BoundWindowExpression &wexpr)
+	    : wexpr(wexpr), buffered(false), lookback(0), lag_offset(1), buffer_start(0), aggregate_destructor(nullptr) {
+		vector<TypeId> payload_types;
+		for (auto &child : wexpr.children) {
+			payload_types.push_back(child->return_type);
+			payload_executor.AddExpression(*child);
+		}
+		if (payload_types.size() > 0) {
+			payload.Initialize(payload_types);
+			row_input.Initialize(payload_types);
+		}
+		if (wexpr.default_expr) {
+			vector<TypeId> default_types = {wexpr.default_expr->return_type};
+			default_executor.AddExpression(*wexpr.default_expr);
+			defaults.Initialize(default_types);
+		}
+
+		switch (wexpr.type) {
+		case ExpressionType::WINDOW_LAG:
+			if (wexpr.offset_expr) {
+				GetStreamingOffset(wexpr.offset_expr.get(), lag_offset);
+			}
+			buffered = true;
+			lookback = lag_offset;
+			break;
+		case ExpressionType::WINDOW_FIRST_VALUE:
+			frame.Bind(wexpr);
+			// with an unbounded frame the first row of the input is kept instead
+			buffered = !frame.unbounded_start;
+			lookback = frame.start_offset;
+			break;
+		case ExpressionType::WINDOW_LAST_VALUE:
+			frame.Bind(wexpr);
+			buffered = true;
+			lookback = frame.end_offset;
+			break;
+		case ExpressionType::WINDOW_AGGREGATE:
+			frame.Bind(wexpr);
+			if (frame.unbounded_start) {
+				aggregate_state.resize(wexpr.aggregate->state_size());
+				wexpr.aggregate->initialize(aggregate_state.data());
+				aggregate_destructor = wexpr.aggregate->destructor;
+			} else {
+				// COUNT(*) only needs the size of the frame
+				buffered = wexpr.children.size() > 0;
+				lookback = frame.start_offset;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	~StreamingWindowState() {
+		if (aggregate_destructor) {
+			Vector state_vector(Value::POINTER((uintptr_t)aggregate_state.data()));
+			state_vector.vector_type = VectorType::FLAT_VECTOR;
+
+			aggregate_destructor(state_vector, 1);
+		}
+	}
+
+	BoundWindowExpression &wexpr;
+	StreamingWindowFrame frame;
+	//! Whether or not the arguments of the preceding rows are kept in the buffer
+	bool buffered;
+	//! The amount of rows before the current row that are kept in the buffer
+	idx_t lookback;
+	idx_t lag_offset;
+
+	//! Executes the arguments of the window function
+	ExpressionExecutor payload_executor;
+	DataChunk payload;
+	//! A single row of the arguments, used to update the running aggregate
+	DataChunk row_input;
+	//! Executes the default value of LAG
+	ExpressionExecutor default_executor;
+	DataChunk defaults;
+
+	//! The arguments of the preceding rows that can still be part of a frame, followed by the current chunk
+	ChunkCollection buffer;
+	//! The row of the input that the buffer starts with
+	idx_t buffer_start;
+	//! The arguments of the first row of the input (for FIRST_VALUE with an unbounded frame)
+	ChunkCollection first_row;
+	//! The running aggregate state (for aggregates with an unbounded frame)
+	vector<data_t> aggregate_state;
+	//! The destructor of the running aggregate state. The state can outlive the physical plan, so the window
+	//! expression cannot be used to find it anymore.
+	aggregate_destructor_t aggregate_destructor;
+};
+
+class PhysicalStreamingWindowOperatorState : public PhysicalOperatorState {
+public:
+	PhysicalStreamingWindowOperatorState(PhysicalOperator *child, vector<unique_ptr<Expression>> &select_list)
+	    : PhysicalOperatorState(child), row_count(0) {
+		for (auto &expr : select_list) {
+			assert(expr->GetExpressionClass() == ExpressionClass::BOUND_WINDOW);
+			window_states.push_back(make_unique<StreamingWindowState>((BoundWindowExpression &)*expr));
+		}
+	}
+
+	//! The amount of rows of the input that have been processed
+	idx_t row_count;
+	//! The states of the window expressions
+	vector<unique_ptr<StreamingWindowState>> window_states;
+};
+
+PhysicalStreamingWindow::PhysicalStreamingWindow(vector<TypeId> types, vector<unique_ptr<Expression>> select_list)
+    : PhysicalOperator(PhysicalOperatorType::STREAMING_WINDOW, move(types)), select_list(move(select_list)) {
+}
+
+//===--------------------------------------------------------------------===//
+// Compute
+//===--------------------------------------------------------------------===//
+//! Copies row sources[i] of the first column of the collection into row i of the result, rows with a source of
+//! INVALID_INDEX are left untouched. The sources are expected to be ascending.
+static void GatherStreamingRows(ChunkCollection &source, const idx_t *sources, idx_t count, Vector &result) {
+	SelectionVector sel(STANDARD_VECTOR_SIZE);
+	idx_t i = 0;
+	while (i < count) {
+		if (sources[i] == INVALID_INDEX) {
+			i++;
+			continue;
+		}
+		// copy the run of rows whose sources are in the same chunk at once
+		idx_t chunk_idx = sources[i] / STANDARD_VECTOR_SIZE;
+		idx_t run_start = i;
+		for (; i < count && sources[i] != INVALID_INDEX && sources[i] / STANDARD_VECTOR_SIZE == chunk_idx; i++) {
+			sel.set_index(i - run_start, sources[i] % STANDARD_VECTOR_SIZE);
+		}
+		VectorOperations::Copy(source.chunks[chunk_idx]->data[0], result, sel, i - run_start, 0, run_start);
+	}
+}
+
+static void SetStreamingCount(Vector &result, idx_t row_idx, idx_t count) {
+	if (result.type == TypeId::INT64) {
+		FlatVector::GetData<int64_t>(result)[row_idx] = count;
+	} else {
+		result.SetValue(row_idx, Value::Numeric(result.type, count));
+	}
+}
+
+static void ComputeStreamingLag(StreamingWindowState &state, DataChunk &input, idx_t row_count, Vector &result) {
+	idx_t sources[STANDARD_VECTOR_SIZE];
+	bool needs_default = false;
+	for (idx_t i = 0; i < input.size(); i++) {
+		auto row = row_count + i;
+		if (row >= state.lag_offset) {
+			sources[i] = row - state.lag_offset - state.buffer_start;
+		} else {
+			// the row is at the start of the input: use the default value
+			sources[i] = INVALID_INDEX;
+			needs_default = true;
+		}
+	}
+	GatherStreamingRows(state.buffer, sources, input.size(), result);
+	if (!needs_default) {
+		return;
+	}
+	if (state.wexpr.default_expr) {
+		state.defaults.Reset();
+		state.default_executor.Execute(input, state.defaults);
+	}
+	for (idx_t i = 0; i < input.size(); i++) {
+		if (sources[i] != INVALID_INDEX) {
+			continue;
+		}
+		if (state.wexpr.default_expr) {
+			// the default value is not necessarily of the result type
+			result.SetValue(i, state.defaults.GetValue(0, i));
+		} else {
+			FlatVector::SetNull(result, i, true);
+		}
+	}
+}
+
+static void ComputeStreamingValue(StreamingWindowState &state, idx_t count, idx_t row_count, Vector &result) {
+	bool first_value = state.wexpr.type == ExpressionType::WINDOW_FIRST_VALUE;
+	if (first_value && state.frame.unbounded_start && row_count == 0) {
+		// keep the first row of the input
+		auto types = state.payload.GetTypes();
+		DataChunk first;
+		first.Initialize(types);
+		VectorOperations::Copy(state.payload.data[0], first.data[0], 1, 0, 0);
+		first.SetCardinality(1);
+		state.first_row.Append(first);
+	}
+	idx_t sources[STANDARD_VECTOR_SIZE];
+	for (idx_t i = 0; i < count; i++) {
+		idx_t begin, end;
+		state.frame.GetFrame(row_count + i, begin, end);
+		if (begin >= end) {
+			// if no values are read for window, result is NULL
+			sources[i] = INVALID_INDEX;
+			FlatVector::SetNull(result, i, true);
+		} else if (first_value) {
+			sources[i] = state.frame.unbounded_start ? 0 : begin - state.buffer_start;
+		} else {
+			sources[i] = end - 1 - state.buffer_start;
+		}
+	}
+	auto &source = first_value && state.frame.unbounded_start ? state.first_row : state.buffer;
+	GatherStreamingRows(source, sources, count, result);
+}
+
+static void ComputeRunningAggregate(StreamingWindowState &state, idx_t count, idx_t row_count, Vector &result) {
+	if (state.wexpr.children.size() == 0) {
+		// COUNT(*): the frame contains all rows up to and including the current row
+		for (idx_t i = 0; i < count; i++) {
+			SetStreamingCount(result, i, row_count + i + 1);
+		}
+		return;
+	}
+	auto &aggregate = *state.wexpr.aggregate;
+	auto state_size = aggregate.state_size();
+	// states that own (string) data are finalized right away, as they might be freed by the next update
+	bool finalize_rows = aggregate.destructor != nullptr;
+	unique_ptr<data_t[]> row_states;
+	Vector row_statev(TypeId::POINTER);
+	auto row_state_pointers = FlatVector::GetData<data_ptr_t>(row_statev);
+	if (!finalize_rows) {
+		row_states = unique_ptr<data_t[]>(new data_t[state_size * count]);
+	}
+
+	Vector statep(TypeId::POINTER);
+	FlatVector::GetData<data_ptr_t>(statep)[0] = state.aggregate_state.data();
+	auto &payload = state.payload;
+	auto &row_input = state.row_input;
+	payload.Normalify();
+	row_input.SetCardinality(1);
+	for (idx_t i = 0; i < count; i++) {
+		for (idx_t col_idx = 0; col_idx < payload.column_count(); col_idx++) {
+			row_input.data[col_idx].Slice(payload.data[col_idx], i);
+		}
+		aggregate.update(&row_input.data[0], row_input.column_count(), statep, 1);
+		if (finalize_rows) {
+			Vector row_result(result.type);
+			aggregate.finalize(statep, row_result, 1);
+			VectorOperations::Copy(row_result, result, 1, 0, i);
+		} else {
+			row_state_pointers[i] = row_states.get() + i * state_size;
+			memcpy(row_state_pointers[i], state.aggregate_state.data(), state_size);
+		}
+	}
+	if (!finalize_rows) {
+		aggregate.finalize(row_statev, result, count);
+	}
+}
+
+static void ComputeFrameAggregate(StreamingWindowState &state, idx_t count, idx_t row_count, Vector &result) {
+	idx_t frame_begins[STANDARD_VECTOR_SIZE];
+	idx_t frame_ends[STANDARD_VECTOR_SIZE];
+	for (idx_t i = 0; i < count; i++) {
+		idx_t begin, end;
+		state.frame.GetFrame(row_count + i, begin, end);
+		if (begin >= end) {
+			frame_begins[i] = frame_ends[i] = 0;
+		} else {
+			frame_begins[i] = begin - state.buffer_start;
+			frame_ends[i] = end - state.buffer_start;
+		}
+	}
+	if (state.wexpr.children.size() == 0) {
+		// COUNT(*): only the size of the frame matters
+		for (idx_t i = 0; i < count; i++) {
+			if (frame_begins[i] >= frame_ends[i]) {
+				FlatVector::SetNull(result, i, true);
+			} else {
+				SetStreamingCount(result, i, frame_ends[i] - frame_begins[i]);
+			}
+		}
+		return;
+	}
+	WindowSegmentTree segment_tree(*state.wexpr.aggregate, state.wexpr.return_type, &state.buffer);
+	segment_tree.Compute(result, frame_begins, frame_ends, count);
+}
+
+static void ComputeStreamingWindow(StreamingWindowState &state, DataChunk &input, idx_t row_count, Vector &result) {
+	auto &wexpr = state.wexpr;
+	idx_t count = input.size();
+	if (state.payload.column_count() > 0) {
+		state.payload.Reset();
+		state.payload_executor.Execute(input, state.payload);
+	}
+	if (state.buffered) {
+		state.buffer.Append(state.payload);
+	}
+
+	switch (wexpr.type) {
+	case ExpressionType::WINDOW_ROW_NUMBER: {
+		auto result_data = FlatVector::GetData<int64_t>(result);
+		for (idx_t i = 0; i < count; i++) {
+			result_data[i] = row_count + i + 1;
+		}
+		break;
+	}
+	case ExpressionType::WINDOW_RANK:
+	case ExpressionType::WINDOW_RANK_DENSE: {
+		auto result_data = FlatVector::GetData<int64_t>(result);
+		for (idx_t i = 0; i < count; i++) {
+			result_data[i] = 1;
+		}
+		break;
+	}
+	case ExpressionType::WINDOW_PERCENT_RANK:
+	case ExpressionType::WINDOW_CUME_DIST: {
+		auto result_data = FlatVector::GetData<double>(result);
+		double value = wexpr.type == ExpressionType::WINDOW_CUME_DIST ? 1 : 0;
+		for (idx_t i = 0; i < count; i++) {
+			result_data[i] = value;
+		}
+		break;
+	}
+	case ExpressionType::WINDOW_LAG:
+		ComputeStreamingLag(state, input, row_count, result);
+		break;
+	case ExpressionType::WINDOW_FIRST_VALUE:
+	case ExpressionType::WINDOW_LAST_VALUE:
+		ComputeStreamingValue(state, count, row_count, result);
+		break;
+	case ExpressionType::WINDOW_AGGREGATE:
+		if (state.frame.unbounded_start) {
+			ComputeRunningAggregate(state, count, row_count, result);
+		} else {
+			ComputeFrameAggregate(state, count, row_count, result);
+		}
+		break;
+	default:
+		throw NotImplementedException("Streaming window aggregate type %s", ExpressionTypeToString(wexpr.type).c_str());
+	}
+
+	if (state.buffered) {
+		// drop the chunks of the buffer that no frame of the next rows can reach anymore
+		auto &buffer = state.buffer;
+		idx_t next_row = row_count + count;
+		idx_t keep_start = next_row < state.lookback ? 0 : next_row - state.lookback;
+		idx_t drop_count = 0;
+		while (drop_count < buffer.chunks.size() &&
+		       state.buffer_start + buffer.chunks[drop_count]->size() <= keep_start) {
+			state.buffer_start += buffer.chunks[drop_count]->size();
+			buffer.count -= buffer.chunks[drop_count]->size();
+			drop_count++;
+		}
+		buffer.chunks.erase(buffer.chunks.begin(), buffer.chunks.begin() + drop_count);
+	}
+}
+
+void PhysicalStreamingWindow::GetChunkInternal(ExecutionContext &context, DataChunk &chunk,
+                                               PhysicalOperatorState *state_) {
+	auto state = reinterpret_cast<PhysicalStreamingWindowOperatorState *>(state_);
+	auto &input = state->child_chunk;
+	children[0]->GetChunk(context, input, state->child_state.get());
+	if (input.size() == 0) {
+		return;
+	}
+	// the columns of the input are passed through, with the results of the window expressions appended to them
+	idx_t out_idx = 0;
+	for (idx_t col_idx = 0; col_idx < input.column_count(); col_idx++) {
+		chunk.data[out_idx++].Reference(input.data[col_idx]);
+	}
+	for (auto &window_state : state->window_states) {
+		ComputeStreamingWindow(*window_state, input, state->row_count, chunk.data[out_idx++]);
+	}
+	chunk.SetCardinality(input);
+	state->row_count += input.size();
+}
+
+unique_ptr<PhysicalOperatorState> PhysicalStreamingWindow::GetOperatorState() {
+	return make_unique<PhysicalStreamingWindowOperatorState>(children[0].get(), select_list);
+}
+
+} // namespace duckdb
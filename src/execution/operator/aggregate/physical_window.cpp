@@ -1,13 +1,18 @@
 #include "duckdb/execution/operator/aggregate/physical_window.hpp"
 
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/operator/comparison_operators.hpp"
 #include "duckdb/common/types/chunk_collection.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/execution/expression_executor.hpp"
 #include "duckdb/execution/window_segment_tree.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "duckdb/planner/expression/bound_reference_expression.hpp"
 #include "duckdb/planner/expression/bound_window_expression.hpp"
 
 #include <cmath>
+#include <condition_variable>
 
 using namespace std;
 
@@ -21,7 +26,8 @@ public:
 
 	idx_t position;
 	ChunkCollection tuples;
-	ChunkCollection window_results;
+	//! The results of the window expressions, one (single column) collection per expression
+	vector<unique_ptr<ChunkCollection>> window_results;
 };
 
 // this implements a sorted window functions variant
@@ -30,38 +36,6 @@ PhysicalWindow::PhysicalWindow(vector<TypeId> types, vector<unique_ptr<Expressio
     : PhysicalOperator(type, move(types)), select_list(std::move(select_list)) {
 }
 
-static bool EqualsSubset(vector<Value> &a, vector<Value> &b, idx_t start, idx_t end) {
-	assert(start <= end);
-	for (idx_t i = start; i < end; i++) {
-		if (a[i] != b[i]) {
-			return false;
-		}
-	}
-	return true;
-}
-
-static idx_t BinarySearchRightmost(ChunkCollection &input, vector<Value> row, idx_t l, idx_t r, idx_t comp_cols) {
-	if (comp_cols == 0) {
-		return r - 1;
-	}
-	while (l < r) {
-		idx_t m = floor((l + r) / 2);
-		bool less_than_equals = true;
-		for (idx_t i = 0; i < comp_cols; i++) {
-			if (input.GetRow(m)[i] > row[i]) {
-				less_than_equals = false;
-				break;
-			}
-		}
-		if (less_than_equals) {
-			l = m + 1;
-		} else {
-			r = m;
-		}
-	}
-	return l - 1;
-}
-
 static void MaterializeExpressions(Expression **exprs, idx_t expr_count, ChunkCollection &input,
                                    ChunkCollection &output, bool scalar = false) {
 	if (expr_count == 0) {
@@ -95,52 +69,279 @@ static void MaterializeExpression(Expression *expr, ChunkCollection &input, Chun
 	MaterializeExpressions(&expr, 1, input, output, scalar);
 }
 
-static void SortCollectionForWindow(BoundWindowExpression *wexpr, ChunkCollection &input, ChunkCollection &output,
-                                    ChunkCollection &sort_collection) {
-	vector<TypeId> sort_types;
-	vector<OrderType> orders;
-	vector<OrderByNullType> null_order_types;
-	ExpressionExecutor executor;
+//===--------------------------------------------------------------------===//
+// Gather
+//===--------------------------------------------------------------------===//
+template <class T>
+static void TemplatedGatherColumn(ChunkCollection &source, idx_t column, const idx_t *indexes, idx_t count,
+                                  Vector &target) {
+	auto target_data = FlatVector::GetData<T>(target);
+	auto &target_mask = FlatVector::Nullmask(target);
+	for (idx_t i = 0; i < count; i++) {
+		if (indexes[i] == INVALID_INDEX) {
+			continue;
+		}
+		auto &source_vector = source.chunks[indexes[i] / STANDARD_VECTOR_SIZE]->data[column];
+		auto source_idx = indexes[i] % STANDARD_VECTOR_SIZE;
+		if (FlatVector::IsNull(source_vector, source_idx)) {
+			target_mask[i] = true;
+		} else {
+			target_data[i] = FlatVector::GetData<T>(source_vector)[source_idx];
+		}
+	}
+}
 
-	// we sort by both 1) partition by expression list and 2) order by expressions
-	for (idx_t prt_idx = 0; prt_idx < wexpr->partitions.size(); prt_idx++) {
-		auto &pexpr = wexpr->partitions[prt_idx];
-		sort_types.push_back(pexpr->return_type);
-		orders.push_back(OrderType::ASCENDING);
-		null_order_types.push_back(OrderByNullType::NULLS_FIRST);
-		executor.AddExpression(*pexpr);
+static void GatherStringColumn(ChunkCollection &source, idx_t column, const idx_t *indexes, idx_t count,
+                               Vector &target) {
+	auto target_data = FlatVector::GetData<string_t>(target);
+	auto &target_mask = FlatVector::Nullmask(target);
+	for (idx_t i = 0; i < count; i++) {
+		if (indexes[i] == INVALID_INDEX) {
+			continue;
+		}
+		auto &source_vector = source.chunks[indexes[i] / STANDARD_VECTOR_SIZE]->data[column];
+		auto source_idx = indexes[i] % STANDARD_VECTOR_SIZE;
+		if (FlatVector::IsNull(source_vector, source_idx)) {
+			target_mask[i] = true;
+		} else {
+			target_data[i] = StringVector::AddBlob(target, FlatVector::GetData<string_t>(source_vector)[source_idx]);
+		}
 	}
+}
 
-	for (idx_t ord_idx = 0; ord_idx < wexpr->orders.size(); ord_idx++) {
-		auto &oexpr = wexpr->orders[ord_idx].expression;
-		sort_types.push_back(oexpr->return_type);
-		orders.push_back(wexpr->orders[ord_idx].type);
-		null_order_types.push_back(wexpr->orders[ord_idx].null_order);
-		executor.AddExpression(*oexpr);
+//! Copies rows of a column of the collection into the flat target vector: row i of the target is row indexes[i] of
+//! the collection. Rows of the target with an index of INVALID_INDEX are left untouched.
+static void GatherColumn(ChunkCollection &source, idx_t column, const idx_t *indexes, idx_t count, Vector &target) {
+	switch (source.types[column]) {
+	case TypeId::BOOL:
+	case TypeId::INT8:
+		TemplatedGatherColumn<int8_t>(source, column, indexes, count, target);
+		break;
+	case TypeId::INT16:
+		TemplatedGatherColumn<int16_t>(source, column, indexes, count, target);
+		break;
+	case TypeId::INT32:
+		TemplatedGatherColumn<int32_t>(source, column, indexes, count, target);
+		break;
+	case TypeId::INT64:
+		TemplatedGatherColumn<int64_t>(source, column, indexes, count, target);
+		break;
+	case TypeId::INT128:
+		TemplatedGatherColumn<hugeint_t>(source, column, indexes, count, target);
+		break;
+	case TypeId::FLOAT:
+		TemplatedGatherColumn<float>(source, column, indexes, count, target);
+		break;
+	case TypeId::DOUBLE:
+		TemplatedGatherColumn<double>(source, column, indexes, count, target);
+		break;
+	case TypeId::INTERVAL:
+		TemplatedGatherColumn<interval_t>(source, column, indexes, count, target);
+		break;
+	case TypeId::VARCHAR:
+		GatherStringColumn(source, column, indexes, count, target);
+		break;
+	default:
+		// nested types
+		for (idx_t i = 0; i < count; i++) {
+			if (indexes[i] != INVALID_INDEX) {
+				target.SetValue(i, source.GetValue(column, indexes[i]));
+			}
+		}
+		break;
+	}
+}
+
+//! Appends the rows of the source collection in the given order to the target collection
+static void GatherCollection(ChunkCollection &source, const idx_t *indexes, idx_t count, ChunkCollection &target) {
+	if (source.column_count() == 0) {
+		return;
+	}
+	for (idx_t offset = 0; offset < count; offset += STANDARD_VECTOR_SIZE) {
+		idx_t chunk_count = std::min((idx_t)STANDARD_VECTOR_SIZE, count - offset);
+		DataChunk chunk;
+		chunk.Initialize(source.types);
+		for (idx_t col_idx = 0; col_idx < source.column_count(); col_idx++) {
+			GatherColumn(source, col_idx, indexes + offset, chunk_count, chunk.data[col_idx]);
+		}
+		chunk.SetCardinality(chunk_count);
+		target.Append(chunk);
 	}
+}
 
-	assert(sort_types.size() > 0);
+//===--------------------------------------------------------------------===//
+// Boundaries
+//===--------------------------------------------------------------------===//
+template <class T>
+static void TemplatedMarkBoundaries(ChunkCollection &collection, idx_t column, bool *boundaries) {
+	bool prev_null = false;
+	T prev_value = T();
+	idx_t row_idx = 0;
+	for (auto &chunk : collection.chunks) {
+		auto &vector = chunk->data[column];
+		auto data = FlatVector::GetData<T>(vector);
+		auto &nullmask = FlatVector::Nullmask(vector);
+		for (idx_t i = 0; i < chunk->size(); i++, row_idx++) {
+			bool is_null = nullmask[i];
+			if (row_idx > 0 && !boundaries[row_idx]) {
+				if (is_null != prev_null || (!is_null && !Equals::Operation<T>(data[i], prev_value))) {
+					boundaries[row_idx] = true;
+				}
+			}
+			prev_null = is_null;
+			prev_value = data[i];
+		}
+	}
+}
 
-	// create a chunkcollection for the results of the expressions in the window definitions
-	for (idx_t i = 0; i < input.chunks.size(); i++) {
-		DataChunk sort_chunk;
-		sort_chunk.Initialize(sort_types);
+//! Marks the rows of the (sorted) collection whose value in the column differs from the value of the previous row.
+//! NULL values are considered equal to each other.
+static void MarkBoundaries(ChunkCollection &collection, idx_t column, bool *boundaries) {
+	switch (collection.types[column]) {
+	case TypeId::BOOL:
+	case TypeId::INT8:
+		TemplatedMarkBoundaries<int8_t>(collection, column, boundaries);
+		break;
+	case TypeId::INT16:
+		TemplatedMarkBoundaries<int16_t>(collection, column, boundaries);
+		break;
+	case TypeId::INT32:
+		TemplatedMarkBoundaries<int32_t>(collection, column, boundaries);
+		break;
+	case TypeId::INT64:
+		TemplatedMarkBoundaries<int64_t>(collection, column, boundaries);
+		break;
+	case TypeId::INT128:
+		TemplatedMarkBoundaries<hugeint_t>(collection, column, boundaries);
+		break;
+	case TypeId::FLOAT:
+		TemplatedMarkBoundaries<float>(collection, column, boundaries);
+		break;
+	case TypeId::DOUBLE:
+		TemplatedMarkBoundaries<double>(collection, column, boundaries);
+		break;
+	case TypeId::INTERVAL:
+		TemplatedMarkBoundaries<interval_t>(collection, column, boundaries);
+		break;
+	case TypeId::VARCHAR:
+		TemplatedMarkBoundaries<string_t>(collection, column, boundaries);
+		break;
+	default: {
+		// nested types
+		Value prev_value;
+		for (idx_t row_idx = 0; row_idx < collection.count; row_idx++) {
+			auto value = collection.GetValue(column, row_idx);
+			if (row_idx > 0 && !boundaries[row_idx] && value != prev_value) {
+				boundaries[row_idx] = true;
+			}
+			prev_value = move(value);
+		}
+		break;
+	}
+	}
+}
+
+//! Reads the value of an integer expression (a frame boundary, or the offset of LEAD/LAG) for a row, scalar
+//! expressions are only materialized for the first row
+static int64_t GetIntegerCell(ChunkCollection &collection, bool scalar, idx_t row_idx) {
+	idx_t index = scalar ? 0 : row_idx;
+	auto &vector = collection.GetChunk(index).data[0];
+	auto vector_idx = index % STANDARD_VECTOR_SIZE;
+	if (!FlatVector::IsNull(vector, vector_idx)) {
+		switch (vector.type) {
+		case TypeId::INT8:
+			return FlatVector::GetData<int8_t>(vector)[vector_idx];
+		case TypeId::INT16:
+			return FlatVector::GetData<int16_t>(vector)[vector_idx];
+		case TypeId::INT32:
+			return FlatVector::GetData<int32_t>(vector)[vector_idx];
+		case TypeId::INT64:
+			return FlatVector::GetData<int64_t>(vector)[vector_idx];
+		default:
+			break;
+		}
+	}
+	return collection.GetValue(0, index).GetValue<int64_t>();
+}
+
+//! The materialized inputs of a window expression, in the order in which the window is computed
+struct WindowInputs {
+	//! The partition by and order by expressions
+	ChunkCollection sort_collection;
+	//! The arguments of the window function
+	ChunkCollection payload_collection;
+	ChunkCollection leadlag_offset_collection;
+	ChunkCollection leadlag_default_collection;
+	ChunkCollection boundary_start_collection;
+	ChunkCollection boundary_end_collection;
+
+	void Materialize(BoundWindowExpression *wexpr, ChunkCollection &input) {
+		// evaluate inner expressions of window functions, could be more complex
+		vector<Expression *> exprs;
+		for (auto &child : wexpr->children) {
+			exprs.push_back(child.get());
+		}
+		// TODO: child may be a scalar, don't need to materialize the whole collection then
+		MaterializeExpressions(exprs.data(), exprs.size(), input, payload_collection);
+
+		if (wexpr->type == ExpressionType::WINDOW_LEAD || wexpr->type == ExpressionType::WINDOW_LAG) {
+			if (wexpr->offset_expr) {
+				MaterializeExpression(wexpr->offset_expr.get(), input, leadlag_offset_collection,
+				                      wexpr->offset_expr->IsScalar());
+			}
+			if (wexpr->default_expr) {
+				MaterializeExpression(wexpr->default_expr.get(), input, leadlag_default_collection,
+				                      wexpr->default_expr->IsScalar());
+			}
+		}
 
-		executor.Execute(*input.chunks[i], sort_chunk);
+		// evaluate boundaries if present.
+		if (HasStartExpression(wexpr)) {
+			MaterializeExpression(wexpr->start_expr.get(), input, boundary_start_collection,
+			                      wexpr->start_expr->IsScalar());
+		}
+		if (HasEndExpression(wexpr)) {
+			MaterializeExpression(wexpr->end_expr.get(), input, boundary_end_collection, wexpr->end_expr->IsScalar());
+		}
+	}
 
-		sort_chunk.Verify();
-		sort_collection.Append(sort_chunk);
+	//! Gathers the rows of the source inputs in the given order, scalar expressions are copied as-is
+	void Gather(BoundWindowExpression *wexpr, WindowInputs &source, const idx_t *indexes, idx_t count) {
+		GatherCollection(source.sort_collection, indexes, count, sort_collection);
+		GatherCollection(source.payload_collection, indexes, count, payload_collection);
+		GatherExpression(wexpr->offset_expr.get(), source.leadlag_offset_collection, leadlag_offset_collection,
+		                 indexes, count);
+		GatherExpression(wexpr->default_expr.get(), source.leadlag_default_collection, leadlag_default_collection,
+		                 indexes, count);
+		GatherExpression(wexpr->start_expr.get(), source.boundary_start_collection, boundary_start_collection,
+		                 indexes, count);
+		GatherExpression(wexpr->end_expr.get(), source.boundary_end_collection, boundary_end_collection, indexes,
+		                 count);
 	}
 
-	assert(input.count == sort_collection.count);
+	static bool HasStartExpression(BoundWindowExpression *wexpr) {
+		return wexpr->start_expr &&
+		       (wexpr->start == WindowBoundary::EXPR_PRECEDING || wexpr->start == WindowBoundary::EXPR_FOLLOWING);
+	}
 
-	auto sorted_vector = unique_ptr<idx_t[]>(new idx_t[input.count]);
-	sort_collection.Sort(orders, null_order_types, sorted_vector.get());
+	static bool HasEndExpression(BoundWindowExpression *wexpr) {
+		return wexpr->end_expr &&
+		       (wexpr->end == WindowBoundary::EXPR_PRECEDING || wexpr->end == WindowBoundary::EXPR_FOLLOWING);
+	}
 
-	input.Reorder(sorted_vector.get());
-	output.Reorder(sorted_vector.get());
-	sort_collection.Reorder(sorted_vector.get());
-}
+private:
+	static void GatherExpression(Expression *expr, ChunkCollection &source, ChunkCollection &target,
+	                             const idx_t *indexes, idx_t count) {
+		if (source.count == 0) {
+			return;
+		}
+		if (expr->IsScalar()) {
+			target.Append(source);
+		} else {
+			GatherCollection(source, indexes, count, target);
+		}
+	}
+};
 
 struct WindowBoundariesState {
 	idx_t partition_start = 0;
@@ -149,52 +350,36 @@ struct WindowBoundariesState {
 	idx_t peer_end = 0;
 	int64_t window_start = -1;
 	int64_t window_end = -1;
-	bool is_same_partition = false;
-	bool is_peer = false;
-	vector<Value> row_prev;
+	idx_t dense_rank = 1;
+	idx_t rank = 1;
+	idx_t rank_equal = 0;
 };
 
-static bool WindowNeedsRank(BoundWindowExpression *wexpr) {
-	return wexpr->type == ExpressionType::WINDOW_PERCENT_RANK || wexpr->type == ExpressionType::WINDOW_RANK ||
-	       wexpr->type == ExpressionType::WINDOW_RANK_DENSE || wexpr->type == ExpressionType::WINDOW_CUME_DIST;
-}
-
-static void UpdateWindowBoundaries(BoundWindowExpression *wexpr, ChunkCollection &input, idx_t input_size,
-                                   idx_t row_idx, ChunkCollection &boundary_start_collection,
-                                   ChunkCollection &boundary_end_collection, WindowBoundariesState &bounds) {
-
-	if (input.column_count() > 0) {
-		vector<Value> row_cur = input.GetRow(row_idx);
-		idx_t sort_col_count = wexpr->partitions.size() + wexpr->orders.size();
-
-		// determine partition and peer group boundaries to ultimately figure out window size
-		bounds.is_same_partition = EqualsSubset(bounds.row_prev, row_cur, 0, wexpr->partitions.size());
-		bounds.is_peer = bounds.is_same_partition &&
-		                 EqualsSubset(bounds.row_prev, row_cur, wexpr->partitions.size(), sort_col_count);
-		bounds.row_prev = row_cur;
-
-		// when the partition changes, recompute the boundaries
-		if (!bounds.is_same_partition || row_idx == 0) { // special case for first row, need to init
-			bounds.partition_start = row_idx;
-			bounds.peer_start = row_idx;
-
-			// find end of partition
-			bounds.partition_end =
-			    BinarySearchRightmost(input, row_cur, bounds.partition_start, input.count, wexpr->partitions.size()) +
-			    1;
-
-		} else if (!bounds.is_peer) {
-			bounds.peer_start = row_idx;
+static void UpdateWindowBoundaries(BoundWindowExpression *wexpr, WindowInputs &inputs, idx_t input_size,
+                                   idx_t row_idx, const bool *partition_boundaries, const bool *peer_boundaries,
+                                   WindowBoundariesState &bounds) {
+	// determine partition and peer group boundaries to ultimately figure out window size
+	if (partition_boundaries[row_idx]) {
+		bounds.partition_start = row_idx;
+		bounds.partition_end = row_idx + 1;
+		while (bounds.partition_end < input_size && !partition_boundaries[bounds.partition_end]) {
+			bounds.partition_end++;
 		}
-
-		if (wexpr->end == WindowBoundary::CURRENT_ROW_RANGE || wexpr->type == ExpressionType::WINDOW_CUME_DIST) {
-			bounds.peer_end = BinarySearchRightmost(input, row_cur, row_idx, bounds.partition_end, sort_col_count) + 1;
+		bounds.dense_rank = 1;
+		bounds.rank = 1;
+		bounds.rank_equal = 0;
+	} else if (peer_boundaries[row_idx]) {
+		bounds.dense_rank++;
+		bounds.rank += bounds.rank_equal;
+		bounds.rank_equal = 0;
+	}
+	bounds.rank_equal++;
+	if (peer_boundaries[row_idx]) {
+		bounds.peer_start = row_idx;
+		bounds.peer_end = row_idx + 1;
+		while (bounds.peer_end < bounds.partition_end && !peer_boundaries[bounds.peer_end]) {
+			bounds.peer_end++;
 		}
-	} else {
-		bounds.is_same_partition = 0;
-		bounds.is_peer = true;
-		bounds.partition_end = input_size;
-		bounds.peer_end = bounds.partition_end;
 	}
 
 	// determine window boundaries depending on the type of expression
@@ -215,17 +400,15 @@ static void UpdateWindowBoundaries(BoundWindowExpression *wexpr, ChunkCollection
 		assert(0); // disallowed
 		break;
 	case WindowBoundary::EXPR_PRECEDING: {
-		assert(boundary_start_collection.column_count() > 0);
-		bounds.window_start =
-		    (int64_t)row_idx -
-		    boundary_start_collection.GetValue(0, wexpr->start_expr->IsScalar() ? 0 : row_idx).GetValue<int64_t>();
+		assert(inputs.boundary_start_collection.column_count() > 0);
+		bounds.window_start = (int64_t)row_idx - GetIntegerCell(inputs.boundary_start_collection,
+		                                                        wexpr->start_expr->IsScalar(), row_idx);
 		break;
 	}
 	case WindowBoundary::EXPR_FOLLOWING: {
-		assert(boundary_start_collection.column_count() > 0);
+		assert(inputs.boundary_start_collection.column_count() > 0);
 		bounds.window_start =
-		    row_idx +
-		    boundary_start_collection.GetValue(0, wexpr->start_expr->IsScalar() ? 0 : row_idx).GetValue<int64_t>();
+		    row_idx + GetIntegerCell(inputs.boundary_start_collection, wexpr->start_expr->IsScalar(), row_idx);
 		break;
 	}
 
@@ -247,16 +430,14 @@ static void UpdateWindowBoundaries(BoundWindowExpression *wexpr, ChunkCollection
 		bounds.window_end = bounds.partition_end;
 		break;
 	case WindowBoundary::EXPR_PRECEDING:
-		assert(boundary_end_collection.column_count() > 0);
-		bounds.window_end =
-		    (int64_t)row_idx -
-		    boundary_end_collection.GetValue(0, wexpr->end_expr->IsScalar() ? 0 : row_idx).GetValue<int64_t>() + 1;
+		assert(inputs.boundary_end_collection.column_count() > 0);
+		bounds.window_end = (int64_t)row_idx -
+		                    GetIntegerCell(inputs.boundary_end_collection, wexpr->end_expr->IsScalar(), row_idx) + 1;
 		break;
 	case WindowBoundary::EXPR_FOLLOWING:
-		assert(boundary_end_collection.column_count() > 0);
+		assert(inputs.boundary_end_collection.column_count() > 0);
 		bounds.window_end =
-		    row_idx +
-		    boundary_end_collection.GetValue(0, wexpr->end_expr->IsScalar() ? 0 : row_idx).GetValue<int64_t>() + 1;
+		    row_idx + GetIntegerCell(inputs.boundary_end_collection, wexpr->end_expr->IsScalar(), row_idx) + 1;
 
 		break;
 	default:
@@ -267,56 +448,67 @@ static void UpdateWindowBoundaries(BoundWindowExpression *wexpr, ChunkCollection
 	if (bounds.window_start < (int64_t)bounds.partition_start) {
 		bounds.window_start = bounds.partition_start;
 	}
-	if ((idx_t)bounds.window_end > bounds.partition_end) {
+	if (bounds.window_end > (int64_t)bounds.partition_end) {
 		bounds.window_end = bounds.partition_end;
 	}
+	// frames that end before the partition starts (e.g. "ROWS BETWEEN 5 PRECEDING AND 3 PRECEDING") are empty
+	if (bounds.window_end < (int64_t)bounds.partition_start) {
+		bounds.window_end = bounds.partition_start;
+	}
 
 	if (bounds.window_start < 0 || bounds.window_end < 0) {
 		throw Exception("Failed to compute window boundaries");
 	}
 }
 
-static void ComputeWindowExpression(BoundWindowExpression *wexpr, ChunkCollection &input, ChunkCollection &output,
-                                    idx_t output_idx) {
-
-	ChunkCollection sort_collection;
-	bool needs_sorting = wexpr->partitions.size() + wexpr->orders.size() > 0;
-	if (needs_sorting) {
-		SortCollectionForWindow(wexpr, input, output, sort_collection);
+static int64_t ComputeNtile(WindowInputs &inputs, WindowBoundariesState &bounds, idx_t row_idx) {
+	if (inputs.payload_collection.column_count() != 1) {
+		throw Exception("NTILE needs a parameter");
 	}
-
-	// evaluate inner expressions of window functions, could be more complex
-	ChunkCollection payload_collection;
-	vector<Expression *> exprs;
-	for (auto &child : wexpr->children) {
-		exprs.push_back(child.get());
+	auto n_param = GetIntegerCell(inputs.payload_collection, false, row_idx);
+	// With thanks from SQLite's ntileValueFunc()
+	int64_t n_total = bounds.partition_end - bounds.partition_start;
+	if (n_param > n_total) {
+		// more groups allowed than we have values
+		// map every entry to a unique group
+		n_param = n_total;
 	}
-	// TODO: child may be a scalar, don't need to materialize the whole collection then
-	MaterializeExpressions(exprs.data(), exprs.size(), input, payload_collection);
-
-	ChunkCollection leadlag_offset_collection;
-	ChunkCollection leadlag_default_collection;
-	if (wexpr->type == ExpressionType::WINDOW_LEAD || wexpr->type == ExpressionType::WINDOW_LAG) {
-		if (wexpr->offset_expr) {
-			MaterializeExpression(wexpr->offset_expr.get(), input, leadlag_offset_collection,
-			                      wexpr->offset_expr->IsScalar());
-		}
-		if (wexpr->default_expr) {
-			MaterializeExpression(wexpr->default_expr.get(), input, leadlag_default_collection,
-			                      wexpr->default_expr->IsScalar());
-		}
+	int64_t n_size = (n_total / n_param);
+	// find the row idx within the group
+	assert(row_idx >= bounds.partition_start);
+	int64_t adjusted_row_idx = row_idx - bounds.partition_start;
+	// now compute the ntile
+	int64_t n_large = n_total - n_param * n_size;
+	int64_t i_small = n_large * (n_size + 1);
+	int64_t result_ntile;
+
+	assert((n_large * (n_size + 1) + (n_param - n_large) * n_size) == n_total);
+
+	if (adjusted_row_idx < i_small) {
+		result_ntile = 1 + adjusted_row_idx / (n_size + 1);
+	} else {
+		result_ntile = 1 + n_large + (adjusted_row_idx - i_small) / n_size;
 	}
+	// result has to be between [1, NTILE]
+	assert(result_ntile >= 1 && result_ntile <= n_param);
+	return result_ntile;
+}
 
-	// evaluate boundaries if present.
-	ChunkCollection boundary_start_collection;
-	if (wexpr->start_expr &&
-	    (wexpr->start == WindowBoundary::EXPR_PRECEDING || wexpr->start == WindowBoundary::EXPR_FOLLOWING)) {
-		MaterializeExpression(wexpr->start_expr.get(), input, boundary_start_collection, wexpr->start_expr->IsScalar());
+//! Computes the window expression over the (sorted) inputs, the results are appended to the result collection one
+//! vector at a time
+static void ComputeWindowResults(BoundWindowExpression *wexpr, WindowInputs &inputs, idx_t input_size,
+                                 ChunkCollection &result) {
+	// rows that start a new partition or peer group in the sorted inputs
+	auto partition_boundaries = unique_ptr<bool[]>(new bool[input_size]);
+	auto peer_boundaries = unique_ptr<bool[]>(new bool[input_size]);
+	memset(partition_boundaries.get(), 0, sizeof(bool) * input_size);
+	partition_boundaries[0] = true;
+	for (idx_t prt_idx = 0; prt_idx < wexpr->partitions.size(); prt_idx++) {
+		MarkBoundaries(inputs.sort_collection, prt_idx, partition_boundaries.get());
 	}
-	ChunkCollection boundary_end_collection;
-	if (wexpr->end_expr &&
-	    (wexpr->end == WindowBoundary::EXPR_PRECEDING || wexpr->end == WindowBoundary::EXPR_FOLLOWING)) {
-		MaterializeExpression(wexpr->end_expr.get(), input, boundary_end_collection, wexpr->end_expr->IsScalar());
+	memcpy(peer_boundaries.get(), partition_boundaries.get(), sizeof(bool) * input_size);
+	for (idx_t ord_idx = 0; ord_idx < wexpr->orders.size(); ord_idx++) {
+		MarkBoundaries(inputs.sort_collection, wexpr->partitions.size() + ord_idx, peer_boundaries.get());
 	}
 
 	// build a segment tree for frame-adhering aggregates
@@ -324,153 +516,352 @@ static void ComputeWindowExpression(BoundWindowExpression *wexpr, ChunkCollectio
 	unique_ptr<WindowSegmentTree> segment_tree = nullptr;
 
 	if (wexpr->aggregate) {
-		segment_tree = make_unique<WindowSegmentTree>(*(wexpr->aggregate), wexpr->return_type, &payload_collection);
+		segment_tree =
+		    make_unique<WindowSegmentTree>(*(wexpr->aggregate), wexpr->return_type, &inputs.payload_collection);
 	}
 
 	WindowBoundariesState bounds;
-	uint64_t dense_rank = 1, rank_equal = 0, rank = 1;
-
-	if (needs_sorting) {
-		bounds.row_prev = sort_collection.GetRow(0);
-	}
-
-	// this is the main loop, go through all sorted rows and compute window function result
-	for (idx_t row_idx = 0; row_idx < input.count; row_idx++) {
-		// special case, OVER (), aggregate over everything
-		UpdateWindowBoundaries(wexpr, sort_collection, input.count, row_idx, boundary_start_collection,
-		                       boundary_end_collection, bounds);
-		if (WindowNeedsRank(wexpr)) {
-			if (!bounds.is_same_partition || row_idx == 0) { // special case for first row, need to init
-				dense_rank = 1;
-				rank = 1;
-				rank_equal = 0;
-			} else if (!bounds.is_peer) {
-				dense_rank++;
-				rank += rank_equal;
-				rank_equal = 0;
+	vector<TypeId> result_types = {wexpr->return_type};
+	idx_t frame_begins[STANDARD_VECTOR_SIZE];
+	idx_t frame_ends[STANDARD_VECTOR_SIZE];
+	idx_t gather_indexes[STANDARD_VECTOR_SIZE];
+	idx_t default_indexes[STANDARD_VECTOR_SIZE];
+
+	// this is the main loop, go through all sorted rows and compute window function result one vector at a time
+	for (idx_t chunk_start = 0; chunk_start < input_size; chunk_start += STANDARD_VECTOR_SIZE) {
+		idx_t chunk_count = std::min((idx_t)STANDARD_VECTOR_SIZE, input_size - chunk_start);
+		DataChunk chunk;
+		chunk.Initialize(result_types);
+		auto &result_vector = chunk.data[0];
+		auto &result_mask = FlatVector::Nullmask(result_vector);
+
+		for (idx_t i = 0; i < chunk_count; i++) {
+			auto row_idx = chunk_start + i;
+			UpdateWindowBoundaries(wexpr, inputs, input_size, row_idx, partition_boundaries.get(),
+			                       peer_boundaries.get(), bounds);
+
+			// if no values are read for window, result is NULL
+			bool empty_frame = bounds.window_start >= bounds.window_end;
+			frame_begins[i] = bounds.window_start;
+			frame_ends[i] = empty_frame ? bounds.window_start : bounds.window_end;
+			gather_indexes[i] = INVALID_INDEX;
+			default_indexes[i] = INVALID_INDEX;
+			if (empty_frame) {
+				result_mask[i] = true;
+				continue;
 			}
-			rank_equal++;
-		}
-
-		auto res = Value();
 
-		// if no values are read for window, result is NULL
-		if (bounds.window_start >= bounds.window_end) {
-			output.SetValue(output_idx, row_idx, res);
-			continue;
+			switch (wexpr->type) {
+			case ExpressionType::WINDOW_AGGREGATE:
+				// computed for the entire vector after the loop
+				break;
+			case ExpressionType::WINDOW_ROW_NUMBER:
+				FlatVector::GetData<int64_t>(result_vector)[i] = row_idx - bounds.partition_start + 1;
+				break;
+			case ExpressionType::WINDOW_RANK_DENSE:
+				FlatVector::GetData<int64_t>(result_vector)[i] = bounds.dense_rank;
+				break;
+			case ExpressionType::WINDOW_RANK:
+				FlatVector::GetData<int64_t>(result_vector)[i] = bounds.rank;
+				break;
+			case ExpressionType::WINDOW_PERCENT_RANK: {
+				int64_t denom = (int64_t)bounds.partition_end - bounds.partition_start - 1;
+				double percent_rank = denom > 0 ? ((double)bounds.rank - 1) / denom : 0;
+				FlatVector::GetData<double>(result_vector)[i] = percent_rank;
+				break;
+			}
+			case ExpressionType::WINDOW_CUME_DIST: {
+				int64_t denom = (int64_t)bounds.partition_end - bounds.partition_start;
+				double cume_dist = denom > 0 ? ((double)(bounds.peer_end - bounds.partition_start)) / denom : 0;
+				FlatVector::GetData<double>(result_vector)[i] = cume_dist;
+				break;
+			}
+			case ExpressionType::WINDOW_NTILE:
+				FlatVector::GetData<int64_t>(result_vector)[i] = ComputeNtile(inputs, bounds, row_idx);
+				break;
+			case ExpressionType::WINDOW_LEAD:
+			case ExpressionType::WINDOW_LAG: {
+				int64_t offset = 1;
+				if (wexpr->offset_expr) {
+					offset =
+					    GetIntegerCell(inputs.leadlag_offset_collection, wexpr->offset_expr->IsScalar(), row_idx);
+				}
+				int64_t source_idx =
+				    wexpr->type == ExpressionType::WINDOW_LEAD ? row_idx + offset : (int64_t)row_idx - offset;
+				if (source_idx >= (int64_t)bounds.partition_start && source_idx < (int64_t)bounds.partition_end) {
+					gather_indexes[i] = source_idx;
+				} else if (wexpr->default_expr) {
+					default_indexes[i] = wexpr->default_expr->IsScalar() ? 0 : row_idx;
+				} else {
+					result_mask[i] = true;
+				}
+				break;
+			}
+			case ExpressionType::WINDOW_FIRST_VALUE:
+				gather_indexes[i] = bounds.window_start;
+				break;
+			case ExpressionType::WINDOW_LAST_VALUE:
+				gather_indexes[i] = bounds.window_end - 1;
+				break;
+			default:
+				throw NotImplementedException("Window aggregate type %s",
+				                              ExpressionTypeToString(wexpr->type).c_str());
+			}
 		}
 
 		switch (wexpr->type) {
-		case ExpressionType::WINDOW_AGGREGATE: {
-			res = segment_tree->Compute(bounds.window_start, bounds.window_end);
+		case ExpressionType::WINDOW_AGGREGATE:
+			segment_tree->Compute(result_vector, frame_begins, frame_ends, chunk_count);
 			break;
-		}
-		case ExpressionType::WINDOW_ROW_NUMBER: {
-			res = Value::Numeric(wexpr->return_type, row_idx - bounds.partition_start + 1);
+		case ExpressionType::WINDOW_LEAD:
+		case ExpressionType::WINDOW_LAG:
+			if (wexpr->default_expr) {
+				auto &default_collection = inputs.leadlag_default_collection;
+				if (default_collection.types[0] == wexpr->return_type) {
+					GatherColumn(default_collection, 0, default_indexes, chunk_count, result_vector);
+				} else {
+					// the default value has to be cast to the type of the result
+					for (idx_t i = 0; i < chunk_count; i++) {
+						if (default_indexes[i] != INVALID_INDEX) {
+							result_vector.SetValue(i, default_collection.GetValue(0, default_indexes[i]));
+						}
+					}
+				}
+			}
+			GatherColumn(inputs.payload_collection, 0, gather_indexes, chunk_count, result_vector);
 			break;
-		}
-		case ExpressionType::WINDOW_RANK_DENSE: {
-			res = Value::Numeric(wexpr->return_type, dense_rank);
+		case ExpressionType::WINDOW_FIRST_VALUE:
+		case ExpressionType::WINDOW_LAST_VALUE:
+			GatherColumn(inputs.payload_collection, 0, gather_indexes, chunk_count, result_vector);
 			break;
-		}
-		case ExpressionType::WINDOW_RANK: {
-			res = Value::Numeric(wexpr->return_type, rank);
+		default:
 			break;
 		}
-		case ExpressionType::WINDOW_PERCENT_RANK: {
-			int64_t denom = (int64_t)bounds.partition_end - bounds.partition_start - 1;
-			double percent_rank = denom > 0 ? ((double)rank - 1) / denom : 0;
-			res = Value(percent_rank);
-			break;
+		chunk.SetCardinality(chunk_count);
+		chunk.Verify();
+		result.Append(chunk);
+	}
+}
+
+//===--------------------------------------------------------------------===//
+// Partitioning
+//===--------------------------------------------------------------------===//
+//! The minimum amount of rows per thread to compute a window in parallel
+static constexpr idx_t WINDOW_PARALLEL_THRESHOLD = 10000;
+
+//! A set of partitions of a window expression, rows with the same PARTITION BY values always end up in the same
+//! bucket. The buckets are sorted and computed independently of each other.
+struct WindowPartitionBucket {
+	//! The rows of the input in this bucket, in the order of the results after computing
+	vector<idx_t> rows;
+	//! The results of the window expression for the rows
+	ChunkCollection results;
+	//! The error that occurred while computing the bucket (if any)
+	string error;
+};
+
+static void SortWindowRows(BoundWindowExpression *wexpr, ChunkCollection &sort_collection, vector<idx_t> &rows) {
+	vector<OrderType> orders;
+	vector<OrderByNullType> null_order_types;
+	// we sort by both 1) partition by expression list and 2) order by expressions
+	for (idx_t prt_idx = 0; prt_idx < wexpr->partitions.size(); prt_idx++) {
+		orders.push_back(OrderType::ASCENDING);
+		null_order_types.push_back(OrderByNullType::NULLS_FIRST);
+	}
+	for (idx_t ord_idx = 0; ord_idx < wexpr->orders.size(); ord_idx++) {
+		orders.push_back(wexpr->orders[ord_idx].type);
+		null_order_types.push_back(wexpr->orders[ord_idx].null_order);
+	}
+	assert(sort_collection.count == rows.size());
+	auto sorted_vector = unique_ptr<idx_t[]>(new idx_t[rows.size()]);
+	sort_collection.Sort(orders, null_order_types, sorted_vector.get());
+
+	vector<idx_t> sorted_rows(rows.size());
+	for (idx_t i = 0; i < rows.size(); i++) {
+		sorted_rows[i] = rows[sorted_vector[i]];
+	}
+	rows = move(sorted_rows);
+}
+
+static void ComputeWindowBucket(BoundWindowExpression *wexpr, WindowInputs &inputs, WindowPartitionBucket &bucket,
+                                bool single_bucket) {
+	if (bucket.rows.size() == 0) {
+		return;
+	}
+	bool needs_sorting = wexpr->partitions.size() + wexpr->orders.size() > 0;
+	if (!needs_sorting) {
+		// OVER (): the rows are computed in their original order
+		ComputeWindowResults(wexpr, inputs, bucket.rows.size(), bucket.results);
+		return;
+	}
+	if (single_bucket) {
+		SortWindowRows(wexpr, inputs.sort_collection, bucket.rows);
+	} else {
+		ChunkCollection bucket_sort_collection;
+		GatherCollection(inputs.sort_collection, bucket.rows.data(), bucket.rows.size(), bucket_sort_collection);
+		SortWindowRows(wexpr, bucket_sort_collection, bucket.rows);
+	}
+	WindowInputs sorted_inputs;
+	sorted_inputs.Gather(wexpr, inputs, bucket.rows.data(), bucket.rows.size());
+	ComputeWindowResults(wexpr, sorted_inputs, bucket.rows.size(), bucket.results);
+}
+
+//! Keeps track of the bucket tasks that have not finished yet
+struct WindowPendingTasks {
+	WindowPendingTasks(idx_t count) : count(count) {
+	}
+
+	//! Lock protecting count
+	mutex lock;
+	//! Signaled when the last task has finished
+	std::condition_variable tasks_finished;
+	//! The amount of tasks that have not finished yet
+	idx_t count;
+
+	void FinishTask() {
+		lock_guard<mutex> guard(lock);
+		if (--count == 0) {
+			tasks_finished.notify_all();
 		}
-		case ExpressionType::WINDOW_CUME_DIST: {
-			int64_t denom = (int64_t)bounds.partition_end - bounds.partition_start;
-			double cume_dist = denom > 0 ? ((double)(bounds.peer_end - bounds.partition_start)) / denom : 0;
-			res = Value(cume_dist);
-			break;
+	}
+
+	//! Block until all tasks have finished
+	void WaitForTasks() {
+		unique_lock<mutex> guard(lock);
+		tasks_finished.wait(guard, [&]() { return count == 0; });
+	}
+};
+
+class WindowBucketTask : public Task {
+public:
+	WindowBucketTask(BoundWindowExpression *wexpr, WindowInputs &inputs, WindowPartitionBucket &bucket,
+	                 WindowPendingTasks &pending_tasks)
+	    : wexpr(wexpr), inputs(inputs), bucket(bucket), pending_tasks(pending_tasks) {
+	}
+
+	BoundWindowExpression *wexpr;
+	WindowInputs &inputs;
+	WindowPartitionBucket &bucket;
+	WindowPendingTasks &pending_tasks;
+
+public:
+	void Execute() override {
+		try {
+			ComputeWindowBucket(wexpr, inputs, bucket, false);
+		} catch (std::exception &ex) {
+			bucket.error = ex.what();
+		} catch (...) {
+			bucket.error = "Unknown exception while computing window";
 		}
-		case ExpressionType::WINDOW_NTILE: {
-			if (payload_collection.column_count() != 1) {
-				throw Exception("NTILE needs a parameter");
-			}
-			auto n_param = payload_collection.GetValue(0, row_idx).GetValue<int64_t>();
-			// With thanks from SQLite's ntileValueFunc()
-			int64_t n_total = bounds.partition_end - bounds.partition_start;
-			if (n_param > n_total) {
-				// more groups allowed than we have values
-				// map every entry to a unique group
-				n_param = n_total;
-			}
-			int64_t n_size = (n_total / n_param);
-			// find the row idx within the group
-			assert(row_idx >= bounds.partition_start);
-			int64_t adjusted_row_idx = row_idx - bounds.partition_start;
-			// now compute the ntile
-			int64_t n_large = n_total - n_param * n_size;
-			int64_t i_small = n_large * (n_size + 1);
-			int64_t result_ntile;
-
-			assert((n_large * (n_size + 1) + (n_param - n_large) * n_size) == n_total);
-
-			if (adjusted_row_idx < i_small) {
-				result_ntile = 1 + adjusted_row_idx / (n_size + 1);
-			} else {
-				result_ntile = 1 + n_large + (adjusted_row_idx - i_small) / n_size;
-			}
-			// result has to be between [1, NTILE]
-			assert(result_ntile >= 1 && result_ntile <= n_param);
-			res = Value::Numeric(wexpr->return_type, result_ntile);
-			break;
+		pending_tasks.FinishTask();
+	}
+};
+
+//! Hash partitions the rows by their PARTITION BY values into the buckets
+static void PartitionWindowRows(BoundWindowExpression *wexpr, ChunkCollection &sort_collection,
+                                vector<unique_ptr<WindowPartitionBucket>> &buckets) {
+	Vector hashes(TypeId::HASH);
+	idx_t row_idx = 0;
+	for (auto &chunk : sort_collection.chunks) {
+		VectorOperations::Hash(chunk->data[0], hashes, chunk->size());
+		for (idx_t prt_idx = 1; prt_idx < wexpr->partitions.size(); prt_idx++) {
+			VectorOperations::CombineHash(hashes, chunk->data[prt_idx], chunk->size());
 		}
-		case ExpressionType::WINDOW_LEAD:
-		case ExpressionType::WINDOW_LAG: {
-			Value def_val = Value(wexpr->return_type);
-			idx_t offset = 1;
-			if (wexpr->offset_expr) {
-				offset = leadlag_offset_collection.GetValue(0, wexpr->offset_expr->IsScalar() ? 0 : row_idx)
-				             .GetValue<int64_t>();
-			}
-			if (wexpr->default_expr) {
-				def_val = leadlag_default_collection.GetValue(0, wexpr->default_expr->IsScalar() ? 0 : row_idx);
-			}
-			if (wexpr->type == ExpressionType::WINDOW_LEAD) {
-				auto lead_idx = row_idx + offset;
-				if (lead_idx < bounds.partition_end) {
-					res = payload_collection.GetValue(0, lead_idx);
-				} else {
-					res = def_val;
-				}
-			} else {
-				int64_t lag_idx = (int64_t)row_idx - offset;
-				if (lag_idx >= 0 && (idx_t)lag_idx >= bounds.partition_start) {
-					res = payload_collection.GetValue(0, lag_idx);
-				} else {
-					res = def_val;
-				}
-			}
+		hashes.Normalify(chunk->size());
+		auto hash_data = FlatVector::GetData<hash_t>(hashes);
+		for (idx_t i = 0; i < chunk->size(); i++, row_idx++) {
+			buckets[hash_data[i] % buckets.size()]->rows.push_back(row_idx);
+		}
+	}
+}
 
-			break;
+//! Computes a window expression over the input. The input and the results of the previous window expressions are
+//! reordered into the order in which the results of this expression are computed.
+static void ComputeWindowExpression(ClientContext &context, BoundWindowExpression *wexpr, ChunkCollection &input,
+                                    vector<unique_ptr<ChunkCollection>> &window_results) {
+	WindowInputs inputs;
+	inputs.Materialize(wexpr, input);
+	// we sort by both 1) partition by expression list and 2) order by expressions
+	vector<Expression *> sort_exprs;
+	for (auto &pexpr : wexpr->partitions) {
+		sort_exprs.push_back(pexpr.get());
+	}
+	for (auto &order : wexpr->orders) {
+		sort_exprs.push_back(order.expression.get());
+	}
+	MaterializeExpressions(sort_exprs.data(), sort_exprs.size(), input, inputs.sort_collection);
+
+	// with multiple threads the partitions are distributed over buckets that are computed in parallel
+	auto &scheduler = TaskScheduler::GetScheduler(context);
+	idx_t thread_count = scheduler.NumberOfThreads();
+	idx_t bucket_count = 1;
+	if (wexpr->partitions.size() > 0 && thread_count > 1 &&
+	    (context.force_parallelism || input.count >= thread_count * WINDOW_PARALLEL_THRESHOLD)) {
+		bucket_count = thread_count;
+	}
+	vector<unique_ptr<WindowPartitionBucket>> buckets;
+	for (idx_t i = 0; i < bucket_count; i++) {
+		buckets.push_back(make_unique<WindowPartitionBucket>());
+	}
+	if (bucket_count == 1) {
+		auto &rows = buckets[0]->rows;
+		rows.resize(input.count);
+		for (idx_t i = 0; i < input.count; i++) {
+			rows[i] = i;
 		}
-		case ExpressionType::WINDOW_FIRST_VALUE: {
-			res = payload_collection.GetValue(0, bounds.window_start);
-			break;
+		ComputeWindowBucket(wexpr, inputs, *buckets[0], true);
+	} else {
+		PartitionWindowRows(wexpr, inputs.sort_collection, buckets);
+		auto producer = scheduler.CreateProducer();
+		WindowPendingTasks pending_tasks(bucket_count);
+		for (auto &bucket : buckets) {
+			scheduler.ScheduleTask(*producer, make_unique<WindowBucketTask>(wexpr, inputs, *bucket, pending_tasks));
 		}
-		case ExpressionType::WINDOW_LAST_VALUE: {
-			res = payload_collection.GetValue(0, bounds.window_end - 1);
-			break;
+		// help computing the buckets until none of them are left to be claimed
+		unique_ptr<Task> task;
+		while (scheduler.GetTaskFromProducer(*producer, task)) {
+			task->Execute();
+			task.reset();
 		}
-		default:
-			throw NotImplementedException("Window aggregate type %s", ExpressionTypeToString(wexpr->type).c_str());
+		// wait for the other threads that are still computing buckets
+		pending_tasks.WaitForTasks();
+		for (auto &bucket : buckets) {
+			if (!bucket->error.empty()) {
+				throw Exception(bucket->error);
+			}
 		}
+	}
 
-		output.SetValue(output_idx, row_idx, res);
+	// the results are in the order of the buckets
+	auto result = make_unique<ChunkCollection>();
+	vector<idx_t> order;
+	order.reserve(input.count);
+	for (auto &bucket : buckets) {
+		order.insert(order.end(), bucket->rows.begin(), bucket->rows.end());
+		result->Append(bucket->results);
+	}
+	bool is_identity = true;
+	for (idx_t i = 0; i < order.size() && is_identity; i++) {
+		is_identity = order[i] == i;
+	}
+	if (!is_identity) {
+		// reorder the input and the previous results
+		ChunkCollection reordered_input;
+		GatherCollection(input, order.data(), order.size(), reordered_input);
+		input.chunks = move(reordered_input.chunks);
+		for (auto &previous_result : window_results) {
+			auto reordered_result = make_unique<ChunkCollection>();
+			GatherCollection(*previous_result, order.data(), order.size(), *reordered_result);
+			previous_result = move(reordered_result);
+		}
 	}
+	window_results.push_back(move(result));
 }
 
 void PhysicalWindow::GetChunkInternal(ExecutionContext &context, DataChunk &chunk, PhysicalOperatorState *state_) {
 	auto state = reinterpret_cast<PhysicalWindowOperatorState *>(state_);
 	ChunkCollection &big_data = state->tuples;
-	ChunkCollection &window_results = state->window_results;
+	auto &window_results = state->window_results;
 
 	// this is a blocking operator, so compute complete result on first invocation
 	if (state->position == 0) {
@@ -483,32 +874,12 @@ void PhysicalWindow::GetChunkInternal(ExecutionContext &context, DataChunk &chun
 			return;
 		}
 
-		vector<TypeId> window_types;
-		for (idx_t expr_idx = 0; expr_idx < select_list.size(); expr_idx++) {
-			window_types.push_back(select_list[expr_idx]->return_type);
-		}
-
-		for (idx_t i = 0; i < big_data.chunks.size(); i++) {
-			DataChunk window_chunk;
-			window_chunk.Initialize(window_types);
-			window_chunk.SetCardinality(big_data.chunks[i]->size());
-			for (idx_t col_idx = 0; col_idx < window_chunk.column_count(); col_idx++) {
-				window_chunk.data[col_idx].vector_type = VectorType::CONSTANT_VECTOR;
-				ConstantVector::SetNull(window_chunk.data[col_idx], true);
-			}
-
-			window_chunk.Verify();
-			window_results.Append(window_chunk);
-		}
-
-		assert(window_results.column_count() == select_list.size());
-		idx_t window_output_idx = 0;
 		// we can have multiple window functions
 		for (idx_t expr_idx = 0; expr_idx < select_list.size(); expr_idx++) {
 			assert(select_list[expr_idx]->GetExpressionClass() == ExpressionClass::BOUND_WINDOW);
 			// sort by partition and order clause in window def
 			auto wexpr = reinterpret_cast<BoundWindowExpression *>(select_list[expr_idx].get());
-			ComputeWindowExpression(wexpr, big_data, window_results, window_output_idx++);
+			ComputeWindowExpression(context.client, wexpr, big_data, window_results);
 		}
 	}
 
@@ -518,16 +889,16 @@ void PhysicalWindow::GetChunkInternal(ExecutionContext &context, DataChunk &chun
 
 	// just return what was computed before, appending the result cols of the window expressions at the end
 	auto &proj_ch = big_data.GetChunk(state->position);
-	auto &wind_ch = window_results.GetChunk(state->position);
 
 	idx_t out_idx = 0;
-	assert(proj_ch.size() == wind_ch.size());
 	chunk.SetCardinality(proj_ch);
 	for (idx_t col_idx = 0; col_idx < proj_ch.column_count(); col_idx++) {
 		chunk.data[out_idx++].Reference(proj_ch.data[col_idx]);
 	}
-	for (idx_t col_idx = 0; col_idx < wind_ch.column_count(); col_idx++) {
-		chunk.data[out_idx++].Reference(wind_ch.data[col_idx]);
+	for (auto &window_result : window_results) {
+		auto &wind_ch = window_result->GetChunk(state->position);
+		assert(proj_ch.size() == wind_ch.size());
+		chunk.data[out_idx++].Reference(wind_ch.data[0]);
 	}
 	state->position += STANDARD_VECTOR_SIZE;
 }
@@ -7,6 +7,7 @@
 #include "duckdb/planner/expression_binder.hpp"
 #include "duckdb/storage/buffer_manager.hpp"
 #include "duckdb/storage/storage_manager.hpp"
+#include "duckdb/transaction/transaction_manager.hpp"
 
 #include <cctype>
 
@@ -115,6 +116,16 @@ void PhysicalPragma::GetChunkInternal(ExecutionContext &context, DataChunk &chun
 		}
 		auto nr_threads = pragma.parameters[0].GetValue<int64_t>();
 		TaskScheduler::GetScheduler(client).SetThreads(nr_threads);
+	} else if (keyword == "enable_thread_pinning") {
+		if (pragma.pragma_type != PragmaType::NOTHING) {
+			throw ParserException("Enable thread pinning must be a statement (PRAGMA enable_thread_pinning)");
+		}
+		TaskScheduler::GetScheduler(client).SetThreadPinning(true);
+	} else if (keyword == "disable_thread_pinning") {
+		if (pragma.pragma_type != PragmaType::NOTHING) {
+			throw ParserException("Disable thread pinning must be a statement (PRAGMA disable_thread_pinning)");
+		}
+		TaskScheduler::GetScheduler(client).SetThreadPinning(false);
 	} else if (keyword == "enable_verification") {
 		if (pragma.pragma_type != PragmaType::NOTHING) {
 			throw ParserException("Enable verification must be a statement (PRAGMA enable_verification)");
@@ -146,6 +157,11 @@ void PhysicalPragma::GetChunkInternal(ExecutionContext &context, DataChunk &chun
 		} else {
 			context.client.log_query_writer = make_unique<BufferedFileWriter>(FileSystem::GetFileSystem(context.client), str_val);
 		}
+	} else if (keyword == "checkpoint") {
+		if (pragma.pragma_type != PragmaType::NOTHING) {
+			throw ParserException("Checkpoint must be a statement (CHECKPOINT or PRAGMA checkpoint)");
+		}
+		client.db.transaction_manager->Checkpoint(client);
 	} else {
 		throw ParserException("Unrecognized PRAGMA keyword: %s", keyword.c_str());
 	}
@@ -1,11 +1,25 @@
 #include "duckdb/execution/operator/helper/physical_vacuum.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/transaction/transaction_manager.hpp"
 
 using namespace std;
 
 namespace duckdb {
 
 void PhysicalVacuum::GetChunkInternal(ExecutionContext &context, DataChunk &chunk, PhysicalOperatorState *state) {
-	// NOP
+	auto &client = context.client;
+	if (info->vacuum) {
+		// remove the deleted rows from the table (or all tables) with a checkpoint that leaves them out
+		TableCatalogEntry *table = nullptr;
+		if (!info->table.empty()) {
+			table = Catalog::GetCatalog(client).GetEntry<TableCatalogEntry>(client, info->schema, info->table);
+		}
+		client.db.transaction_manager->Checkpoint(client, true, table);
+	}
+	// ANALYZE is a NOP
 	state->finished = true;
 }
 
@@ -1,5 +1,6 @@
 #include "duckdb/execution/operator/join/physical_blockwise_nl_join.hpp"
 
+#include "duckdb/common/mutex.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/execution/expression_executor.hpp"
 #include "duckdb/execution/operator/join/physical_comparison_join.hpp"
@@ -34,6 +35,8 @@ public:
 	BlockwiseNLJoinGlobalState() : right_outer_position(0) {
 	}
 
+	//! Lock for appending to the materialized RHS from multiple threads
+	mutex lock;
 	ChunkCollection right_chunks;
 	//! Whether or not a tuple on the RHS has found a match, only used for FULL OUTER joins
 	unique_ptr<bool[]> rhs_found_match;
@@ -52,6 +55,7 @@ unique_ptr<LocalSinkState> PhysicalBlockwiseNLJoin::GetLocalSinkState(ExecutionC
 void PhysicalBlockwiseNLJoin::Sink(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate,
                                    DataChunk &input) {
 	auto &gstate = (BlockwiseNLJoinGlobalState &)state;
+	lock_guard<mutex> glock(gstate.lock);
 	gstate.right_chunks.Append(input);
 }
 
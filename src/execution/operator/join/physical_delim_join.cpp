@@ -52,6 +52,10 @@ void PhysicalDelimJoin::Sink(ExecutionContext &context, GlobalOperatorState &sta
 	distinct->Sink(context, state, lstate, input);
 }
 
+void PhysicalDelimJoin::Combine(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate) {
+	distinct->Combine(context, state, lstate);
+}
+
 void PhysicalDelimJoin::Finalize(ClientContext &client, unique_ptr<GlobalOperatorState> state) {
 	// finalize the distinct HT
 	distinct->Finalize(client, move(state));
@@ -1,10 +1,17 @@
 #include "duckdb/execution/operator/join/physical_hash_join.hpp"
 
 #include "duckdb/storage/storage_manager.hpp"
+#include "duckdb/common/mutex.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/execution/spillable_chunk_collection.hpp"
 #include "duckdb/storage/buffer_manager.hpp"
 #include "duckdb/function/aggregate/distributive_functions.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+
+#include <atomic>
+#include <condition_variable>
 
 using namespace std;
 
@@ -42,15 +49,21 @@ public:
 	DataChunk build_chunk;
 	DataChunk join_keys;
 	ExpressionExecutor build_executor;
+	//! The thread-local HT that is merged into the global HT in Combine
+	unique_ptr<JoinHashTable> hash_table;
 };
 
 class HashJoinGlobalState : public GlobalOperatorState {
 public:
-	HashJoinGlobalState() {
+	HashJoinGlobalState() : radix_bits(0) {
 	}
 
 	//! The HT used by the join
 	unique_ptr<JoinHashTable> hash_table;
+	//! Only used for out-of-core joins: the partitions of the HT, which are processed one at a time
+	vector<unique_ptr<JoinHashTable>> partitions;
+	//! The amount of radix bits used to partition the HT
+	idx_t radix_bits;
 	//! Only used for FULL OUTER JOIN: scan state of the final scan to find unmatched tuples in the build-side
 	JoinHTScanState ht_scan_state;
 };
@@ -101,6 +114,13 @@ unique_ptr<LocalSinkState> PhysicalHashJoin::GetLocalSinkState(ExecutionContext
 		state->build_executor.AddExpression(*cond.right);
 	}
 	state->join_keys.Initialize(condition_types);
+	// the correlated MARK join aggregates the correlated counts in the global HT
+	bool correlated_mark_join =
+	    join_type == JoinType::MARK && delim_types.size() > 0 && delim_types.size() + 1 == conditions.size();
+	if (!correlated_mark_join) {
+		state->hash_table = make_unique<JoinHashTable>(BufferManager::GetBufferManager(context.client), conditions,
+		                                               build_types, join_type);
+	}
 	return move(state);
 }
 
@@ -111,6 +131,7 @@ void PhysicalHashJoin::Sink(ExecutionContext &context, GlobalOperatorState &stat
 	// resolve the join keys for the right chunk
 	lstate.build_executor.Execute(input, lstate.join_keys);
 	// build the HT
+	auto &hash_table = lstate.hash_table ? *lstate.hash_table : *sink.hash_table;
 	if (right_projection_map.size() > 0) {
 		// there is a projection map: fill the build chunk with the projected columns
 		lstate.build_chunk.Reset();
@@ -118,38 +139,240 @@ void PhysicalHashJoin::Sink(ExecutionContext &context, GlobalOperatorState &stat
 		for (idx_t i = 0; i < right_projection_map.size(); i++) {
 			lstate.build_chunk.data[i].Reference(input.data[right_projection_map[i]]);
 		}
-		sink.hash_table->Build(lstate.join_keys, lstate.build_chunk);
+		hash_table.Build(lstate.join_keys, lstate.build_chunk);
 	} else {
 		// there is not a projected map: place the entire right chunk in the HT
-		sink.hash_table->Build(lstate.join_keys, input);
+		hash_table.Build(lstate.join_keys, input);
+	}
+}
+
+void PhysicalHashJoin::Combine(ExecutionContext &context, GlobalOperatorState &gstate, LocalSinkState &lstate_) {
+	auto &sink = (HashJoinGlobalState &)gstate;
+	auto &lstate = (HashJoinLocalState &)lstate_;
+	if (lstate.hash_table) {
+		sink.hash_table->Merge(*lstate.hash_table);
 	}
 }
 
 //===--------------------------------------------------------------------===//
 // Finalize
 //===--------------------------------------------------------------------===//
+class HashJoinFinalizeState {
+public:
+	HashJoinFinalizeState(JoinHashTable &hash_table, Executor &executor)
+	    : hash_table(hash_table), executor(executor), block_count(hash_table.BlockCount()), next_block(0),
+	      finished_blocks(0) {
+	}
+
+	JoinHashTable &hash_table;
+	Executor &executor;
+	idx_t block_count;
+	//! The next block to insert into the pointer table
+	std::atomic<idx_t> next_block;
+	//! Lock protecting finished_blocks
+	mutex lock;
+	//! Signaled when the last block has been inserted
+	std::condition_variable blocks_finished;
+	//! The amount of blocks that have been inserted
+	idx_t finished_blocks;
+
+public:
+	//! Insert blocks into the pointer table until no blocks are left
+	void InsertBlocks() {
+		while (true) {
+			idx_t block_idx = next_block++;
+			if (block_idx >= block_count) {
+				// note that the HT might already be destroyed here: do not touch it
+				return;
+			}
+			try {
+				hash_table.InsertBlock(block_idx, true);
+			} catch (std::exception &ex) {
+				executor.PushError(ex.what());
+			} catch (...) {
+				executor.PushError("Unknown exception in hash join finalize!");
+			}
+			lock_guard<mutex> guard(lock);
+			if (++finished_blocks == block_count) {
+				blocks_finished.notify_all();
+			}
+		}
+	}
+
+	//! Block until all blocks have been inserted into the pointer table
+	void WaitForBlocks() {
+		unique_lock<mutex> guard(lock);
+		blocks_finished.wait(guard, [&]() { return finished_blocks == block_count; });
+	}
+};
+
+class HashJoinFinalizeTask : public Task {
+public:
+	HashJoinFinalizeTask(shared_ptr<HashJoinFinalizeState> state) : state(move(state)) {
+	}
+
+	shared_ptr<HashJoinFinalizeState> state;
+
+public:
+	void Execute() override {
+		state->InsertBlocks();
+	}
+};
+
+//! The maximum amount of radix bits used to partition the HT of an out-of-core join
+static constexpr idx_t MAX_RADIX_BITS = 8;
+
+//! Splits up a HT that does not fit in memory into partitions, such that every partition fits in the given amount of
+//! memory. The first partition is probed while the probe side is streamed, the probe rows of the other partitions are
+//! spilled and processed afterwards, one partition at a time.
+static void PartitionHashTable(ClientContext &context, PhysicalHashJoin &op, HashJoinGlobalState &sink,
+                               idx_t partition_memory) {
+	auto &hash_table = *sink.hash_table;
+	idx_t required_memory = hash_table.RequiredMemory();
+	sink.radix_bits = 1;
+	while (sink.radix_bits < MAX_RADIX_BITS && (required_memory >> sink.radix_bits) > partition_memory) {
+		sink.radix_bits++;
+	}
+	for (idx_t i = 0; i < ((idx_t)1 << sink.radix_bits); i++) {
+		sink.partitions.push_back(make_unique<JoinHashTable>(BufferManager::GetBufferManager(context), op.conditions,
+		                                                     op.build_types, op.join_type));
+	}
+	hash_table.Partition(sink.partitions, sink.radix_bits);
+	sink.partitions[0]->Finalize();
+}
+
 void PhysicalHashJoin::Finalize(ClientContext &context, unique_ptr<GlobalOperatorState> state) {
 	auto &sink = (HashJoinGlobalState &)*state;
-	sink.hash_table->Finalize();
+	auto &hash_table = *sink.hash_table;
+	idx_t num_threads = TaskScheduler::GetScheduler(context).NumberOfThreads();
+	idx_t max_memory = BufferManager::GetBufferManager(context).GetMaxMemory();
+	bool correlated_mark_join = hash_table.correlated_mark_join_info.correlated_types.size() > 0;
+	if (!correlated_mark_join && hash_table.RequiredMemory() > max_memory / 2) {
+		// the HT does not comfortably fit in memory: switch to an out-of-core join
+		PartitionHashTable(context, *this, sink, max_memory / 4);
+	} else if (num_threads <= 1 || hash_table.BlockCount() <= 1) {
+		hash_table.Finalize();
+	} else {
+		// insert the blocks into the pointer table in parallel
+		// we schedule helper tasks, and insert blocks in this thread as well until all blocks are claimed
+		hash_table.InitializePointerTable();
+		auto finalize_state = make_shared<HashJoinFinalizeState>(hash_table, context.executor);
+		idx_t helper_count = std::min<idx_t>(num_threads, hash_table.BlockCount()) - 1;
+		for (idx_t i = 0; i < helper_count; i++) {
+			context.executor.ScheduleTask(make_unique<HashJoinFinalizeTask>(finalize_state));
+		}
+		finalize_state->InsertBlocks();
+		// all blocks have been claimed: wait for the helpers that are still inserting blocks
+		finalize_state->WaitForBlocks();
+		hash_table.finalized = true;
+	}
 
 	PhysicalSink::Finalize(context, move(state));
 }
 
+bool PhysicalHashJoin::IsExternal() {
+	return sink_state && ((HashJoinGlobalState &)*sink_state).partitions.size() > 0;
+}
+
 //===--------------------------------------------------------------------===//
 // GetChunkInternal
 //===--------------------------------------------------------------------===//
 class PhysicalHashJoinState : public PhysicalOperatorState {
 public:
 	PhysicalHashJoinState(PhysicalOperator *left, PhysicalOperator *right, vector<JoinCondition> &conditions)
-	    : PhysicalOperatorState(left) {
+	    : PhysicalOperatorState(left), partition_idx(0), probe_chunk_idx(0) {
 	}
 
 	DataChunk cached_chunk;
 	DataChunk join_keys;
 	ExpressionExecutor probe_executor;
 	unique_ptr<JoinHashTable::ScanStructure> scan_structure;
+	//! Only used for out-of-core joins: the partition of the HT that is currently probed
+	idx_t partition_idx;
+	//! Only used for out-of-core joins: the spilled probe rows of every partition
+	vector<unique_ptr<SpillableChunkCollection>> probe_partitions;
+	//! Only used for out-of-core joins: the next spilled chunk of the current partition to probe
+	idx_t probe_chunk_idx;
 };
 
+//! Returns the HT that is currently being probed
+static JoinHashTable &GetProbeTable(HashJoinGlobalState &sink, PhysicalHashJoinState &state) {
+	return sink.partitions.size() > 0 ? *sink.partitions[state.partition_idx] : *sink.hash_table;
+}
+
+//! Spills the rows of the probe chunk that do not belong to the first partition of an out-of-core join. Afterwards the
+//! probe chunk and its join keys only contain the rows of the first partition.
+static void SpillProbeRows(ClientContext &context, HashJoinGlobalState &sink, PhysicalHashJoinState &state) {
+	idx_t partition_count = sink.partitions.size();
+	if (state.probe_partitions.size() == 0) {
+		auto types = state.child_chunk.GetTypes();
+		for (idx_t i = 0; i < partition_count; i++) {
+			state.probe_partitions.push_back(
+			    make_unique<SpillableChunkCollection>(BufferManager::GetBufferManager(context), types));
+		}
+	}
+	idx_t partition_indices[STANDARD_VECTOR_SIZE];
+	sink.hash_table->ComputeRadixPartitions(state.join_keys, sink.radix_bits, partition_indices);
+
+	// group the rows by partition
+	auto partition_offsets = unique_ptr<idx_t[]>(new idx_t[partition_count + 1]);
+	memset(partition_offsets.get(), 0, sizeof(idx_t) * (partition_count + 1));
+	idx_t count = state.child_chunk.size();
+	for (idx_t i = 0; i < count; i++) {
+		partition_offsets[partition_indices[i] + 1]++;
+	}
+	for (idx_t partition_idx = 0; partition_idx < partition_count; partition_idx++) {
+		partition_offsets[partition_idx + 1] += partition_offsets[partition_idx];
+	}
+	SelectionVector partition_sel(STANDARD_VECTOR_SIZE);
+	for (idx_t i = 0; i < count; i++) {
+		partition_sel.set_index(partition_offsets[partition_indices[i]]++, i);
+	}
+	// now partition_offsets[i] holds the end of partition i: append the rows of every partition to its spill
+	idx_t first_partition_count = partition_offsets[0];
+	for (idx_t partition_idx = 1; partition_idx < partition_count; partition_idx++) {
+		idx_t start = partition_offsets[partition_idx - 1];
+		idx_t partition_size = partition_offsets[partition_idx] - start;
+		if (partition_size == 0) {
+			continue;
+		}
+		SelectionVector sel(partition_sel.data() + start);
+		DataChunk spill_chunk;
+		spill_chunk.InitializeEmpty(state.probe_partitions[partition_idx]->types);
+		spill_chunk.Slice(state.child_chunk, sel, partition_size);
+		state.probe_partitions[partition_idx]->Append(spill_chunk);
+	}
+	if (first_partition_count < count) {
+		state.child_chunk.Slice(partition_sel, first_partition_count);
+		state.join_keys.Slice(partition_sel, first_partition_count);
+	}
+}
+
+//! Moves an out-of-core join on to the next partition that needs to be processed, returns false if all partitions
+//! have been processed
+static bool NextPartition(HashJoinGlobalState &sink, PhysicalHashJoinState &state, JoinType join_type) {
+	state.scan_structure = nullptr;
+	while (true) {
+		// the current partition has been processed entirely: free it
+		sink.partitions[state.partition_idx].reset();
+		state.partition_idx++;
+		if (state.partition_idx >= sink.partitions.size()) {
+			state.finished = true;
+			return false;
+		}
+		bool has_probe_rows =
+		    state.probe_partitions.size() > 0 && state.probe_partitions[state.partition_idx]->count > 0;
+		if (has_probe_rows || join_type == JoinType::OUTER) {
+			// the partition has to be probed, or the unmatched rows of the full outer join need to be scanned
+			break;
+		}
+	}
+	sink.partitions[state.partition_idx]->Finalize();
+	sink.ht_scan_state = JoinHTScanState();
+	state.probe_chunk_idx = 0;
+	return true;
+}
+
 unique_ptr<PhysicalOperatorState> PhysicalHashJoin::GetOperatorState() {
 	auto state = make_unique<PhysicalHashJoinState>(children[0].get(), children[1].get(), conditions);
 	state->cached_chunk.Initialize(types);
@@ -176,11 +399,19 @@ void PhysicalHashJoin::GetChunkInternal(ExecutionContext &context, DataChunk &ch
 				// finished probing but cached data remains, return cached chunk
 				chunk.Reference(state->cached_chunk);
 				state->cached_chunk.Reset();
-			} else
+				return;
+			}
 #endif
-			    if (join_type == JoinType::OUTER) {
+			if (join_type == JoinType::OUTER) {
 				// check if we need to scan any unmatched tuples from the RHS for the full outer join
-				sink.hash_table->ScanFullOuter(chunk, sink.ht_scan_state);
+				GetProbeTable(sink, *state).ScanFullOuter(chunk, sink.ht_scan_state);
+				if (chunk.size() > 0) {
+					return;
+				}
+			}
+			if (sink.partitions.size() > 0 && NextPartition(sink, *state, join_type)) {
+				// out-of-core join: continue with the spilled probe rows of the next partition
+				continue;
 			}
 			return;
 		} else {
@@ -223,8 +454,17 @@ void PhysicalHashJoin::ProbeHashTable(ExecutionContext &context, DataChunk &chun
 
 	// probe the HT
 	do {
-		// fetch the chunk from the left side
-		children[0]->GetChunk(context, state->child_chunk, state->child_state.get());
+		if (state->partition_idx == 0) {
+			// fetch the chunk from the left side
+			children[0]->GetChunk(context, state->child_chunk, state->child_state.get());
+		} else {
+			// out-of-core join: fetch the next spilled chunk of the current partition
+			state->child_chunk.Reset();
+			if (state->probe_partitions.size() > 0 &&
+			    state->probe_chunk_idx < state->probe_partitions[state->partition_idx]->ChunkCount()) {
+				state->probe_partitions[state->partition_idx]->LoadChunk(state->probe_chunk_idx++, state->child_chunk);
+			}
+		}
 		if (state->child_chunk.size() == 0) {
 			return;
 		}
@@ -235,8 +475,26 @@ void PhysicalHashJoin::ProbeHashTable(ExecutionContext &context, DataChunk &chun
 		// resolve the join keys for the left chunk
 		state->probe_executor.Execute(state->child_chunk, state->join_keys);
 
+		auto &hash_table = GetProbeTable(sink, *state);
+		if (sink.partitions.size() > 0) {
+			if (state->partition_idx == 0) {
+				// out-of-core join: only the rows of the first partition can be probed right now
+				SpillProbeRows(context.client, sink, *state);
+				if (state->child_chunk.size() == 0) {
+					continue;
+				}
+			}
+			if (hash_table.size() == 0) {
+				// the partition is empty: for INNER and SEMI joins the result of this chunk is empty, but that does not
+				// mean the probe side is exhausted, so we keep on fetching (and spilling) probe chunks
+				state->scan_structure = nullptr;
+				ConstructEmptyJoinResult(hash_table.join_type, hash_table.has_null, state->child_chunk, chunk);
+				continue;
+			}
+		}
+
 		// perform the actual probe
-		state->scan_structure = sink.hash_table->Probe(state->join_keys);
+		state->scan_structure = hash_table.Probe(state->join_keys);
 		state->scan_structure->Next(state->join_keys, state->child_chunk, chunk);
 	} while (chunk.size() == 0);
 }
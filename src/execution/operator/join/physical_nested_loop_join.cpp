@@ -1,6 +1,7 @@
 #include "duckdb/execution/operator/join/physical_nested_loop_join.hpp"
 
 #include "duckdb/common/operator/comparison_operators.hpp"
+#include "duckdb/common/mutex.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/execution/expression_executor.hpp"
 #include "duckdb/execution/nested_loop_join.hpp"
@@ -131,6 +132,8 @@ public:
 	NestedLoopJoinGlobalState() : has_null(false), right_outer_position(0) {
 	}
 
+	//! Lock for appending to the materialized RHS from multiple threads
+	mutex lock;
 	//! Materialized data of the RHS
 	ChunkCollection right_data;
 	//! Materialized join condition of the RHS
@@ -151,6 +154,7 @@ void PhysicalNestedLoopJoin::Sink(ExecutionContext &context, GlobalOperatorState
 	// resolve the join expression of the right side
 	nlj_state.rhs_executor.Execute(input, nlj_state.right_condition);
 
+	lock_guard<mutex> glock(gstate.lock);
 	// if we have not seen any NULL values yet, and we are performing a MARK join, check if there are NULL values in
 	// this chunk
 	if (join_type == JoinType::MARK && !gstate.has_null) {
@@ -1,5 +1,6 @@
 #include "duckdb/execution/operator/join/physical_piecewise_merge_join.hpp"
 
+#include "duckdb/common/mutex.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/execution/expression_executor.hpp"
 #include "duckdb/execution/merge_join.hpp"
@@ -50,6 +51,8 @@ public:
 	MergeJoinGlobalState() : has_null(false), right_outer_position(0) {
 	}
 
+	//! Lock for appending to the materialized RHS from multiple threads
+	mutex lock;
 	//! The materialized data of the RHS
 	ChunkCollection right_chunks;
 	//! The materialized join keys of the RHS
@@ -87,6 +90,7 @@ void PhysicalPiecewiseMergeJoin::Sink(ExecutionContext &context, GlobalOperatorS
 		mj_state.rhs_executor.ExecuteExpression(k, mj_state.join_keys.data[k]);
 	}
 	// append the join keys and the chunk to the chunk collection
+	lock_guard<mutex> glock(gstate.lock);
 	gstate.right_chunks.Append(input);
 	gstate.right_conditions.Append(mj_state.join_keys);
 }
@@ -4,7 +4,9 @@
 #include "duckdb/common/value_operations/value_operations.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/execution/expression_executor.hpp"
-#include "duckdb/storage/data_table.hpp"
+#include "duckdb/execution/external_sort.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 
 using namespace std;
 
@@ -12,10 +14,11 @@ namespace duckdb {
 
 class PhysicalOrderOperatorState : public PhysicalOperatorState {
 public:
-	PhysicalOrderOperatorState(PhysicalOperator *child) : PhysicalOperatorState(child), position(0) {
+	PhysicalOrderOperatorState(PhysicalOperator *child) : PhysicalOperatorState(child) {
 	}
 
-	idx_t position;
+	//! The merger of the sorted runs
+	unique_ptr<SortedRunMerger> merger;
 };
 
 //===--------------------------------------------------------------------===//
@@ -23,63 +26,105 @@ public:
 //===--------------------------------------------------------------------===//
 class OrderByGlobalOperatorState : public GlobalOperatorState {
 public:
-	//! The lock for updating the global aggregate state
+	OrderByGlobalOperatorState(BufferManager &buffer_manager, SortLayout layout)
+	    : buffer_manager(buffer_manager), layout(move(layout)) {
+	}
+
+	//! The lock for updating the global order by state
 	mutex lock;
-	//! The sorted data
-	ChunkCollection sorted_data;
-	//! The sorted vector
-	unique_ptr<idx_t[]> sorted_vector;
+	BufferManager &buffer_manager;
+	//! The layout of the normalized sort keys
+	SortLayout layout;
+	//! Whether or not the rows can be written to runs that can be offloaded to disk
+	bool can_spill;
+	//! The amount of rows a thread collects before sorting them into a run that can be offloaded to disk
+	idx_t run_size;
+	//! The sorted runs
+	vector<unique_ptr<SortedRun>> runs;
 };
 
-unique_ptr<GlobalOperatorState> PhysicalOrder::GetGlobalState(ClientContext &context) {
-	return make_unique<OrderByGlobalOperatorState>();
-}
-
-void PhysicalOrder::Sink(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate,
-                         DataChunk &input) {
-	// concatenate all the data of the child chunks
-	auto &gstate = (OrderByGlobalOperatorState &)state;
-	lock_guard<mutex> glock(gstate.lock);
-	gstate.sorted_data.Append(input);
-}
-
-//===--------------------------------------------------------------------===//
-// Finalize
-//===--------------------------------------------------------------------===//
-void PhysicalOrder::Finalize(ClientContext &context, unique_ptr<GlobalOperatorState> state) {
-	// finalize: perform the actual sorting
-	auto &sink = (OrderByGlobalOperatorState &)*state;
-	ChunkCollection &big_data = sink.sorted_data;
+class OrderByLocalSinkState : public LocalSinkState {
+public:
+	OrderByLocalSinkState(PhysicalOrder &op) {
+		vector<TypeId> sort_types;
+		for (auto &order : op.orders) {
+			sort_types.push_back(order.expression->return_type);
+			executor.AddExpression(*order.expression);
+		}
+		sort_chunk.Initialize(sort_types);
+		// the rows consist of the input columns followed by the sort columns
+		auto row_types = op.types;
+		row_types.insert(row_types.end(), sort_types.begin(), sort_types.end());
+		row_chunk.InitializeEmpty(row_types);
+	}
 
-	// compute the sorting columns from the input data
+	//! Executor for the sort expressions
 	ExpressionExecutor executor;
+	DataChunk sort_chunk;
+	DataChunk row_chunk;
+	//! The rows that have not been sorted into a run yet
+	ChunkCollection rows;
+};
+
+unique_ptr<GlobalOperatorState> PhysicalOrder::GetGlobalState(ClientContext &context) {
 	vector<TypeId> sort_types;
 	vector<OrderType> order_types;
 	vector<OrderByNullType> null_order_types;
-	for (idx_t i = 0; i < orders.size(); i++) {
-		auto &expr = orders[i].expression;
-		sort_types.push_back(expr->return_type);
-		order_types.push_back(orders[i].type);
-		null_order_types.push_back(orders[i].null_order);
-		executor.AddExpression(*expr);
+	for (auto &order : orders) {
+		sort_types.push_back(order.expression->return_type);
+		order_types.push_back(order.type);
+		null_order_types.push_back(order.null_order);
 	}
+	auto state = make_unique<OrderByGlobalOperatorState>(BufferManager::GetBufferManager(context),
+	                                                     SortLayout(sort_types, order_types, null_order_types));
+	state->can_spill = SortedRun::CanSpill(types);
+	// with force_parallelism we use tiny runs, so small inputs are offloaded to disk and merged as well
+	state->run_size = context.force_parallelism ? STANDARD_VECTOR_SIZE : SORTED_RUN_SIZE;
+	return move(state);
+}
 
-	ChunkCollection sort_collection;
-	for (idx_t i = 0; i < big_data.chunks.size(); i++) {
-		DataChunk sort_chunk;
-		sort_chunk.Initialize(sort_types);
+unique_ptr<LocalSinkState> PhysicalOrder::GetLocalSinkState(ExecutionContext &context) {
+	return make_unique<OrderByLocalSinkState>(*this);
+}
 
-		executor.Execute(*big_data.chunks[i], sort_chunk);
-		sort_collection.Append(sort_chunk);
+void PhysicalOrder::Sink(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate_,
+                         DataChunk &input) {
+	auto &gstate = (OrderByGlobalOperatorState &)state;
+	auto &lstate = (OrderByLocalSinkState &)lstate_;
+
+	// compute the sort columns and append the rows to the thread-local collection
+	lstate.sort_chunk.Reset();
+	lstate.executor.Execute(input, lstate.sort_chunk);
+	for (idx_t col_idx = 0; col_idx < input.column_count(); col_idx++) {
+		lstate.row_chunk.data[col_idx].Reference(input.data[col_idx]);
 	}
+	for (idx_t col_idx = 0; col_idx < lstate.sort_chunk.column_count(); col_idx++) {
+		lstate.row_chunk.data[input.column_count() + col_idx].Reference(lstate.sort_chunk.data[col_idx]);
+	}
+	lstate.row_chunk.SetCardinality(input);
+	lstate.rows.Append(lstate.row_chunk);
 
-	assert(sort_collection.count == big_data.count);
+	if (gstate.can_spill && lstate.rows.count >= gstate.run_size) {
+		// sort the collected rows into a run that can be offloaded to disk
+		auto run = make_unique<SortedRun>(gstate.buffer_manager, gstate.layout, lstate.rows, types.size(), true);
+		lstate.rows = ChunkCollection();
 
-	// now perform the actual sort
-	sink.sorted_vector = unique_ptr<idx_t[]>(new idx_t[sort_collection.count]);
-	sort_collection.Sort(order_types, null_order_types, sink.sorted_vector.get());
+		lock_guard<mutex> glock(gstate.lock);
+		gstate.runs.push_back(move(run));
+	}
+}
+
+void PhysicalOrder::Combine(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate_) {
+	auto &gstate = (OrderByGlobalOperatorState &)state;
+	auto &lstate = (OrderByLocalSinkState &)lstate_;
+	if (lstate.rows.count == 0) {
+		return;
+	}
+	// sort the remaining rows into an in-memory run
+	auto run = make_unique<SortedRun>(gstate.buffer_manager, gstate.layout, lstate.rows, types.size(), false);
 
-	PhysicalSink::Finalize(context, move(state));
+	lock_guard<mutex> glock(gstate.lock);
+	gstate.runs.push_back(move(run));
 }
 
 //===--------------------------------------------------------------------===//
@@ -88,13 +133,10 @@ void PhysicalOrder::Finalize(ClientContext &context, unique_ptr<GlobalOperatorSt
 void PhysicalOrder::GetChunkInternal(ExecutionContext &context, DataChunk &chunk, PhysicalOperatorState *state_) {
 	auto state = reinterpret_cast<PhysicalOrderOperatorState *>(state_);
 	auto &sink = (OrderByGlobalOperatorState &)*this->sink_state;
-	ChunkCollection &big_data = sink.sorted_data;
-	if (state->position >= big_data.count) {
-		return;
+	if (!state->merger) {
+		state->merger = make_unique<SortedRunMerger>(sink.layout, sink.runs);
 	}
-
-	big_data.MaterializeSortedChunk(chunk, sink.sorted_vector.get(), state->position);
-	state->position += STANDARD_VECTOR_SIZE;
+	state->merger->Scan(chunk);
 }
 
 unique_ptr<PhysicalOperatorState> PhysicalOrder::GetOperatorState() {
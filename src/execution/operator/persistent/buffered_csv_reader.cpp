@@ -5,6 +5,7 @@
 #include "duckdb/common/gzip_stream.hpp"
 #include "duckdb/common/string_util.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/execution/operator/persistent/parallel_csv_reader.hpp"
 #include "duckdb/execution/operator/persistent/physical_copy_from_file.hpp"
 #include "duckdb/main/database.hpp"
 #include "duckdb/parser/column_definition.hpp"
@@ -16,6 +17,12 @@
 #include <fstream>
 #include <queue>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace duckdb;
 using namespace std;
 
@@ -23,6 +30,47 @@ static char is_newline(char c) {
 	return c == '\n' || c == '\r';
 }
 
+//! Returns the position of the first character in buffer[position, end) that is equal to c1, c2 or c3, or end if there
+//! is no such character. The buffer is compared 32 (AVX2) or 16 (SSE2) bytes at a time if the CPU supports it.
+static idx_t FindFirstOf(const char *buffer, idx_t position, idx_t end, char c1, char c2, char c3) {
+#if defined(__AVX2__)
+	const __m256i c1_avx = _mm256_set1_epi8(c1);
+	const __m256i c2_avx = _mm256_set1_epi8(c2);
+	const __m256i c3_avx = _mm256_set1_epi8(c3);
+	for (; position + 32 <= end; position += 32) {
+		__m256i data = _mm256_loadu_si256((const __m256i *)(buffer + position));
+		__m256i matches =
+		    _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(data, c1_avx), _mm256_cmpeq_epi8(data, c2_avx)),
+		                    _mm256_cmpeq_epi8(data, c3_avx));
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(matches);
+		if (mask != 0) {
+			return position + __builtin_ctz(mask);
+		}
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128i c1_sse = _mm_set1_epi8(c1);
+	const __m128i c2_sse = _mm_set1_epi8(c2);
+	const __m128i c3_sse = _mm_set1_epi8(c3);
+	for (; position + 16 <= end; position += 16) {
+		__m128i data = _mm_loadu_si128((const __m128i *)(buffer + position));
+		__m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(data, c1_sse), _mm_cmpeq_epi8(data, c2_sse)),
+		                               _mm_cmpeq_epi8(data, c3_sse));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(matches);
+		if (mask != 0) {
+			return position + __builtin_ctz(mask);
+		}
+	}
+#endif
+	for (; position < end; position++) {
+		char c = buffer[position];
+		if (c == c1 || c == c2 || c == c3) {
+			break;
+		}
+	}
+	return position;
+}
+
 // Helper function to generate column names
 static string GenerateColumnName(const idx_t total_cols, const idx_t col_number, const string prefix = "column") {
 	uint8_t max_digits = total_cols > 10 ? (int)log10((double)total_cols - 1) + 1 : 1;
@@ -79,6 +127,9 @@ BufferedCSVReader::BufferedCSVReader(BufferedCSVReaderOptions options, vector<SQ
 	Initialize(requested_types);
 }
 
+BufferedCSVReader::~BufferedCSVReader() {
+}
+
 void BufferedCSVReader::Initialize(vector<SQLType> requested_types) {
 	if (options.auto_detect) {
 		sql_types = SniffCSV(requested_types);
@@ -142,9 +193,41 @@ void BufferedCSVReader::ResetBuffer() {
 	buffer_size = 0;
 	position = 0;
 	start = 0;
+	buffer_offset = 0;
 	cached_buffers.clear();
 }
 
+void BufferedCSVReader::SetRange(idx_t range_start, idx_t range_end, bool exact_start) {
+	ResetBuffer();
+	source->clear();
+	idx_t row_start = range_start;
+	if (!exact_start && range_start > 0) {
+		// find the first newline at or after range_start - 1: the first row starts after it
+		// note that this newline might be part of a quoted value, the caller has to verify the row start
+		source->seekg(range_start - 1, source->beg);
+		row_start = range_start - 1;
+		char c;
+		while (source->get(c)) {
+			row_start++;
+			if (c == '\n') {
+				break;
+			}
+			if (c == '\r') {
+				// \r\n is a single newline
+				if (source->peek() == '\n') {
+					source->get(c);
+					row_start++;
+				}
+				break;
+			}
+		}
+		source->clear();
+	}
+	source->seekg(row_start, source->beg);
+	buffer_offset = row_start;
+	this->range_end = range_end;
+}
+
 void BufferedCSVReader::ResetStream() {
 	if (!plain_file_source && StringUtil::EndsWith(StringUtil::Lower(options.file_path), ".gz")) {
 		// seeking to the beginning appears to not be supported in all compiler/os-scenarios,
@@ -781,6 +864,9 @@ void BufferedCSVReader::ParseSimpleCSV(DataChunk &insert_chunk) {
 	idx_t column = 0;
 	idx_t offset = 0;
 	vector<idx_t> escape_positions;
+	const char delimiter = options.delimiter[0];
+	const char quote = options.quote[0];
+	const char escape = options.escape[0];
 
 	// read values into the buffer (if any)
 	if (position >= buffer_size) {
@@ -794,7 +880,11 @@ value_start:
 	offset = 0;
 	/* state: value_start */
 	// this state parses the first character of a value
-	if (buffer[position] == options.quote[0]) {
+	if (column == 0 && buffer_offset + position >= range_end) {
+		// the next row starts after the range of the reader: stop parsing
+		goto final_state;
+	}
+	if (buffer[position] == quote) {
 		// quote: actual value starts in the next position
 		// move to in_quotes state
 		start = position + 1;
@@ -808,11 +898,13 @@ normal:
 	/* state: normal parsing state */
 	// this state parses the remainder of a non-quoted value until we reach a delimiter or newline
 	do {
-		for (; position < buffer_size; position++) {
-			if (buffer[position] == options.delimiter[0]) {
+		// skip ahead to the next delimiter or newline
+		position = FindFirstOf(buffer.get(), position, buffer_size, delimiter, '\n', '\r');
+		if (position < buffer_size) {
+			if (buffer[position] == delimiter) {
 				// delimiter: end the value and add it to the chunk
 				goto add_value;
-			} else if (is_newline(buffer[position])) {
+			} else {
 				// newline: add row
 				goto add_row;
 			}
@@ -858,11 +950,13 @@ in_quotes:
 	// this state parses the remainder of a quoted value
 	position++;
 	do {
-		for (; position < buffer_size; position++) {
-			if (buffer[position] == options.quote[0]) {
+		// skip ahead to the next quote or escape
+		position = FindFirstOf(buffer.get(), position, buffer_size, quote, escape, escape);
+		if (position < buffer_size) {
+			if (buffer[position] == quote) {
 				// quote: move to unquoted state
 				goto unquote;
-			} else if (buffer[position] == options.escape[0]) {
+			} else {
 				// escape: store the escaped position and move to handle_escape state
 				escape_positions.push_back(position - start);
 				goto handle_escape;
@@ -882,11 +976,11 @@ unquote:
 		offset = 1;
 		goto final_state;
 	}
-	if (buffer[position] == options.quote[0] && (options.escape.size() == 0 || options.escape[0] == options.quote[0])) {
+	if (buffer[position] == quote && (options.escape.size() == 0 || escape == quote)) {
 		// escaped quote, return to quoted state and store escape position
 		escape_positions.push_back(position - start);
 		goto in_quotes;
-	} else if (buffer[position] == options.delimiter[0]) {
+	} else if (buffer[position] == delimiter) {
 		// delimiter, add value
 		offset = 1;
 		goto add_value;
@@ -905,7 +999,7 @@ handle_escape:
 		throw ParserException("Error on line %s: neither QUOTE nor ESCAPE is proceeded by ESCAPE",
 							  GetLineNumberStr(linenr, linenr_estimated).c_str());
 	}
-	if (buffer[position] != options.quote[0] && buffer[position] != options.escape[0]) {
+	if (buffer[position] != quote && buffer[position] != escape) {
 		throw ParserException("Error on line %s: neither QUOTE nor ESCAPE is proceeded by ESCAPE",
 							  GetLineNumberStr(linenr, linenr_estimated).c_str());
 	}
@@ -950,6 +1044,7 @@ bool BufferedCSVReader::ReadBuffer(idx_t &start) {
 
 	// the remaining part of the last buffer
 	idx_t remaining = buffer_size - start;
+	buffer_offset += start;
 	idx_t buffer_read_size = INITIAL_BUFFER_SIZE;
 	while (remaining > buffer_read_size) {
 		buffer_read_size *= 2;
@@ -978,6 +1073,20 @@ bool BufferedCSVReader::ReadBuffer(idx_t &start) {
 	return read_count > 0;
 }
 
+void BufferedCSVReader::ParseCSV(ClientContext &context, DataChunk &insert_chunk) {
+	if (!parallel_checked) {
+		parallel_checked = true;
+		if (ParallelCSVReader::CanParallelize(context, *this)) {
+			parallel_reader = make_unique<ParallelCSVReader>(context, *this);
+		}
+	}
+	if (parallel_reader) {
+		parallel_reader->ParseCSV(insert_chunk);
+		return;
+	}
+	ParseCSV(insert_chunk);
+}
+
 void BufferedCSVReader::ParseCSV(DataChunk &insert_chunk) {
 	cached_buffers.clear();
 
@@ -1014,7 +1123,8 @@ void BufferedCSVReader::AddValue(char *str_val, idx_t length, idx_t &column, vec
 	str_val[length] = '\0';
 
 	// test against null string
-	if (!options.force_not_null[column] && strcmp(options.null_str.c_str(), str_val) == 0) {
+	if (!options.force_not_null[column] && length == options.null_str.size() &&
+	    memcmp(options.null_str.c_str(), str_val, length) == 0) {
 		FlatVector::SetNull(parse_chunk.data[column], row_entry, true);
 	} else {
 		auto &v = parse_chunk.data[column];
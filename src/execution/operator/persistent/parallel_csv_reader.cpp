@@ -0,0 +1,181 @@
+#include "duckdb/execution/operator/persistent/parallel_csv_reader.hpp"
+
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+
+#include <fstream>
+
+using namespace std;
+
+namespace duckdb {
+
+class CSVRangeTask : public Task {
+public:
+	CSVRangeTask(ParallelCSVReader &reader, CSVRange &range) : reader(reader), range(range) {
+	}
+
+	ParallelCSVReader &reader;
+	CSVRange &range;
+
+public:
+	void Execute() override {
+		reader.ParseRange(range);
+		reader.FinishRange(range);
+	}
+};
+
+bool ParallelCSVReader::CanParallelize(ClientContext &context, BufferedCSVReader &reader) {
+	auto &options = reader.options;
+	if (!reader.plain_file_source) {
+		// compressed files cannot be read starting at an arbitrary offset
+		return false;
+	}
+	if (options.quote.size() > 1 || options.escape.size() > 1 || options.delimiter.size() != 1) {
+		// the range boundaries are only handled by the simple parser
+		return false;
+	}
+	if (TaskScheduler::GetScheduler(context).NumberOfThreads() <= 1) {
+		return false;
+	}
+	auto data_start = reader.source->tellg();
+	if (data_start < 0) {
+		return false;
+	}
+	// only read the file in parallel if it consists of multiple ranges
+	idx_t range_size = context.force_parallelism ? FORCE_PARALLELISM_RANGE_SIZE : RANGE_SIZE;
+	return reader.file_size > (idx_t)data_start + range_size;
+}
+
+ParallelCSVReader::ParallelCSVReader(ClientContext &context, BufferedCSVReader &reader)
+    : scheduler(TaskScheduler::GetScheduler(context)), options(reader.options), sql_types(reader.sql_types),
+      file_size(reader.file_size), pending_tasks(0), chunk_index(0), linenr(reader.linenr) {
+	producer = scheduler.CreateProducer();
+	for (auto &type : sql_types) {
+		internal_types.push_back(GetInternalType(type));
+	}
+	// the ranges are parsed without sniffing the file again and without skipping the header
+	options.auto_detect = false;
+	options.header = false;
+	options.skip_rows = 0;
+
+	range_size = context.force_parallelism ? FORCE_PARALLELISM_RANGE_SIZE : RANGE_SIZE;
+	max_ranges = scheduler.NumberOfThreads() * RANGES_PER_THREAD;
+	next_range_start = (idx_t)reader.source->tellg();
+	expected_row_start = next_range_start;
+	ScheduleRanges();
+}
+
+ParallelCSVReader::~ParallelCSVReader() {
+	// the tasks refer to the ranges of this reader: wait until all of them have finished
+	WaitForTasks([&]() { return pending_tasks == 0; });
+}
+
+void ParallelCSVReader::ScheduleRanges() {
+	while (ranges.size() < max_ranges && next_range_start < file_size) {
+		idx_t range_end = std::min(next_range_start + range_size, file_size);
+		// the first range starts at the first row after the header, other ranges start at an unknown position
+		bool exact_start = next_range_start == expected_row_start;
+		auto range = make_unique<CSVRange>(next_range_start, range_end, exact_start);
+		{
+			lock_guard<mutex> guard(lock);
+			pending_tasks++;
+		}
+		scheduler.ScheduleTask(*producer, make_unique<CSVRangeTask>(*this, *range));
+		ranges.push_back(move(range));
+		next_range_start = range_end;
+	}
+}
+
+void ParallelCSVReader::ReadRange(CSVRange &range, idx_t linenr) {
+	auto source = make_unique<ifstream>();
+	source->open(options.file_path);
+	BufferedCSVReader reader(options, sql_types, move(source));
+	reader.SetRange(range.range_start, range.range_end, range.exact_start);
+	reader.linenr = linenr;
+	range.row_start = reader.GetPosition();
+
+	DataChunk insert_chunk;
+	insert_chunk.Initialize(internal_types);
+	while (true) {
+		insert_chunk.Reset();
+		reader.ParseCSV(insert_chunk);
+		if (insert_chunk.size() == 0) {
+			break;
+		}
+		range.chunks.Append(insert_chunk);
+	}
+	range.row_end = reader.GetPosition();
+}
+
+void ParallelCSVReader::ParseRange(CSVRange &range) {
+	try {
+		ReadRange(range, 0);
+	} catch (std::exception &ex) {
+		range.error = ex.what();
+	} catch (...) {
+		range.error = "Unknown exception while parsing CSV file";
+	}
+}
+
+void ParallelCSVReader::FinishRange(CSVRange &range) {
+	// notify while holding the lock: a waiting destructor cannot destroy the reader before we are done with it
+	lock_guard<mutex> guard(lock);
+	range.finished = true;
+	pending_tasks--;
+	task_finished.notify_all();
+}
+
+void ParallelCSVReader::WaitForTasks(const std::function<bool()> &condition) {
+	unique_ptr<Task> task;
+	while (true) {
+		{
+			lock_guard<mutex> guard(lock);
+			if (condition()) {
+				return;
+			}
+		}
+		// help executing the tasks of this reader, the tasks are not guaranteed to be executed in order so this might
+		// not be the task we are waiting for
+		if (!scheduler.GetTaskFromProducer(*producer, task)) {
+			break;
+		}
+		task->Execute();
+		task.reset();
+	}
+	// all tasks of this reader have been taken by other threads: block until they have finished
+	unique_lock<mutex> guard(lock);
+	task_finished.wait(guard, condition);
+}
+
+void ParallelCSVReader::ParseCSV(DataChunk &insert_chunk) {
+	while (!current_range || chunk_index >= current_range->chunks.chunks.size()) {
+		if (ranges.size() == 0) {
+			// all ranges have been returned
+			current_range.reset();
+			insert_chunk.SetCardinality(0);
+			return;
+		}
+		// move on to the next range
+		auto range = move(ranges.front());
+		ranges.pop_front();
+		WaitForTasks([&]() { return range->finished; });
+		if (range->row_start != expected_row_start || !range->error.empty()) {
+			// the range started at the wrong position (e.g. in the middle of a quoted value that contains a newline)
+			// or it contains an error: parse it again starting at the end of the previous range. This also makes
+			// sure errors are reported with the correct line number.
+			idx_t range_end = std::max(range->range_end, expected_row_start);
+			auto new_range = make_unique<CSVRange>(expected_row_start, range_end, true);
+			ReadRange(*new_range, linenr);
+			range = move(new_range);
+		}
+		expected_row_start = range->row_end;
+		linenr += range->chunks.count;
+		current_range = move(range);
+		chunk_index = 0;
+		ScheduleRanges();
+	}
+	insert_chunk.Reference(*current_range->chunks.chunks[chunk_index]);
+	chunk_index++;
+}
+
+} // namespace duckdb
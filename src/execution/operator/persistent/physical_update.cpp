@@ -6,6 +6,8 @@
 #include "duckdb/planner/expression/bound_reference_expression.hpp"
 #include "duckdb/storage/data_table.hpp"
 
+#include <atomic>
+
 using namespace std;
 
 namespace duckdb {
@@ -18,8 +20,9 @@ public:
 	UpdateGlobalState() : updated_count(0) {
 	}
 
+	//! Lock for updates that modify an index, these are executed as a delete and an append
 	std::mutex lock;
-	idx_t updated_count;
+	std::atomic<idx_t> updated_count;
 };
 
 class UpdateLocalState : public LocalSinkState {
@@ -69,9 +72,9 @@ void PhysicalUpdate::Sink(ExecutionContext &context, GlobalOperatorState &state,
 		}
 	}
 
-	lock_guard<mutex> glock(gstate.lock);
 	if (is_index_update) {
 		// index update, perform a delete and an append instead
+		lock_guard<mutex> glock(gstate.lock);
 		table.Delete(tableref, context.client, row_ids, update_chunk.size());
 		mock_chunk.SetCardinality(update_chunk);
 		for (idx_t i = 0; i < columns.size(); i++) {
@@ -79,6 +82,7 @@ void PhysicalUpdate::Sink(ExecutionContext &context, GlobalOperatorState &state,
 		}
 		table.Append(tableref, context.client, mock_chunk);
 	} else {
+		// regular update: the updates of different threads are applied to the segments in parallel
 		table.Update(tableref, context.client, row_ids, columns, update_chunk);
 	}
 	gstate.updated_count += chunk.size();
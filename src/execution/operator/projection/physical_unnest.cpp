@@ -57,6 +57,12 @@ void PhysicalUnnest::GetChunkInternal(ExecutionContext &context, DataChunk &chun
 			state->list_data.Destroy();
 			state->list_data.Initialize(list_data_types);
 			executor.Execute(state->child_chunk, state->list_data);
+			for (auto &list_vector : state->list_data.data) {
+				// lists that were filtered are sliced: the list entries are read directly below
+				if (list_vector.vector_type == VectorType::DICTIONARY_VECTOR) {
+					list_vector.Normalify(state->list_data.size());
+				}
+			}
 
 			// paranoia aplenty
 			state->child_chunk.Verify();
@@ -67,11 +73,15 @@ void PhysicalUnnest::GetChunkInternal(ExecutionContext &context, DataChunk &chun
 
 		// need to figure out how many times we need to repeat for current row
 		if (state->list_length < 0) {
+			state->list_length = 0;
 			for (idx_t col_idx = 0; col_idx < state->list_data.column_count(); col_idx++) {
 				auto &v = state->list_data.data[col_idx];
 
 				assert(v.type == TypeId::LIST);
-				// TODO deal with NULL values here!
+				if (FlatVector::IsNull(v, state->parent_position)) {
+					// NULL lists are unnested like empty lists
+					continue;
+				}
 				auto list_data = FlatVector::GetData<list_entry_t>(v);
 				auto list_entry = list_data[state->parent_position];
 				if ((int64_t)list_entry.length > state->list_length) {
@@ -99,10 +109,10 @@ void PhysicalUnnest::GetChunkInternal(ExecutionContext &context, DataChunk &chun
 			auto &v = state->list_data.data[col_idx];
 			auto list_data = FlatVector::GetData<list_entry_t>(v);
 			auto list_entry = list_data[state->parent_position];
-			auto &child_cc = ListVector::GetEntry(v);
 
 			idx_t i = 0;
-			if (list_entry.length > state->list_position) {
+			if (!FlatVector::IsNull(v, state->parent_position) && list_entry.length > state->list_position) {
+				auto &child_cc = ListVector::GetEntry(v);
 				for (i = 0; i < min((idx_t)this_chunk_len, list_entry.length - state->list_position); i++) {
 					chunk.data[target_col].SetValue(i,
 					                                child_cc.GetValue(0, list_entry.offset + i + state->list_position));
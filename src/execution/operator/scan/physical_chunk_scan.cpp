@@ -1,18 +1,48 @@
 #include "duckdb/execution/operator/scan/physical_chunk_scan.hpp"
 
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parallel/task_context.hpp"
+
 using namespace std;
 
 namespace duckdb {
 
 class PhysicalChunkScanState : public PhysicalOperatorState {
 public:
-	PhysicalChunkScanState() : PhysicalOperatorState(nullptr), chunk_index(0) {
+	PhysicalChunkScanState() : PhysicalOperatorState(nullptr), initialized(false), chunk_index(0), chunk_end(0) {
 	}
 
+	bool initialized;
 	//! The current position in the scan
 	idx_t chunk_index;
+	//! The chunk index at which the scan ends
+	idx_t chunk_end;
+};
+
+class ChunkScanTaskInfo : public OperatorTaskInfo {
+public:
+	ChunkScanTaskInfo(idx_t chunk_start, idx_t chunk_end) : chunk_start(chunk_start), chunk_end(chunk_end) {
+	}
+
+	//! The range of chunks to scan
+	idx_t chunk_start;
+	idx_t chunk_end;
 };
 
+void PhysicalChunkScan::ParallelScanInfo(ClientContext &context,
+                                         std::function<void(unique_ptr<OperatorTaskInfo>)> callback) {
+	if (type != PhysicalOperatorType::DELIM_SCAN && !owned_collection) {
+		// the collection might still change while the query is running (e.g. the working table of a recursive CTE):
+		// scan it sequentially
+		return;
+	}
+	idx_t PARALLEL_SCAN_CHUNK_COUNT = context.force_parallelism ? 1 : 100;
+	for (idx_t chunk_idx = 0; chunk_idx < collection->chunks.size(); chunk_idx += PARALLEL_SCAN_CHUNK_COUNT) {
+		idx_t chunk_end = std::min(chunk_idx + PARALLEL_SCAN_CHUNK_COUNT, (idx_t)collection->chunks.size());
+		callback(make_unique<ChunkScanTaskInfo>(chunk_idx, chunk_end));
+	}
+}
+
 void PhysicalChunkScan::GetChunkInternal(ExecutionContext &context, DataChunk &chunk, PhysicalOperatorState *state_) {
 	auto state = (PhysicalChunkScanState *)state_;
 	assert(collection);
@@ -20,7 +50,21 @@ void PhysicalChunkScan::GetChunkInternal(ExecutionContext &context, DataChunk &c
 		return;
 	}
 	assert(chunk.GetTypes() == collection->types);
-	if (state->chunk_index >= collection->chunks.size()) {
+	if (!state->initialized) {
+		auto &task = context.task;
+		auto task_info = task.task_info.find(this);
+		if (task_info != task.task_info.end()) {
+			// task specific limitations: scan only the range of chunks indicated by the task
+			auto &info = (ChunkScanTaskInfo &)*task_info->second;
+			state->chunk_index = info.chunk_start;
+			state->chunk_end = info.chunk_end;
+		} else {
+			// no task specific limitations: scan the entire collection
+			state->chunk_end = INVALID_INDEX;
+		}
+		state->initialized = true;
+	}
+	if (state->chunk_index >= collection->chunks.size() || state->chunk_index >= state->chunk_end) {
 		return;
 	}
 	auto &collection_chunk = *collection->chunks[state->chunk_index];
@@ -3,14 +3,52 @@
 #include "duckdb/catalog/catalog_entry/schema_catalog_entry.hpp"
 #include "duckdb/catalog/catalog_entry/table_function_catalog_entry.hpp"
 #include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/parallel/task_context.hpp"
 #include "duckdb/planner/expression/bound_function_expression.hpp"
 
 using namespace std;
 
 namespace duckdb {
 
+class PhysicalTableFunctionOperatorState : public PhysicalOperatorState {
+public:
+	PhysicalTableFunctionOperatorState() : PhysicalOperatorState(nullptr), initialized(false), task_info(nullptr) {
+	}
+
+	bool initialized;
+	//! The part of the table function that is scanned by this task (if any)
+	OperatorTaskInfo *task_info;
+};
+
+unique_ptr<PhysicalOperatorState> PhysicalTableFunction::GetOperatorState() {
+	return make_unique<PhysicalTableFunctionOperatorState>();
+}
+
+void PhysicalTableFunction::ParallelScanInfo(ClientContext &context,
+                                             std::function<void(unique_ptr<OperatorTaskInfo>)> callback) {
+	if (!function.parallel_tasks) {
+		return;
+	}
+	assert(function.parallel_function);
+	function.parallel_tasks(context, parameters, bind_data.get(), callback);
+}
+
 void PhysicalTableFunction::GetChunkInternal(ExecutionContext &context, DataChunk &chunk,
-                                             PhysicalOperatorState *state) {
+                                             PhysicalOperatorState *state_) {
+	auto state = reinterpret_cast<PhysicalTableFunctionOperatorState *>(state_);
+	if (!state->initialized) {
+		auto &task = context.task;
+		auto task_info = task.task_info.find(this);
+		if (task_info != task.task_info.end()) {
+			state->task_info = task_info->second.get();
+		}
+		state->initialized = true;
+	}
+	if (state->task_info) {
+		// scan the part of the table function that belongs to this task
+		function.parallel_function(context.client, parameters, chunk, bind_data.get(), *state->task_info);
+		return;
+	}
 	// run main code
 	function.function(context.client, parameters, chunk, bind_data.get());
 	if (chunk.size() == 0) {
@@ -6,11 +6,15 @@ namespace duckdb {
 
 class PhysicalUnionOperatorState : public PhysicalOperatorState {
 public:
-	PhysicalUnionOperatorState() : PhysicalOperatorState(nullptr), top_done(false) {
+	PhysicalUnionOperatorState()
+	    : PhysicalOperatorState(nullptr), initialized(false), top_done(false), skip_bottom(false) {
 	}
 	unique_ptr<PhysicalOperatorState> top_state;
 	unique_ptr<PhysicalOperatorState> bottom_state;
+	bool initialized;
 	bool top_done = false;
+	//! Whether or not only the top child is scanned (in a parallel task)
+	bool skip_bottom;
 };
 
 PhysicalUnion::PhysicalUnion(vector<TypeId> types, unique_ptr<PhysicalOperator> top, unique_ptr<PhysicalOperator> bottom)
@@ -22,13 +26,24 @@ PhysicalUnion::PhysicalUnion(vector<TypeId> types, unique_ptr<PhysicalOperator>
 // first exhaust top, then exhaust bottom. state to remember which.
 void PhysicalUnion::GetChunkInternal(ExecutionContext &context, DataChunk &chunk, PhysicalOperatorState *state_) {
 	auto state = reinterpret_cast<PhysicalUnionOperatorState *>(state_);
+	if (!state->initialized) {
+		auto &task = context.task;
+		auto task_info = task.task_info.find(this);
+		if (task_info != task.task_info.end()) {
+			// task specific limitations: only scan the child indicated by the task
+			auto &info = (UnionTaskInfo &)*task_info->second;
+			state->top_done = info.child_idx != 0;
+			state->skip_bottom = info.child_idx == 0;
+		}
+		state->initialized = true;
+	}
 	if (!state->top_done) {
 		children[0]->GetChunk(context, chunk, state->top_state.get());
 		if (chunk.size() == 0) {
 			state->top_done = true;
 		}
 	}
-	if (state->top_done) {
+	if (state->top_done && !state->skip_bottom) {
 		children[1]->GetChunk(context, chunk, state->bottom_state.get());
 	}
 	if (chunk.size() == 0) {
@@ -58,7 +58,7 @@ void PhysicalOperator::Print() {
 
 void PhysicalOperator::ParallelScanInfo(ClientContext &context,
                                         std::function<void(unique_ptr<OperatorTaskInfo>)> callback) {
-	throw InternalException("Unsupported operator for parallel scan!");
+	// by default operators cannot be split up into parallel scans
 }
 
 } // namespace duckdb
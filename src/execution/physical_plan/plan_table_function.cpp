@@ -12,5 +12,7 @@ unique_ptr<PhysicalOperator> PhysicalPlanGenerator::CreatePlan(LogicalTableFunct
 	assert(tfd);
 	// pass on bound column ids into the bind data so the function scan can see them
 	tfd->column_ids = op.column_ids;
+	// pass on the filters that were pushed down into the function
+	tfd->table_filters = move(op.table_filters);
 	return make_unique<PhysicalTableFunction>(op.types, op.function, move(op.bind_data), move(op.parameters));
 }
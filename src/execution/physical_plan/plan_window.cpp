@@ -1,3 +1,4 @@
+#include "duckdb/execution/operator/aggregate/physical_streaming_window.hpp"
 #include "duckdb/execution/operator/aggregate/physical_window.hpp"
 #include "duckdb/execution/physical_plan_generator.hpp"
 #include "duckdb/planner/operator/logical_window.hpp"
@@ -15,7 +16,20 @@ unique_ptr<PhysicalOperator> PhysicalPlanGenerator::CreatePlan(LogicalWindow &op
 	}
 #endif
 
-	auto window = make_unique<PhysicalWindow>(op.types, move(op.expressions));
+	// window functions that do not need to sort their input can be computed while streaming over it
+	bool all_streaming = true;
+	for (auto &expr : op.expressions) {
+		if (!PhysicalStreamingWindow::IsStreamingFunction(*expr)) {
+			all_streaming = false;
+			break;
+		}
+	}
+	unique_ptr<PhysicalOperator> window;
+	if (all_streaming) {
+		window = make_unique<PhysicalStreamingWindow>(op.types, move(op.expressions));
+	} else {
+		window = make_unique<PhysicalWindow>(op.types, move(op.expressions));
+	}
 	window->children.push_back(move(plan));
-	return move(window);
+	return window;
 }
@@ -0,0 +1,81 @@
+#include "duckdb/execution/spillable_chunk_collection.hpp"
+
+#include "duckdb/common/serializer/buffered_deserializer.hpp"
+#include "duckdb/common/serializer/buffered_serializer.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+using namespace std;
+
+namespace duckdb {
+
+SpillableChunkCollection::SpillableChunkCollection(BufferManager &buffer_manager, vector<TypeId> types_)
+    : buffer_manager(buffer_manager), types(move(types_)), count(0), can_spill(true), block_offset(0) {
+	for (auto &type : types) {
+		if (!TypeIsConstantSize(type) && type != TypeId::VARCHAR) {
+			can_spill = false;
+		}
+	}
+}
+
+SpillableChunkCollection::~SpillableChunkCollection() {
+	for (auto &block_id : blocks) {
+		buffer_manager.DestroyBuffer(block_id);
+	}
+}
+
+void SpillableChunkCollection::Append(DataChunk &input) {
+	buffer.Append(input);
+	count += input.size();
+	if (can_spill && buffer.count >= STANDARD_VECTOR_SIZE) {
+		Flush();
+	}
+}
+
+void SpillableChunkCollection::Flush() {
+	if (!can_spill || buffer.count == 0) {
+		return;
+	}
+	BufferedSerializer serializer;
+	unique_ptr<BufferHandle> handle;
+	for (auto &chunk : buffer.chunks) {
+		serializer.Reset();
+		chunk->Serialize(serializer);
+
+		SpilledChunk spilled_chunk;
+		spilled_chunk.size = serializer.blob.size;
+		if (!handle && blocks.size() > 0) {
+			handle = buffer_manager.Pin(blocks.back());
+		}
+		if (!handle || block_offset + spilled_chunk.size > handle->node->size) {
+			// the chunk does not fit in the last buffer: allocate a new buffer
+			auto alloc_size = std::max<idx_t>(Storage::BLOCK_ALLOC_SIZE, spilled_chunk.size + Storage::BLOCK_HEADER_SIZE);
+			handle = buffer_manager.Allocate(alloc_size);
+			blocks.push_back(handle->block_id);
+			block_offset = 0;
+		}
+		spilled_chunk.block_idx = blocks.size() - 1;
+		spilled_chunk.offset = block_offset;
+		memcpy(handle->node->buffer + block_offset, serializer.blob.data.get(), spilled_chunk.size);
+		block_offset += spilled_chunk.size;
+		chunks.push_back(spilled_chunk);
+	}
+	buffer.chunks.clear();
+	buffer.count = 0;
+}
+
+void SpillableChunkCollection::LoadChunk(idx_t chunk_idx, DataChunk &result) {
+	assert(chunk_idx < ChunkCount());
+	if (chunk_idx >= chunks.size()) {
+		// the chunk is still buffered in memory
+		result.Reference(*buffer.chunks[chunk_idx - chunks.size()]);
+		return;
+	}
+	auto &spilled_chunk = chunks[chunk_idx];
+	auto handle = buffer_manager.Pin(blocks[spilled_chunk.block_idx]);
+	BufferedDeserializer deserializer(handle->node->buffer + spilled_chunk.offset, spilled_chunk.size);
+	DataChunk chunk;
+	chunk.Deserialize(deserializer);
+	result.Reference(chunk);
+}
+
+} // namespace duckdb
@@ -9,8 +9,8 @@ using namespace duckdb;
 using namespace std;
 
 WindowSegmentTree::WindowSegmentTree(AggregateFunction &aggregate, TypeId result_type, ChunkCollection *input)
-    : aggregate(aggregate), state(aggregate.state_size()), statep(TypeId::POINTER), result_type(result_type),
-      input_ref(input) {
+    : aggregate(aggregate), state(aggregate.state_size()), batch_states(aggregate.state_size() * STANDARD_VECTOR_SIZE),
+      statep(TypeId::POINTER), result_type(result_type), input_ref(input) {
 #if STANDARD_VECTOR_SIZE < 512
 		throw NotImplementedException("Window functions are not supported for vector sizes < 512");
 #endif
@@ -32,16 +32,6 @@ void WindowSegmentTree::AggregateInit() {
 	aggregate.initialize(state.data());
 }
 
-Value WindowSegmentTree::AggegateFinal() {
-	Vector statev(Value::POINTER((idx_t)state.data()));
-	Vector result(result_type);
-	result.vector_type = VectorType::CONSTANT_VECTOR;
-	ConstantVector::SetNull(result, false);
-	aggregate.finalize(statev, result, 1);
-
-	return result.GetValue(0);
-}
-
 void WindowSegmentTree::WindowSegmentValue(idx_t l_idx, idx_t begin, idx_t end) {
 	assert(begin <= end);
 	if (begin == end) {
@@ -54,7 +44,7 @@ void WindowSegmentTree::WindowSegmentValue(idx_t l_idx, idx_t begin, idx_t end)
 	s.Slice(statep, 0);
 	if (l_idx == 0) {
 		const auto input_count = input_ref->column_count();
-		if (start_in_vector + inputs.size() < STANDARD_VECTOR_SIZE) {
+		if (start_in_vector + inputs.size() <= STANDARD_VECTOR_SIZE) {
 			auto &chunk = input_ref->GetChunk(begin);
 			for (idx_t i = 0; i < input_count; ++i) {
 				auto &v = inputs.data[i];
@@ -70,6 +60,8 @@ void WindowSegmentTree::WindowSegmentValue(idx_t l_idx, idx_t begin, idx_t end)
 			idx_t chunk_b_count = inputs.size() - chunk_a_count;
 			for (idx_t i = 0; i < input_count; ++i) {
 				auto &v = inputs.data[i];
+				// the vector might still be a slice of the input: give it its own buffer before copying into it
+				v.Initialize();
 				VectorOperations::Copy(chunk_a.data[i], v, chunk_a.size(), start_in_vector, 0);
 				VectorOperations::Copy(chunk_b.data[i], v, chunk_b_count, 0, chunk_a_count);
 			}
@@ -124,20 +116,20 @@ void WindowSegmentTree::ConstructTree() {
 	}
 }
 
-Value WindowSegmentTree::Compute(idx_t begin, idx_t end) {
-	assert(input_ref);
-
-	// No arguments, so just count
-	if (inputs.column_count() == 0) {
-		return Value::Numeric(result_type, end - begin);
-	}
-
+void WindowSegmentTree::ComputeState(idx_t begin, idx_t end) {
 	AggregateInit();
+	if (begin >= end) {
+		return;
+	}
 
-	// Aggregate everything at once if we can't combine states
+	// Aggregate everything at once if we can't combine states, one vector of the input at a time
 	if (!aggregate.combine) {
-		WindowSegmentValue(0, begin, end);
-		return AggegateFinal();
+		while (begin < end) {
+			idx_t vector_end = min(end, (begin / STANDARD_VECTOR_SIZE + 1) * STANDARD_VECTOR_SIZE);
+			WindowSegmentValue(0, begin, vector_end);
+			begin = vector_end;
+		}
+		return;
 	}
 
 	for (idx_t l_idx = 0; l_idx < levels_flat_start.size() + 1; l_idx++) {
@@ -145,7 +137,7 @@ Value WindowSegmentTree::Compute(idx_t begin, idx_t end) {
 		idx_t parent_end = end / TREE_FANOUT;
 		if (parent_begin == parent_end) {
 			WindowSegmentValue(l_idx, begin, end);
-			return AggegateFinal();
+			return;
 		}
 		idx_t group_begin = parent_begin * TREE_FANOUT;
 		if (begin != group_begin) {
@@ -159,6 +151,40 @@ Value WindowSegmentTree::Compute(idx_t begin, idx_t end) {
 		begin = parent_begin;
 		end = parent_end;
 	}
+}
+
+void WindowSegmentTree::Compute(Vector &result, const idx_t *begins, const idx_t *ends, idx_t count) {
+	assert(input_ref);
+	assert(count <= STANDARD_VECTOR_SIZE);
+	assert(result.vector_type == VectorType::FLAT_VECTOR);
 
-	return AggegateFinal();
+	// No arguments, so just count
+	if (inputs.column_count() == 0) {
+		for (idx_t i = 0; i < count; i++) {
+			if (begins[i] >= ends[i]) {
+				FlatVector::SetNull(result, i, true);
+			} else if (result_type == TypeId::INT64) {
+				FlatVector::GetData<int64_t>(result)[i] = ends[i] - begins[i];
+			} else {
+				result.SetValue(i, Value::Numeric(result_type, ends[i] - begins[i]));
+			}
+		}
+		return;
+	}
+
+	// aggregate every frame into its own state, and finalize all of them at once
+	Vector statev(TypeId::POINTER);
+	auto state_pointers = FlatVector::GetData<data_ptr_t>(statev);
+	for (idx_t i = 0; i < count; i++) {
+		ComputeState(begins[i], ends[i]);
+		state_pointers[i] = batch_states.data() + i * state.size();
+		memcpy(state_pointers[i], state.data(), state.size());
+	}
+	aggregate.finalize(statev, result, count);
+	for (idx_t i = 0; i < count; i++) {
+		if (begins[i] >= ends[i]) {
+			// if no values are read for window, result is NULL
+			FlatVector::SetNull(result, i, true);
+		}
+	}
 }
@@ -521,7 +521,7 @@ unique_ptr<GlobalFunctionData> read_csv_initialize(ClientContext &context, Funct
 void read_csv_get_chunk(ExecutionContext &context, GlobalFunctionData &gstate, FunctionData &bind_data, DataChunk &chunk) {
 	// read a chunk from the CSV reader
 	auto &gdata = (GlobalReadCSVData &) gstate;
-	gdata.csv_reader->ParseCSV(chunk);
+	gdata.csv_reader->ParseCSV(context.client, chunk);
 }
 
 void CSVCopyFunction::RegisterFunction(BuiltinFunctions &set) {
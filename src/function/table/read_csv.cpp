@@ -66,7 +66,7 @@ static unique_ptr<FunctionData> read_csv_auto_bind(ClientContext &context, vecto
 
 static void read_csv_info(ClientContext &context, vector<Value> &input, DataChunk &output, FunctionData *dataptr) {
 	auto &data = ((ReadCSVFunctionData &)*dataptr);
-	data.csv_reader->ParseCSV(output);
+	data.csv_reader->ParseCSV(context, output);
 }
 
 void ReadCSVTableFunction::RegisterFunction(BuiltinFunctions &set) {
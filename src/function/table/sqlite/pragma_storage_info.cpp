@@ -0,0 +1,125 @@
+#include "duckdb/function/table/sqlite_functions.hpp"
+
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/storage/data_table.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace duckdb {
+
+struct PragmaStorageFunctionData : public TableFunctionData {
+	PragmaStorageFunctionData() : initialized(false), offset(0) {
+	}
+
+	bool initialized;
+	//! The rows that are returned, one for each segment of each column
+	vector<vector<Value>> rows;
+	idx_t offset;
+};
+
+static unique_ptr<FunctionData> pragma_storage_info_bind(ClientContext &context, vector<Value> inputs,
+                                                         vector<SQLType> &return_types, vector<string> &names) {
+	names.push_back("column_id");
+	return_types.push_back(SQLType::BIGINT);
+
+	names.push_back("column_name");
+	return_types.push_back(SQLType::VARCHAR);
+
+	names.push_back("column_type");
+	return_types.push_back(SQLType::VARCHAR);
+
+	names.push_back("segment_id");
+	return_types.push_back(SQLType::BIGINT);
+
+	names.push_back("segment_type");
+	return_types.push_back(SQLType::VARCHAR);
+
+	names.push_back("start");
+	return_types.push_back(SQLType::BIGINT);
+
+	names.push_back("count");
+	return_types.push_back(SQLType::BIGINT);
+
+	names.push_back("min");
+	return_types.push_back(SQLType::VARCHAR);
+
+	names.push_back("max");
+	return_types.push_back(SQLType::VARCHAR);
+
+	names.push_back("has_null");
+	return_types.push_back(SQLType::BOOLEAN);
+
+	names.push_back("has_no_null");
+	return_types.push_back(SQLType::BOOLEAN);
+
+	names.push_back("null_count");
+	return_types.push_back(SQLType::BIGINT);
+
+	names.push_back("distinct_count");
+	return_types.push_back(SQLType::BIGINT);
+
+	return make_unique<PragmaStorageFunctionData>();
+}
+
+static void pragma_storage_info_collect(PragmaStorageFunctionData &data, TableCatalogEntry &table) {
+	auto storage_info = table.storage->GetStorageInfo();
+	for (auto &segment_info : storage_info) {
+		// add the name and the type of the column, and render the min/max in the SQL type of the column
+		auto &column = table.columns[segment_info[0].GetValue<int64_t>()];
+		vector<Value> row;
+		row.push_back(segment_info[0]);
+		row.push_back(Value(column.name));
+		row.push_back(Value(SQLTypeToString(column.type)));
+		for (idx_t i = 1; i < segment_info.size(); i++) {
+			auto &value = segment_info[i];
+			if ((i == 5 || i == 6) && !value.is_null) {
+				row.push_back(Value(value.ToString(column.type)));
+			} else {
+				row.push_back(value);
+			}
+		}
+		data.rows.push_back(move(row));
+	}
+}
+
+static void pragma_storage_info(ClientContext &context, vector<Value> &input, DataChunk &output,
+                                FunctionData *dataptr) {
+	auto &data = *((PragmaStorageFunctionData *)dataptr);
+	if (!data.initialized) {
+		// first call: load the table from the catalog and collect the statistics of its segments
+		assert(input.size() == 1);
+
+		string schema, table_name;
+		auto range_var = input[0].GetValue<string>();
+		Catalog::ParseRangeVar(range_var, schema, table_name);
+
+		auto &catalog = Catalog::GetCatalog(context);
+		auto table = catalog.GetEntry<TableCatalogEntry>(context, schema, table_name);
+		pragma_storage_info_collect(data, *table);
+		data.initialized = true;
+	}
+	if (data.offset >= data.rows.size()) {
+		// finished returning values
+		return;
+	}
+	idx_t next = min(data.offset + STANDARD_VECTOR_SIZE, (idx_t)data.rows.size());
+	output.SetCardinality(next - data.offset);
+	for (idx_t i = data.offset; i < next; i++) {
+		auto &row = data.rows[i];
+		for (idx_t col_idx = 0; col_idx < row.size(); col_idx++) {
+			output.SetValue(col_idx, i - data.offset, row[col_idx]);
+		}
+	}
+	data.offset = next;
+}
+
+void PragmaStorageInfo::RegisterFunction(BuiltinFunctions &set) {
+	set.AddFunction(TableFunction("pragma_storage_info", {SQLType::VARCHAR}, pragma_storage_info_bind,
+	                              pragma_storage_info, nullptr));
+}
+
+} // namespace duckdb
@@ -23,6 +23,7 @@ enum class PhysicalOperatorType : uint8_t {
 	TOP_N,
 	AGGREGATE,
 	WINDOW,
+	STREAMING_WINDOW,
 	UNNEST,
 	DISTINCT,
 	SIMPLE_AGGREGATE,
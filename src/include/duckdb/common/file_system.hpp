@@ -10,6 +10,7 @@
 
 #include "duckdb/common/constants.hpp"
 #include "duckdb/common/file_buffer.hpp"
+#include "duckdb/common/vector.hpp"
 
 #include <functional>
 
@@ -72,8 +73,8 @@ public:
 	unique_ptr<FileHandle> OpenFile(string &path, uint8_t flags, FileLockType lock = FileLockType::NO_LOCK) {
 		return OpenFile(path.c_str(), flags, lock);
 	}
-	//! Read exactly nr_bytes from the specified location in the file. Fails if nr_bytes could not be read. This is
-	//! equivalent to calling SetFilePointer(location) followed by calling Read().
+	//! Read exactly nr_bytes from the specified location in the file. Fails if nr_bytes could not be read. This is a
+	//! positional read that does not depend on the file pointer, it can be used concurrently on the same handle.
 	virtual void Read(FileHandle &handle, void *buffer, int64_t nr_bytes, idx_t location);
 	//! Write exactly nr_bytes to the specified location in the file. Fails if nr_bytes could not be read. This is
 	//! equivalent to calling SetFilePointer(location) followed by calling Write().
@@ -84,6 +85,9 @@ public:
 	//! Write nr_bytes from the buffer into the file, moving the file pointer forward by nr_bytes.
 	virtual int64_t Write(FileHandle &handle, void *buffer, int64_t nr_bytes);
 
+	//! Hint that the specified range of the file will be read soon, so it can be loaded in the background
+	virtual void Prefetch(FileHandle &handle, idx_t location, idx_t nr_bytes);
+
 	//! Returns the file size of a file handle, returns -1 on error
 	virtual int64_t GetFileSize(FileHandle &handle);
 	//! Truncate a file to a maximum size of new_size, new_size should be smaller than or equal to the current size of
@@ -111,6 +115,9 @@ public:
 	virtual string JoinPath(const string &a, const string &path);
 	//! Sync a file handle to disk
 	virtual void FileSync(FileHandle &handle);
+	//! Returns the paths of all files that match the glob pattern in alphabetical order. The wildcards *, ? and [...]
+	//! can be used in every component of the path. A path without wildcards is returned as-is if the file exists.
+	virtual vector<string> Glob(const string &path);
 
 private:
 	//! Set the file pointer of a file handle to a specified location. Reads and writes will happen from this location
@@ -127,6 +127,10 @@ public:
 	//! Deserializes a blob back into a Vector
 	void Deserialize(idx_t count, Deserializer &source);
 
+protected:
+	//! Marks the dictionary size of a (re-sliced) dictionary vector as unknown
+	void ClearDictionarySize();
+
 protected:
 	//! A pointer to the data.
 	data_ptr_t data;
@@ -142,11 +146,14 @@ protected:
 //! The DictionaryBuffer holds a selection vector
 class VectorChildBuffer : public VectorBuffer {
 public:
-	VectorChildBuffer() : VectorBuffer(VectorBufferType::VECTOR_CHILD_BUFFER), data() {
+	VectorChildBuffer()
+	    : VectorBuffer(VectorBufferType::VECTOR_CHILD_BUFFER), data(), dictionary_size(INVALID_INDEX) {
 	}
 
 public:
 	Vector data;
+	//! The amount of entries of the child that are referenced by the dictionary (INVALID_INDEX if unknown)
+	idx_t dictionary_size;
 };
 
 struct ConstantVector {
@@ -183,6 +190,26 @@ struct DictionaryVector {
 		assert(vector.vector_type == VectorType::DICTIONARY_VECTOR);
 		return ((VectorChildBuffer &)*vector.auxiliary).data;
 	}
+	//! Returns the amount of distinct entries of the child that the selection vector refers to, or INVALID_INDEX if
+	//! this is not known. If known, operations can be executed once per dictionary entry instead of once per row.
+	static inline idx_t DictionarySize(const Vector &vector) {
+		assert(vector.vector_type == VectorType::DICTIONARY_VECTOR);
+		return ((VectorChildBuffer &)*vector.auxiliary).dictionary_size;
+	}
+	static inline void SetDictionarySize(Vector &vector, idx_t dictionary_size) {
+		assert(vector.vector_type == VectorType::DICTIONARY_VECTOR);
+		assert(dictionary_size <= STANDARD_VECTOR_SIZE);
+		((VectorChildBuffer &)*vector.auxiliary).dictionary_size = dictionary_size;
+	}
+	//! Whether or not operations on the vector can be executed on the dictionary entries instead of on every row
+	static inline bool CanExecuteOnDictionary(const Vector &vector, idx_t count) {
+		if (vector.vector_type != VectorType::DICTIONARY_VECTOR) {
+			return false;
+		}
+		auto dictionary_size = DictionarySize(vector);
+		return dictionary_size != INVALID_INDEX && dictionary_size < count &&
+		       Child(vector).vector_type == VectorType::FLAT_VECTOR;
+	}
 };
 
 struct FlatVector {
@@ -159,6 +159,25 @@ struct BinaryExecutor {
 		    *ldata.nullmask, *rdata.nullmask, FlatVector::Nullmask(result), fun);
 	}
 
+	//! Execute a dictionary vector and a constant vector once for every dictionary entry
+	template <class LEFT_TYPE, class RIGHT_TYPE, class RESULT_TYPE, class OPWRAPPER, class OP, class FUNC,
+	          bool IGNORE_NULL, bool DICTIONARY_LEFT>
+	static void ExecuteDictionaryConstant(Vector &left, Vector &right, Vector &result, idx_t count, FUNC fun) {
+		auto &dictionary = DICTIONARY_LEFT ? left : right;
+		auto dictionary_size = DictionaryVector::DictionarySize(dictionary);
+		auto &child = DictionaryVector::Child(dictionary);
+
+		ExecuteFlat<LEFT_TYPE, RIGHT_TYPE, RESULT_TYPE, OPWRAPPER, OP, FUNC, IGNORE_NULL, !DICTIONARY_LEFT,
+		            DICTIONARY_LEFT>(DICTIONARY_LEFT ? child : left, DICTIONARY_LEFT ? right : child, result,
+		                             dictionary_size, fun);
+		if (result.vector_type == VectorType::CONSTANT_VECTOR) {
+			// the constant is NULL: the result is a constant NULL
+			return;
+		}
+		result.Slice(DictionaryVector::SelVector(dictionary), count);
+		DictionaryVector::SetDictionarySize(result, dictionary_size);
+	}
+
 	template <class LEFT_TYPE, class RIGHT_TYPE, class RESULT_TYPE, class OPWRAPPER, class OP, class FUNC,
 	          bool IGNORE_NULL>
 	static void ExecuteSwitch(Vector &left, Vector &right, Vector &result, idx_t count, FUNC fun) {
@@ -174,6 +193,14 @@ struct BinaryExecutor {
 		} else if (left.vector_type == VectorType::FLAT_VECTOR && right.vector_type == VectorType::FLAT_VECTOR) {
 			ExecuteFlat<LEFT_TYPE, RIGHT_TYPE, RESULT_TYPE, OPWRAPPER, OP, FUNC, IGNORE_NULL, false, false>(
 			    left, right, result, count, fun);
+		} else if (right.vector_type == VectorType::CONSTANT_VECTOR && &left != &result &&
+		           DictionaryVector::CanExecuteOnDictionary(left, count)) {
+			ExecuteDictionaryConstant<LEFT_TYPE, RIGHT_TYPE, RESULT_TYPE, OPWRAPPER, OP, FUNC, IGNORE_NULL, true>(
+			    left, right, result, count, fun);
+		} else if (left.vector_type == VectorType::CONSTANT_VECTOR && &right != &result &&
+		           DictionaryVector::CanExecuteOnDictionary(right, count)) {
+			ExecuteDictionaryConstant<LEFT_TYPE, RIGHT_TYPE, RESULT_TYPE, OPWRAPPER, OP, FUNC, IGNORE_NULL, false>(
+			    left, right, result, count, fun);
 		} else {
 			ExecuteGeneric<LEFT_TYPE, RIGHT_TYPE, RESULT_TYPE, OPWRAPPER, OP, FUNC, IGNORE_NULL>(left, right, result,
 			                                                                                     count, fun);
@@ -372,6 +399,44 @@ public:
 		}
 	}
 
+	//! Compare a dictionary vector with a constant vector once for every dictionary entry
+	template <class LEFT_TYPE, class RIGHT_TYPE, class OP, bool DICTIONARY_LEFT>
+	static idx_t SelectDictionaryConstant(Vector &left, Vector &right, const SelectionVector *sel, idx_t count,
+	                                      SelectionVector *true_sel, SelectionVector *false_sel) {
+		auto &dictionary = DICTIONARY_LEFT ? left : right;
+		auto &constant = DICTIONARY_LEFT ? right : left;
+		if (ConstantVector::IsNull(constant)) {
+			return 0;
+		}
+		auto dictionary_size = DictionaryVector::DictionarySize(dictionary);
+		auto &child = DictionaryVector::Child(dictionary);
+		auto &child_nullmask = FlatVector::Nullmask(child);
+		auto ldata = FlatVector::GetData<LEFT_TYPE>(DICTIONARY_LEFT ? child : left);
+		auto rdata = FlatVector::GetData<RIGHT_TYPE>(DICTIONARY_LEFT ? right : child);
+
+		bool matches[STANDARD_VECTOR_SIZE];
+		for (idx_t i = 0; i < dictionary_size; i++) {
+			matches[i] = !child_nullmask[i] &&
+			             OP::Operation(ldata[DICTIONARY_LEFT ? i : 0], rdata[DICTIONARY_LEFT ? 0 : i]);
+		}
+		// now look up the result for every row
+		auto &dictionary_sel = DictionaryVector::SelVector(dictionary);
+		idx_t true_count = 0, false_count = 0;
+		for (idx_t i = 0; i < count; i++) {
+			auto result_idx = sel->get_index(i);
+			if (matches[dictionary_sel.get_index(i)]) {
+				if (true_sel) {
+					true_sel->set_index(true_count++, result_idx);
+				}
+			} else {
+				if (false_sel) {
+					false_sel->set_index(false_count++, result_idx);
+				}
+			}
+		}
+		return true_sel ? true_count : count - false_count;
+	}
+
 	template <class LEFT_TYPE, class RIGHT_TYPE, class OP>
 	static idx_t SelectGeneric(Vector &left, Vector &right, const SelectionVector *sel, idx_t count,
 	                           SelectionVector *true_sel, SelectionVector *false_sel) {
@@ -399,6 +464,14 @@ public:
 			return SelectFlat<LEFT_TYPE, RIGHT_TYPE, OP, false, true>(left, right, sel, count, true_sel, false_sel);
 		} else if (left.vector_type == VectorType::FLAT_VECTOR && right.vector_type == VectorType::FLAT_VECTOR) {
 			return SelectFlat<LEFT_TYPE, RIGHT_TYPE, OP, false, false>(left, right, sel, count, true_sel, false_sel);
+		} else if (right.vector_type == VectorType::CONSTANT_VECTOR &&
+		           DictionaryVector::CanExecuteOnDictionary(left, count)) {
+			return SelectDictionaryConstant<LEFT_TYPE, RIGHT_TYPE, OP, true>(left, right, sel, count, true_sel,
+			                                                                 false_sel);
+		} else if (left.vector_type == VectorType::CONSTANT_VECTOR &&
+		           DictionaryVector::CanExecuteOnDictionary(right, count)) {
+			return SelectDictionaryConstant<LEFT_TYPE, RIGHT_TYPE, OP, false>(left, right, sel, count, true_sel,
+			                                                                  false_sel);
 		} else {
 			return SelectGeneric<LEFT_TYPE, RIGHT_TYPE, OP>(left, right, sel, count, true_sel, false_sel);
 		}
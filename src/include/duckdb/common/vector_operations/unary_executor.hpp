@@ -78,8 +78,27 @@ private:
 		}
 	}
 
+	template <class INPUT_TYPE, class RESULT_TYPE, class OPWRAPPER, class OP, class FUNC, bool IGNORE_NULL>
+	static inline void ExecuteDictionary(Vector &input, Vector &result, idx_t count, FUNC fun) {
+		// execute the operation once for every entry of the dictionary, and turn the result into a dictionary as well
+		auto dictionary_size = DictionaryVector::DictionarySize(input);
+		auto &child = DictionaryVector::Child(input);
+
+		result.vector_type = VectorType::FLAT_VECTOR;
+		FlatVector::SetNullmask(result, FlatVector::Nullmask(child));
+		ExecuteFlat<INPUT_TYPE, RESULT_TYPE, OPWRAPPER, OP, FUNC, IGNORE_NULL>(
+		    FlatVector::GetData<INPUT_TYPE>(child), FlatVector::GetData<RESULT_TYPE>(result), dictionary_size,
+		    FlatVector::Nullmask(child), FlatVector::Nullmask(result), fun);
+		result.Slice(DictionaryVector::SelVector(input), count);
+		DictionaryVector::SetDictionarySize(result, dictionary_size);
+	}
+
 	template <class INPUT_TYPE, class RESULT_TYPE, class OPWRAPPER, class OP, class FUNC, bool IGNORE_NULL>
 	static inline void ExecuteStandard(Vector &input, Vector &result, idx_t count, FUNC fun) {
+		if (&input != &result && DictionaryVector::CanExecuteOnDictionary(input, count)) {
+			ExecuteDictionary<INPUT_TYPE, RESULT_TYPE, OPWRAPPER, OP, FUNC, IGNORE_NULL>(input, result, count, fun);
+			return;
+		}
 		switch (input.vector_type) {
 		case VectorType::CONSTANT_VECTOR: {
 			result.vector_type = VectorType::CONSTANT_VECTOR;
@@ -13,9 +13,14 @@
 #include "duckdb/common/types/data_chunk.hpp"
 #include "duckdb/common/types/vector.hpp"
 #include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/storage/storage_info.hpp"
+
+#include <functional>
 
 namespace duckdb {
 class BoundAggregateExpression;
+class BufferManager;
+class BufferHandle;
 
 struct AggregateObject {
 	AggregateObject(AggregateFunction function, idx_t child_count, idx_t payload_size, bool distinct,
@@ -33,6 +38,57 @@ struct AggregateObject {
 	static vector<AggregateObject> CreateAggregateObjects(vector<BoundAggregateExpression *> bindings);
 };
 
+//! AggregateSpill holds groups and aggregate states that were moved out of a SuperLargeHashTable. The groups are
+//! serialized together with the raw aggregate states into buffers obtained from the buffer manager, so they can be
+//! offloaded to the temporary directory when the memory limit is reached. The same group can occur multiple times in
+//! a spill, the spilled states are merged by combining the spill into a SuperLargeHashTable.
+class AggregateSpill {
+	struct SpilledChunk {
+		idx_t block_idx;
+		idx_t offset;
+		idx_t groups_size;
+		idx_t count;
+	};
+
+public:
+	AggregateSpill(BufferManager &buffer_manager, vector<AggregateObject> aggregates, idx_t payload_width);
+	~AggregateSpill();
+
+	BufferManager &buffer_manager;
+	//! The aggregates of the spilled states
+	vector<AggregateObject> aggregates;
+	//! The size of the aggregate states of a single group in bytes
+	idx_t payload_width;
+	//! The total amount of spilled groups
+	idx_t count;
+
+public:
+	//! Append the groups together with the aggregate states the addresses point to. The spill takes ownership of the
+	//! aggregate states.
+	void Append(DataChunk &groups, Vector &addresses);
+	//! Move the spilled groups of another spill into this spill. The other spill is left empty.
+	void Merge(AggregateSpill &other);
+	//! The amount of chunks that can be loaded from the spill
+	idx_t ChunkCount() {
+		return chunks.size();
+	}
+	//! Load the chunk with the specified index, the groups chunk references the loaded groups and the addresses point
+	//! to their aggregate states. The states remain valid as long as the returned handle is kept.
+	unique_ptr<BufferHandle> LoadChunk(idx_t chunk_idx, DataChunk &groups, Vector &addresses);
+	//! Discard the spilled data without calling any destructors, after the aggregate states have been moved out
+	void ClearMoved();
+
+private:
+	//! The buffers holding the spilled groups and states
+	vector<block_id_t> blocks;
+	//! The offset within the last buffer to write to
+	idx_t block_offset;
+	//! The spilled chunks
+	vector<SpilledChunk> chunks;
+
+	AggregateSpill(const AggregateSpill &) = delete;
+};
+
 //! SuperLargeHashTable is a linear probing HT that is used for computing
 //! aggregates
 /*!
@@ -60,6 +116,13 @@ public:
 	//! chunks are filled. scan_position will be updated by this function.
 	//! Returns the amount of elements found.
 	idx_t Scan(idx_t &scan_position, DataChunk &group, DataChunk &result);
+	//! Scan the HT starting from the scan_position until either the result and group chunks are filled or the
+	//! scan_end position is reached. scan_position will be updated by this function. Returns the amount of elements
+	//! found.
+	idx_t Scan(idx_t &scan_position, idx_t scan_end, DataChunk &group, DataChunk &result);
+	//! Split the HT into ranges of at most range_size cells that can be scanned independently. The callback is called
+	//! with the [start, end) scan positions of every range.
+	void InitializeParallelScan(idx_t range_size, const std::function<void(idx_t, idx_t)> &callback);
 
 	//! Fetch the aggregates for specific groups from the HT and place them in the result
 	void FetchAggregates(DataChunk &groups, DataChunk &result);
@@ -70,6 +133,27 @@ public:
 	idx_t FindOrCreateGroups(DataChunk &groups, Vector &addresses, SelectionVector &new_groups);
 	void FindOrCreateGroups(DataChunk &groups, Vector &addresses);
 
+	//! Combine the groups and aggregate states of another HT into this HT. The aggregate states are merged using the
+	//! combine function of the aggregates, which takes ownership of the source states. The other HT is left empty.
+	void Combine(SuperLargeHashTable &other);
+	//! Move the groups and aggregate states of this HT into a set of 2^radix_bits partition HTs, based on the radix of
+	//! the group hashes. Partition HTs are created on demand. This HT is left empty.
+	void Partition(vector<unique_ptr<SuperLargeHashTable>> &partition_hts, idx_t radix_bits);
+	//! Move the groups and aggregate states of this HT into a set of 2^radix_bits spills, using the same radix
+	//! partitioning as Partition. Spills are created on demand. This HT is left empty.
+	void Spill(BufferManager &buffer_manager, vector<unique_ptr<AggregateSpill>> &spills, idx_t radix_bits);
+	//! Combine the spilled groups and aggregate states into this HT. The spill is left empty.
+	void Combine(AggregateSpill &spill);
+
+	//! Returns the amount of groups stored in the HT
+	idx_t Size() {
+		return entries;
+	}
+	//! Returns the amount of memory used by the cells of the HT in bytes
+	idx_t SizeInBytes() {
+		return capacity * tuple_size;
+	}
+
 	//! The stringheap of the AggregateHashTable
 	StringHeap string_heap;
 
@@ -112,6 +196,9 @@ private:
 	static constexpr int EMPTY_CELL = 0x00;
 	//! Flag indicating a cell is full
 	static constexpr int FULL_CELL = 0xFF;
+	//! The highest (exclusive) bit of the hash used for partitioning. Partitioning uses the upper bits of the lower 32
+	//! bits, as the hashes of 32-bit values do not fill the upper half of the hash.
+	static constexpr idx_t PARTITION_BIT_END = 32;
 
 	SuperLargeHashTable(const SuperLargeHashTable &) = delete;
 
@@ -120,6 +207,11 @@ private:
 
 private:
 	void Destroy();
+	//! Scan the HT starting from the scan_position, gathering the groups of up to STANDARD_VECTOR_SIZE full cells into
+	//! the group chunk and the pointers to their payload into the addresses vector
+	idx_t ScanGroups(idx_t &scan_position, DataChunk &groups, Vector &addresses);
+	//! Discard the data of the HT without calling the destructors, after the aggregate states have been moved out
+	void ClearMoved();
 	void CallDestructors(Vector &state_vector, idx_t count);
 	void ScatterGroups(DataChunk &groups, unique_ptr<VectorData[]> &group_data, Vector &addresses,
 	                   const SelectionVector &sel, idx_t count);
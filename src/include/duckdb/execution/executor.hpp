@@ -47,6 +47,8 @@ public:
 
 	//! Push a new error
 	void PushError(std::string exception);
+	//! Schedule a task to be executed as part of the current query
+	void ScheduleTask(unique_ptr<Task> task);
 
 	//! Flush a thread context into the client context
 	void Flush(ThreadContext &context);
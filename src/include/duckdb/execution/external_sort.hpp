@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// duckdb/execution/external_sort.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/common.hpp"
+#include "duckdb/common/enums/order_type.hpp"
+#include "duckdb/common/types/chunk_collection.hpp"
+#include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/storage/storage_info.hpp"
+
+namespace duckdb {
+class BufferManager;
+
+//! A SortRowSource locates the rows that the row indices of the sort entries refer to, either in a ChunkCollection or
+//! in a single DataChunk
+struct SortRowSource {
+	SortRowSource() : collection(nullptr), chunk(nullptr), sort_column_offset(0) {
+	}
+
+	ChunkCollection *collection;
+	DataChunk *chunk;
+	//! The column index of the first sort column
+	idx_t sort_column_offset;
+
+	DataChunk &Locate(idx_t row_idx, idx_t &chunk_row) const {
+		if (collection) {
+			chunk_row = row_idx % STANDARD_VECTOR_SIZE;
+			return *collection->chunks[row_idx / STANDARD_VECTOR_SIZE];
+		}
+		chunk_row = row_idx;
+		return *chunk;
+	}
+};
+
+//! The SortLayout describes how the ORDER BY columns are normalized into fixed-width keys that can be compared with
+//! memcmp
+/*!
+    Every sort entry looks like this:
+    [NULL BYTE][VALUE BYTES][NULL BYTE][VALUE BYTES]...[PADDING][ROW INDEX]
+    Values are stored big-endian with their sign bit flipped, descending columns have all their bytes inverted.
+    Strings store a fixed-size prefix followed by their length (capped at the prefix size + 1), ties between strings
+    that are longer than the prefix are broken by comparing the full strings.
+*/
+class SortLayout {
+public:
+	SortLayout(vector<TypeId> types, vector<OrderType> order_types, vector<OrderByNullType> null_order_types);
+
+	//! The types of the sort columns
+	vector<TypeId> types;
+	//! The order types of the sort columns
+	vector<OrderType> order_types;
+	//! The null order types of the sort columns
+	vector<OrderByNullType> null_order_types;
+	//! The offset of each sort column within the normalized key
+	vector<idx_t> key_offsets;
+	//! The width of each sort column within the normalized key (including the null byte)
+	vector<idx_t> key_widths;
+	//! The sort columns that are strings, and that might require tie-breaking
+	vector<idx_t> string_columns;
+	//! The width of the normalized key
+	idx_t key_width;
+	//! The size of a sort entry (the normalized key followed by the row index)
+	idx_t entry_size;
+
+	//! The amount of bytes of a string that are stored in the normalized key
+	static constexpr idx_t STRING_PREFIX_SIZE = 12;
+
+public:
+	//! Whether or not the sort entries can be sorted by only looking at the normalized keys
+	bool IsFixedSize() {
+		return string_columns.size() == 0;
+	}
+	//! Normalizes the sort columns into "count" sort entries starting at "target". The entries are tagged with
+	//! consecutive row indices starting from "row_offset".
+	void EncodeKeys(DataChunk &sort_chunk, data_ptr_t target, idx_t row_offset);
+	//! Returns the row index of a sort entry
+	idx_t GetRowIndex(data_ptr_t entry) {
+		return *((idx_t *)(entry + key_width));
+	}
+	void SetRowIndex(data_ptr_t entry, idx_t row_idx) {
+		*((idx_t *)(entry + key_width)) = row_idx;
+	}
+	//! Compares two sort entries, returns a value smaller than, equal to or larger than zero like memcmp
+	int Compare(data_ptr_t left, data_ptr_t right, const SortRowSource &left_source,
+	            const SortRowSource &right_source);
+	//! Sorts "count" sort entries in-place. Entries with fixed-size keys are radix sorted.
+	void SortEntries(data_ptr_t entries, idx_t count, const SortRowSource &source);
+};
+
+//! A SortedRun holds a set of rows together with their sort entries in sorted order. Small runs are kept in memory
+//! as-is, large runs are materialized in sorted order and written to buffers obtained from the buffer manager, so they
+//! can be offloaded to disk when they exceed the memory limit.
+class SortedRun {
+public:
+	//! A chunk of a spilled run: the sort entries of the chunk followed by the serialized chunk
+	struct RunChunk {
+		idx_t block_idx;
+		idx_t offset;
+		idx_t count;
+		idx_t size;
+	};
+
+	SortedRun(BufferManager &buffer_manager, SortLayout &layout, ChunkCollection &data, idx_t sort_column_offset,
+	          bool spill);
+	~SortedRun();
+
+	BufferManager &buffer_manager;
+	SortLayout &layout;
+	//! The amount of rows in the run
+	idx_t count;
+	//! The column index of the first sort column in the rows
+	idx_t sort_column_offset;
+
+	//! In-memory run: the rows and the sorted entries referring to them
+	ChunkCollection data;
+	unique_ptr<data_t[]> entries;
+
+	//! Spilled run: the buffers and the sorted chunks stored in them
+	vector<block_id_t> blocks;
+	vector<RunChunk> chunks;
+
+public:
+	bool IsSpilled() {
+		return !entries;
+	}
+	//! Whether or not the types of the rows can be written to a spilled run
+	static bool CanSpill(const vector<TypeId> &types);
+	//! Loads a chunk of a spilled run, the sort entries are copied to "target_entries"
+	void LoadChunk(idx_t chunk_idx, DataChunk &result, data_ptr_t target_entries);
+
+private:
+	void Spill(ChunkCollection &source, data_ptr_t sorted_entries);
+};
+
+//! The SortedRunMerger performs a k-way merge of a set of sorted runs
+class SortedRunMerger {
+	struct RunCursor {
+		SortedRun *run;
+		SortRowSource source;
+		//! The loaded chunk of a spilled run
+		DataChunk chunk;
+		//! The sort entries of the current chunk of a spilled run
+		unique_ptr<data_t[]> chunk_entries;
+		idx_t chunk_idx;
+		//! The current sort entry, and the amount of loaded entries that remain
+		data_ptr_t entry;
+		idx_t remaining;
+	};
+
+public:
+	SortedRunMerger(SortLayout &layout, vector<unique_ptr<SortedRun>> &runs);
+
+	//! Fetches the next set of merged rows, only the first result.column_count() columns of the rows are output. An
+	//! empty result signifies that the merge is finished.
+	void Scan(DataChunk &result);
+
+private:
+	SortLayout &layout;
+	vector<unique_ptr<RunCursor>> cursors;
+	//! Binary heap of the indices of the cursors that still have entries remaining
+	vector<idx_t> heap;
+	//! The source of each output row
+	DataChunk *source_chunks[STANDARD_VECTOR_SIZE];
+	idx_t source_rows[STANDARD_VECTOR_SIZE];
+
+private:
+	bool LoadNextChunk(RunCursor &cursor);
+	bool CursorGreaterThan(idx_t left, idx_t right);
+};
+
+} // namespace duckdb
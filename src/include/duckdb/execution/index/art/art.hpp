@@ -88,6 +88,8 @@ public:
 
 	//! Insert data into the index.
 	bool Insert(IndexLock &lock, DataChunk &data, Vector &row_ids) override;
+	//! Remove all entries from the index
+	void Clear(IndexLock &lock) override;
 
 private:
 	DataChunk expression_result;
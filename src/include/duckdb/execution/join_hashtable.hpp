@@ -126,9 +126,28 @@ public:
 
 	//! Add the given data to the HT
 	void Build(DataChunk &keys, DataChunk &input);
+	//! Merge the data of a thread-local HT into this HT. The other HT is empty afterwards.
+	void Merge(JoinHashTable &other);
 	//! Finalize the build of the HT, constructing the actual hash table and making the HT ready for probing. Finalize
 	//! must be called before any call to Probe, and after Finalize is called Build should no longer be ever called.
 	void Finalize();
+	//! Allocate the pointer table of the HT. Together with InsertBlock this can be used to finalize the HT in parallel.
+	void InitializePointerTable();
+	//! Insert the entries of the specified block into the pointer table. If parallel is true, this method can be
+	//! called concurrently for different blocks.
+	void InsertBlock(idx_t block_idx, bool parallel);
+	//! The amount of blocks holding the data of the HT
+	idx_t BlockCount() {
+		return blocks.size();
+	}
+	//! The amount of memory that is required to keep the entire HT in memory after it is finalized
+	idx_t RequiredMemory();
+	//! Move the entries of the (not finalized) HT into 2^radix_bits partitions based on the upper bits of their hashes.
+	//! This is used for out-of-core joins, where only a single partition is kept in memory at a time. The entries of the
+	//! partitions keep referring to the strings in the string heap of this HT.
+	void Partition(vector<unique_ptr<JoinHashTable>> &partitions, idx_t radix_bits);
+	//! Compute the partition of every row of the given probe keys, rows with NULL keys are assigned to partition 0
+	void ComputeRadixPartitions(DataChunk &keys, idx_t radix_bits, idx_t partition_indices[]);
 	//! Probe the HT with the given input chunk, resulting in the given result
 	unique_ptr<ScanStructure> Probe(DataChunk &keys);
 	//! Scan the HT to construct the final full outer join result after
@@ -194,9 +213,19 @@ private:
 	//! Apply a bitmask to the hashes
 	void ApplyBitmask(Vector &hashes, idx_t count);
 	void ApplyBitmask(Vector &hashes, const SelectionVector &sel, idx_t count, Vector &pointers);
+	//! Reserve space for the given amount of entries in the blocks of the HT. The blocks that are written to are kept
+	//! pinned in the handles.
+	void ReserveEntries(idx_t entry_count, data_ptr_t key_locations[], vector<unique_ptr<BufferHandle>> &handles);
+	//! Copy the given serialized entries of a HT with the same layout into this HT
+	void AppendEntries(data_ptr_t entries[], idx_t entry_count);
+	//! The highest (exclusive) bit of the hash used for partitioning. Partitioning uses the upper bits of the lower 32
+	//! bits, as the hashes of 32-bit values do not fill the upper half of the hash.
+	static constexpr idx_t PARTITION_BIT_END = 32;
+	//! Compute the partition of a hash
+	static idx_t RadixPartition(hash_t hash, idx_t radix_bits);
 	//! Insert the given set of locations into the HT with the given set of
-	//! hashes. Caller should hold lock in parallel HT.
-	void InsertHashes(Vector &hashes, idx_t count, data_ptr_t key_locations[]);
+	//! hashes. If parallel is true, the pointers are inserted with atomic compare-and-swap.
+	void InsertHashes(Vector &hashes, idx_t count, data_ptr_t key_locations[], bool parallel);
 
 	idx_t PrepareKeys(DataChunk &keys, unique_ptr<VectorData[]> &key_data, const SelectionVector *&current_sel,
 	                  SelectionVector &sel);
@@ -208,7 +237,7 @@ private:
 	idx_t count;
 	//! The blocks holding the main data of the hash table
 	vector<HTDataBlock> blocks;
-	//! Pinned handles, these are pinned during finalization only
+	//! Pinned handles of the blocks, these are pinned during finalization only
 	vector<unique_ptr<BufferHandle>> pinned_handles;
 	//! The hash map of the HT, created after finalization
 	unique_ptr<BufferHandle> hash_map;
@@ -32,6 +32,8 @@ public:
 	bool is_implicit_aggr;
 	//! Whether or not all aggregates are combinable
 	bool all_combinable;
+	//! Whether or not any of the aggregates is a DISTINCT aggregate
+	bool any_distinct;
 
 	//! The group types
 	vector<TypeId> group_types;
@@ -43,14 +45,31 @@ public:
 	//! Pointers to the aggregates
 	vector<BoundAggregateExpression *> bindings;
 
+	//! Thread-local HTs with fewer groups than this are combined into a single HT instead of being radix partitioned
+	static constexpr idx_t RADIX_PARTITION_THRESHOLD = 10000;
+	//! The maximum amount of radix bits used to partition the thread-local HTs
+	static constexpr idx_t MAX_RADIX_BITS = 7;
+	//! The amount of HT cells scanned by a single task in a parallel scan
+	static constexpr idx_t PARALLEL_SCAN_CELL_COUNT = 100 * STANDARD_VECTOR_SIZE;
+	//! The amount of radix bits used to partition the groups that are spilled to disk
+	static constexpr idx_t SPILL_RADIX_BITS = 6;
+
 public:
 	void Sink(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate, DataChunk &input) override;
+	void Combine(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate) override;
+	void Finalize(ClientContext &context, unique_ptr<GlobalOperatorState> state) override;
 
 	unique_ptr<LocalSinkState> GetLocalSinkState(ExecutionContext &context) override;
 	unique_ptr<GlobalOperatorState> GetGlobalState(ClientContext &context) override;
 
 	void GetChunkInternal(ExecutionContext &context, DataChunk &chunk, PhysicalOperatorState *state) override;
 	unique_ptr<PhysicalOperatorState> GetOperatorState() override;
+	void ParallelScanInfo(ClientContext &context, std::function<void(unique_ptr<OperatorTaskInfo>)> callback) override;
+
+	//! Whether or not the aggregates can be computed in thread-local HTs that are combined afterwards
+	bool UseThreadLocalHT() {
+		return all_combinable && !any_distinct;
+	}
 };
 
 } // namespace duckdb
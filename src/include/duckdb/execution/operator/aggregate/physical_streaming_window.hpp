@@ -0,0 +1,34 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// duckdb/execution/operator/aggregate/physical_streaming_window.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/execution/physical_operator.hpp"
+
+namespace duckdb {
+
+//! PhysicalStreamingWindow implements window functions without a PARTITION BY or ORDER BY whose frames only look a
+//! bounded amount of rows back (or keep a running state) over the input in its original order. Unlike the
+//! PhysicalWindow it does not materialize its input: the results are computed one chunk at a time.
+class PhysicalStreamingWindow : public PhysicalOperator {
+public:
+	PhysicalStreamingWindow(vector<TypeId> types, vector<unique_ptr<Expression>> select_list);
+
+	void GetChunkInternal(ExecutionContext &context, DataChunk &chunk, PhysicalOperatorState *state) override;
+
+	//! The projection list of the SELECT statement (that contains the window functions)
+	vector<unique_ptr<Expression>> select_list;
+
+public:
+	unique_ptr<PhysicalOperatorState> GetOperatorState() override;
+
+	//! Returns whether or not the window expression can be computed without materializing the input
+	static bool IsStreamingFunction(Expression &expr);
+};
+
+} // namespace duckdb
@@ -14,8 +14,8 @@
 
 namespace duckdb {
 
-//! Represents a physical ordering of the data. Note that this will not change
-//! the data but only add a selection vector.
+//! Represents a physical ordering of the data. Every thread sorts its input into sorted runs, which are merged when
+//! the result is scanned.
 class PhysicalOrder : public PhysicalSink {
 public:
 	PhysicalOrder(vector<TypeId> types, vector<BoundOrderByNode> orders)
@@ -24,10 +24,14 @@ public:
 
 	vector<BoundOrderByNode> orders;
 
+	//! The amount of rows a thread collects before sorting them into a run that can be offloaded to disk
+	static constexpr idx_t SORTED_RUN_SIZE = 100 * STANDARD_VECTOR_SIZE;
+
 public:
 	void Sink(ExecutionContext &context, GlobalOperatorState &state, LocalSinkState &lstate, DataChunk &input) override;
-	void Finalize(ClientContext &context, unique_ptr<GlobalOperatorState> state) override;
+	void Combine(ExecutionContext &context, GlobalOperatorState &gstate, LocalSinkState &lstate) override;
 	unique_ptr<GlobalOperatorState> GetGlobalState(ClientContext &context) override;
+	unique_ptr<LocalSinkState> GetLocalSinkState(ExecutionContext &context) override;
 
 	void GetChunkInternal(ExecutionContext &context, DataChunk &chunk, PhysicalOperatorState *state) override;
 	unique_ptr<PhysicalOperatorState> GetOperatorState() override;
@@ -20,6 +20,7 @@
 
 namespace duckdb {
 struct CopyInfo;
+class ParallelCSVReader;
 
 //! The shifts array allows for linear searching of multi-byte values. For each position, it determines the next
 //! position given that we encounter a byte with the given value.
@@ -85,6 +86,7 @@ class BufferedCSVReader {
 public:
 	BufferedCSVReader(ClientContext &context, BufferedCSVReaderOptions options, vector<SQLType> requested_types = vector<SQLType>());
 	BufferedCSVReader(BufferedCSVReaderOptions options, vector<SQLType> requested_types, unique_ptr<std::istream> source);
+	~BufferedCSVReader();
 
     BufferedCSVReaderOptions options;
 	vector<SQLType> sql_types;
@@ -114,9 +116,30 @@ public:
 
 	DataChunk parse_chunk;
 
+	//! The file offset of the first byte in the buffer
+	idx_t buffer_offset = 0;
+	//! Only rows that start before this file offset are parsed
+	idx_t range_end = INVALID_INDEX;
+	//! Whether or not we have decided if the file is parsed in parallel (this happens when the first chunk is parsed)
+	bool parallel_checked = false;
+	//! The reader used to parse the file in parallel (if any)
+	unique_ptr<ParallelCSVReader> parallel_reader;
+
 public:
 	//! Extract a single DataChunk from the CSV file and stores it in insert_chunk
 	void ParseCSV(DataChunk &insert_chunk);
+	//! Extract a single DataChunk from the CSV file and stores it in insert_chunk, the file is parsed in parallel if
+	//! possible. The parallel parse is only started when the first chunk is requested, not when the reader is created
+	//! (e.g. while binding a query that is never executed)
+	void ParseCSV(ClientContext &context, DataChunk &insert_chunk);
+	//! Restrict the reader to the rows that start in the byte range [range_start, range_end) of the file. If
+	//! exact_start is false, range_start is not necessarily the start of a row: the first row then starts after the
+	//! first newline at or after range_start - 1.
+	void SetRange(idx_t range_start, idx_t range_end, bool exact_start);
+	//! Returns the file offset of the next row that will be parsed
+	idx_t GetPosition() {
+		return buffer_offset + position;
+	}
 
 private:
 	//! Initialize Parser
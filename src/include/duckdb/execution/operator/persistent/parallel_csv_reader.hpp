@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// duckdb/execution/operator/persistent/parallel_csv_reader.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/types/chunk_collection.hpp"
+#include "duckdb/execution/operator/persistent/buffered_csv_reader.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
+namespace duckdb {
+class TaskScheduler;
+struct ProducerToken;
+
+//! A byte range of a CSV file that is parsed by a single task
+struct CSVRange {
+	CSVRange(idx_t range_start, idx_t range_end, bool exact_start)
+	    : range_start(range_start), range_end(range_end), exact_start(exact_start), row_start(0), row_end(0),
+	      finished(false) {
+	}
+
+	//! The byte range of the file; the range contains the rows that start in [range_start, range_end)
+	idx_t range_start;
+	idx_t range_end;
+	//! Whether or not range_start is known to be the start of a row
+	bool exact_start;
+	//! The file offset of the first row that was parsed
+	idx_t row_start;
+	//! The file offset directly after the last row that was parsed
+	idx_t row_end;
+	//! The parsed and converted rows of the range
+	ChunkCollection chunks;
+	//! The error that occurred while parsing the range (if any)
+	string error;
+	//! Whether or not the task parsing this range has finished (protected by the lock of the reader)
+	bool finished;
+};
+
+//! The ParallelCSVReader reads an uncompressed CSV file by splitting it into byte ranges that are parsed and converted
+//! by tasks of the task scheduler. The start of a row in the middle of the file cannot be determined without parsing
+//! the file up to that point (a newline might be part of a quoted value), so every range speculatively starts after
+//! the first newline in the range. When the ranges are consumed in order, the start of every range is verified
+//! against the end of the last row of the previous range, and ranges that started at the wrong position are parsed
+//! again from the correct position. The chunks are returned in the order of the file.
+class ParallelCSVReader {
+	//! The size of the byte range parsed by a single task
+	static constexpr idx_t RANGE_SIZE = 8 * 1024 * 1024;
+	//! The size of the byte ranges with force_parallelism enabled
+	static constexpr idx_t FORCE_PARALLELISM_RANGE_SIZE = 1024;
+	//! The maximum amount of ranges that are scheduled per thread at any time
+	static constexpr idx_t RANGES_PER_THREAD = 2;
+
+public:
+	//! Creates a parallel reader for the rest of the file of the (fully initialized) reader
+	ParallelCSVReader(ClientContext &context, BufferedCSVReader &reader);
+	~ParallelCSVReader();
+
+	//! Whether or not the file of the reader can (and should) be read in parallel
+	static bool CanParallelize(ClientContext &context, BufferedCSVReader &reader);
+
+	//! Extract a single DataChunk from the CSV file and stores it in insert_chunk
+	void ParseCSV(DataChunk &insert_chunk);
+	//! Parse the specified range of the file, storing any error that occurs in the range
+	void ParseRange(CSVRange &range);
+	//! Mark the task of the range as finished and wake up any thread waiting for it
+	void FinishRange(CSVRange &range);
+
+private:
+	//! Parse the specified range of the file, linenr is the amount of lines before the range
+	void ReadRange(CSVRange &range, idx_t linenr);
+	//! Schedule tasks for ranges until the maximum amount of ranges is in flight
+	void ScheduleRanges();
+	//! Wait until the condition holds, executing tasks of this reader while waiting. Once no tasks of this reader
+	//! are left to execute, the remaining tasks are being executed by other threads and we block until they finish.
+	void WaitForTasks(const std::function<bool()> &condition);
+
+	TaskScheduler &scheduler;
+	//! The producer token of the tasks of this reader
+	unique_ptr<ProducerToken> producer;
+	//! The options of the CSV file
+	BufferedCSVReaderOptions options;
+	//! The types of the columns
+	vector<SQLType> sql_types;
+	vector<TypeId> internal_types;
+	//! The size of the file
+	idx_t file_size;
+	//! The size of the ranges
+	idx_t range_size;
+	//! The maximum amount of ranges in flight
+	idx_t max_ranges;
+	//! The start of the next range that has to be scheduled
+	idx_t next_range_start;
+	//! The ranges that have been scheduled, in the order of the file
+	std::deque<unique_ptr<CSVRange>> ranges;
+	//! Lock protecting the finished flags of the ranges and the amount of pending tasks
+	mutex lock;
+	//! Signaled whenever a task of this reader finishes
+	std::condition_variable task_finished;
+	//! The amount of tasks that have been scheduled but have not finished yet
+	idx_t pending_tasks;
+
+	//! The range that is currently being returned
+	unique_ptr<CSVRange> current_range;
+	//! The next chunk of the current range to return
+	idx_t chunk_index;
+	//! The file offset at which the next range has to start (i.e. directly after the last row of the previous range)
+	idx_t expected_row_start;
+	//! The amount of lines before the next range (used for error messages)
+	idx_t linenr;
+};
+
+} // namespace duckdb
@@ -9,8 +9,20 @@
 #pragma once
 
 #include "duckdb/execution/physical_operator.hpp"
+#include "duckdb/parallel/task_context.hpp"
 
 namespace duckdb {
+
+//! Task info restricting a task of a parallel pipeline to a single child of a union
+class UnionTaskInfo : public OperatorTaskInfo {
+public:
+	UnionTaskInfo(idx_t child_idx) : child_idx(child_idx) {
+	}
+
+	//! The child of the union that is executed by the task
+	idx_t child_idx;
+};
+
 class PhysicalUnion : public PhysicalOperator {
 public:
 	PhysicalUnion(vector<TypeId> types, unique_ptr<PhysicalOperator> top, unique_ptr<PhysicalOperator> bottom);
@@ -98,7 +98,8 @@ public:
 	}
 
 	//! Provides an interface for parallel scans of this operator. For every OperatorTaskInfo returned, one task is
-	//! created. The OperatorTaskInfo can be accessed as part of the TaskContext during execution.
+	//! created. The OperatorTaskInfo can be accessed as part of the TaskContext during execution. If no
+	//! OperatorTaskInfo is returned (the default), the operator is scanned by a single task.
 	virtual void ParallelScanInfo(ClientContext &context, std::function<void(unique_ptr<OperatorTaskInfo>)> callback);
 };
 
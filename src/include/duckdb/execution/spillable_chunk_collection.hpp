@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// duckdb/execution/spillable_chunk_collection.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/common.hpp"
+#include "duckdb/common/types/chunk_collection.hpp"
+#include "duckdb/storage/storage_info.hpp"
+
+namespace duckdb {
+class BufferManager;
+
+//! A SpillableChunkCollection is an append-only set of chunks that are serialized into buffers obtained from the
+//! buffer manager, so they can be offloaded to the temporary directory when they exceed the memory limit. Chunks with
+//! types that cannot be serialized are kept in memory instead.
+class SpillableChunkCollection {
+	struct SpilledChunk {
+		idx_t block_idx;
+		idx_t offset;
+		idx_t size;
+	};
+
+public:
+	SpillableChunkCollection(BufferManager &buffer_manager, vector<TypeId> types);
+	~SpillableChunkCollection();
+
+	BufferManager &buffer_manager;
+	//! The types of the chunks
+	vector<TypeId> types;
+	//! The total amount of rows in the collection
+	idx_t count;
+
+public:
+	//! Append a chunk to the collection
+	void Append(DataChunk &input);
+	//! The amount of chunks that can be loaded from the collection
+	idx_t ChunkCount() {
+		return chunks.size() + buffer.chunks.size();
+	}
+	//! Load the chunk with the specified index, the result references the loaded data
+	void LoadChunk(idx_t chunk_idx, DataChunk &result);
+
+private:
+	//! Write the rows that are buffered in memory to the buffers
+	void Flush();
+
+private:
+	//! Whether or not the chunks can be serialized
+	bool can_spill;
+	//! Rows that have been appended but not yet written to the buffers
+	ChunkCollection buffer;
+	//! The buffers holding the serialized chunks
+	vector<block_id_t> blocks;
+	//! The offset within the last buffer to write to
+	idx_t block_offset;
+	//! The serialized chunks
+	vector<SpilledChunk> chunks;
+};
+
+} // namespace duckdb
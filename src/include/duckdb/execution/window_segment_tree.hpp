@@ -17,16 +17,20 @@ namespace duckdb {
 class WindowSegmentTree {
 public:
 	WindowSegmentTree(AggregateFunction &aggregate, TypeId result_type, ChunkCollection *input);
-	Value Compute(idx_t start, idx_t end);
+	//! Computes the aggregates of the frames [begins[i], ends[i]) into the result vector, empty frames result in NULL
+	void Compute(Vector &result, const idx_t *begins, const idx_t *ends, idx_t count);
 
 private:
 	void ConstructTree();
 	void WindowSegmentValue(idx_t l_idx, idx_t begin, idx_t end);
 	void AggregateInit();
-	Value AggegateFinal();
+	//! Aggregates the frame [begin, end) into the state
+	void ComputeState(idx_t begin, idx_t end);
 
 	AggregateFunction aggregate;
 	vector<data_t> state;
+	//! The states of a batch of frames that are finalized together
+	vector<data_t> batch_states;
 	DataChunk inputs;
 	StandaloneVector statep;
 	TypeId result_type;
@@ -11,6 +11,7 @@
 #include "duckdb/common/types/data_chunk.hpp"
 #include "duckdb/common/unordered_set.hpp"
 #include "duckdb/parser/column_definition.hpp"
+#include "duckdb/planner/table_filter.hpp"
 
 namespace duckdb {
 class CatalogEntry;
@@ -43,6 +44,10 @@ struct TableFunctionData : public FunctionData {
 	}
 	// used to pass on projections to table functions that support them. NB, can contain COLUMN_IDENTIFIER_ROW_ID
 	vector<idx_t> column_ids;
+	// used to pass on filters to table functions that support filter pushdown, column_index refers to the column of
+	// the function (not the projected column). The filters are still evaluated on the output of the function: they can
+	// only be used to skip data that cannot match
+	vector<TableFilter> table_filters;
 };
 
 //! Function is the base class used for any type of function (scalar, aggregate or simple function)
@@ -20,6 +20,10 @@ struct PragmaTableInfo {
 	static void RegisterFunction(BuiltinFunctions &set);
 };
 
+struct PragmaStorageInfo {
+	static void RegisterFunction(BuiltinFunctions &set);
+};
+
 struct SQLiteMaster {
 	static void RegisterFunction(BuiltinFunctions &set);
 };
@@ -10,7 +10,10 @@
 
 #include "duckdb/function/function.hpp"
 
+#include <functional>
+
 namespace duckdb {
+class OperatorTaskInfo;
 
 //! Function used for determining the return type of a table producing function
 typedef unique_ptr<FunctionData> (*table_function_bind_t)(ClientContext &context, vector<Value> inputs,
@@ -20,6 +23,14 @@ typedef void (*table_function_t)(ClientContext &context, vector<Value> &input, D
                                  FunctionData *dataptr);
 //! Type used for final (cleanup) function
 typedef void (*table_function_final_t)(ClientContext &context, FunctionData *dataptr);
+//! Function used to split up a table function into parts that can be scanned in parallel. The callback is invoked once
+//! for every part, every part is scanned by a separate task using the parallel function.
+typedef void (*table_function_parallel_tasks_t)(ClientContext &context, vector<Value> &input, FunctionData *dataptr,
+                                                std::function<void(unique_ptr<OperatorTaskInfo>)> callback);
+//! Type used for scanning a single part of a table function that was split up using the parallel tasks function. The
+//! task info is the part created by the parallel tasks function, and can be used to keep state between calls.
+typedef void (*table_function_parallel_t)(ClientContext &context, vector<Value> &input, DataChunk &output,
+                                          FunctionData *dataptr, OperatorTaskInfo &task_info);
 
 class TableFunction : public SimpleFunction {
 public:
@@ -41,6 +52,12 @@ public:
 	table_function_final_t final;
 	//! Whether or not the table function supports projection
 	bool supports_projection;
+	//! (Optional) function that splits up the table function into parts that can be scanned in parallel
+	table_function_parallel_tasks_t parallel_tasks = nullptr;
+	//! (Optional) function that scans a single part of the table function, required if parallel_tasks is set
+	table_function_parallel_t parallel_function = nullptr;
+	//! Whether or not the table function can use filters on its columns to skip data (see TableFunctionData)
+	bool filter_pushdown = false;
 
 	string ToString() {
 		return Function::CallToString(name, arguments);
@@ -29,6 +29,15 @@ public:
 	AccessMode access_mode = AccessMode::AUTOMATIC;
 	// Checkpoint when WAL reaches this size
 	idx_t checkpoint_wal_size = 1 << 20;
+	//! The time (in microseconds) a commit waits for concurrent commits, so their WAL entries can be synced to disk
+	//! together. Only used if other transactions are active. Default: 0 (concurrent commits are still grouped while
+	//! a sync is in progress)
+	idx_t group_commit_delay = 0;
+	//! Whether or not checkpoints remove the deleted rows of tables in which at least auto_vacuum_threshold of the
+	//! rows are deleted
+	bool auto_vacuum = false;
+	//! The fraction of deleted rows at which a checkpoint vacuums a table (if auto_vacuum is enabled)
+	double auto_vacuum_threshold = 0.2;
 	//! Whether or not to use Direct IO, bypassing operating system buffers
 	bool use_direct_io = false;
 	//! The FileSystem to use, can be overwritten to allow for injecting custom file systems for testing purposes (e.g.
@@ -51,10 +60,6 @@ public:
 
 public:
 	static DBConfig &GetConfig(ClientContext &context);
-
-private:
-	// FIXME: don't set this as a user: used internally (only for now)
-	bool checkpoint_only = false;
 };
 
 } // namespace duckdb
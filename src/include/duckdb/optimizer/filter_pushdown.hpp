@@ -53,6 +53,8 @@ private:
 	unique_ptr<LogicalOperator> PushdownSetOperation(unique_ptr<LogicalOperator> op);
 	//! Push down a LogicalGet op
 	unique_ptr<LogicalOperator> PushdownGet(unique_ptr<LogicalOperator> op);
+	//! Push down a LogicalTableFunction op
+	unique_ptr<LogicalOperator> PushdownTableFunction(unique_ptr<LogicalOperator> op);
 	// Pushdown an inner join
 	unique_ptr<LogicalOperator> PushdownInnerJoin(unique_ptr<LogicalOperator> op, unordered_set<idx_t> &left_bindings,
 	                                              unordered_set<idx_t> &right_bindings);
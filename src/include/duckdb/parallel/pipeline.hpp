@@ -70,6 +70,9 @@ private:
 
 private:
 	void ScheduleSequentialTask();
+	//! Gathers the parallel tasks of the operator chain starting at op. Returns false if the chain cannot be executed
+	//! in parallel.
+	bool GetParallelTasks(PhysicalOperator *op, vector<TaskContext> &tasks);
 	bool ScheduleOperator(PhysicalOperator *op);
 };
 
@@ -14,23 +14,28 @@
 #include "duckdb/common/vector.hpp"
 #include "duckdb/parallel/task.hpp"
 
+#include <atomic>
+
 namespace duckdb {
 
-struct ConcurrentQueue;
-struct QueueProducerToken;
+struct WorkerQueue;
+struct WorkerSemaphore;
 class ClientContext;
 class TaskScheduler;
 
 struct ProducerToken {
-	ProducerToken(TaskScheduler &scheduler, unique_ptr<QueueProducerToken> token);
+	ProducerToken(TaskScheduler &scheduler);
 	~ProducerToken();
 
 	TaskScheduler &scheduler;
-	unique_ptr<QueueProducerToken> token;
-	std::mutex producer_lock;
+	//! The amount of tasks of this producer that are scheduled but have not been dequeued yet
+	std::atomic<idx_t> pending_tasks;
 };
 
-//! The TaskScheduler is responsible for managing tasks and threads
+//! The TaskScheduler is responsible for managing tasks and threads. Every worker thread owns a task queue: tasks
+//! scheduled from within a worker are pushed onto the queue of that worker, tasks scheduled from outside are
+//! distributed over the queues. Workers execute the most recently pushed task of their own queue first and steal the
+//! oldest task from the queues of other workers (preferring workers on the same NUMA node) when their queue is empty.
 class TaskScheduler {
 	// timeout for semaphore wait, default 50ms
 	constexpr static int64_t TASK_TIMEOUT_USECS = 50000;
@@ -44,24 +49,43 @@ public:
 	unique_ptr<ProducerToken> CreateProducer();
 	//! Schedule a task to be executed by the task scheduler
 	void ScheduleTask(ProducerToken &producer, unique_ptr<Task> task);
-	//! Fetches a task from a specific producer, returns true if successful or false if no tasks were available
+	//! Fetches a task from a specific producer, returns true if successful or false if no tasks were available. This
+	//! allows the thread that created the producer to help execute its tasks while waiting for them to finish.
 	bool GetTaskFromProducer(ProducerToken &token, unique_ptr<Task> &task);
 	//! Run tasks forever until "marker" is set to false, "marker" must remain valid until the thread is joined
-	void ExecuteForever(bool *marker);
+	void ExecuteForever(idx_t worker_id, bool *marker);
 
 	//! Sets the amount of active threads executing tasks for the system; n-1 background threads will be launched.
 	//! The main thread will also be used for execution
 	void SetThreads(int32_t n);
 	//! Returns the number of threads
 	int32_t NumberOfThreads();
+	//! Sets whether or not the background threads are pinned to a single core each
+	void SetThreadPinning(bool pin_threads);
 
 private:
-	//! The task queue
-	unique_ptr<ConcurrentQueue> queue;
+	//! Pop a task from the queue of the specified worker, or steal one from the queues of other workers
+	bool GetTask(idx_t worker_id, unique_ptr<Task> &task);
+	//! Pin the background thread of the specified worker to its core
+	void PinThread(idx_t worker_id);
+
+	//! The task queues. Queue 0 is used by threads that are not part of the scheduler (e.g. the main thread), queue i
+	//! is owned by background worker i. If there are more workers than queues, workers share queues.
+	vector<unique_ptr<WorkerQueue>> queues;
+	//! For every queue, the order in which the queues of other workers are visited when stealing tasks
+	vector<vector<idx_t>> steal_order;
+	//! The amount of queues that tasks scheduled from outside the scheduler are distributed over
+	std::atomic<idx_t> active_queues;
+	//! The queue that the next task scheduled from outside the scheduler is pushed onto
+	std::atomic<idx_t> next_queue;
+	//! Semaphore used to wake up sleeping workers when tasks are scheduled
+	unique_ptr<WorkerSemaphore> semaphore;
 	//! The active background threads of the task scheduler
 	vector<unique_ptr<thread>> threads;
 	//! Markers used by the various threads, if the markers are set to "false" the thread execution is stopped
 	vector<unique_ptr<bool>> markers;
+	//! Whether or not background threads are pinned to cores
+	bool pin_threads;
 };
 
 } // namespace duckdb
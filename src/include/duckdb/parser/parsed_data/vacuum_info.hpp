@@ -9,11 +9,20 @@
 #pragma once
 
 #include "duckdb/parser/parsed_data/parse_info.hpp"
+#include "duckdb/common/string.hpp"
 
 namespace duckdb {
 
 struct VacuumInfo : public ParseInfo {
-	// nothing for now
+	VacuumInfo() : vacuum(false), schema(INVALID_SCHEMA) {
+	}
+
+	//! Whether or not the deleted rows should be removed (VACUUM), rather than only analyzing the tables (ANALYZE)
+	bool vacuum;
+	//! The schema of the table to vacuum
+	string schema;
+	//! The table to vacuum, or empty to vacuum all tables
+	string table;
 };
 
 } // namespace duckdb
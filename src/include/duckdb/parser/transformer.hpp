@@ -93,6 +93,8 @@ private:
 	unique_ptr<ExplainStatement> TransformExplain(PGNode *node);
 	unique_ptr<VacuumStatement> TransformVacuum(PGNode *node);
 	unique_ptr<PragmaStatement> TransformShow(PGNode *node);
+	//! Transform a Postgres T_PGCheckPointStmt node into a PragmaStatement
+	unique_ptr<PragmaStatement> TransformCheckpoint(PGNode *node);
 
 	unique_ptr<PrepareStatement> TransformPrepare(PGNode *node);
 	unique_ptr<ExecuteStatement> TransformExecute(PGNode *node);
@@ -38,6 +38,8 @@ public:
 	vector<string> names;
 	//! Bound column IDs
 	vector<column_t> column_ids;
+	//! Filters pushed down into the function, only used if the function supports filter pushdown
+	vector<TableFilter> table_filters;
 
 public:
 	vector<ColumnBinding> GetColumnBindings() override;
@@ -37,6 +37,8 @@ struct BoundCreateTableInfo {
 	unordered_set<CatalogEntry *> dependencies;
 	//! The existing table data on disk (if any)
 	unique_ptr<vector<unique_ptr<PersistentSegment>>[]> data;
+	//! The rows of the existing table data that are deleted
+	vector<row_t> deleted_rows;
 	//! CREATE TABLE from QUERY
 	unique_ptr<LogicalOperator> query;
 
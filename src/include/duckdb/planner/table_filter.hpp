@@ -0,0 +1,27 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// duckdb/planner/table_filter.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/common/common.hpp"
+#include "duckdb/common/enums/expression_type.hpp"
+#include "duckdb/common/types/value.hpp"
+
+namespace duckdb {
+
+//! TableFilter represents a filter pushed down into the table scan.
+class TableFilter {
+public:
+	TableFilter(Value constant, ExpressionType comparison_type, idx_t column_index)
+	    : constant(constant), comparison_type(comparison_type), column_index(column_index){};
+	Value constant;
+	ExpressionType comparison_type;
+	idx_t column_index;
+};
+
+} // namespace duckdb
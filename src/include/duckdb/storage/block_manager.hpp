@@ -9,6 +9,7 @@
 #pragma once
 
 #include "duckdb/common/common.hpp"
+#include "duckdb/common/vector.hpp"
 #include "duckdb/storage/block.hpp"
 #include "duckdb/storage/storage_info.hpp"
 
@@ -24,6 +25,11 @@ public:
 	virtual unique_ptr<Block> CreateBlock() = 0;
 	//! Return the next free block id
 	virtual block_id_t GetFreeBlockId() = 0;
+	//! Mark a block of the current storage as used by the checkpoint that is being written, i.e. the checkpoint
+	//! keeps the block as-is instead of rewriting its contents
+	virtual void MarkBlockAsUsed(block_id_t block_id) = 0;
+	//! Returns the blocks that are free after the last checkpoint
+	virtual vector<block_id_t> GetFreeBlocks() = 0;
 	//! Get the first meta block id
 	virtual block_id_t GetMetaBlock() = 0;
 	//! Read the content of the block from disk
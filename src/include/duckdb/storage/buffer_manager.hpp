@@ -37,10 +37,21 @@ public:
 	unique_ptr<BufferHandle> Allocate(idx_t alloc_size, bool can_destroy = false);
 	//! Destroy the managed buffer with the specified buffer_id, freeing its memory
 	void DestroyBuffer(block_id_t buffer_id, bool can_destroy = false);
+	//! Remove a block of the database file from the buffer manager (if it is loaded), e.g. because it was freed by a
+	//! checkpoint and its contents can be overwritten. The block cannot be pinned.
+	void UnloadBlock(block_id_t block_id);
 
 	//! Set a new memory limit to the buffer manager, throws an exception if the new limit is too low and not enough
 	//! blocks can be evicted
 	void SetLimit(idx_t limit = (idx_t)-1);
+	//! Returns the maximum amount of memory that the buffer manager can keep (in bytes)
+	idx_t GetMaxMemory() {
+		return maximum_memory;
+	}
+	//! Whether or not unpinned buffers can be offloaded to the temporary directory when the memory limit is reached
+	bool HasTemporaryDirectory() {
+		return !temp_directory.empty();
+	}
 
 	static BufferManager &GetBufferManager(ClientContext &context);
 
@@ -13,7 +13,9 @@
 
 namespace duckdb {
 class UncompressedSegment;
+class PersistentSegment;
 class SegmentStatistics;
+class HyperLogLog;
 
 //! The table data writer is responsible for writing the data of a table to the block manager
 class TableDataWriter {
@@ -21,16 +23,26 @@ public:
 	TableDataWriter(CheckpointManager &manager, TableCatalogEntry &table);
 	~TableDataWriter();
 
-	void WriteTableData(Transaction &transaction);
+	//! Write the data of the table. If vacuum is set, the deleted rows of the table are not written.
+	void WriteTableData(Transaction &transaction, bool vacuum);
+	//! Replace the data of the table with the segments written by WriteTableData, after the checkpoint is complete
+	void CommitTableData();
 
-private:
+	//! Append a vector of data to the segment of the column that is currently written
 	void AppendData(Transaction &transaction, idx_t col_idx, Vector &data, idx_t count);
+	//! Keep a persistent segment that was not changed since the last checkpoint, instead of writing it again
+	void ReuseSegment(Transaction &transaction, idx_t col_idx, PersistentSegment &segment);
 
+private:
 	void CreateSegment(idx_t col_idx);
+	//! Adds the (non-NULL) values appended to the current segment of the column to its distinct counter
+	void UpdateDistinctCount(idx_t col_idx, Vector &data, idx_t offset, idx_t count);
 	void FlushSegment(Transaction &transaction, idx_t col_idx);
 
 	void WriteDataPointers();
 	void VerifyDataPointers();
+	//! Write the rows of the table that are deleted, as a bitmask for every vector that has deleted rows
+	void WriteDeletedRows(const vector<row_t> &deleted_rows);
 
 private:
 	CheckpointManager &manager;
@@ -38,8 +50,12 @@ private:
 
 	vector<unique_ptr<UncompressedSegment>> segments;
 	vector<unique_ptr<SegmentStatistics>> stats;
+	//! Estimates the amount of distinct values in the current segment of each column
+	vector<unique_ptr<HyperLogLog>> distinct_counters;
 
 	vector<vector<DataPointer>> data_pointers;
+	//! Whether or not the deleted rows were left out of the written data
+	bool vacuumed;
 };
 
 } // namespace duckdb
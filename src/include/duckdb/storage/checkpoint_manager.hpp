@@ -12,6 +12,7 @@
 #include "duckdb/common/types/chunk_collection.hpp"
 #include "duckdb/storage/storage_manager.hpp"
 #include "duckdb/storage/meta_block_writer.hpp"
+#include "duckdb/storage/table/column_segment.hpp"
 
 namespace duckdb {
 class ClientContext;
@@ -19,6 +20,7 @@ class MetaBlockReader;
 class SchemaCatalogEntry;
 class SequenceCatalogEntry;
 class TableCatalogEntry;
+class TableDataWriter;
 class ViewCatalogEntry;
 
 class DataPointer {
@@ -30,20 +32,25 @@ public:
 	uint64_t tuple_count;
 	block_id_t block_id;
 	uint32_t offset;
-	//! The minimum value of the segment
-	data_t min_stats[16];
-	//! The maximum value of the segment
-	data_t max_stats[16];
+	//! Whether or not the block is compressed: a CompressedSegment, or a StringSegment with a deduplicated dictionary
+	bool compressed;
+	//! The statistics of the segment
+	unique_ptr<SegmentStatistics> statistics;
+	//! The blocks holding the overflow strings of the segment (if any)
+	vector<block_id_t> overflow_blocks;
 };
 
 //! CheckpointManager is responsible for checkpointing the database
 class CheckpointManager {
 public:
 	CheckpointManager(StorageManager &manager);
+	~CheckpointManager();
 
-	//! Checkpoint the current state of the WAL and flush it to the main storage. This should be called BEFORE any
-	//! connction is available because right now the checkpointing cannot be done online. (TODO)
-	void CreateCheckpoint();
+	//! Write all data visible to the transaction to a new checkpoint and make it the current state of the database.
+	//! Persistent segments that were not changed since the previous checkpoint are reused. The transaction should be
+	//! the only active transaction, since the in-memory table data is replaced by the checkpointed data. If vacuum is
+	//! set, the deleted rows of vacuum_table (or of all tables if it is not set) are removed from the written data.
+	void CreateCheckpoint(Transaction &transaction, bool vacuum = false, TableCatalogEntry *vacuum_table = nullptr);
 	//! Load from a stored checkpoint
 	void LoadFromStorage();
 
@@ -59,6 +66,17 @@ public:
 	unique_ptr<MetaBlockWriter> tabledata_writer;
 
 private:
+	//! The writers of the table data, that are used to swap in the written data once the checkpoint is complete
+	vector<unique_ptr<TableDataWriter>> table_writers;
+	//! Whether or not the checkpoint vacuums the tables
+	bool vacuum;
+	//! The table to vacuum, or nullptr to vacuum all tables
+	TableCatalogEntry *vacuum_table;
+
+private:
+	//! Whether or not the deleted rows of the table should be removed when writing it, either because it is vacuumed
+	//! explicitly or because auto_vacuum is enabled and enough of its rows are deleted
+	bool ShouldVacuum(TableCatalogEntry &table);
 	void WriteSchema(Transaction &transaction, SchemaCatalogEntry &schema);
 	void WriteTable(Transaction &transaction, TableCatalogEntry &table);
 	void WriteView(ViewCatalogEntry &table);
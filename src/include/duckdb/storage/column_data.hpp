@@ -14,7 +14,9 @@
 #include "duckdb/storage/table/persistent_segment.hpp"
 
 namespace duckdb {
+class DataTable;
 class PersistentSegment;
+class TableDataWriter;
 class Transaction;
 
 struct DataTableInfo;
@@ -59,14 +61,23 @@ public:
 	//! Revert a set of appends to the ColumnData
 	void RevertAppend(row_t start_row);
 
-	//! Update the specified row identifiers
-	void Update(Transaction &transaction, Vector &updates, Vector &row_ids, idx_t count);
+	//! Update the specified (sorted) row identifiers. The updates are applied one vector at a time.
+	void Update(Transaction &transaction, Vector &updates, row_t *ids, idx_t count);
 
 	//! Fetch the vector from the column data that belongs to this specific row
 	void Fetch(ColumnScanState &state, row_t row_id, Vector &result);
 	//! Fetch a specific row id and append it to the vector
 	void FetchRow(ColumnFetchState &state, Transaction &transaction, row_t row_id, Vector &result, idx_t result_idx);
 
+	//! Write the column to the checkpoint as the column with the given index, reusing the persistent segments that
+	//! have not been changed since the last checkpoint. If vacuum_table is set, the rows that are deleted from it are
+	//! not written.
+	void Checkpoint(TableDataWriter &writer, Transaction &transaction, idx_t col_idx, DataTable *vacuum_table);
+	//! Replace the segments of the column with the persistent segments written by the checkpoint
+	void CommitCheckpoint(vector<unique_ptr<PersistentSegment>> &segments);
+	//! Rewrite the column into new transient segments without the rows that are deleted from the table
+	void Vacuum(Transaction &transaction, DataTable &table);
+
 private:
 	//! Append a transient segment
 	void AppendTransientSegment(idx_t start_row);
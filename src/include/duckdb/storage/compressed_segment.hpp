@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// duckdb/storage/compressed_segment.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/storage/numeric_segment.hpp"
+
+namespace duckdb {
+
+//! The compression used for a single vector of a CompressedSegment
+enum class VectorCompression : uint8_t {
+	//! The values are stored as-is
+	UNCOMPRESSED = 0,
+	//! The values are stored as a set of (value, run end) pairs
+	RLE = 1,
+	//! The values are stored as bit-packed offsets from the minimum value of the vector (frame of reference)
+	BITPACKING = 2
+};
+
+//! A CompressedSegment is a numeric segment that is written to disk at checkpoint time with lightweight compression.
+//! Every vector is compressed separately with the smallest of run-length encoding, frame-of-reference bit-packing
+//! (integers only) or no compression, and scans decompress the vectors directly into the result. Vectors that consist
+//! of a single run are scanned as constant vectors. The segment is read-only: when it is updated the data is
+//! decompressed into a regular in-memory NumericSegment buffer.
+/*!
+    The block of a compressed segment looks like this:
+    [VECTOR OFFSETS: uint32_t * MAX_VECTOR_COUNT]
+    [VECTOR 0][VECTOR 1]...
+    Every vector starts at an 8-byte aligned offset with the following layout:
+    [VectorCompression][HAS NULL][PADDING][uint32_t RUN COUNT OR BIT WIDTH]
+    [NULLMASK (only if HAS NULL)]
+    [COMPRESSED VALUES]
+*/
+class CompressedSegment : public NumericSegment {
+public:
+	//! Create a new compressed segment that can be appended to
+	CompressedSegment(BufferManager &manager, TypeId type, idx_t row_start);
+	//! Load a persistent compressed segment from the specified block
+	CompressedSegment(BufferManager &manager, TypeId type, idx_t row_start, block_id_t block_id, idx_t tuple_count);
+
+	//! The maximum amount of vectors stored in a compressed segment
+	static constexpr idx_t MAX_VECTOR_COUNT = 1024;
+
+	//! Whether or not columns of the specified type are stored in compressed segments
+	static bool SupportsType(TypeId type);
+
+public:
+	//! Fetch a single value and append it to the vector
+	void FetchRow(ColumnFetchState &state, Transaction &transaction, row_t row_id, Vector &result,
+	              idx_t result_idx) override;
+
+	//! Append a part of a vector to the compressed segment. The last vector is compressed again every time values
+	//! are appended to it. Returns the amount of tuples appended, if this is less than `count` the segment is full.
+	idx_t Append(SegmentStatistics &stats, Vector &data, idx_t offset, idx_t count) override;
+
+	//! Decompress the segment into a temporary in-memory buffer that can be updated
+	void ToTemporary() override;
+
+protected:
+	void Select(ColumnScanState &state, Vector &result, SelectionVector &sel, idx_t &approved_tuple_count,
+	            vector<TableFilter> &tableFilter) override;
+	void FetchBaseData(ColumnScanState &state, idx_t vector_index, Vector &result) override;
+	void FilterFetchBaseData(ColumnScanState &state, Vector &result, SelectionVector &sel,
+	                         idx_t &approved_tuple_count) override;
+
+public:
+	typedef idx_t (*compress_function_t)(data_ptr_t source, idx_t count, data_ptr_t target);
+	typedef void (*decompress_function_t)(data_ptr_t source, idx_t count, Vector &result, bool emit_constant);
+	typedef void (*decompress_row_function_t)(data_ptr_t source, idx_t row_idx, Vector &result, idx_t result_idx);
+
+private:
+	compress_function_t compress_function;
+	decompress_function_t decompress_function;
+	decompress_row_function_t decompress_row_function;
+
+	//! Whether or not the data is compressed, this is false after the segment is converted into a temporary segment
+	bool compressed;
+	//! The uncompressed data ([NULLMASK][VALUES]) of the vector that is currently being appended to
+	unique_ptr<data_t[]> append_vector;
+	//! The offset in the block where the next vector is written
+	idx_t append_offset;
+
+	void InitializeFunctions();
+	//! Decompress the vector with the specified index from the block into the result vector. If emit_constant is true,
+	//! vectors that consist of a single value are emitted as a constant vector.
+	void DecompressVector(data_ptr_t baseptr, idx_t vector_index, Vector &result, bool emit_constant);
+};
+
+} // namespace duckdb
@@ -10,6 +10,7 @@
 
 #include "duckdb/common/enums/index_type.hpp"
 #include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/planner/table_filter.hpp"
 #include "duckdb/storage/index.hpp"
 #include "duckdb/storage/table_statistics.hpp"
 #include "duckdb/storage/block.hpp"
@@ -28,20 +29,11 @@ class ColumnDefinition;
 class DataTable;
 class StorageManager;
 class TableCatalogEntry;
+class TableDataWriter;
 class Transaction;
 
 typedef unique_ptr<vector<unique_ptr<PersistentSegment>>[]> persistent_data_t;
 
-//! TableFilter represents a filter pushed down into the table scan.
-class TableFilter {
-public:
-	TableFilter(Value constant, ExpressionType comparison_type, idx_t column_index)
-	    : constant(constant), comparison_type(comparison_type), column_index(column_index){};
-	Value constant;
-	ExpressionType comparison_type;
-	idx_t column_index;
-};
-
 struct DataTableInfo {
 	DataTableInfo(string schema, string table) : cardinality(0), schema(move(schema)), table(move(table)) {
 	}
@@ -64,8 +56,10 @@ struct DataTableInfo {
 //! DataTable represents a physical table on disk
 class DataTable {
 public:
-	//! Constructs a new data table from an (optional) set of persistent segments
-	DataTable(StorageManager &storage, string schema, string table, vector<TypeId> types, persistent_data_t data);
+	//! Constructs a new data table from an (optional) set of persistent segments, and the rows of the persistent
+	//! segments that are deleted
+	DataTable(StorageManager &storage, string schema, string table, vector<TypeId> types, persistent_data_t data,
+	          vector<row_t> deleted_rows);
 	//! Constructs a DataTable as a delta on an existing data table with a newly added column
 	DataTable(ClientContext &context, DataTable &parent, ColumnDefinition &new_column, Expression *default_value);
 	//! Constructs a DataTable as a delta on an existing data table but with one column removed
@@ -140,6 +134,26 @@ public:
 	//! Remove the row identifiers from all the indexes of the table
 	void RemoveFromIndexes(Vector &row_identifiers, idx_t count);
 
+	//! Write the data of the table to a checkpoint. If vacuum is set, the deleted rows are left out.
+	void Checkpoint(TableDataWriter &writer, Transaction &transaction, bool vacuum);
+	//! Replace the data of the table with the persistent segments written by a checkpoint. Should only be called when
+	//! no transaction can see older versions of the data.
+	void CommitCheckpoint(persistent_data_t data, bool vacuumed);
+	//! Remove the deleted rows from the (in-memory) table by rewriting it into new transient segments. Should only be
+	//! called when no transaction can see older versions of the data.
+	void Vacuum(Transaction &transaction);
+	//! Returns the (sorted) rows of the table that were deleted by committed transactions
+	vector<row_t> GetDeletedRows();
+	//! Returns the total amount of rows in the table, including deleted rows
+	idx_t GetTotalRows();
+	//! Returns the rows of the vector starting at start_row that are visible to the transaction. If not all rows are
+	//! visible, the selection vector is set to the visible rows.
+	idx_t GetVisibleRows(Transaction &transaction, idx_t start_row, SelectionVector &sel, idx_t count);
+
+	//! Returns one row for every segment of every column of the table: (column_id, segment_id, segment_type, start,
+	//! count, min, max, has_null, has_no_null, null_count, distinct_count)
+	vector<vector<Value>> GetStorageInfo();
+
 	void SetAsRoot() {
 		this->is_root = true;
 	}
@@ -163,6 +177,12 @@ private:
 	bool ScanCreateIndex(CreateIndexScanState &state, const vector<column_t> &column_ids, DataChunk &result,
 	                     idx_t &current_row, idx_t max_row, idx_t base_row);
 
+	//! Removes the rows that were deleted before the last checkpoint from a chunk whose last column holds the row
+	//! identifiers. These rows are not visible to any transaction and have already been removed from all indexes.
+	void RemoveCheckpointedDeletes(DataChunk &chunk);
+	//! Rebuild the indexes of the table after its rows were compacted by a vacuum
+	void RebuildIndexes();
+
 	//! Figure out which of the row ids to use for the given transaction by looking at inserted/deleted data. Returns
 	//! the amount of rows to use and places the row_ids in the result_rows array.
 	idx_t FetchRows(Transaction &transaction, Vector &row_identifiers, idx_t fetch_count, row_t result_rows[]);
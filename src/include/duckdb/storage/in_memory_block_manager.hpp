@@ -26,6 +26,12 @@ public:
 	block_id_t GetFreeBlockId() override {
 		throw Exception("Cannot perform IO in in-memory database!");
 	}
+	void MarkBlockAsUsed(block_id_t block_id) override {
+		throw Exception("Cannot perform IO in in-memory database!");
+	}
+	vector<block_id_t> GetFreeBlocks() override {
+		throw Exception("Cannot perform IO in in-memory database!");
+	}
 	block_id_t GetMetaBlock() override {
 		throw Exception("Cannot perform IO in in-memory database!");
 	}
@@ -42,6 +42,9 @@ public:
 	vector<unique_ptr<Expression>> unbound_expressions;
 	//! The types of the expressions
 	vector<TypeId> types;
+	//! The index holds the most recent committed values of the indexed columns at the time it was created.
+	//! Transactions that started before this timestamp might see older values and cannot use the index.
+	transaction_t start_timestamp = 0;
 
 public:
 	//! Initialize a scan on the index with the given expression and column ids
@@ -73,6 +76,8 @@ public:
 
 	//! Insert data into the index. Does not lock the index.
 	virtual bool Insert(IndexLock &lock, DataChunk &input, Vector &row_identifiers) = 0;
+	//! Remove all entries from the index. The lock obtained from InitializeLock must be held
+	virtual void Clear(IndexLock &lock) = 0;
 
 	//! Returns true if the index is affected by updates on the specified column ids, and false otherwise
 	bool IndexIsUpdated(vector<column_t> &column_ids);
@@ -43,6 +43,10 @@ protected:
 	void FetchUpdateData(ColumnScanState &state, Transaction &transaction, UpdateInfo *versions,
 	                     Vector &result) override;
 
+	//! Executes the filters on a vector of uncompressed values ([NULLMASK] and [VALUES])
+	void SelectData(Vector &result, data_ptr_t source_data, nullmask_t *source_nullmask, SelectionVector &sel,
+	                idx_t &approved_tuple_count, vector<TableFilter> &tableFilter);
+
 public:
 	typedef void (*append_function_t)(SegmentStatistics &stats, data_ptr_t target, idx_t target_offset, Vector &source,
 	                                  idx_t offset, idx_t count);
@@ -54,7 +58,7 @@ public:
 	typedef void (*merge_update_function_t)(SegmentStatistics &stats, UpdateInfo *node, data_ptr_t target,
 	                                        Vector &update, row_t *ids, idx_t count, idx_t vector_offset);
 
-private:
+protected:
 	append_function_t append_function;
 	update_function_t update_function;
 	update_info_fetch_function_t fetch_from_update_info;
@@ -32,6 +32,10 @@ public:
 	unique_ptr<Block> CreateBlock() override;
 	//! Return the next free block id
 	block_id_t GetFreeBlockId() override;
+	//! Mark a block of the current storage as used by the checkpoint
+	void MarkBlockAsUsed(block_id_t block_id) override;
+	//! Returns the blocks that are free after the last checkpoint
+	vector<block_id_t> GetFreeBlocks() override;
 	//! Return the meta block id
 	block_id_t GetMetaBlock() override;
 	//! Read the content of the block from disk
@@ -19,6 +19,7 @@ class Catalog;
 class DuckDB;
 class TransactionManager;
 class TableCatalogEntry;
+class Transaction;
 
 //! StorageManager is responsible for managing the physical storage of the
 //! database on disk
@@ -31,6 +32,10 @@ public:
 
 	//! Initialize a database or load an existing database from the given path
 	void Initialize();
+	//! Write a checkpoint of all data visible to the given transaction, and truncate the WAL. If vacuum is set, the
+	//! deleted rows of vacuum_table (or of all tables if it is not set) are removed as well. Does nothing for
+	//! read-only databases, and only vacuums for in-memory databases.
+	void CreateCheckpoint(Transaction &transaction, bool vacuum = false, TableCatalogEntry *vacuum_table = nullptr);
 	//! Get the WAL of the StorageManager, returns nullptr if in-memory
 	WriteAheadLog *GetWriteAheadLog() {
 		return wal.initialized ? &wal : nullptr;
@@ -53,8 +58,8 @@ public:
 private:
 	//! Load the database from a directory
 	void LoadDatabase();
-	//! Create a checkpoint of the database
-	void Checkpoint(string wal_path);
+	//! Remove the deleted rows from the tables of an in-memory database
+	void VacuumInMemory(Transaction &transaction, TableCatalogEntry *vacuum_table);
 
 	//! The path of the database
 	string path;
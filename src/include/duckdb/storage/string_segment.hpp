@@ -9,6 +9,7 @@
 #pragma once
 
 #include "duckdb/storage/uncompressed_segment.hpp"
+#include "duckdb/common/unordered_map.hpp"
 
 namespace duckdb {
 class OverflowStringWriter {
@@ -38,11 +39,19 @@ struct string_location_t {
 	int32_t offset;
 };
 
+//! The most recent values of the updated strings of a vector, stored column-wise and sized to the amount of updated
+//! strings
 struct StringUpdateInfo {
+	StringUpdateInfo(idx_t capacity)
+	    : count(0), ids(new sel_t[capacity]), block_ids(new block_id_t[capacity]), offsets(new int32_t[capacity]) {
+	}
+
 	sel_t count;
-	sel_t ids[STANDARD_VECTOR_SIZE];
-	block_id_t block_ids[STANDARD_VECTOR_SIZE];
-	int32_t offsets[STANDARD_VECTOR_SIZE];
+	//! The (sorted) offsets of the updated tuples within the vector
+	unique_ptr<sel_t[]> ids;
+	//! The locations of the updated strings
+	unique_ptr<block_id_t[]> block_ids;
+	unique_ptr<int32_t[]> offsets;
 };
 
 typedef unique_ptr<StringUpdateInfo> string_update_info_t;
@@ -54,6 +63,9 @@ public:
 
 	//! The current dictionary offset
 	idx_t dictionary_offset;
+	//! Whether or not the dictionary offset is known. It is not stored for segments that are loaded from disk, and is
+	//! only computed when strings have to be added to the dictionary of such a segment.
+	bool dictionary_offset_known;
 	//! The string block holding strings that do not fit in the main block
 	//! FIXME: this should be replaced by a heap that also allows freeing of unused strings
 	unique_ptr<StringBlock> head;
@@ -61,6 +73,11 @@ public:
 	unique_ptr<string_update_info_t[]> string_updates;
 	//! Overflow string writer (if any), if not set overflow strings will be written to memory blocks
 	unique_ptr<OverflowStringWriter> overflow_writer;
+	//! Map of string -> dictionary offset of the strings stored in the dictionary (if any). If set, strings that are
+	//! appended multiple times are only stored in the dictionary once.
+	unique_ptr<unordered_map<string, int32_t>> string_dictionary;
+	//! Whether or not scans emit dictionary vectors, this is only worth it if identical strings share a dictionary entry
+	bool dictionary_vectors;
 
 public:
 	void InitializeScan(ColumnScanState &state) override;
@@ -91,12 +108,20 @@ protected:
 	void FilterFetchBaseData(ColumnScanState &state, Vector &result, SelectionVector &sel,
 	                         idx_t &approved_tuple_count) override;
 
+	//! Move the updated strings of the vector into the dictionary of the segment, so scans no longer have to merge
+	//! them with the base data
+	void ConsolidateUpdates(idx_t vector_index) override;
+
 private:
 	void AppendData(SegmentStatistics &stats, data_ptr_t target, data_ptr_t end, idx_t target_offset, Vector &source,
 	                idx_t offset, idx_t count);
 
 	//! Fetch all the strings of a vector from the base table and place their locations in the result vector
 	void FetchBaseData(ColumnScanState &state, data_ptr_t base_data, idx_t vector_index, Vector &result, idx_t count);
+	//! Fetch the strings of a vector as a dictionary vector with one entry per distinct dictionary offset. Returns
+	//! false if the vector has too many distinct strings, in which case nothing is fetched.
+	bool FetchDictionaryVector(ColumnScanState &state, data_ptr_t baseptr, idx_t vector_index, Vector &result,
+	                           idx_t count);
 
 	string_location_t FetchStringLocation(data_ptr_t baseptr, int32_t dict_offset);
 	string_t FetchString(buffer_handle_set_t &handles, data_ptr_t baseptr, string_location_t location);
@@ -128,6 +153,9 @@ private:
 	void MergeUpdateInfo(UpdateInfo *node, row_t *ids, idx_t update_count, idx_t vector_offset,
 	                     string_location_t string_locations[], nullmask_t original_nullmask);
 
+	//! Compute the size of the dictionary from the dictionary offsets that are in use
+	idx_t ComputeDictionaryOffset(data_ptr_t baseptr);
+
 	//! The amount of bytes remaining to store in the block
 	idx_t RemainingSpace() {
 		return Storage::BLOCK_SIZE - dictionary_offset - max_vector_count * vector_size;
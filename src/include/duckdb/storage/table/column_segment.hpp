@@ -10,8 +10,10 @@
 
 #include "duckdb/storage/block.hpp"
 #include "duckdb/storage/table/segment_tree.hpp"
+#include "duckdb/common/mutex.hpp"
 #include "duckdb/common/types.hpp"
 #include "duckdb/common/types/vector.hpp"
+#include "duckdb/common/types/value.hpp"
 #include "duckdb/storage/buffer_manager.hpp"
 
 namespace duckdb {
@@ -20,23 +22,39 @@ class ColumnSegment;
 class ColumnData;
 class Transaction;
 class TableFilter;
+class Serializer;
+class Deserializer;
 struct ColumnFetchState;
 struct ColumnScanState;
 enum class ColumnSegmentType : uint8_t { TRANSIENT, PERSISTENT };
-//! TableFilter represents a filter pushed down into the table scan.
 
 class SegmentStatistics {
 public:
 	SegmentStatistics(TypeId type, idx_t type_size);
-	SegmentStatistics(TypeId type, idx_t type_size, data_t stats_min[], data_t stats_max[]);
+	SegmentStatistics(SegmentStatistics &&other);
+
 	TypeId type;
 	idx_t type_size;
-	//! The minimum value of the segment
+	//! The minimum value of the segment, not used for string columns
 	unique_ptr<data_t[]> minimum;
-	//! The maximum value of the segment
+	//! The maximum value of the segment, not used for string columns
 	unique_ptr<data_t[]> maximum;
+	//! Lock protecting min_string and max_string: appends and updates modify them while scans check them
+	mutex string_lock;
+	//! The minimum string of the segment, only used for string columns
+	string min_string;
+	//! The maximum string of the segment, only used for string columns
+	string max_string;
 	//! Whether or not the segment has NULL values
 	bool has_null;
+	//! Whether or not the segment has values that are not NULL. If not, the min/max are not set.
+	bool has_no_null;
+	//! The amount of NULL values in the segment. Updates that set values to NULL increase it, but updates that
+	//! overwrite NULL values do not decrease it: it is an upper bound.
+	idx_t null_count;
+	//! The estimated amount of distinct values in the segment, computed when the segment is written to disk (0 if
+	//! unknown)
+	idx_t distinct_count;
 	//! The maximum string length, only used for string columns
 	idx_t max_string_length;
 	//! Whether or not the segment contains any big strings in overflow blocks, only used for string columns
@@ -44,6 +62,22 @@ public:
 
 public:
 	void Reset();
+	//! Update the min/max of a string column with a (non-NULL) string
+	void UpdateStringMinMax(string_t value);
+	//! Returns false if none of the rows of the segment can pass the filter, i.e. if the segment can be skipped
+	bool CheckFilter(TableFilter &filter);
+
+	//! Returns the minimum value of the segment, or a NULL value if it has no values that are not NULL
+	Value GetMinimum();
+	//! Returns the maximum value of the segment, or a NULL value if it has no values that are not NULL
+	Value GetMaximum();
+
+	//! Returns a copy of the statistics
+	unique_ptr<SegmentStatistics> Copy();
+	//! Serializes the statistics to a stand-alone binary blob
+	void Serialize(Serializer &serializer);
+	//! Deserializes the statistics of a segment of the given type
+	static unique_ptr<SegmentStatistics> Deserialize(Deserializer &source, TypeId type);
 };
 
 class ColumnSegment : public SegmentBase {
@@ -51,8 +85,8 @@ public:
 	//! Initialize an empty column segment of the specified type
 	ColumnSegment(TypeId type, ColumnSegmentType segment_type, idx_t start, idx_t count = 0);
 
-	ColumnSegment(TypeId type, ColumnSegmentType segment_type, idx_t start, idx_t count, data_t stats_min[],
-	              data_t stats_max[]);
+	ColumnSegment(TypeId type, ColumnSegmentType segment_type, idx_t start, idx_t count,
+	              unique_ptr<SegmentStatistics> statistics);
 
 	virtual ~ColumnSegment() = default;
 
@@ -18,7 +18,7 @@ namespace duckdb {
 class PersistentSegment : public ColumnSegment {
 public:
 	PersistentSegment(BufferManager &manager, block_id_t id, idx_t offset, TypeId type, idx_t start, idx_t count,
-	                  data_t stats_min[], data_t stats_max[]);
+	                  unique_ptr<SegmentStatistics> statistics, bool compressed = false);
 
 	//! The buffer manager
 	BufferManager &manager;
@@ -26,6 +26,10 @@ public:
 	block_id_t block_id;
 	//! The offset into the block
 	idx_t offset;
+	//! Whether or not the block is compressed
+	bool compressed;
+	//! The blocks holding the overflow strings of the segment (if any)
+	vector<block_id_t> overflow_blocks;
 	//! The uncompressed segment that the data of the persistent segment is loaded into
 	unique_ptr<UncompressedSegment> data;
 
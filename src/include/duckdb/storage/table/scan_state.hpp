@@ -43,6 +43,8 @@ struct ColumnScanState {
 	buffer_handle_set_t handles;
 	//! The locks that are held during the scan, only used by the index scan
 	vector<unique_ptr<StorageLockKey>> locks;
+	//! The highest commit id of the committed updates that were read by the index scan
+	transaction_t max_update_id = 0;
 	//! Whether or not InitializeState has been called for this segment
 	bool initialized;
 	//! If this segment has already been checked for skipping puorposes
@@ -92,6 +94,8 @@ struct TableIndexScanState {
 	ColumnFetchState fetch_state;
 	LocalScanState local_state;
 	vector<column_t> column_ids;
+	//! The regular table scan that is used instead of the index if the index cannot be used by the transaction
+	unique_ptr<TableScanState> table_scan;
 };
 
 } // namespace duckdb
@@ -54,6 +54,14 @@ public:
 	//! Revert a set of appends made to the version manager from the rows [row_start] until [row_end]
 	void RevertAppend(row_t row_start, row_t row_end);
 
+	//! Appends the rows that were deleted by committed transactions to the result (as table row identifiers)
+	void GetDeletedRows(vector<row_t> &result);
+	//! Marks the given rows as deleted for every transaction, used for rows that were deleted before the last
+	//! checkpoint
+	void SetDeletedRows(const vector<row_t> &rows);
+	//! Whether or not the row was deleted before the last checkpoint, i.e. it is not visible to any transaction
+	bool DeletedBeforeCheckpoint(idx_t row);
+
 private:
 	ChunkInsertInfo *GetInsertInfo(idx_t chunk_idx);
 };
@@ -55,7 +55,7 @@ public:
 	void FilterScan(Transaction &transaction, ColumnScanState &state, Vector &result, SelectionVector &sel,
 	                idx_t &approved_tuple_count);
 	//! Fetch the vector at index "vector_index" from the uncompressed segment, throwing an exception if there are any
-	//! outstanding updates
+	//! uncommitted updates
 	void IndexScan(ColumnScanState &state, idx_t vector_index, Vector &result);
 	static void filterSelection(SelectionVector &sel, Vector &result, TableFilter filter, idx_t &approved_tuple_count,
 	                            nullmask_t &nullmask);
@@ -85,7 +85,7 @@ public:
 
 	//! Convert a persistently backed uncompressed segment (i.e. one where block_id refers to an on-disk block) to a
 	//! temporary in-memory one
-	void ToTemporary();
+	virtual void ToTemporary();
 
 	//! Get the amount of tuples in a vector
 	idx_t GetVectorCount(idx_t vector_index) {
@@ -111,6 +111,11 @@ protected:
 	virtual void FetchUpdateData(ColumnScanState &state, Transaction &transaction, UpdateInfo *version,
 	                             Vector &result) = 0;
 
+	//! Called when the version chain of a vector becomes empty, i.e. when no transaction can see older values of the
+	//! vector anymore. Should only be called if an exclusive lock is held on the segment.
+	virtual void ConsolidateUpdates(idx_t vector_index) {
+	}
+
 	//! Create a new update info for the specified transaction reflecting an update of the specified rows
 	UpdateInfo *CreateUpdateInfo(ColumnData &data, Transaction &transaction, row_t *ids, idx_t count,
 	                             idx_t vector_index, idx_t vector_offset, idx_t type_size);
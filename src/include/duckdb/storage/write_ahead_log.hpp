@@ -12,7 +12,12 @@
 #include "duckdb/common/types/data_chunk.hpp"
 #include "duckdb/common/enums/wal_type.hpp"
 #include "duckdb/common/serializer/buffered_file_writer.hpp"
+#include "duckdb/storage/storage_info.hpp"
 #include "duckdb/catalog/catalog_entry/sequence_catalog_entry.hpp"
+#include "duckdb/common/mutex.hpp"
+
+#include <atomic>
+#include <condition_variable>
 
 namespace duckdb {
 
@@ -40,8 +45,9 @@ public:
 	bool initialized;
 
 public:
-	//! Replay the WAL
-	static void Replay(DuckDB &database, string &path);
+	//! Replay the WAL, returns true if the WAL was already fully written to the current checkpoint (i.e. the database
+	//! was shut down between writing a checkpoint and truncating the WAL) and can be discarded without replaying it
+	static bool Replay(DuckDB &database, string &path);
 
 	//! Initialize the WAL in the specified directory
 	void Initialize(string &path);
@@ -70,13 +76,46 @@ public:
 	void WriteDelete(DataChunk &chunk);
 	void WriteUpdate(DataChunk &chunk, column_t col_idx);
 
+	//! Marks that all changes in the WAL have been written to the checkpoint starting at the given meta block
+	void WriteCheckpoint(block_id_t meta_block);
+
 	//! Truncate the WAL to a previous size, and clear anything currently set in the writer
 	void Truncate(int64_t size);
+	//! Write a flush marker and sync the WAL to disk
 	void Flush();
 
+	//! Write a flush marker after the entries of a committing transaction and hand them to the file system without
+	//! syncing them to disk. Returns the sequence number of the commit, that has to be passed to SyncCommit.
+	idx_t FlushCommit();
+	//! Wait until the WAL is synced to disk up to (at least) the commit with the given sequence number. Concurrent
+	//! committers are grouped: one of them syncs the WAL once for all commits that were flushed at that point. If
+	//! wait_for_group is set and a group commit delay is configured, the syncing committer first waits for the delay so
+	//! more commits can join the group. Throws if the WAL could not be synced: after a failed sync no commit can be made
+	//! durable anymore, and every subsequent call throws as well.
+	void SyncCommit(idx_t commit_sequence, bool wait_for_group);
+	//! Returns the sequence number of the last commit that was flushed to the file system
+	idx_t GetFlushedSequence() {
+		return flushed_sequence;
+	}
+
 private:
 	DuckDB &database;
 	unique_ptr<BufferedFileWriter> writer;
+
+	//! The sequence number of the last commit that was flushed to the file system
+	std::atomic<idx_t> flushed_sequence;
+	//! Lock protecting the sync state below
+	mutex sync_lock;
+	//! Signalled when a sync of the WAL finishes
+	std::condition_variable sync_finished;
+	//! Whether or not a committer is currently syncing the WAL
+	bool sync_in_progress;
+	//! The sequence number up to which all commits are synced to disk
+	idx_t synced_sequence;
+	//! Whether or not a sync of the WAL failed, which invalidates the database
+	bool sync_failed;
+	//! The error of the failed sync
+	string sync_error;
 };
 
 } // namespace duckdb
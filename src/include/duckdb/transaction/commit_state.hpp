@@ -13,6 +13,7 @@
 
 namespace duckdb {
 class CatalogEntry;
+class ColumnData;
 class DataChunk;
 class WriteAheadLog;
 
@@ -31,15 +32,22 @@ public:
 	DataTableInfo *current_table_info;
 	idx_t row_identifiers[STANDARD_VECTOR_SIZE];
 
+	//! The deletes and updates are collected in these chunks, so consecutive entries are written to the WAL together
 	unique_ptr<DataChunk> delete_chunk;
 	unique_ptr<DataChunk> update_chunk;
+	//! The column of the updates that are collected in the update chunk
+	ColumnData *update_column;
 
 public:
 	template <bool HAS_LOG> void CommitEntry(UndoFlags type, data_ptr_t data);
 	void RevertCommit(UndoFlags type, data_ptr_t data);
+	//! Write the deletes and updates that have been collected to the WAL
+	void Flush();
 
 private:
 	void SwitchTable(DataTableInfo *table, UndoFlags new_op);
+	void FlushDelete();
+	void FlushUpdate();
 
 	void WriteCatalogEntry(CatalogEntry *entry, data_ptr_t extra_data);
 	void WriteDelete(DeleteInfo *info);
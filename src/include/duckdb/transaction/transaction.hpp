@@ -63,8 +63,11 @@ public:
 	void PushCatalogEntry(CatalogEntry *entry, data_ptr_t extra_data = nullptr, idx_t extra_data_size = 0);
 
 	//! Commit the current transaction with the given commit identifier. Returns an error message if the transaction
-	//! commit failed, or an empty string if the commit was sucessful
-	string Commit(WriteAheadLog *log, transaction_t commit_id) noexcept;
+	//! commit failed, or an empty string if the commit was sucessful. If changes were written to the WAL,
+	//! wal_sequence is set to the sequence number of the commit in the WAL, which still has to be synced to disk.
+	string Commit(WriteAheadLog *log, transaction_t commit_id, idx_t &wal_sequence) noexcept;
+	//! Whether or not the transaction has made any changes that have to be written on commit
+	bool ChangesMade();
 	//! Rollback
 	void Rollback() noexcept {
 		undo_buffer.Rollback();
@@ -83,6 +86,8 @@ public:
 	UpdateInfo *CreateUpdateInfo(idx_t type_size, idx_t entries);
 
 private:
+	//! Lock for creating entries in the undo buffer, updates and deletes can be executed by multiple threads
+	std::mutex undo_lock;
 	//! The undo buffer is used to store old versions of rows that are updated
 	//! or deleted
 	UndoBuffer undo_buffer;
@@ -19,6 +19,7 @@ namespace duckdb {
 
 class ClientContext;
 class StorageManager;
+class TableCatalogEntry;
 class Transaction;
 
 struct StoredCatalogSet {
@@ -43,6 +44,10 @@ public:
 	void RollbackTransaction(Transaction *transaction);
 	//! Add the catalog set
 	void AddCatalogSet(ClientContext &context, unique_ptr<CatalogSet> catalog_set);
+	//! Checkpoint the database from within the (unchanged) transaction of the given context. Throws an exception if
+	//! the checkpoint cannot run because other transactions are active. If vacuum is set, the deleted rows of
+	//! vacuum_table (or of all tables if it is not set) are removed by the checkpoint.
+	void Checkpoint(ClientContext &context, bool vacuum = false, TableCatalogEntry *vacuum_table = nullptr);
 
 	transaction_t GetQueryNumber() {
 		return current_query_number++;
@@ -51,6 +56,9 @@ public:
 private:
 	//! Remove the given transaction from the list of active transactions
 	void RemoveTransaction(Transaction *transaction) noexcept;
+	//! Checkpoint the database, should only be called while holding the transaction lock and when no transaction
+	//! other than (optionally) the one triggering the checkpoint is active
+	void CheckpointInternal(bool vacuum = false, TableCatalogEntry *vacuum_table = nullptr);
 
 	//! The current query number
 	std::atomic<transaction_t> current_query_number;
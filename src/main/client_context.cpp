@@ -343,7 +343,12 @@ unique_ptr<QueryResult> ClientContext::RunStatement(const string &query, unique_
 	unique_ptr<QueryResult> result;
 	// check if we are on AutoCommit. In this case we should start a transaction.
 	if (transaction.IsAutoCommit()) {
-		transaction.BeginTransaction();
+		try {
+			transaction.BeginTransaction();
+		} catch (std::exception &ex) {
+			// the transaction could not be started (e.g. because the database is invalidated)
+			return make_unique<MaterializedQueryResult>(ex.what());
+		}
 	}
 	ActiveTransaction().active_query = db.transaction_manager->GetQueryNumber();
 	if (statement->type == StatementType::SELECT_STATEMENT && query_verification_enabled) {
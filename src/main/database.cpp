@@ -69,8 +69,10 @@ void DuckDB::Configure(DBConfig &new_config) {
 	} else {
 		config.file_system = make_unique<FileSystem>();
 	}
-	config.checkpoint_only = new_config.checkpoint_only;
 	config.checkpoint_wal_size = new_config.checkpoint_wal_size;
+	config.group_commit_delay = new_config.group_commit_delay;
+	config.auto_vacuum = new_config.auto_vacuum;
+	config.auto_vacuum_threshold = new_config.auto_vacuum_threshold;
 	config.use_direct_io = new_config.use_direct_io;
 	config.maximum_memory = new_config.maximum_memory;
 	config.temporary_directory = new_config.temporary_directory;
@@ -42,6 +42,7 @@ bool QueryProfiler::OperatorRequiresProfiling(PhysicalOperatorType op_type) {
 	case PhysicalOperatorType::TOP_N:
 	case PhysicalOperatorType::AGGREGATE:
 	case PhysicalOperatorType::WINDOW:
+	case PhysicalOperatorType::STREAMING_WINDOW:
 	case PhysicalOperatorType::UNNEST:
 	case PhysicalOperatorType::DISTINCT:
 	case PhysicalOperatorType::SIMPLE_AGGREGATE:
@@ -5,6 +5,7 @@
 #include "duckdb/planner/expression/bound_comparison_expression.hpp"
 #include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
 #include "duckdb/planner/operator/logical_empty_result.hpp"
 #include "duckdb/planner/operator/logical_filter.hpp"
 #include "duckdb/planner/expression/bound_columnref_expression.hpp"
@@ -286,6 +287,73 @@ FilterCombiner::GenerateTableScanFilters(std::function<void(unique_ptr<Expressio
 				}
 			}
 		}
+		//! IS NULL and IS NOT NULL filters can be used to skip segments that have only (or no) NULL values
+		if (remaining_filter->type == ExpressionType::OPERATOR_IS_NULL ||
+		    remaining_filter->type == ExpressionType::OPERATOR_IS_NOT_NULL) {
+			auto &op = (BoundOperatorExpression &)*remaining_filter;
+			if (op.children[0]->type != ExpressionType::BOUND_COLUMN_REF) {
+				continue;
+			}
+			auto &column_ref = (BoundColumnRefExpression &)*op.children[0];
+			if (column_ids[column_ref.binding.column_index] == COLUMN_IDENTIFIER_ROW_ID) {
+				continue;
+			}
+			tableFilters.push_back(TableFilter(Value(), op.type, column_ref.binding.column_index));
+		}
+	}
+	//! An IN list of constants implies a range between the smallest and the largest constant, which we can use to
+	//! skip segments. The IN expression itself is kept as a filter.
+	for (auto &remaining_filter : remaining_filters) {
+		if (remaining_filter->type != ExpressionType::COMPARE_IN) {
+			continue;
+		}
+		auto &op = (BoundOperatorExpression &)*remaining_filter;
+		if (op.children[0]->type != ExpressionType::BOUND_COLUMN_REF) {
+			continue;
+		}
+		auto &column_ref = (BoundColumnRefExpression &)*op.children[0];
+		auto column_index = column_ref.binding.column_index;
+		auto column_type = column_ref.return_type;
+		if (column_ids[column_index] == COLUMN_IDENTIFIER_ROW_ID ||
+		    !(TypeIsNumeric(column_type) || column_type == TypeId::VARCHAR)) {
+			continue;
+		}
+		//! the table scan only combines filters on the same column into a range, so skip columns that are filtered
+		//! already
+		bool has_filter = false;
+		for (auto &filter : tableFilters) {
+			if (filter.column_index == column_index) {
+				has_filter = true;
+				break;
+			}
+		}
+		if (has_filter) {
+			continue;
+		}
+		bool all_constants = true;
+		Value min_value, max_value;
+		for (idx_t i = 1; i < op.children.size(); i++) {
+			if (op.children[i]->type != ExpressionType::VALUE_CONSTANT) {
+				all_constants = false;
+				break;
+			}
+			auto &value = ((BoundConstantExpression &)*op.children[i]).value;
+			if (value.is_null || value.type != column_type) {
+				all_constants = false;
+				break;
+			}
+			if (i == 1 || value < min_value) {
+				min_value = value;
+			}
+			if (i == 1 || value > max_value) {
+				max_value = value;
+			}
+		}
+		if (!all_constants || op.children.size() < 2) {
+			continue;
+		}
+		tableFilters.push_back(TableFilter(min_value, ExpressionType::COMPARE_GREATERTHANOREQUALTO, column_index));
+		tableFilters.push_back(TableFilter(max_value, ExpressionType::COMPARE_LESSTHANOREQUALTO, column_index));
 	}
 
 	return tableFilters;
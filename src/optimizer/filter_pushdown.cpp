@@ -36,6 +36,8 @@ unique_ptr<LogicalOperator> FilterPushdown::Rewrite(unique_ptr<LogicalOperator>
 	}
 	case LogicalOperatorType::GET:
 		return PushdownGet(move(op));
+	case LogicalOperatorType::TABLE_FUNCTION:
+		return PushdownTableFunction(move(op));
 	default:
 		return FinishPushdown(move(op));
 	}
@@ -0,0 +1,37 @@
+#include "duckdb/optimizer/filter_pushdown.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_table_function.hpp"
+using namespace duckdb;
+using namespace std;
+
+using Filter = FilterPushdown::Filter;
+
+unique_ptr<LogicalOperator> FilterPushdown::PushdownTableFunction(unique_ptr<LogicalOperator> op) {
+	assert(op->type == LogicalOperatorType::TABLE_FUNCTION);
+	auto &function = (LogicalTableFunction &)*op;
+	if (!function.function.filter_pushdown || !function.table_filters.empty() || filters.empty()) {
+		return FinishPushdown(move(op));
+	}
+	PushFilters();
+
+	// the table function only uses the pushed down filters to skip data that cannot match the filters, so all
+	// filters are still executed on top of the table function
+	vector<unique_ptr<Filter>> pushed_filters;
+	function.table_filters = combiner.GenerateTableScanFilters(
+	    [&](unique_ptr<Expression> filter) {
+		    auto f = make_unique<Filter>();
+		    f->filter = move(filter);
+		    f->ExtractBindings();
+		    pushed_filters.push_back(move(f));
+	    },
+	    function.column_ids);
+	for (auto &f : function.table_filters) {
+		f.column_index = function.column_ids[f.column_index];
+	}
+
+	GenerateFilters();
+	for (auto &f : pushed_filters) {
+		filters.push_back(move(f));
+	}
+	return FinishPushdown(move(op));
+}
@@ -164,6 +164,11 @@ void Executor::PushError(std::string exception) {
 	exceptions.push_back(exception);
 }
 
+void Executor::ScheduleTask(unique_ptr<Task> task) {
+	auto &scheduler = TaskScheduler::GetScheduler(context);
+	scheduler.ScheduleTask(*producer, move(task));
+}
+
 void Executor::Flush(ThreadContext &tcontext) {
 	lock_guard<mutex> elock(executor_lock);
 	context.profiler.Flush(tcontext.profiler);
@@ -10,6 +10,9 @@
 #include "duckdb/execution/operator/aggregate/physical_simple_aggregate.hpp"
 #include "duckdb/execution/operator/scan/physical_table_scan.hpp"
 #include "duckdb/execution/operator/aggregate/physical_hash_aggregate.hpp"
+#include "duckdb/execution/operator/join/physical_hash_join.hpp"
+#include "duckdb/execution/operator/set/physical_union.hpp"
+#include "duckdb/execution/operator/persistent/physical_update.hpp"
 
 using namespace std;
 
@@ -91,44 +94,93 @@ void Pipeline::ScheduleSequentialTask() {
 	scheduler.ScheduleTask(*executor.producer, move(task));
 }
 
-bool Pipeline::ScheduleOperator(PhysicalOperator *op) {
+bool Pipeline::GetParallelTasks(PhysicalOperator *op, vector<TaskContext> &tasks) {
 	switch (op->type) {
 	case PhysicalOperatorType::FILTER:
 	case PhysicalOperatorType::PROJECTION:
-	case PhysicalOperatorType::HASH_JOIN:
-		// filter, projection or hash probe: continue in children
-		return ScheduleOperator(op->children[0].get());
-	case PhysicalOperatorType::SEQ_SCAN: {
-		// we reached a scan: split it up into parts and schedule the parts
-		auto &scheduler = TaskScheduler::GetScheduler(executor.context);
-
-		// first we gather all of the tasks of this pipeline
-		// we gather the tasks first because we want to set total_tasks to the actual task amount
-		// otherwise we can encounter race conditions in which a pipeline could finish twice
-		vector<unique_ptr<OperatorTaskInfo>> tasks;
-		op->ParallelScanInfo(executor.context, [&](unique_ptr<OperatorTaskInfo> info) { tasks.push_back(move(info)); });
-		this->total_tasks = tasks.size();
-		if (this->total_tasks == 0) {
-			// could not generate parallel tasks, or parallel tasks were determined as not worthwhile
-			// move on to sequential execution
+	case PhysicalOperatorType::UNNEST:
+		// streaming operator: continue in children
+		return GetParallelTasks(op->children[0].get(), tasks);
+	case PhysicalOperatorType::HASH_JOIN: {
+		auto &hash_join = (PhysicalHashJoin &)*op;
+		if (hash_join.join_type == JoinType::OUTER || hash_join.IsExternal()) {
+			// full outer join: the unmatched tuples of the build side can only be scanned after the entire probe
+			// has finished, which requires a sequential probe
+			// out-of-core join: the spilled probe rows can only be processed after the entire probe has finished
 			return false;
 		}
-		// after we have gathered all the tasks we actually schedule them for execution
-		for (auto &info : tasks) {
-			auto task = make_unique<PipelineTask>(this);
-			task->task.task_info[op] = move(info);
-			scheduler.ScheduleTask(*executor.producer, move(task));
+		// hash probe: continue in children
+		return GetParallelTasks(op->children[0].get(), tasks);
+	}
+	case PhysicalOperatorType::PIECEWISE_MERGE_JOIN:
+	case PhysicalOperatorType::NESTED_LOOP_JOIN:
+	case PhysicalOperatorType::BLOCKWISE_NL_JOIN: {
+		auto &join = (PhysicalJoin &)*op;
+		if (join.join_type == JoinType::OUTER) {
+			// full outer join: requires a sequential probe (see above)
+			return false;
 		}
-		return true;
+		// the RHS has been materialized by a separate pipeline: continue in the LHS
+		return GetParallelTasks(op->children[0].get(), tasks);
 	}
-	case PhysicalOperatorType::HASH_GROUP_BY: {
-		// FIXME: parallelize scan of GROUP_BY HT
+	case PhysicalOperatorType::CROSS_PRODUCT:
+		// the cross product materializes its RHS in the operator state: every task would execute the RHS again (with
+		// different results for non-deterministic expressions), hence we execute the cross product sequentially
 		return false;
+	case PhysicalOperatorType::UNION: {
+		// every task executes one of the children of the union, the children are split up further if possible
+		for (idx_t child_idx = 0; child_idx < op->children.size(); child_idx++) {
+			vector<TaskContext> child_tasks;
+			if (!GetParallelTasks(op->children[child_idx].get(), child_tasks)) {
+				// the child cannot be split up: execute the entire child in a single task
+				child_tasks.clear();
+				child_tasks.push_back(TaskContext());
+			}
+			for (auto &child_task : child_tasks) {
+				child_task.task_info[op] = make_unique<UnionTaskInfo>(child_idx);
+				tasks.push_back(move(child_task));
+			}
+		}
+		return true;
 	}
-	default:
-		// unknown operator: skip parallel task scheduling
+	default: {
+		if (op->children.size() > 0 && !op->IsSink()) {
+			// streaming operator that cannot be executed in parallel (e.g. LIMIT)
+			return false;
+		}
+		// we reached the source of the pipeline: a scan, or a sink that was finished by another pipeline
+		// let the source split itself up into parts, one task is created for every part
+		idx_t task_count = 0;
+		op->ParallelScanInfo(executor.context, [&](unique_ptr<OperatorTaskInfo> info) {
+			TaskContext task;
+			task.task_info[op] = move(info);
+			tasks.push_back(move(task));
+			task_count++;
+		});
+		// if the source generated no parts, parallel tasks are not possible or not worthwhile
+		return task_count > 0;
+	}
+	}
+}
+
+bool Pipeline::ScheduleOperator(PhysicalOperator *op) {
+	// first we gather all of the tasks of this pipeline
+	// we gather the tasks first because we want to set total_tasks to the actual task amount
+	// otherwise we can encounter race conditions in which a pipeline could finish twice
+	vector<TaskContext> tasks;
+	if (!GetParallelTasks(op, tasks) || tasks.size() == 0) {
+		// could not generate parallel tasks: move on to sequential execution
 		return false;
 	}
+	this->total_tasks = tasks.size();
+	// after we have gathered all the tasks we actually schedule them for execution
+	auto &scheduler = TaskScheduler::GetScheduler(executor.context);
+	for (auto &task_context : tasks) {
+		auto task = make_unique<PipelineTask>(this);
+		task->task = move(task_context);
+		scheduler.ScheduleTask(*executor.producer, move(task));
+	}
+	return true;
 }
 
 void Pipeline::Schedule() {
@@ -150,7 +202,8 @@ void Pipeline::Schedule() {
 		}
 		break;
 	}
-	case PhysicalOperatorType::HASH_GROUP_BY: {
+	case PhysicalOperatorType::HASH_GROUP_BY:
+	case PhysicalOperatorType::DISTINCT: {
 		auto &hash_aggr = (PhysicalHashAggregate &)*sink;
 		if (!hash_aggr.all_combinable) {
 			// not all aggregates are parallelizable: switch to sequential mode
@@ -162,7 +215,35 @@ void Pipeline::Schedule() {
 		}
 		break;
 	}
-	case PhysicalOperatorType::HASH_JOIN: {
+	case PhysicalOperatorType::ORDER_BY: {
+		// order by: every thread sorts its own runs
+		if (ScheduleOperator(sink->children[0].get())) {
+			return;
+		}
+		break;
+	}
+	case PhysicalOperatorType::UPDATE: {
+		auto &update = (PhysicalUpdate &)*sink;
+		if (update.is_index_update) {
+			// index updates are executed as a delete and an append: switch to sequential mode
+			break;
+		}
+		if (ScheduleOperator(sink->children[0].get())) {
+			return;
+		}
+		break;
+	}
+	case PhysicalOperatorType::DELETE: {
+		// deletes only mark the rows as deleted in the version info: every thread deletes the rows it scanned
+		if (ScheduleOperator(sink->children[0].get())) {
+			return;
+		}
+		break;
+	}
+	case PhysicalOperatorType::HASH_JOIN:
+	case PhysicalOperatorType::PIECEWISE_MERGE_JOIN:
+	case PhysicalOperatorType::NESTED_LOOP_JOIN:
+	case PhysicalOperatorType::BLOCKWISE_NL_JOIN: {
 		// schedule build side of the join
 		if (ScheduleOperator(sink->children[1].get())) {
 			// all parallel tasks have been scheduled: return
@@ -206,7 +287,7 @@ string Pipeline::ToString() const {
 	auto node = this->child;
 	while (node) {
 		str = PhysicalOperatorToString(node->type) + " -> " + str;
-		node = node->children[0].get();
+		node = node->children.size() > 0 ? node->children[0].get() : nullptr;
 	}
 	return str;
 }
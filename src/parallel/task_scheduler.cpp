@@ -1,39 +1,153 @@
 #include "duckdb/parallel/task_scheduler.hpp"
 
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/unordered_map.hpp"
 #include "duckdb/main/client_context.hpp"
 #include "duckdb/main/database.hpp"
 
 #include "concurrentqueue.h"
 #include "lightweightsemaphore.h"
 
+#include <algorithm>
+#include <deque>
+#include <fstream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 using namespace std;
 
 namespace duckdb {
 
-typedef moodycamel::ConcurrentQueue<unique_ptr<Task>> concurrent_queue_t;
 typedef moodycamel::LightweightSemaphore lightweight_semaphore_t;
 
-struct ConcurrentQueue {
-	concurrent_queue_t q;
-	lightweight_semaphore_t semaphore;
+struct ScheduledTask {
+	ScheduledTask(ProducerToken *producer, unique_ptr<Task> task) : producer(producer), task(move(task)) {
+	}
+
+	//! The producer that scheduled the task
+	ProducerToken *producer;
+	unique_ptr<Task> task;
 };
 
-struct QueueProducerToken {
-	QueueProducerToken(concurrent_queue_t &q) : queue_token(q) {
+struct WorkerQueue {
+	WorkerQueue(idx_t core, idx_t numa_node) : task_count(0), core(core), numa_node(numa_node) {
 	}
 
-	moodycamel::ProducerToken queue_token;
+	mutex lock;
+	//! The tasks of the queue; the owner pops from the back, other threads steal from the front
+	deque<ScheduledTask> tasks;
+	//! The amount of tasks in the queue, used to skip empty queues without locking them
+	std::atomic<idx_t> task_count;
+	//! The core that the worker of this queue is pinned to (if thread pinning is enabled)
+	idx_t core;
+	//! The NUMA node of the core
+	idx_t numa_node;
 };
 
-ProducerToken::ProducerToken(TaskScheduler &scheduler, unique_ptr<QueueProducerToken> token)
-    : scheduler(scheduler), token(move(token)) {
+struct WorkerSemaphore {
+	lightweight_semaphore_t semaphore;
+};
+
+//! The scheduler and worker id of the current thread, if the current thread is a background worker
+static thread_local TaskScheduler *current_scheduler = nullptr;
+static thread_local idx_t current_worker = 0;
+
+//! Returns the cores that this process is allowed to run on
+static vector<idx_t> GetAvailableCores() {
+	vector<idx_t> cores;
+#if defined(__linux__)
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0) {
+		for (idx_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &cpuset)) {
+				cores.push_back(cpu);
+			}
+		}
+	}
+#endif
+	if (cores.size() == 0) {
+		idx_t core_count = std::max<idx_t>(thread::hardware_concurrency(), 1);
+		for (idx_t cpu = 0; cpu < core_count; cpu++) {
+			cores.push_back(cpu);
+		}
+	}
+	return cores;
+}
+
+//! Returns the NUMA node of every core, or an empty map if the topology is unknown
+static unordered_map<idx_t, idx_t> GetNUMANodes() {
+	unordered_map<idx_t, idx_t> result;
+#if defined(__linux__)
+	for (idx_t node = 0;; node++) {
+		// the cpulist contains a comma-separated list of cores or core ranges, e.g. "0-15,32-47"
+		ifstream cpulist("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+		if (!cpulist.is_open()) {
+			break;
+		}
+		string range;
+		while (getline(cpulist, range, ',')) {
+			auto dash = range.find('-');
+			auto start = strtoull(range.c_str(), nullptr, 10);
+			auto end = dash == string::npos ? start : strtoull(range.c_str() + dash + 1, nullptr, 10);
+			for (auto cpu = start; cpu <= end; cpu++) {
+				result[cpu] = node;
+			}
+		}
+	}
+#endif
+	return result;
+}
+
+static void SetThreadAffinity(thread &worker_thread, vector<idx_t> cores) {
+#if defined(__linux__)
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	for (auto &core : cores) {
+		CPU_SET(core, &cpuset);
+	}
+	// pinning is best-effort: ignore failures
+	pthread_setaffinity_np(worker_thread.native_handle(), sizeof(cpu_set_t), &cpuset);
+#endif
+}
+
+ProducerToken::ProducerToken(TaskScheduler &scheduler) : scheduler(scheduler), pending_tasks(0) {
 }
 
 ProducerToken::~ProducerToken() {
 }
 
-TaskScheduler::TaskScheduler() : queue(make_unique<ConcurrentQueue>()) {
+TaskScheduler::TaskScheduler()
+    : active_queues(1), next_queue(0), semaphore(make_unique<WorkerSemaphore>()), pin_threads(false) {
+	// create one queue for the threads outside of the scheduler and one queue for every available core
+	auto cores = GetAvailableCores();
+	auto numa_nodes = GetNUMANodes();
+	for (idx_t i = 0; i < cores.size() + 1; i++) {
+		// worker i is pinned to core i, wrapping around to the first core for the last worker
+		auto core = cores[i % cores.size()];
+		auto entry = numa_nodes.find(core);
+		queues.push_back(make_unique<WorkerQueue>(core, entry == numa_nodes.end() ? 0 : entry->second));
+	}
+	// steal from the queues of workers on the same NUMA node first, starting at the next worker
+	steal_order.resize(queues.size());
+	for (idx_t i = 0; i < queues.size(); i++) {
+		auto numa_node = queues[i]->numa_node;
+		for (idx_t j = 1; j < queues.size(); j++) {
+			auto queue_idx = (i + j) % queues.size();
+			if (queues[queue_idx]->numa_node == numa_node) {
+				steal_order[i].push_back(queue_idx);
+			}
+		}
+		for (idx_t j = 1; j < queues.size(); j++) {
+			auto queue_idx = (i + j) % queues.size();
+			if (queues[queue_idx]->numa_node != numa_node) {
+				steal_order[i].push_back(queue_idx);
+			}
+		}
+	}
 }
 
 TaskScheduler::~TaskScheduler() {
@@ -45,47 +159,146 @@ TaskScheduler &TaskScheduler::GetScheduler(ClientContext &context) {
 }
 
 unique_ptr<ProducerToken> TaskScheduler::CreateProducer() {
-	auto token = make_unique<QueueProducerToken>(queue->q);
-	return make_unique<ProducerToken>(*this, move(token));
+	return make_unique<ProducerToken>(*this);
 }
 
 void TaskScheduler::ScheduleTask(ProducerToken &token, unique_ptr<Task> task) {
-	lock_guard<mutex> producer_lock(token.producer_lock);
-
-	// Enqueue a task for the given producer token and signal any sleeping threads
-	if (queue->q.enqueue(token.token->queue_token, move(task))) {
-		queue->semaphore.signal();
+	idx_t queue_idx;
+	if (current_scheduler == this) {
+		// scheduled from within a worker: push onto its own queue, the task likely uses data that is still in the
+		// cache of that worker
+		queue_idx = current_worker % queues.size();
 	} else {
-		throw InternalException("Could not schedule task!");
+		// scheduled from outside: distribute the tasks over the queues of the active workers
+		queue_idx = next_queue++ % active_queues;
 	}
+	auto &queue = *queues[queue_idx];
+	token.pending_tasks++;
+	{
+		lock_guard<mutex> queue_lock(queue.lock);
+		queue.tasks.push_back(ScheduledTask(&token, move(task)));
+		queue.task_count++;
+	}
+	// signal any sleeping threads
+	semaphore->semaphore.signal();
 }
 
 bool TaskScheduler::GetTaskFromProducer(ProducerToken &token, unique_ptr<Task> &task) {
-	lock_guard<mutex> producer_lock(token.producer_lock);
-	return queue->q.try_dequeue_from_producer(token.token->queue_token, task);
+	if (token.pending_tasks == 0) {
+		return false;
+	}
+	for (idx_t queue_idx = 0; queue_idx < queues.size(); queue_idx++) {
+		auto &queue = *queues[queue_idx];
+		if (queue.task_count == 0) {
+			continue;
+		}
+		lock_guard<mutex> queue_lock(queue.lock);
+		for (auto entry = queue.tasks.begin(); entry != queue.tasks.end(); entry++) {
+			if (entry->producer == &token) {
+				task = move(entry->task);
+				queue.tasks.erase(entry);
+				queue.task_count--;
+				token.pending_tasks--;
+				// consume the signal of the task, so idle workers are not woken up for it
+				semaphore->semaphore.tryWait();
+				return true;
+			}
+		}
+	}
+	return false;
 }
 
-void TaskScheduler::ExecuteForever(bool *marker) {
+bool TaskScheduler::GetTask(idx_t worker_id, unique_ptr<Task> &task) {
+	auto own_queue = worker_id % queues.size();
+	// first check our own queue: take the task that was scheduled most recently
+	auto &queue = *queues[own_queue];
+	if (queue.task_count > 0) {
+		lock_guard<mutex> queue_lock(queue.lock);
+		if (queue.tasks.size() > 0) {
+			auto &entry = queue.tasks.back();
+			task = move(entry.task);
+			entry.producer->pending_tasks--;
+			queue.tasks.pop_back();
+			queue.task_count--;
+			return true;
+		}
+	}
+	// our own queue is empty: steal the oldest task from another queue
+	for (auto &queue_idx : steal_order[own_queue]) {
+		auto &victim = *queues[queue_idx];
+		if (victim.task_count == 0) {
+			continue;
+		}
+		lock_guard<mutex> queue_lock(victim.lock);
+		if (victim.tasks.size() > 0) {
+			auto &entry = victim.tasks.front();
+			task = move(entry.task);
+			entry.producer->pending_tasks--;
+			victim.tasks.pop_front();
+			victim.task_count--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::ExecuteForever(idx_t worker_id, bool *marker) {
+	current_scheduler = this;
+	current_worker = worker_id;
 	unique_ptr<Task> task;
+	// whether the signal of the next task was already consumed by waiting on the semaphore
+	bool consumed_signal = false;
 	// loop until the marker is set to false
 	while (*marker) {
-		// wait for a signal with a timeout; the timeout allows us to periodically check
-		queue->semaphore.wait(TASK_TIMEOUT_USECS);
-		if (queue->q.try_dequeue(task)) {
+		if (GetTask(worker_id, task)) {
+			// every scheduled task signals the semaphore: consume the signal of the task we took, otherwise the
+			// signals of tasks that were taken by busy workers would keep waking up idle workers
+			if (!consumed_signal) {
+				semaphore->semaphore.tryWait();
+			}
+			consumed_signal = false;
 			task->Execute();
 			task.reset();
+			continue;
 		}
+		// no tasks available: wait for a signal with a timeout; the timeout allows us to periodically check
+		consumed_signal = semaphore->semaphore.wait(TASK_TIMEOUT_USECS);
 	}
+	current_scheduler = nullptr;
 }
 
-static void ThreadExecuteTasks(TaskScheduler *scheduler, bool *marker) {
-	scheduler->ExecuteForever(marker);
+static void ThreadExecuteTasks(TaskScheduler *scheduler, idx_t worker_id, bool *marker) {
+	scheduler->ExecuteForever(worker_id, marker);
 }
 
 int32_t TaskScheduler::NumberOfThreads() {
 	return threads.size() + 1;
 }
 
+void TaskScheduler::PinThread(idx_t worker_id) {
+	assert(worker_id > 0 && worker_id <= threads.size());
+	vector<idx_t> cores;
+	if (pin_threads) {
+		cores.push_back(queues[worker_id % queues.size()]->core);
+	} else {
+		// unpin the thread: allow it to run on every core
+		for (idx_t i = 1; i < queues.size(); i++) {
+			cores.push_back(queues[i]->core);
+		}
+	}
+	SetThreadAffinity(*threads[worker_id - 1], cores);
+}
+
+void TaskScheduler::SetThreadPinning(bool pin) {
+	if (pin_threads == pin) {
+		return;
+	}
+	pin_threads = pin;
+	for (idx_t i = 0; i < threads.size(); i++) {
+		PinThread(i + 1);
+	}
+}
+
 void TaskScheduler::SetThreads(int32_t n) {
 	if (n < 1) {
 		throw SyntaxException("Must have at least 1 thread!");
@@ -96,11 +309,16 @@ void TaskScheduler::SetThreads(int32_t n) {
 		idx_t create_new_threads = new_thread_count - threads.size();
 		for (idx_t i = 0; i < create_new_threads; i++) {
 			// launch a thread and assign it a cancellation marker
+			// worker ids start at 1: queue 0 is used by threads outside of the scheduler
+			idx_t worker_id = threads.size() + 1;
 			auto marker = unique_ptr<bool>(new bool(true));
-			auto worker_thread = make_unique<thread>(ThreadExecuteTasks, this, marker.get());
+			auto worker_thread = make_unique<thread>(ThreadExecuteTasks, this, worker_id, marker.get());
 
 			threads.push_back(move(worker_thread));
 			markers.push_back(move(marker));
+			if (pin_threads) {
+				PinThread(worker_id);
+			}
 		}
 	} else if (threads.size() > new_thread_count) {
 		// we are reducing the number of threads: cancel any threads exceeding new_thread_count
@@ -115,6 +333,9 @@ void TaskScheduler::SetThreads(int32_t n) {
 		threads.resize(new_thread_count);
 		markers.resize(new_thread_count);
 	}
+	// distribute tasks scheduled from outside over the queues of the remaining workers; any tasks left in the queues
+	// of stopped workers are stolen by the other threads
+	active_queues = std::min<idx_t>(threads.size() + 1, queues.size());
 }
 
 } // namespace duckdb
@@ -62,10 +62,11 @@ void Transformer::TransformWindowDef(PGWindowDef *window_spec, WindowExpression
 		expr->start = WindowBoundary::EXPR_PRECEDING;
 	} else if (window_spec->frameOptions & FRAMEOPTION_START_VALUE_FOLLOWING) {
 		expr->start = WindowBoundary::EXPR_FOLLOWING;
+	} else if ((window_spec->frameOptions & FRAMEOPTION_START_CURRENT_ROW) &&
+	           (window_spec->frameOptions & FRAMEOPTION_ROWS)) {
+		expr->start = WindowBoundary::CURRENT_ROW_ROWS;
 	} else if (window_spec->frameOptions & (FRAMEOPTION_START_CURRENT_ROW | FRAMEOPTION_RANGE)) {
 		expr->start = WindowBoundary::CURRENT_ROW_RANGE;
-	} else if (window_spec->frameOptions & (FRAMEOPTION_START_CURRENT_ROW | FRAMEOPTION_ROWS)) {
-		expr->start = WindowBoundary::CURRENT_ROW_ROWS;
 	}
 
 	if (window_spec->frameOptions & FRAMEOPTION_END_UNBOUNDED_PRECEDING) {
@@ -76,10 +77,11 @@ void Transformer::TransformWindowDef(PGWindowDef *window_spec, WindowExpression
 		expr->end = WindowBoundary::EXPR_PRECEDING;
 	} else if (window_spec->frameOptions & FRAMEOPTION_END_VALUE_FOLLOWING) {
 		expr->end = WindowBoundary::EXPR_FOLLOWING;
+	} else if ((window_spec->frameOptions & FRAMEOPTION_END_CURRENT_ROW) &&
+	           (window_spec->frameOptions & FRAMEOPTION_ROWS)) {
+		expr->end = WindowBoundary::CURRENT_ROW_ROWS;
 	} else if (window_spec->frameOptions & (FRAMEOPTION_END_CURRENT_ROW | FRAMEOPTION_RANGE)) {
 		expr->end = WindowBoundary::CURRENT_ROW_RANGE;
-	} else if (window_spec->frameOptions & (FRAMEOPTION_END_CURRENT_ROW | FRAMEOPTION_ROWS)) {
-		expr->end = WindowBoundary::CURRENT_ROW_ROWS;
 	}
 
 	assert(expr->start != WindowBoundary::INVALID && expr->end != WindowBoundary::INVALID);
@@ -0,0 +1,14 @@
+#include "duckdb/parser/statement/pragma_statement.hpp"
+#include "duckdb/parser/transformer.hpp"
+
+using namespace duckdb;
+using namespace std;
+
+unique_ptr<PragmaStatement> Transformer::TransformCheckpoint(PGNode *node) {
+	// we transform CHECKPOINT into PRAGMA checkpoint
+	auto result = make_unique<PragmaStatement>();
+	auto &info = *result->info;
+	info.name = "checkpoint";
+	info.pragma_type = PragmaType::NOTHING;
+	return result;
+}
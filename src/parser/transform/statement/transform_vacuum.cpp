@@ -8,5 +8,13 @@ unique_ptr<VacuumStatement> Transformer::TransformVacuum(PGNode *node) {
 	auto stmt = reinterpret_cast<PGVacuumStmt *>(node);
 	assert(stmt);
 	auto result = make_unique<VacuumStatement>();
+	result->info = make_unique<VacuumInfo>();
+	result->info->vacuum = stmt->options & PG_VACOPT_VACUUM;
+	if (stmt->relation) {
+		if (stmt->relation->schemaname) {
+			result->info->schema = stmt->relation->schemaname;
+		}
+		result->info->table = stmt->relation->relname;
+	}
 	return result;
 }
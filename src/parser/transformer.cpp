@@ -74,6 +74,8 @@ unique_ptr<SQLStatement> Transformer::TransformStatement(PGNode *stmt) {
 		return TransformVacuum(stmt);
 	case T_PGVariableShowStmt:
 		return TransformShow(stmt);
+	case T_PGCheckPointStmt:
+		return TransformCheckpoint(stmt);
 	default:
 		throw NotImplementedException(NodetypeToString(stmt->type));
 	}
@@ -1,4 +1,6 @@
 #include "duckdb/planner/binder.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/parser/statement/vacuum_statement.hpp"
 #include "duckdb/planner/operator/logical_simple.hpp"
 
@@ -7,6 +9,11 @@ using namespace std;
 namespace duckdb {
 
 BoundStatement Binder::Bind(VacuumStatement &stmt) {
+	if (!stmt.info->table.empty()) {
+		// verify that the table exists
+		auto &catalog = Catalog::GetCatalog(context);
+		catalog.GetEntry<TableCatalogEntry>(context, stmt.info->schema, stmt.info->table);
+	}
 	BoundStatement result;
 	result.names = {"Success"};
 	result.types = {SQLType::BOOLEAN};
@@ -33,6 +33,24 @@ unique_ptr<SQLStatement> PragmaHandler::HandlePragma(PragmaInfo &pragma) {
 		parser.ParseQuery("SELECT * FROM pragma_table_info()");
 
 		// push the table name parameter into the table function
+		auto select_statement = move(parser.statements[0]);
+		auto &select = (SelectStatement &)*select_statement;
+		auto &select_node = (SelectNode &)*select.node;
+		auto &table_function = (TableFunctionRef &)*select_node.from_table;
+		auto &function = (FunctionExpression &)*table_function.function;
+		function.children.push_back(make_unique<ConstantExpression>(SQLTypeId::VARCHAR, pragma.parameters[0]));
+		return select_statement;
+	} else if (keyword == "storage_info") {
+		if (pragma.pragma_type != PragmaType::CALL) {
+			throw ParserException("Invalid PRAGMA storage_info: expected table name");
+		}
+		if (pragma.parameters.size() != 1) {
+			throw ParserException("Invalid PRAGMA storage_info: storage_info takes exactly one argument");
+		}
+		// turn into SELECT * FROM pragma_storage_info('table_name')
+		Parser parser;
+		parser.ParseQuery("SELECT * FROM pragma_storage_info()");
+
 		auto select_statement = move(parser.statements[0]);
 		auto &select = (SelectStatement &)*select_statement;
 		auto &select_node = (SelectNode &)*select.node;
@@ -189,6 +189,23 @@ void BufferManager::DestroyBuffer(block_id_t buffer_id, bool can_destroy) {
 	lru.Erase(handle);
 }
 
+void BufferManager::UnloadBlock(block_id_t block_id) {
+	lock_guard<mutex> lock(block_lock);
+
+	assert(block_id < MAXIMUM_BLOCK);
+	auto entry = blocks.find(block_id);
+	if (entry == blocks.end()) {
+		// block is not loaded
+		return;
+	}
+	auto handle = entry->second;
+	assert(handle->ref_count == 0);
+
+	current_memory -= Storage::BLOCK_ALLOC_SIZE;
+	blocks.erase(block_id);
+	lru.Erase(handle);
+}
+
 void BufferManager::SetLimit(idx_t limit) {
 	lock_guard<mutex> lock(block_lock);
 
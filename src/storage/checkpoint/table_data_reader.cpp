@@ -40,14 +40,20 @@ void TableDataReader::ReadTableData() {
 			data_pointer.tuple_count = reader.Read<idx_t>();
 			data_pointer.block_id = reader.Read<block_id_t>();
 			data_pointer.offset = reader.Read<uint32_t>();
-			reader.ReadData(data_pointer.min_stats, 16);
-			reader.ReadData(data_pointer.max_stats, 16);
+			data_pointer.compressed = reader.Read<bool>();
+			data_pointer.statistics = SegmentStatistics::Deserialize(reader, GetInternalType(column.type));
+			idx_t overflow_block_count = reader.Read<idx_t>();
+			for (idx_t i = 0; i < overflow_block_count; i++) {
+				data_pointer.overflow_blocks.push_back(reader.Read<block_id_t>());
+			}
 
 			column_count += data_pointer.tuple_count;
 			// create a persistent segment
 			auto segment = make_unique<PersistentSegment>(
 			    manager.buffer_manager, data_pointer.block_id, data_pointer.offset, GetInternalType(column.type),
-			    data_pointer.row_start, data_pointer.tuple_count, data_pointer.min_stats, data_pointer.max_stats);
+			    data_pointer.row_start, data_pointer.tuple_count, move(data_pointer.statistics),
+			    data_pointer.compressed);
+			segment->overflow_blocks = move(data_pointer.overflow_blocks);
 			info.data[col].push_back(move(segment));
 		}
 		if (col == 0) {
@@ -58,4 +64,17 @@ void TableDataReader::ReadTableData() {
 			}
 		}
 	}
+	// finally load the rows that are deleted
+	idx_t vector_count = reader.Read<idx_t>();
+	for (idx_t i = 0; i < vector_count; i++) {
+		idx_t vector_index = reader.Read<idx_t>();
+		for (idx_t k = 0; k < (STANDARD_VECTOR_SIZE + 63) / 64; k++) {
+			auto mask = reader.Read<uint64_t>();
+			for (idx_t bit = 0; bit < 64; bit++) {
+				if (mask & ((uint64_t)1 << bit)) {
+					info.deleted_rows.push_back(vector_index * STANDARD_VECTOR_SIZE + k * 64 + bit);
+				}
+			}
+		}
+	}
 }
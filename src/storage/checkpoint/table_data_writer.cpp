@@ -2,13 +2,16 @@
 
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/common/types/null_value.hpp"
+#include "duckdb/common/types/hyperloglog.hpp"
 
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/common/serializer/buffered_serializer.hpp"
 
+#include "duckdb/storage/compressed_segment.hpp"
 #include "duckdb/storage/numeric_segment.hpp"
 #include "duckdb/storage/string_segment.hpp"
 #include "duckdb/storage/table/column_segment.hpp"
+#include "duckdb/storage/table/persistent_segment.hpp"
 
 using namespace duckdb;
 using namespace std;
@@ -26,6 +29,8 @@ public:
 	block_id_t block_id;
 	//! The offset within the current block
 	idx_t offset;
+	//! All blocks that were written to
+	vector<block_id_t> written_blocks;
 
 	static constexpr idx_t STRING_SPACE = Storage::BLOCK_SIZE - sizeof(block_id_t);
 
@@ -37,56 +42,48 @@ private:
 };
 
 TableDataWriter::TableDataWriter(CheckpointManager &manager, TableCatalogEntry &table)
-    : manager(manager), table(table) {
+    : manager(manager), table(table), vacuumed(false) {
 }
 
 TableDataWriter::~TableDataWriter() {
 }
 
-void TableDataWriter::WriteTableData(Transaction &transaction) {
-	// allocate segments to write the table to
+void TableDataWriter::WriteTableData(Transaction &transaction, bool vacuum) {
+	vacuumed = vacuum;
+	// segments are created lazily when data is appended to a column
 	segments.resize(table.columns.size());
 	data_pointers.resize(table.columns.size());
-	for (idx_t i = 0; i < table.columns.size(); i++) {
-		auto type_id = GetInternalType(table.columns[i].type);
-		stats.push_back(make_unique<SegmentStatistics>(type_id, GetTypeIdSize(type_id)));
-		CreateSegment(i);
-	}
-
-	// now start scanning the table and append the data to the uncompressed segments
-	vector<column_t> column_ids;
-	for (auto &column : table.columns) {
-		column_ids.push_back(column.oid);
-	}
-	// initialize scan structures to prepare for the scan
-	TableScanState state;
-	table.storage->InitializeScan(transaction, state, column_ids);
-	//! get all types of the table and initialize the chunk
-	auto types = table.GetTypes();
-	DataChunk chunk;
-	chunk.Initialize(types);
-
-	while (true) {
-		chunk.Reset();
-		// now scan the table to construct the blocks
-		unordered_map<idx_t, vector<TableFilter>> mock;
-		table.storage->Scan(transaction, chunk, state, column_ids, mock);
-		if (chunk.size() == 0) {
-			break;
-		}
-		// for each column, we append whatever we can fit into the block
-		idx_t chunk_size = chunk.size();
-		for (idx_t i = 0; i < table.columns.size(); i++) {
-			assert(chunk.data[i].type == GetInternalType(table.columns[i].type));
-			AppendData(transaction, i, chunk.data[i], chunk_size);
-		}
-	}
+	stats.resize(table.columns.size());
+	distinct_counters.resize(table.columns.size());
+
+	// let the table write its columns: unchanged persistent segments are reused, all other data is appended
+	table.storage->Checkpoint(*this, transaction, vacuum);
+
 	// flush any remaining data and write the data pointers to disk
 	for (idx_t i = 0; i < table.columns.size(); i++) {
 		FlushSegment(transaction, i);
 	}
 	VerifyDataPointers();
 	WriteDataPointers();
+	// a vacuum leaves out the deleted rows entirely
+	WriteDeletedRows(vacuum ? vector<row_t>() : table.storage->GetDeletedRows());
+}
+
+void TableDataWriter::CommitTableData() {
+	auto data = unique_ptr<vector<unique_ptr<PersistentSegment>>[]>(
+	    new vector<unique_ptr<PersistentSegment>>[table.columns.size()]);
+	for (idx_t col_idx = 0; col_idx < table.columns.size(); col_idx++) {
+		auto type = GetInternalType(table.columns[col_idx].type);
+		for (auto &data_pointer : data_pointers[col_idx]) {
+			auto segment = make_unique<PersistentSegment>(
+			    manager.buffer_manager, data_pointer.block_id, data_pointer.offset, type, data_pointer.row_start,
+			    data_pointer.tuple_count, move(data_pointer.statistics), data_pointer.compressed);
+			segment->overflow_blocks = move(data_pointer.overflow_blocks);
+			data[col_idx].push_back(move(segment));
+		}
+	}
+	data_pointers.clear();
+	table.storage->CommitCheckpoint(move(data), vacuumed);
 }
 
 void TableDataWriter::CreateSegment(idx_t col_idx) {
@@ -94,16 +91,45 @@ void TableDataWriter::CreateSegment(idx_t col_idx) {
 	if (type_id == TypeId::VARCHAR) {
 		auto string_segment = make_unique<StringSegment>(manager.buffer_manager, 0);
 		string_segment->overflow_writer = make_unique<WriteOverflowStringsToDisk>(manager);
+		// store repeated strings only once in the dictionary of the persistent segment
+		string_segment->string_dictionary = make_unique<unordered_map<string, int32_t>>();
 		segments[col_idx] = move(string_segment);
+	} else if (CompressedSegment::SupportsType(type_id)) {
+		segments[col_idx] = make_unique<CompressedSegment>(manager.buffer_manager, type_id, 0);
 	} else {
 		segments[col_idx] = make_unique<NumericSegment>(manager.buffer_manager, type_id, 0);
 	}
+	stats[col_idx] = make_unique<SegmentStatistics>(type_id, GetTypeIdSize(type_id));
+	distinct_counters[col_idx] = make_unique<HyperLogLog>();
+}
+
+void TableDataWriter::UpdateDistinctCount(idx_t col_idx, Vector &data, idx_t offset, idx_t count) {
+	// add the hashes of the values to the HyperLogLog counter of the segment, rather than the values themselves
+	auto &counter = *distinct_counters[col_idx];
+	Vector hashes(TypeId::HASH);
+	VectorOperations::Hash(data, hashes, offset + count);
+	VectorData hdata;
+	hashes.Orrify(offset + count, hdata);
+	VectorData vdata;
+	data.Orrify(offset + count, vdata);
+	auto hash_data = (hash_t *)hdata.data;
+	for (idx_t i = offset; i < offset + count; i++) {
+		if ((*vdata.nullmask)[vdata.sel->get_index(i)]) {
+			continue;
+		}
+		counter.Add((data_ptr_t)&hash_data[hdata.sel->get_index(i)], sizeof(hash_t));
+	}
 }
 
 void TableDataWriter::AppendData(Transaction &transaction, idx_t col_idx, Vector &data, idx_t count) {
+	assert(data.type == GetInternalType(table.columns[col_idx].type));
+	if (!segments[col_idx]) {
+		CreateSegment(col_idx);
+	}
 	idx_t offset = 0;
 	while (count > 0) {
 		idx_t appended = segments[col_idx]->Append(*stats[col_idx], data, offset, count);
+		UpdateDistinctCount(col_idx, data, offset, appended);
 		if (appended == count) {
 			// appended everything: finished
 			return;
@@ -118,9 +144,39 @@ void TableDataWriter::AppendData(Transaction &transaction, idx_t col_idx, Vector
 	}
 }
 
+void TableDataWriter::ReuseSegment(Transaction &transaction, idx_t col_idx, PersistentSegment &segment) {
+	// first flush any data that precedes the segment
+	FlushSegment(transaction, col_idx);
+
+	DataPointer data_pointer;
+	data_pointer.block_id = segment.block_id;
+	data_pointer.offset = segment.offset;
+	data_pointer.compressed = segment.compressed;
+	data_pointer.row_start = 0;
+	if (data_pointers[col_idx].size() > 0) {
+		auto &last_pointer = data_pointers[col_idx].back();
+		data_pointer.row_start = last_pointer.row_start + last_pointer.tuple_count;
+	}
+	// note that the row_start of the segment can differ from its current start when preceding rows were vacuumed
+	data_pointer.tuple_count = segment.count;
+	data_pointer.statistics = segment.stats.Copy();
+	data_pointer.overflow_blocks = segment.overflow_blocks;
+
+	// the blocks of the segment are still in use: they should not end up in the free list
+	manager.block_manager.MarkBlockAsUsed(data_pointer.block_id);
+	for (auto &block_id : data_pointer.overflow_blocks) {
+		manager.block_manager.MarkBlockAsUsed(block_id);
+	}
+	data_pointers[col_idx].push_back(move(data_pointer));
+}
+
 void TableDataWriter::FlushSegment(Transaction &transaction, idx_t col_idx) {
+	if (!segments[col_idx]) {
+		return;
+	}
 	auto tuple_count = segments[col_idx]->tuple_count;
 	if (tuple_count == 0) {
+		segments[col_idx] = nullptr;
 		return;
 	}
 
@@ -130,19 +186,25 @@ void TableDataWriter::FlushSegment(Transaction &transaction, idx_t col_idx) {
 	// get a free block id to write to
 	auto block_id = manager.block_manager.GetFreeBlockId();
 
-	// construct the data pointer, FIXME: add statistics as well
+	// construct the data pointer
 	DataPointer data_pointer;
 	data_pointer.block_id = block_id;
 	data_pointer.offset = 0;
+	data_pointer.compressed =
+	    stats[col_idx]->type == TypeId::VARCHAR || CompressedSegment::SupportsType(stats[col_idx]->type);
 	data_pointer.row_start = 0;
 	if (data_pointers[col_idx].size() > 0) {
 		auto &last_pointer = data_pointers[col_idx].back();
 		data_pointer.row_start = last_pointer.row_start + last_pointer.tuple_count;
 	}
 	data_pointer.tuple_count = tuple_count;
-	idx_t type_size = stats[col_idx]->type == TypeId::VARCHAR ? 8 : stats[col_idx]->type_size;
-	memcpy(&data_pointer.min_stats, stats[col_idx]->minimum.get(), type_size);
-	memcpy(&data_pointer.max_stats, stats[col_idx]->maximum.get(), type_size);
+	stats[col_idx]->distinct_count = distinct_counters[col_idx]->Count();
+	data_pointer.statistics = move(stats[col_idx]);
+	if (data_pointer.statistics->type == TypeId::VARCHAR) {
+		auto &string_segment = (StringSegment &)*segments[col_idx];
+		auto &overflow_writer = (WriteOverflowStringsToDisk &)*string_segment.overflow_writer;
+		data_pointer.overflow_blocks = overflow_writer.written_blocks;
+	}
 	data_pointers[col_idx].push_back(move(data_pointer));
 	// write the block to disk
 	manager.block_manager.Write(*handle->node, block_id);
@@ -162,9 +224,6 @@ void TableDataWriter::VerifyDataPointers() {
 			auto &data_pointer = data_pointer_list[k];
 			column_count += data_pointer.tuple_count;
 		}
-		if (segments[i]) {
-			column_count += segments[i]->tuple_count;
-		}
 		if (i == 0) {
 			table_count = column_count;
 		} else {
@@ -189,8 +248,32 @@ void TableDataWriter::WriteDataPointers() {
 			manager.tabledata_writer->Write<idx_t>(data_pointer.tuple_count);
 			manager.tabledata_writer->Write<block_id_t>(data_pointer.block_id);
 			manager.tabledata_writer->Write<uint32_t>(data_pointer.offset);
-			manager.tabledata_writer->WriteData(data_pointer.min_stats, 16);
-			manager.tabledata_writer->WriteData(data_pointer.max_stats, 16);
+			manager.tabledata_writer->Write<bool>(data_pointer.compressed);
+			data_pointer.statistics->Serialize(*manager.tabledata_writer);
+			manager.tabledata_writer->Write<idx_t>(data_pointer.overflow_blocks.size());
+			for (auto &block_id : data_pointer.overflow_blocks) {
+				manager.tabledata_writer->Write<block_id_t>(block_id);
+			}
+		}
+	}
+}
+
+void TableDataWriter::WriteDeletedRows(const vector<row_t> &deleted_rows) {
+	// group the (sorted) deleted rows by vector
+	vector<pair<idx_t, vector<uint64_t>>> masks;
+	for (auto &row : deleted_rows) {
+		idx_t vector_index = row / STANDARD_VECTOR_SIZE;
+		idx_t offset = row % STANDARD_VECTOR_SIZE;
+		if (masks.size() == 0 || masks.back().first != vector_index) {
+			masks.push_back(make_pair(vector_index, vector<uint64_t>((STANDARD_VECTOR_SIZE + 63) / 64, 0)));
+		}
+		masks.back().second[offset / 64] |= (uint64_t)1 << (offset % 64);
+	}
+	manager.tabledata_writer->Write<idx_t>(masks.size());
+	for (auto &mask : masks) {
+		manager.tabledata_writer->Write<idx_t>(mask.first);
+		for (auto &entry : mask.second) {
+			manager.tabledata_writer->Write<uint64_t>(entry);
 		}
 	}
 }
@@ -250,4 +333,5 @@ void WriteOverflowStringsToDisk::AllocateNewBlock(block_id_t new_block_id) {
 	}
 	offset = 0;
 	block_id = new_block_id;
+	written_blocks.push_back(new_block_id);
 }
@@ -33,14 +33,19 @@ using namespace std;
 // constexpr uint64_t CheckpointManager::DATA_BLOCK_HEADER_SIZE;
 
 CheckpointManager::CheckpointManager(StorageManager &manager)
-    : block_manager(*manager.block_manager), buffer_manager(*manager.buffer_manager), database(manager.database) {
+    : block_manager(*manager.block_manager), buffer_manager(*manager.buffer_manager), database(manager.database),
+      vacuum(false), vacuum_table(nullptr) {
 }
 
-void CheckpointManager::CreateCheckpoint() {
+CheckpointManager::~CheckpointManager() {
+}
+
+void CheckpointManager::CreateCheckpoint(Transaction &transaction, bool vacuum, TableCatalogEntry *vacuum_table) {
 	// assert that the checkpoint manager hasn't been used before
 	assert(!metadata_writer);
+	this->vacuum = vacuum;
+	this->vacuum_table = vacuum_table;
 
-	auto transaction = database.transaction_manager->StartTransaction();
 	block_manager.StartCheckpoint();
 
 	//! Set up the writers for the checkpoints
@@ -52,22 +57,43 @@ void CheckpointManager::CreateCheckpoint() {
 
 	vector<SchemaCatalogEntry *> schemas;
 	// we scan the schemas
-	database.catalog->schemas->Scan(*transaction,
+	database.catalog->schemas->Scan(transaction,
 	                               [&](CatalogEntry *entry) { schemas.push_back((SchemaCatalogEntry *)entry); });
 	// write the actual data into the database
 	// write the amount of schemas
 	metadata_writer->Write<uint32_t>(schemas.size());
 	for (auto &schema : schemas) {
-		WriteSchema(*transaction, *schema);
+		WriteSchema(transaction, *schema);
 	}
 	// flush the meta data to disk
 	metadata_writer->Flush();
 	tabledata_writer->Flush();
 
+	// mark in the WAL that its contents are part of the checkpoint, so it is not replayed if we crash before it is
+	// truncated
+	auto wal = database.storage->GetWriteAheadLog();
+	if (wal) {
+		wal->WriteCheckpoint(meta_block);
+		wal->Flush();
+	}
+
 	// finally write the updated header
 	DatabaseHeader header;
 	header.meta_block = meta_block;
 	block_manager.WriteHeader(header);
+
+	// the checkpoint is written: the tables now use the written segments
+	for (auto &writer : table_writers) {
+		writer->CommitTableData();
+	}
+	table_writers.clear();
+	// the blocks that are no longer used can be reused by the next checkpoint: remove them from the buffer cache
+	for (auto &block_id : block_manager.GetFreeBlocks()) {
+		buffer_manager.UnloadBlock(block_id);
+	}
+	if (wal) {
+		wal->Truncate(0);
+	}
 }
 
 void CheckpointManager::LoadFromStorage() {
@@ -188,8 +214,22 @@ void CheckpointManager::WriteTable(Transaction &transaction, TableCatalogEntry &
 	//! and the offset to where the info starts
 	metadata_writer->Write<uint64_t>(tabledata_writer->offset);
 	// now we need to write the table data
-	TableDataWriter writer(*this, table);
-	writer.WriteTableData(transaction);
+	auto writer = make_unique<TableDataWriter>(*this, table);
+	writer->WriteTableData(transaction, ShouldVacuum(table));
+	table_writers.push_back(move(writer));
+}
+
+bool CheckpointManager::ShouldVacuum(TableCatalogEntry &table) {
+	if (vacuum) {
+		return !vacuum_table || vacuum_table->storage.get() == table.storage.get();
+	}
+	auto &config = database.config;
+	if (!config.auto_vacuum) {
+		return false;
+	}
+	// automatically vacuum tables of which a large enough fraction of the rows is deleted
+	idx_t deleted_count = table.storage->GetDeletedRows().size();
+	return deleted_count > 0 && deleted_count >= config.auto_vacuum_threshold * table.storage->GetTotalRows();
 }
 
 void CheckpointManager::ReadTable(ClientContext &context, MetaBlockReader &reader) {
@@ -3,6 +3,7 @@
 #include "duckdb/storage/table/transient_segment.hpp"
 #include "duckdb/storage/data_table.hpp"
 #include "duckdb/storage/storage_manager.hpp"
+#include "duckdb/storage/checkpoint/table_data_writer.hpp"
 
 using namespace duckdb;
 using namespace std;
@@ -155,12 +156,29 @@ void ColumnData::RevertAppend(row_t start_row) {
 	transient.RevertAppend(start_row);
 }
 
-void ColumnData::Update(Transaction &transaction, Vector &updates, Vector &row_ids, idx_t count) {
-	// first find the segment that the update belongs to
-	idx_t first_id = FlatVector::GetValue<row_t>(row_ids, 0);
-	auto segment = (ColumnSegment *)data.GetSegment(first_id);
-	// now perform the update within the segment
-	segment->Update(*this, transaction, updates, FlatVector::GetData<row_t>(row_ids), count);
+void ColumnData::Update(Transaction &transaction, Vector &updates, row_t *ids, idx_t count) {
+	idx_t offset = 0;
+	while (offset < count) {
+		// find the segment and the vector that the next update belongs to
+		auto segment = (ColumnSegment *)data.GetSegment(ids[offset]);
+		idx_t vector_index = (ids[offset] - segment->start) / STANDARD_VECTOR_SIZE;
+		idx_t vector_end = min(segment->start + (vector_index + 1) * STANDARD_VECTOR_SIZE,
+		                       segment->start + segment->count);
+		// the row ids are sorted: all updates up to the end of the vector are performed together
+		idx_t next = offset + 1;
+		while (next < count && (idx_t)ids[next] < vector_end) {
+			next++;
+		}
+		if (offset == 0 && next == count) {
+			// all updates belong to the same vector
+			segment->Update(*this, transaction, updates, ids, count);
+			return;
+		}
+		Vector vector_updates;
+		vector_updates.Slice(updates, offset);
+		segment->Update(*this, transaction, vector_updates, ids + offset, next - offset);
+		offset = next;
+	}
 }
 
 void ColumnData::Fetch(ColumnScanState &state, row_t row_id, Vector &result) {
@@ -179,6 +197,104 @@ void ColumnData::FetchRow(ColumnFetchState &state, Transaction &transaction, row
 	segment->FetchRow(state, transaction, row_id, result, result_idx);
 }
 
+void ColumnData::Checkpoint(TableDataWriter &writer, Transaction &transaction, idx_t col_idx,
+                            DataTable *vacuum_table) {
+	SelectionVector sel(STANDARD_VECTOR_SIZE);
+	// the amount of rows written for this column so far
+	idx_t written_rows = 0;
+	auto segment = (ColumnSegment *)data.GetRootSegment();
+	while (segment) {
+		if (segment->segment_type == ColumnSegmentType::PERSISTENT && written_rows % STANDARD_VECTOR_SIZE == 0) {
+			// persistent segments that were not updated since the last checkpoint can be kept as-is
+			// note that only the last segment of a column can end in the middle of a vector
+			auto &persistent = (PersistentSegment &)*segment;
+			bool reuse = persistent.data->block_id == persistent.block_id &&
+			             (!segment->next || segment->count % STANDARD_VECTOR_SIZE == 0);
+			if (reuse && vacuum_table) {
+				// when vacuuming the segment can only be kept if none of its rows are deleted
+				for (idx_t offset = 0; reuse && offset < segment->count; offset += STANDARD_VECTOR_SIZE) {
+					idx_t count = std::min((idx_t)STANDARD_VECTOR_SIZE, segment->count - offset);
+					reuse = vacuum_table->GetVisibleRows(transaction, segment->start + offset, sel, count) == count;
+				}
+			}
+			if (reuse) {
+				writer.ReuseSegment(transaction, col_idx, persistent);
+				written_rows += segment->count;
+				segment = (ColumnSegment *)segment->next.get();
+				continue;
+			}
+		}
+		// otherwise rewrite the data of the segment, including any committed updates
+		ColumnScanState state;
+		segment->InitializeScan(state);
+		for (idx_t vector_index = 0; vector_index * STANDARD_VECTOR_SIZE < segment->count; vector_index++) {
+			idx_t offset = vector_index * STANDARD_VECTOR_SIZE;
+			idx_t count = std::min((idx_t)STANDARD_VECTOR_SIZE, segment->count - offset);
+			idx_t visible_count = count;
+			if (vacuum_table) {
+				visible_count = vacuum_table->GetVisibleRows(transaction, segment->start + offset, sel, count);
+				if (visible_count == 0) {
+					continue;
+				}
+			}
+			Vector result(type);
+			segment->Scan(transaction, state, vector_index, result);
+			if (visible_count != count) {
+				result.Slice(sel, visible_count);
+			}
+			writer.AppendData(transaction, col_idx, result, visible_count);
+			written_rows += visible_count;
+		}
+		segment = (ColumnSegment *)segment->next.get();
+	}
+}
+
+void ColumnData::CommitCheckpoint(vector<unique_ptr<PersistentSegment>> &segments) {
+	lock_guard<mutex> tree_lock(data.node_lock);
+	data.nodes.clear();
+	data.root_node = nullptr;
+	persistent_rows = 0;
+	Initialize(segments);
+}
+
+void ColumnData::Vacuum(Transaction &transaction, DataTable &table) {
+	// append the rows that are not deleted to a new set of transient segments
+	ColumnData vacuumed(manager, table_info);
+	vacuumed.type = type;
+	vacuumed.column_idx = column_idx;
+	{
+		ColumnAppendState append_state;
+		vacuumed.InitializeAppend(append_state);
+
+		SelectionVector sel(STANDARD_VECTOR_SIZE);
+		auto segment = (ColumnSegment *)data.GetRootSegment();
+		while (segment) {
+			ColumnScanState state;
+			segment->InitializeScan(state);
+			for (idx_t vector_index = 0; vector_index * STANDARD_VECTOR_SIZE < segment->count; vector_index++) {
+				idx_t offset = vector_index * STANDARD_VECTOR_SIZE;
+				idx_t count = std::min((idx_t)STANDARD_VECTOR_SIZE, segment->count - offset);
+				idx_t visible_count = table.GetVisibleRows(transaction, segment->start + offset, sel, count);
+				if (visible_count == 0) {
+					continue;
+				}
+				Vector result(type);
+				segment->Scan(transaction, state, vector_index, result);
+				if (visible_count != count) {
+					result.Slice(sel, visible_count);
+				}
+				vacuumed.Append(append_state, result, visible_count);
+			}
+			segment = (ColumnSegment *)segment->next.get();
+		}
+	}
+	// now replace the segments of the column
+	lock_guard<mutex> tree_lock(data.node_lock);
+	data.nodes = move(vacuumed.data.nodes);
+	data.root_node = move(vacuumed.data.root_node);
+	persistent_rows = 0;
+}
+
 void ColumnData::AppendTransientSegment(idx_t start_row) {
 	auto new_segment = make_unique<TransientSegment>(manager, type, start_row);
 	data.AppendSegment(move(new_segment));
@@ -0,0 +1,478 @@
+#include "duckdb/storage/compressed_segment.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "duckdb/common/types/vector.hpp"
+#include "duckdb/common/vector_size.hpp"
+#include "duckdb/common/exception.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+using namespace std;
+
+namespace duckdb {
+
+//! The header that is stored in front of every compressed vector
+struct CompressedVectorHeader {
+	VectorCompression compression;
+	bool has_null;
+	uint16_t padding;
+	//! The amount of runs (RLE) or the bit width of the packed values (BITPACKING)
+	uint32_t parameter;
+};
+static_assert(sizeof(CompressedVectorHeader) == 8, "CompressedVectorHeader should be 8 bytes");
+
+static constexpr idx_t VECTOR_DIRECTORY_SIZE = CompressedSegment::MAX_VECTOR_COUNT * sizeof(uint32_t);
+
+static idx_t AlignVectorOffset(idx_t offset) {
+	return (offset + 7) & ~((idx_t)7);
+}
+
+//! The size of a vector that could not be compressed at all, the space for this is reserved before a vector is started
+static idx_t MaximumVectorSize(idx_t type_size) {
+	return AlignVectorOffset(sizeof(CompressedVectorHeader) + sizeof(nullmask_t) + type_size * STANDARD_VECTOR_SIZE);
+}
+
+//! The offset of the run ends in an RLE compressed vector, the run ends are stored after the run values
+template <class T> static inline idx_t RunEndOffset(idx_t run_count) {
+	return (run_count * sizeof(T) + 1) & ~((idx_t)1);
+}
+
+template <class T> static inline bool IdenticalValues(T left, T right) {
+	// compare the bit patterns, so that e.g. -0.0 and 0.0 do not end up in the same run
+	return memcmp(&left, &right, sizeof(T)) == 0;
+}
+
+//===--------------------------------------------------------------------===//
+// Compression
+//===--------------------------------------------------------------------===//
+template <class T> static void BitPack(T *values, idx_t count, uint64_t reference, idx_t width, data_ptr_t target) {
+	*((uint64_t *)target) = reference;
+	auto words = (uint64_t *)(target + sizeof(uint64_t));
+	idx_t word_count = (count * width + 63) / 64;
+	memset(words, 0, word_count * sizeof(uint64_t));
+	idx_t bit_position = 0;
+	for (idx_t i = 0; i < count; i++, bit_position += width) {
+		uint64_t delta = (uint64_t)(int64_t)values[i] - reference;
+		idx_t word = bit_position / 64;
+		idx_t shift = bit_position % 64;
+		words[word] |= delta << shift;
+		if (shift + width > 64) {
+			// the value spills over into the next word
+			words[word + 1] |= delta >> (64 - shift);
+		}
+	}
+}
+
+template <class T> static idx_t CompressVector(data_ptr_t source, idx_t count, data_ptr_t target) {
+	auto &nullmask = *((nullmask_t *)source);
+	auto source_data = (T *)(source + sizeof(nullmask_t));
+	bool has_null = nullmask.any();
+
+	// replace NULL values with the preceding value, so they do not break runs or widen the bit-packing range
+	T values[STANDARD_VECTOR_SIZE];
+	if (has_null) {
+		T previous = T();
+		for (idx_t i = 0; i < count; i++) {
+			if (!nullmask[i]) {
+				previous = source_data[i];
+				break;
+			}
+		}
+		for (idx_t i = 0; i < count; i++) {
+			if (!nullmask[i]) {
+				previous = source_data[i];
+			}
+			values[i] = previous;
+		}
+	} else {
+		memcpy(values, source_data, count * sizeof(T));
+	}
+
+	// figure out the size of the vector with every compression method and pick the smallest one
+	idx_t run_count = 1;
+	for (idx_t i = 1; i < count; i++) {
+		if (!IdenticalValues<T>(values[i], values[i - 1])) {
+			run_count++;
+		}
+	}
+	VectorCompression compression = VectorCompression::UNCOMPRESSED;
+	idx_t compressed_size = count * sizeof(T);
+	idx_t rle_size = RunEndOffset<T>(run_count) + run_count * sizeof(uint16_t);
+	if (rle_size < compressed_size) {
+		compression = VectorCompression::RLE;
+		compressed_size = rle_size;
+	}
+	uint64_t reference = 0;
+	idx_t bit_width = 0;
+	if (std::is_integral<T>::value) {
+		auto min = (int64_t)values[0], max = (int64_t)values[0];
+		for (idx_t i = 1; i < count; i++) {
+			min = std::min(min, (int64_t)values[i]);
+			max = std::max(max, (int64_t)values[i]);
+		}
+		reference = (uint64_t)min;
+		uint64_t range = (uint64_t)max - (uint64_t)min;
+		while (range > 0) {
+			bit_width++;
+			range >>= 1;
+		}
+		idx_t bitpacking_size = sizeof(uint64_t) + (count * bit_width + 63) / 64 * sizeof(uint64_t);
+		if (bitpacking_size < compressed_size) {
+			compression = VectorCompression::BITPACKING;
+			compressed_size = bitpacking_size;
+		}
+	}
+
+	// now write the vector
+	auto &header = *((CompressedVectorHeader *)target);
+	header.compression = compression;
+	header.has_null = has_null;
+	header.padding = 0;
+	header.parameter = 0;
+	auto data = target + sizeof(CompressedVectorHeader);
+	if (has_null) {
+		memcpy(data, &nullmask, sizeof(nullmask_t));
+		data += sizeof(nullmask_t);
+	}
+	switch (compression) {
+	case VectorCompression::UNCOMPRESSED:
+		memcpy(data, values, count * sizeof(T));
+		break;
+	case VectorCompression::RLE: {
+		header.parameter = run_count;
+		auto run_values = (T *)data;
+		auto run_ends = (uint16_t *)(data + RunEndOffset<T>(run_count));
+		idx_t run = 0;
+		for (idx_t i = 1; i < count; i++) {
+			if (!IdenticalValues<T>(values[i], values[i - 1])) {
+				run_values[run] = values[i - 1];
+				run_ends[run] = i;
+				run++;
+			}
+		}
+		run_values[run] = values[count - 1];
+		run_ends[run] = count;
+		break;
+	}
+	case VectorCompression::BITPACKING:
+		header.parameter = bit_width;
+		BitPack<T>(values, count, reference, bit_width, data);
+		break;
+	}
+	return (data - target) + compressed_size;
+}
+
+//===--------------------------------------------------------------------===//
+// Decompression
+//===--------------------------------------------------------------------===//
+static inline uint64_t BitUnpackValue(uint64_t *words, idx_t width, uint64_t mask, idx_t index) {
+	idx_t bit_position = index * width;
+	idx_t word = bit_position / 64;
+	idx_t shift = bit_position % 64;
+	uint64_t delta = words[word] >> shift;
+	if (shift + width > 64) {
+		delta |= words[word + 1] << (64 - shift);
+	}
+	return delta & mask;
+}
+
+static inline uint64_t BitUnpackMask(idx_t width) {
+	return width == 64 ? ~((uint64_t)0) : (((uint64_t)1 << width) - 1);
+}
+
+template <class T>
+static void DecompressValues(CompressedVectorHeader &header, data_ptr_t data, idx_t count, T *__restrict result) {
+	switch (header.compression) {
+	case VectorCompression::UNCOMPRESSED:
+		memcpy(result, data, count * sizeof(T));
+		break;
+	case VectorCompression::RLE: {
+		auto run_values = (T *)data;
+		auto run_ends = (uint16_t *)(data + RunEndOffset<T>(header.parameter));
+		idx_t idx = 0;
+		for (idx_t run = 0; run < header.parameter; run++) {
+			auto value = run_values[run];
+			for (; idx < run_ends[run]; idx++) {
+				result[idx] = value;
+			}
+		}
+		break;
+	}
+	case VectorCompression::BITPACKING: {
+		auto reference = *((uint64_t *)data);
+		auto words = (uint64_t *)(data + sizeof(uint64_t));
+		auto width = header.parameter;
+		if (width == 0) {
+			// constant vector
+			for (idx_t i = 0; i < count; i++) {
+				result[i] = (T)(int64_t)reference;
+			}
+			break;
+		}
+		auto mask = BitUnpackMask(width);
+		for (idx_t i = 0; i < count; i++) {
+			result[i] = (T)(int64_t)(reference + BitUnpackValue(words, width, mask, i));
+		}
+		break;
+	}
+	}
+}
+
+template <class T> static T DecompressValue(CompressedVectorHeader &header, data_ptr_t data, idx_t index) {
+	switch (header.compression) {
+	case VectorCompression::RLE: {
+		auto run_values = (T *)data;
+		auto run_ends = (uint16_t *)(data + RunEndOffset<T>(header.parameter));
+		// find the first run that ends after the index
+		auto run = std::upper_bound(run_ends, run_ends + header.parameter, (uint16_t)index) - run_ends;
+		return run_values[run];
+	}
+	case VectorCompression::BITPACKING: {
+		auto reference = *((uint64_t *)data);
+		auto words = (uint64_t *)(data + sizeof(uint64_t));
+		auto width = header.parameter;
+		if (width == 0) {
+			return (T)(int64_t)reference;
+		}
+		return (T)(int64_t)(reference + BitUnpackValue(words, width, BitUnpackMask(width), index));
+	}
+	default:
+		return ((T *)data)[index];
+	}
+}
+
+template <class T>
+static void DecompressVectorTemplated(data_ptr_t source, idx_t count, Vector &result, bool emit_constant) {
+	auto &header = *((CompressedVectorHeader *)source);
+	auto data = source + sizeof(CompressedVectorHeader);
+	if (emit_constant && !header.has_null &&
+	    ((header.compression == VectorCompression::RLE && header.parameter == 1) ||
+	     (header.compression == VectorCompression::BITPACKING && header.parameter == 0))) {
+		// the vector consists of a single value: emit a constant vector
+		result.vector_type = VectorType::CONSTANT_VECTOR;
+		ConstantVector::SetNull(result, false);
+		*ConstantVector::GetData<T>(result) = DecompressValue<T>(header, data, 0);
+		return;
+	}
+	result.vector_type = VectorType::FLAT_VECTOR;
+	if (header.has_null) {
+		FlatVector::SetNullmask(result, *((nullmask_t *)data));
+		data += sizeof(nullmask_t);
+	} else {
+		FlatVector::Nullmask(result).reset();
+	}
+	DecompressValues<T>(header, data, count, FlatVector::GetData<T>(result));
+}
+
+template <class T>
+static void DecompressRowTemplated(data_ptr_t source, idx_t row_idx, Vector &result, idx_t result_idx) {
+	auto &header = *((CompressedVectorHeader *)source);
+	auto data = source + sizeof(CompressedVectorHeader);
+	bool is_null = false;
+	if (header.has_null) {
+		is_null = (*((nullmask_t *)data))[row_idx];
+		data += sizeof(nullmask_t);
+	}
+	FlatVector::SetNull(result, result_idx, is_null);
+	FlatVector::GetData<T>(result)[result_idx] = DecompressValue<T>(header, data, row_idx);
+}
+
+//===--------------------------------------------------------------------===//
+// Compressed Segment
+//===--------------------------------------------------------------------===//
+bool CompressedSegment::SupportsType(TypeId type) {
+	switch (type) {
+	case TypeId::BOOL:
+	case TypeId::INT8:
+	case TypeId::INT16:
+	case TypeId::INT32:
+	case TypeId::INT64:
+	case TypeId::FLOAT:
+	case TypeId::DOUBLE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+template <class T> static void SetCompressionFunctions(CompressedSegment::compress_function_t &compress,
+                                                       CompressedSegment::decompress_function_t &decompress,
+                                                       CompressedSegment::decompress_row_function_t &decompress_row) {
+	compress = CompressVector<T>;
+	decompress = DecompressVectorTemplated<T>;
+	decompress_row = DecompressRowTemplated<T>;
+}
+
+void CompressedSegment::InitializeFunctions() {
+	switch (type) {
+	case TypeId::BOOL:
+	case TypeId::INT8:
+		SetCompressionFunctions<int8_t>(compress_function, decompress_function, decompress_row_function);
+		break;
+	case TypeId::INT16:
+		SetCompressionFunctions<int16_t>(compress_function, decompress_function, decompress_row_function);
+		break;
+	case TypeId::INT32:
+		SetCompressionFunctions<int32_t>(compress_function, decompress_function, decompress_row_function);
+		break;
+	case TypeId::INT64:
+		SetCompressionFunctions<int64_t>(compress_function, decompress_function, decompress_row_function);
+		break;
+	case TypeId::FLOAT:
+		SetCompressionFunctions<float>(compress_function, decompress_function, decompress_row_function);
+		break;
+	case TypeId::DOUBLE:
+		SetCompressionFunctions<double>(compress_function, decompress_function, decompress_row_function);
+		break;
+	default:
+		throw InvalidTypeException(type, "Unsupported type for compressed segment");
+	}
+}
+
+CompressedSegment::CompressedSegment(BufferManager &manager, TypeId type, idx_t row_start)
+    : NumericSegment(manager, type, row_start), compressed(true), append_offset(VECTOR_DIRECTORY_SIZE) {
+	InitializeFunctions();
+	this->max_vector_count = MAX_VECTOR_COUNT;
+	this->append_vector = unique_ptr<data_t[]>(new data_t[vector_size]);
+}
+
+CompressedSegment::CompressedSegment(BufferManager &manager, TypeId type, idx_t row_start, block_id_t block_id,
+                                     idx_t tuple_count)
+    : NumericSegment(manager, type, row_start, block_id), compressed(true), append_offset(0) {
+	InitializeFunctions();
+	this->tuple_count = tuple_count;
+	this->max_vector_count = (tuple_count + STANDARD_VECTOR_SIZE - 1) / STANDARD_VECTOR_SIZE;
+}
+
+void CompressedSegment::DecompressVector(data_ptr_t baseptr, idx_t vector_index, Vector &result, bool emit_constant) {
+	auto vector_offsets = (uint32_t *)baseptr;
+	decompress_function(baseptr + vector_offsets[vector_index], GetVectorCount(vector_index), result, emit_constant);
+}
+
+//===--------------------------------------------------------------------===//
+// Scan
+//===--------------------------------------------------------------------===//
+void CompressedSegment::FetchBaseData(ColumnScanState &state, idx_t vector_index, Vector &result) {
+	if (!compressed) {
+		NumericSegment::FetchBaseData(state, vector_index, result);
+		return;
+	}
+	auto handle = manager.Pin(block_id);
+	DecompressVector(handle->node->buffer, vector_index, result, true);
+}
+
+void CompressedSegment::FilterFetchBaseData(ColumnScanState &state, Vector &result, SelectionVector &sel,
+                                            idx_t &approved_tuple_count) {
+	if (!compressed) {
+		NumericSegment::FilterFetchBaseData(state, result, sel, approved_tuple_count);
+		return;
+	}
+	FetchBaseData(state, state.vector_index, result);
+	result.Slice(sel, approved_tuple_count);
+}
+
+void CompressedSegment::Select(ColumnScanState &state, Vector &result, SelectionVector &sel,
+                               idx_t &approved_tuple_count, vector<TableFilter> &tableFilter) {
+	if (!compressed) {
+		NumericSegment::Select(state, result, sel, approved_tuple_count, tableFilter);
+		return;
+	}
+	// decompress the vector into the result and evaluate the filters on the decompressed values
+	auto handle = manager.Pin(block_id);
+	DecompressVector(handle->node->buffer, state.vector_index, result, false);
+	SelectData(result, FlatVector::GetData(result), &FlatVector::Nullmask(result), sel, approved_tuple_count,
+	           tableFilter);
+}
+
+//===--------------------------------------------------------------------===//
+// Fetch
+//===--------------------------------------------------------------------===//
+void CompressedSegment::FetchRow(ColumnFetchState &state, Transaction &transaction, row_t row_id, Vector &result,
+                                 idx_t result_idx) {
+	auto read_lock = lock.GetSharedLock();
+	if (!compressed) {
+		// the segment has been decompressed: it can never become compressed again, so we can release the lock here
+		read_lock.reset();
+		NumericSegment::FetchRow(state, transaction, row_id, result, result_idx);
+		return;
+	}
+	// compressed segments are decompressed before they are updated, so there is no version information to check
+	assert(!versions);
+	auto handle = manager.Pin(block_id);
+	auto baseptr = handle->node->buffer;
+
+	idx_t vector_index = row_id / STANDARD_VECTOR_SIZE;
+	idx_t id_in_vector = row_id - vector_index * STANDARD_VECTOR_SIZE;
+	assert(vector_index < max_vector_count);
+
+	auto vector_offsets = (uint32_t *)baseptr;
+	decompress_row_function(baseptr + vector_offsets[vector_index], id_in_vector, result, result_idx);
+}
+
+//===--------------------------------------------------------------------===//
+// Append
+//===--------------------------------------------------------------------===//
+idx_t CompressedSegment::Append(SegmentStatistics &stats, Vector &data, idx_t offset, idx_t count) {
+	assert(data.type == type);
+	assert(compressed && append_vector);
+	auto handle = manager.Pin(block_id);
+	auto baseptr = handle->node->buffer;
+	auto vector_offsets = (uint32_t *)baseptr;
+
+	idx_t initial_count = tuple_count;
+	while (count > 0) {
+		idx_t vector_index = tuple_count / STANDARD_VECTOR_SIZE;
+		idx_t current_tuple_count = tuple_count - vector_index * STANDARD_VECTOR_SIZE;
+		if (current_tuple_count == 0) {
+			// start a new vector: only do this if it fits even if the vector cannot be compressed
+			if (vector_index == max_vector_count || append_offset + MaximumVectorSize(type_size) > Storage::BLOCK_SIZE) {
+				break;
+			}
+			vector_offsets[vector_index] = append_offset;
+			auto nullmask = (nullmask_t *)append_vector.get();
+			nullmask->reset();
+		}
+		idx_t append_count = std::min(STANDARD_VECTOR_SIZE - current_tuple_count, count);
+		append_function(stats, append_vector.get(), current_tuple_count, data, offset, append_count);
+
+		offset += append_count;
+		count -= append_count;
+		tuple_count += append_count;
+
+		// (re-)compress the vector into the block
+		auto vector_start = vector_offsets[vector_index];
+		auto compressed_size = compress_function(append_vector.get(), current_tuple_count + append_count,
+		                                         baseptr + vector_start);
+		append_offset = AlignVectorOffset(vector_start + compressed_size);
+	}
+	return tuple_count - initial_count;
+}
+
+//===--------------------------------------------------------------------===//
+// ToTemporary
+//===--------------------------------------------------------------------===//
+void CompressedSegment::ToTemporary() {
+	auto write_lock = lock.GetExclusiveLock();
+	if (!compressed) {
+		// conversion has already been performed by a different thread
+		return;
+	}
+	auto current = manager.Pin(block_id);
+
+	// decompress every vector into the layout used by the NumericSegment
+	auto alloc_size = std::max((idx_t)Storage::BLOCK_ALLOC_SIZE,
+	                           max_vector_count * vector_size + Storage::BLOCK_HEADER_SIZE);
+	auto handle = manager.Allocate(alloc_size);
+	Vector decompressed(type);
+	for (idx_t vector_index = 0; vector_index < max_vector_count; vector_index++) {
+		DecompressVector(current->node->buffer, vector_index, decompressed, false);
+		auto target = handle->node->buffer + vector_index * vector_size;
+		*((nullmask_t *)target) = FlatVector::Nullmask(decompressed);
+		memcpy(target + sizeof(nullmask_t), FlatVector::GetData(decompressed),
+		       GetVectorCount(vector_index) * type_size);
+	}
+	this->block_id = handle->block_id;
+	this->compressed = false;
+}
+
+} // namespace duckdb
@@ -12,12 +12,14 @@
 #include "duckdb/storage/storage_manager.hpp"
 #include "duckdb/main/client_context.hpp"
 
+#include <algorithm>
+
 using namespace duckdb;
 using namespace std;
 using namespace chrono;
 
 DataTable::DataTable(StorageManager &storage, string schema, string table, vector<TypeId> types_,
-                     unique_ptr<vector<unique_ptr<PersistentSegment>>[]> data)
+                     unique_ptr<vector<unique_ptr<PersistentSegment>>[]> data, vector<row_t> deleted_rows)
     : info(make_shared<DataTableInfo>(schema, table)), types(types_), storage(storage),
       persistent_manager(make_shared<VersionManager>(*info)), transient_manager(make_shared<VersionManager>(*info)),
       is_root(true) {
@@ -40,6 +42,7 @@ DataTable::DataTable(StorageManager &storage, string schema, string table, vecto
 		}
 		persistent_manager->max_row = columns[0]->persistent_rows;
 		transient_manager->base_row = persistent_manager->max_row;
+		persistent_manager->SetDeletedRows(deleted_rows);
 	}
 }
 
@@ -312,113 +315,23 @@ void DataTable::Scan(Transaction &transaction, DataChunk &result, TableScanState
 	transaction.storage.Scan(state.local_state, column_ids, result, &table_filters);
 }
 
-template <class T> bool checkZonemap(TableScanState &state, TableFilter &table_filter, T constant) {
-	T *min = (T *)state.column_scans[table_filter.column_index].current->stats.minimum.get();
-	T *max = (T *)state.column_scans[table_filter.column_index].current->stats.maximum.get();
-	switch (table_filter.comparison_type) {
-	case ExpressionType::COMPARE_EQUAL:
-		return constant >= *min && constant <= *max;
-	case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
-		return constant <= *max;
-	case ExpressionType::COMPARE_GREATERTHAN:
-		return constant < *max;
-	case ExpressionType::COMPARE_LESSTHANOREQUALTO:
-		return constant >= *min;
-	case ExpressionType::COMPARE_LESSTHAN:
-		return constant > *min;
-	default:
-		throw NotImplementedException("Operation not implemented");
-	}
-}
-
-bool checkZonemapString(TableScanState &state, TableFilter &table_filter, const char *constant) {
-	char *min = (char *)state.column_scans[table_filter.column_index].current->stats.minimum.get();
-	char *max = (char *)state.column_scans[table_filter.column_index].current->stats.maximum.get();
-	int min_comp = strcmp(min, constant);
-	int max_comp = strcmp(max, constant);
-	switch (table_filter.comparison_type) {
-	case ExpressionType::COMPARE_EQUAL:
-		return min_comp <= 0 && max_comp >= 0;
-	case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
-	case ExpressionType::COMPARE_GREATERTHAN:
-		return max_comp >= 0;
-	case ExpressionType::COMPARE_LESSTHAN:
-	case ExpressionType::COMPARE_LESSTHANOREQUALTO:
-		return min_comp <= 0;
-	default:
-		throw NotImplementedException("Operation not implemented");
-	}
-}
-
 bool DataTable::CheckZonemap(TableScanState &state, unordered_map<idx_t, vector<TableFilter>> &table_filters,
                              idx_t &current_row) {
 	for (auto &table_filter : table_filters) {
+		auto &column_scan = state.column_scans[table_filter.first];
+		if (column_scan.segment_checked) {
+			continue;
+		}
+		column_scan.segment_checked = true;
+		if (!column_scan.current) {
+			return true;
+		}
+		auto segment = column_scan.current;
 		for (auto &predicate_constant : table_filter.second) {
-            bool readSegment = true;
-
-            if (!state.column_scans[predicate_constant.column_index].segment_checked) {
-				state.column_scans[predicate_constant.column_index].segment_checked = true;
-				if (!state.column_scans[predicate_constant.column_index].current) {
-					return true;
-				}
-				switch (state.column_scans[predicate_constant.column_index].current->type) {
-				case TypeId::INT8: {
-					int8_t constant = predicate_constant.constant.value_.tinyint;
-					readSegment = checkZonemap<int8_t>(state, predicate_constant, constant);
-					break;
-				}
-				case TypeId::INT16: {
-					int16_t constant = predicate_constant.constant.value_.smallint;
-					readSegment = checkZonemap<int16_t>(state, predicate_constant, constant);
-					break;
-				}
-				case TypeId::INT32: {
-					int32_t constant = predicate_constant.constant.value_.integer;
-					readSegment = checkZonemap<int32_t>(state, predicate_constant, constant);
-					break;
-				}
-				case TypeId::INT64: {
-					int64_t constant = predicate_constant.constant.value_.bigint;
-					readSegment = checkZonemap<int64_t>(state, predicate_constant, constant);
-					break;
-				}
-				case TypeId::INT128: {
-					auto constant = predicate_constant.constant.value_.hugeint;
-					readSegment = checkZonemap<hugeint_t>(state, predicate_constant, constant);
-					break;
-				}
-				case TypeId::FLOAT: {
-					float constant = predicate_constant.constant.value_.float_;
-					readSegment = checkZonemap<float>(state, predicate_constant, constant);
-					break;
-				}
-				case TypeId::DOUBLE: {
-					double constant = predicate_constant.constant.value_.double_;
-					readSegment = checkZonemap<double>(state, predicate_constant, constant);
-					break;
-				}
-				case TypeId::VARCHAR: {
-					//! we can only compare the first 7 bytes
-					size_t value_size = predicate_constant.constant.str_value.size() > 7
-					                        ? 7
-					                        : predicate_constant.constant.str_value.size();
-					string constant;
-					for (size_t i = 0; i < value_size; i++) {
-						constant += predicate_constant.constant.str_value[i];
-					}
-					readSegment = checkZonemapString(state, predicate_constant, constant.c_str());
-					break;
-				}
-				default:
-					throw NotImplementedException("Unimplemented type for zonemaps");
-				}
-			}
-			if (!readSegment) {
-				//! We can skip this partition
+			if (!segment->stats.CheckFilter(predicate_constant)) {
+				//! We can skip this segment
 				idx_t vectorsToSkip =
-				    ceil((double)(state.column_scans[predicate_constant.column_index].current->count +
-				                  state.column_scans[predicate_constant.column_index].current->start - current_row) /
-				         STANDARD_VECTOR_SIZE);
+				    ceil((double)(segment->count + segment->start - current_row) / STANDARD_VECTOR_SIZE);
 				for (idx_t i = 0; i < vectorsToSkip; ++i) {
 					state.NextVector();
 					current_row += STANDARD_VECTOR_SIZE;
@@ -522,12 +435,22 @@ void DataTable::InitializeIndexScan(Transaction &transaction, TableIndexScanStat
                                     vector<column_t> column_ids) {
 	state.index = &index;
 	state.column_ids = move(column_ids);
+	if (transaction.start_time < index.start_timestamp) {
+		// the transaction might see older values than the ones in the index: fall back to a regular table scan
+		// the filter on top of the index scan removes the tuples that do not match the predicate
+		state.table_scan = make_unique<TableScanState>();
+		InitializeScan(transaction, *state.table_scan, state.column_ids);
+		return;
+	}
 	transaction.storage.InitializeScan(this, state.local_state);
 }
 
 void DataTable::InitializeIndexScan(Transaction &transaction, TableIndexScanState &state, Index &index, Value value,
                                     ExpressionType expr_type, vector<column_t> column_ids) {
 	InitializeIndexScan(transaction, state, index, move(column_ids));
+	if (state.table_scan) {
+		return;
+	}
 	state.index_state = index.InitializeScanSinglePredicate(transaction, state.column_ids, value, expr_type);
 }
 
@@ -535,11 +458,19 @@ void DataTable::InitializeIndexScan(Transaction &transaction, TableIndexScanStat
                                     ExpressionType low_type, Value high_value, ExpressionType high_type,
                                     vector<column_t> column_ids) {
 	InitializeIndexScan(transaction, state, index, move(column_ids));
+	if (state.table_scan) {
+		return;
+	}
 	state.index_state =
 	    index.InitializeScanTwoPredicates(transaction, state.column_ids, low_value, low_type, high_value, high_type);
 }
 
 void DataTable::IndexScan(Transaction &transaction, DataChunk &result, TableIndexScanState &state) {
+	if (state.table_scan) {
+		unordered_map<idx_t, vector<TableFilter>> table_filters;
+		Scan(transaction, result, *state.table_scan, state.column_ids, table_filters);
+		return;
+	}
 	// clear any previously pinned blocks
 	state.fetch_state.handles.clear();
 	// scan the index
@@ -711,7 +642,8 @@ void DataTable::InitializeAppend(TableAppendState &state) {
 	for (idx_t i = 0; i < types.size(); i++) {
 		columns[i]->InitializeAppend(state.states[i]);
 	}
-	state.row_start = transient_manager->max_row;
+	// the row identifiers of the append are offset by the rows stored in the persistent segments
+	state.row_start = transient_manager->base_row + transient_manager->max_row;
 	state.current_row = state.row_start;
 }
 
@@ -721,7 +653,7 @@ void DataTable::Append(Transaction &transaction, transaction_t commit_id, DataCh
 	chunk.Verify();
 
 	// set up the inserted info in the version manager
-	transient_manager->Append(transaction, state.current_row, chunk.size(), commit_id);
+	transient_manager->Append(transaction, state.current_row - transient_manager->base_row, chunk.size(), commit_id);
 
 	// append the physical data to each of the entries
 	for (idx_t i = 0; i < types.size(); i++) {
@@ -743,9 +675,10 @@ void DataTable::RevertAppend(TableAppendState &state) {
 	}
 	// adjust the cardinality
 	info->cardinality -= state.current_row - state.row_start;
-	transient_manager->max_row = state.row_start;
+	transient_manager->max_row = state.row_start - transient_manager->base_row;
 	// revert changes in the transient manager
-	transient_manager->RevertAppend(state.row_start, state.current_row);
+	transient_manager->RevertAppend(state.row_start - transient_manager->base_row,
+	                                state.current_row - transient_manager->base_row);
 }
 
 //===--------------------------------------------------------------------===//
@@ -825,6 +758,29 @@ void DataTable::RemoveFromIndexes(Vector &row_identifiers, idx_t count) {
 //===--------------------------------------------------------------------===//
 // Delete
 //===--------------------------------------------------------------------===//
+//! Computes the selection vector that sorts the row identifiers, returns false if they are already sorted
+static bool sort_row_identifiers(row_t ids[], idx_t count, SelectionVector &sel) {
+	idx_t i = 1;
+	while (i < count && ids[i - 1] < ids[i]) {
+		i++;
+	}
+	if (i >= count) {
+		return false;
+	}
+	sel.Initialize(count);
+	for (i = 0; i < count; i++) {
+		sel.set_index(i, i);
+	}
+	std::sort(sel.data(), sel.data() + count, [&](sel_t a, sel_t b) { return ids[a] < ids[b]; });
+	return true;
+}
+
+//! Returns the end of the transaction-local chunk that the (sorted) row identifier at offset belongs to
+static idx_t local_chunk_end(row_t ids[], idx_t offset, idx_t count) {
+	row_t chunk_end = MAX_ROW_ID + ((ids[offset] - MAX_ROW_ID) / STANDARD_VECTOR_SIZE + 1) * STANDARD_VECTOR_SIZE;
+	return std::lower_bound(ids + offset, ids + count, chunk_end) - ids;
+}
+
 void DataTable::Delete(TableCatalogEntry &table, ClientContext &context, Vector &row_identifiers, idx_t count) {
 	assert(row_identifiers.type == ROW_TYPE);
 	if (count == 0) {
@@ -835,17 +791,33 @@ void DataTable::Delete(TableCatalogEntry &table, ClientContext &context, Vector
 
 	row_identifiers.Normalify(count);
 	auto ids = FlatVector::GetData<row_t>(row_identifiers);
-	auto first_id = ids[0];
+	SelectionVector sel;
+	if (sort_row_identifiers(ids, count, sel)) {
+		row_identifiers.Slice(sel, count);
+		row_identifiers.Normalify(count);
+		ids = FlatVector::GetData<row_t>(row_identifiers);
+	}
 
-	if (first_id >= MAX_ROW_ID) {
-		// deletion is in transaction-local storage: push delete into local chunk collection
-		transaction.storage.Delete(this, row_identifiers, count);
-	} else if ((idx_t)first_id < persistent_manager->max_row) {
+	// split the row identifiers into persistent, transient and transaction-local rows
+	idx_t transient_start = std::lower_bound(ids, ids + count, (row_t)persistent_manager->max_row) - ids;
+	idx_t local_start = std::lower_bound(ids + transient_start, ids + count, (row_t)MAX_ROW_ID) - ids;
+	if (transient_start > 0) {
 		// deletion is in persistent storage: delete in the persistent version manager
-		persistent_manager->Delete(transaction, this, row_identifiers, count);
-	} else {
-		// deletion is in transient storage: delete in the persistent version manager
-		transient_manager->Delete(transaction, this, row_identifiers, count);
+		persistent_manager->Delete(transaction, this, row_identifiers, transient_start);
+	}
+	if (local_start > transient_start) {
+		// deletion is in transient storage: delete in the transient version manager
+		Vector transient_ids;
+		transient_ids.Slice(row_identifiers, transient_start);
+		transient_manager->Delete(transaction, this, transient_ids, local_start - transient_start);
+	}
+	for (idx_t offset = local_start; offset < count;) {
+		// deletion is in transaction-local storage: push delete into local chunk collection
+		idx_t next = local_chunk_end(ids, offset, count);
+		Vector local_ids;
+		local_ids.Slice(row_identifiers, offset);
+		transaction.storage.Delete(this, local_ids, next - offset);
+		offset = next;
 	}
 }
 
@@ -944,18 +916,40 @@ void DataTable::Update(TableCatalogEntry &table, ClientContext &context, Vector
 
 	updates.Normalify();
 	row_ids.Normalify(updates.size());
-	auto first_id = FlatVector::GetValue<row_t>(row_ids, 0);
-	if (first_id >= MAX_ROW_ID) {
-		// update is in transaction-local storage: push update into local storage
-		transaction.storage.Update(this, row_ids, column_ids, updates);
-		return;
-	}
-
-	for (idx_t i = 0; i < column_ids.size(); i++) {
-		auto column = column_ids[i];
-		assert(column != COLUMN_IDENTIFIER_ROW_ID);
+	auto count = updates.size();
+	auto ids = FlatVector::GetData<row_t>(row_ids);
+	// the updates are applied one vector at a time: sort them by row identifier
+	SelectionVector sel;
+	if (sort_row_identifiers(ids, count, sel)) {
+		row_ids.Slice(sel, count);
+		row_ids.Normalify(count);
+		updates.Slice(sel, count);
+		updates.Normalify();
+		ids = FlatVector::GetData<row_t>(row_ids);
+	}
+	idx_t local_start = std::lower_bound(ids, ids + count, (row_t)MAX_ROW_ID) - ids;
+	if (local_start > 0) {
+		for (idx_t i = 0; i < column_ids.size(); i++) {
+			auto column = column_ids[i];
+			assert(column != COLUMN_IDENTIFIER_ROW_ID);
 
-		columns[column]->Update(transaction, updates.data[i], row_ids, updates.size());
+			columns[column]->Update(transaction, updates.data[i], ids, local_start);
+		}
+	}
+	for (idx_t offset = local_start; offset < count;) {
+		// update is in transaction-local storage: push update into local storage
+		idx_t next = local_chunk_end(ids, offset, count);
+		auto update_types = updates.GetTypes();
+		DataChunk local_updates;
+		local_updates.InitializeEmpty(update_types);
+		for (idx_t i = 0; i < updates.column_count(); i++) {
+			local_updates.data[i].Slice(updates.data[i], offset);
+		}
+		local_updates.SetCardinality(next - offset);
+		Vector local_ids;
+		local_ids.Slice(row_ids, offset);
+		transaction.storage.Update(this, local_ids, column_ids, local_updates);
+		offset = next;
 	}
 }
 
@@ -1046,6 +1040,10 @@ void DataTable::AddIndex(unique_ptr<Index> index, vector<unique_ptr<Expression>>
 			// release all locks
 			break;
 		}
+		RemoveCheckpointedDeletes(intermediate);
+		if (intermediate.size() == 0) {
+			continue;
+		}
 		// resolve the expressions for this chunk
 		executor.Execute(intermediate, result);
 
@@ -1054,5 +1052,170 @@ void DataTable::AddIndex(unique_ptr<Index> index, vector<unique_ptr<Expression>>
 			throw ConstraintException("Cant create unique index, table contains duplicate data on indexed column(s)");
 		}
 	}
+	// the index contains the values of the committed updates: transactions that started before the last of these
+	// updates was committed might see older values, and cannot use the index
+	for (idx_t i = 0; i < column_ids.size(); i++) {
+		if (state.column_scans[i].max_update_id > 0) {
+			index->start_timestamp = max(index->start_timestamp, state.column_scans[i].max_update_id + 1);
+		}
+	}
 	info->indexes.push_back(move(index));
 }
+
+void DataTable::RemoveCheckpointedDeletes(DataChunk &chunk) {
+	VectorData rdata;
+	chunk.data.back().Orrify(chunk.size(), rdata);
+	auto ids = (row_t *)rdata.data;
+
+	SelectionVector sel(STANDARD_VECTOR_SIZE);
+	idx_t count = 0;
+	for (idx_t i = 0; i < chunk.size(); i++) {
+		auto row_id = ids[rdata.sel->get_index(i)];
+		auto &manager = (idx_t)row_id < persistent_manager->max_row ? *persistent_manager : *transient_manager;
+		if (!manager.DeletedBeforeCheckpoint(row_id)) {
+			sel.set_index(count++, i);
+		}
+	}
+	if (count != chunk.size()) {
+		chunk.Slice(sel, count);
+	}
+}
+
+//===--------------------------------------------------------------------===//
+// Checkpoint
+//===--------------------------------------------------------------------===//
+void DataTable::Checkpoint(TableDataWriter &writer, Transaction &transaction, bool vacuum) {
+	for (idx_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+		columns[col_idx]->Checkpoint(writer, transaction, col_idx, vacuum ? this : nullptr);
+	}
+}
+
+void DataTable::CommitCheckpoint(persistent_data_t data, bool vacuumed) {
+	// a vacuum removed all deleted rows from the table
+	auto deleted_rows = vacuumed ? vector<row_t>() : GetDeletedRows();
+	for (idx_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+		columns[col_idx]->CommitCheckpoint(data[col_idx]);
+	}
+	// all rows of the table are now stored in persistent segments, and visible to every transaction
+	{
+		auto persistent_lock = persistent_manager->lock.GetExclusiveLock();
+		auto transient_lock = transient_manager->lock.GetExclusiveLock();
+		persistent_manager->info.clear();
+		persistent_manager->max_row = columns[0]->persistent_rows;
+		transient_manager->info.clear();
+		transient_manager->base_row = persistent_manager->max_row;
+		transient_manager->max_row = 0;
+	}
+	persistent_manager->SetDeletedRows(deleted_rows);
+	if (vacuumed) {
+		// the row identifiers of the rows have changed
+		RebuildIndexes();
+	}
+}
+
+void DataTable::Vacuum(Transaction &transaction) {
+	if (GetDeletedRows().size() == 0) {
+		// nothing to vacuum
+		return;
+	}
+	for (idx_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+		columns[col_idx]->Vacuum(transaction, *this);
+	}
+	// all rows of the table are now stored in transient segments, and visible to every transaction
+	auto last_segment = columns[0]->data.GetLastSegment();
+	{
+		auto persistent_lock = persistent_manager->lock.GetExclusiveLock();
+		auto transient_lock = transient_manager->lock.GetExclusiveLock();
+		persistent_manager->info.clear();
+		persistent_manager->max_row = 0;
+		transient_manager->info.clear();
+		transient_manager->base_row = 0;
+		transient_manager->max_row = last_segment ? last_segment->start + last_segment->count : 0;
+	}
+	RebuildIndexes();
+}
+
+vector<row_t> DataTable::GetDeletedRows() {
+	vector<row_t> result;
+	persistent_manager->GetDeletedRows(result);
+	transient_manager->GetDeletedRows(result);
+	return result;
+}
+
+idx_t DataTable::GetTotalRows() {
+	return persistent_manager->max_row + transient_manager->max_row;
+}
+
+idx_t DataTable::GetVisibleRows(Transaction &transaction, idx_t start_row, SelectionVector &sel, idx_t count) {
+	// vectors never cross the boundary between the persistent and the transient rows
+	auto &manager = start_row < persistent_manager->max_row ? *persistent_manager : *transient_manager;
+	idx_t row = start_row - manager.base_row;
+	assert(row % STANDARD_VECTOR_SIZE == 0);
+	return manager.GetSelVector(transaction, row / STANDARD_VECTOR_SIZE, sel, count);
+}
+
+void DataTable::RebuildIndexes() {
+	if (info->indexes.size() == 0) {
+		return;
+	}
+	vector<column_t> column_ids;
+	for (idx_t i = 0; i < types.size(); i++) {
+		column_ids.push_back(i);
+	}
+	DataChunk chunk;
+	chunk.Initialize(types);
+
+	CreateIndexScanState state;
+	InitializeCreateIndexScan(state, column_ids);
+	vector<IndexLock> locks(info->indexes.size());
+	for (idx_t i = 0; i < info->indexes.size(); i++) {
+		info->indexes[i]->InitializeLock(locks[i]);
+		info->indexes[i]->Clear(locks[i]);
+	}
+	// the rows are stored contiguously: re-insert them with their new row identifiers
+	row_t row_start = 0;
+	while (true) {
+		chunk.Reset();
+		CreateIndexScan(state, column_ids, chunk);
+		if (chunk.size() == 0) {
+			break;
+		}
+		Vector row_identifiers(ROW_TYPE);
+		VectorOperations::GenerateSequence(row_identifiers, chunk.size(), row_start, 1);
+		for (idx_t i = 0; i < info->indexes.size(); i++) {
+			if (!info->indexes[i]->Append(locks[i], chunk, row_identifiers)) {
+				throw InternalException("Failed to rebuild index after vacuum");
+			}
+		}
+		row_start += chunk.size();
+	}
+}
+
+//===--------------------------------------------------------------------===//
+// Storage Info
+//===--------------------------------------------------------------------===//
+vector<vector<Value>> DataTable::GetStorageInfo() {
+	vector<vector<Value>> result;
+	for (idx_t col_idx = 0; col_idx < columns.size(); col_idx++) {
+		auto &segment_tree = columns[col_idx]->data;
+		lock_guard<mutex> tree_lock(segment_tree.node_lock);
+		for (idx_t segment_idx = 0; segment_idx < segment_tree.nodes.size(); segment_idx++) {
+			auto &segment = (ColumnSegment &)*segment_tree.nodes[segment_idx].node;
+			auto &stats = segment.stats;
+			vector<Value> row;
+			row.push_back(Value::BIGINT(col_idx));
+			row.push_back(Value::BIGINT(segment_idx));
+			row.push_back(Value(segment.segment_type == ColumnSegmentType::PERSISTENT ? "PERSISTENT" : "TRANSIENT"));
+			row.push_back(Value::BIGINT(segment.start));
+			row.push_back(Value::BIGINT(segment.count));
+			row.push_back(stats.GetMinimum());
+			row.push_back(stats.GetMaximum());
+			row.push_back(Value::BOOLEAN(stats.has_null));
+			row.push_back(Value::BOOLEAN(stats.has_no_null));
+			row.push_back(Value::BIGINT(stats.null_count));
+			row.push_back(Value::BIGINT(stats.distinct_count));
+			result.push_back(move(row));
+		}
+	}
+	return result;
+}
@@ -209,31 +209,35 @@ void NumericSegment::Select(ColumnScanState &state, Vector &result, SelectionVec
 	auto offset = vector_index * vector_size;
 	auto source_nullmask = (nullmask_t *)(data + offset);
 	auto source_data = data + offset + sizeof(nullmask_t);
+	SelectData(result, source_data, source_nullmask, sel, approved_tuple_count, tableFilter);
+}
 
+void NumericSegment::SelectData(Vector &result, data_ptr_t source_data, nullmask_t *source_nullmask,
+                                SelectionVector &sel, idx_t &approved_tuple_count, vector<TableFilter> &tableFilter) {
 	if (tableFilter.size() == 1) {
 		switch (tableFilter[0].comparison_type) {
 		case ExpressionType::COMPARE_EQUAL: {
-			templated_select_operation<Equals>(sel, result, state.current->type, source_data, source_nullmask,
+			templated_select_operation<Equals>(sel, result, type, source_data, source_nullmask,
 			                                   tableFilter[0].constant, approved_tuple_count);
 			break;
 		}
 		case ExpressionType::COMPARE_LESSTHAN: {
-			templated_select_operation<LessThan>(sel, result, state.current->type, source_data, source_nullmask,
+			templated_select_operation<LessThan>(sel, result, type, source_data, source_nullmask,
 			                                     tableFilter[0].constant, approved_tuple_count);
 			break;
 		}
 		case ExpressionType::COMPARE_GREATERTHAN: {
-			templated_select_operation<GreaterThan>(sel, result, state.current->type, source_data, source_nullmask,
+			templated_select_operation<GreaterThan>(sel, result, type, source_data, source_nullmask,
 			                                        tableFilter[0].constant, approved_tuple_count);
 			break;
 		}
 		case ExpressionType::COMPARE_LESSTHANOREQUALTO: {
-			templated_select_operation<LessThanEquals>(sel, result, state.current->type, source_data, source_nullmask,
+			templated_select_operation<LessThanEquals>(sel, result, type, source_data, source_nullmask,
 			                                           tableFilter[0].constant, approved_tuple_count);
 			break;
 		}
 		case ExpressionType::COMPARE_GREATERTHANOREQUALTO: {
-			templated_select_operation<GreaterThanEquals>(sel, result, state.current->type, source_data,
+			templated_select_operation<GreaterThanEquals>(sel, result, type, source_data,
 			                                              source_nullmask, tableFilter[0].constant,
 			                                              approved_tuple_count);
 			break;
@@ -250,21 +254,21 @@ void NumericSegment::Select(ColumnScanState &state, Vector &result, SelectionVec
 		if (tableFilter[0].comparison_type == ExpressionType::COMPARE_GREATERTHAN) {
 			if (tableFilter[1].comparison_type == ExpressionType::COMPARE_LESSTHAN) {
 				templated_select_operation_between<GreaterThan, LessThan>(
-				    sel, result, state.current->type, source_data, source_nullmask, tableFilter[0].constant,
+				    sel, result, type, source_data, source_nullmask, tableFilter[0].constant,
 				    tableFilter[1].constant, approved_tuple_count);
 			} else {
 				templated_select_operation_between<GreaterThan, LessThanEquals>(
-				    sel, result, state.current->type, source_data, source_nullmask, tableFilter[0].constant,
+				    sel, result, type, source_data, source_nullmask, tableFilter[0].constant,
 				    tableFilter[1].constant, approved_tuple_count);
 			}
 		} else {
 			if (tableFilter[1].comparison_type == ExpressionType::COMPARE_LESSTHAN) {
 				templated_select_operation_between<GreaterThanEquals, LessThan>(
-				    sel, result, state.current->type, source_data, source_nullmask, tableFilter[0].constant,
+				    sel, result, type, source_data, source_nullmask, tableFilter[0].constant,
 				    tableFilter[1].constant, approved_tuple_count);
 			} else {
 				templated_select_operation_between<GreaterThanEquals, LessThanEquals>(
-				    sel, result, state.current->type, source_data, source_nullmask, tableFilter[0].constant,
+				    sel, result, type, source_data, source_nullmask, tableFilter[0].constant,
 				    tableFilter[1].constant, approved_tuple_count);
 			}
 		}
@@ -491,19 +495,30 @@ static void append_loop(SegmentStatistics &stats, data_ptr_t target, idx_t targe
 	auto sdata = (T *)adata.data;
 	auto tdata = (T *)(target + sizeof(nullmask_t));
 	if (adata.nullmask->any()) {
+		idx_t null_count = 0;
 		for (idx_t i = 0; i < count; i++) {
 			auto source_idx = adata.sel->get_index(offset + i);
 			auto target_idx = target_offset + i;
 			bool is_null = (*adata.nullmask)[source_idx];
 			if (is_null) {
 				nullmask[target_idx] = true;
-				stats.has_null = true;
+				null_count++;
 			} else {
 				update_min_max_numeric_segment(sdata[source_idx], min, max);
 				tdata[target_idx] = sdata[source_idx];
 			}
 		}
+		if (null_count > 0) {
+			stats.has_null = true;
+			stats.null_count += null_count;
+		}
+		if (null_count < count) {
+			stats.has_no_null = true;
+		}
 	} else {
+		if (count > 0) {
+			stats.has_no_null = true;
+		}
 		for (idx_t i = 0; i < count; i++) {
 			auto source_idx = adata.sel->get_index(offset + i);
 			auto target_idx = target_offset + i;
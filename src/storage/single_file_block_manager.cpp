@@ -133,6 +133,15 @@ block_id_t SingleFileBlockManager::GetFreeBlockId() {
 	return block;
 }
 
+void SingleFileBlockManager::MarkBlockAsUsed(block_id_t block_id) {
+	assert(block_id >= 0 && block_id < max_block);
+	used_blocks.insert(block_id);
+}
+
+vector<block_id_t> SingleFileBlockManager::GetFreeBlocks() {
+	return free_list;
+}
+
 block_id_t SingleFileBlockManager::GetMetaBlock() {
 	return meta_block;
 }
@@ -156,7 +165,7 @@ void SingleFileBlockManager::WriteHeader(DatabaseHeader header) {
 	// set the iteration count
 	header.iteration = ++iteration_count;
 	header.block_count = max_block;
-	// now handle the free list
+	// now handle the free list: every block that is not used by this checkpoint is free
 	free_list.clear();
 	for (block_id_t i = 0; i < max_block; i++) {
 		if (used_blocks.find(i) == used_blocks.end()) {
@@ -164,20 +173,30 @@ void SingleFileBlockManager::WriteHeader(DatabaseHeader header) {
 		}
 	}
 	if (free_list.size() > 0) {
-		// there are blocks in the free list
-		// write them to the file
-		MetaBlockWriter writer(*this);
-		auto entry = std::find(free_list.begin(), free_list.end(), writer.block->id);
-		if (entry != free_list.end()) {
-			free_list.erase(entry);
+		// there are blocks in the free list: write them to the file
+		// the blocks the free list is written to are taken from the back of the free list itself, figure out how many
+		// blocks we need so we only write the entries that remain free
+		idx_t block_capacity = Storage::BLOCK_SIZE - sizeof(block_id_t);
+		idx_t free_list_blocks = 1;
+		while (true) {
+			idx_t entry_count = free_list.size() > free_list_blocks ? free_list.size() - free_list_blocks : 0;
+			idx_t required_size = sizeof(uint64_t) + entry_count * sizeof(block_id_t);
+			idx_t required_blocks = (required_size + block_capacity - 1) / block_capacity;
+			if (required_blocks <= free_list_blocks) {
+				break;
+			}
+			free_list_blocks = required_blocks;
 		}
+		idx_t entry_count = free_list.size() > free_list_blocks ? free_list.size() - free_list_blocks : 0;
+		MetaBlockWriter writer(*this);
 		header.free_list = writer.block->id;
-
-		writer.Write<uint64_t>(free_list.size());
-		for (auto &block_id : free_list) {
-			writer.Write<block_id_t>(block_id);
+		writer.Write<uint64_t>(entry_count);
+		for (idx_t i = 0; i < entry_count; i++) {
+			writer.Write<block_id_t>(free_list[i]);
 		}
 		writer.Flush();
+		// the free list now only contains the entries that were written
+		free_list.resize(std::min(entry_count, (idx_t)free_list.size()));
 	} else {
 		// no blocks in the free list
 		header.free_list = INVALID_BLOCK;
@@ -198,10 +217,8 @@ void SingleFileBlockManager::WriteHeader(DatabaseHeader header) {
 	//! Ensure the header write ends up on disk
 	handle->Sync();
 
-	// the free list is now equal to the blocks that were used by the previous iteration
-	free_list.clear();
-	for (auto &block_id : used_blocks) {
-		free_list.push_back(block_id);
-	}
+	// the header now points to the new checkpoint
+	meta_block = header.meta_block;
+	free_list_id = header.free_list;
 	used_blocks.clear();
 }
@@ -4,6 +4,8 @@
 #include "duckdb/storage/single_file_block_manager.hpp"
 
 #include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/schema_catalog_entry.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/common/file_system.hpp"
 #include "duckdb/main/database.hpp"
 #include "duckdb/main/client_context.hpp"
@@ -11,7 +13,6 @@
 #include "duckdb/parser/parsed_data/create_schema_info.hpp"
 #include "duckdb/transaction/transaction_manager.hpp"
 #include "duckdb/planner/binder.hpp"
-#include "duckdb/common/serializer/buffered_file_reader.hpp"
 
 using namespace duckdb;
 using namespace std;
@@ -66,32 +67,39 @@ void StorageManager::Initialize() {
 	}
 }
 
-void StorageManager::Checkpoint(string wal_path) {
-    auto &fs = database.GetFileSystem();
-	if (!fs.FileExists(wal_path)) {
-		// no WAL to checkpoint
-		return;
-	}
+void StorageManager::CreateCheckpoint(Transaction &transaction, bool vacuum, TableCatalogEntry *vacuum_table) {
 	if (read_only) {
-		// cannot checkpoint in read-only system
+		// read-only database: nothing to checkpoint
 		return;
 	}
-	// check the size of the WAL
-	{
-		BufferedFileReader reader(fs, wal_path.c_str());
-		if (reader.FileSize() <= database.config.checkpoint_wal_size) {
-			// WAL is too small
-			return;
+	if (!wal.initialized || (vacuum_table && vacuum_table->temporary)) {
+		// in-memory database or temporary table: nothing to checkpoint, but the tables can still be vacuumed in-memory
+		if (vacuum) {
+			VacuumInMemory(transaction, vacuum_table);
 		}
+		return;
 	}
+	CheckpointManager checkpointer(*this);
+	checkpointer.CreateCheckpoint(transaction, vacuum, vacuum_table);
+}
 
-	// checkpoint the database
-	// FIXME: we do this now by creating a new database and forcing a checkpoint in that database
-	// then reloading the file again
-	// this should be fixed and turned into an incremental checkpoint
-	DBConfig config;
-	config.checkpoint_only = true;
-	DuckDB db(path, &config);
+void StorageManager::VacuumInMemory(Transaction &transaction, TableCatalogEntry *vacuum_table) {
+	if (vacuum_table) {
+		vacuum_table->storage->Vacuum(transaction);
+		return;
+	}
+	vector<TableCatalogEntry *> tables;
+	database.catalog->schemas->Scan(transaction, [&](CatalogEntry *schema_entry) {
+		auto &schema = (SchemaCatalogEntry &)*schema_entry;
+		schema.tables.Scan(transaction, [&](CatalogEntry *entry) {
+			if (entry->type == CatalogType::TABLE) {
+				tables.push_back((TableCatalogEntry *)entry);
+			}
+		});
+	});
+	for (auto &table : tables) {
+		table->storage->Vacuum(transaction);
+	}
 }
 
 void StorageManager::LoadDatabase() {
@@ -115,9 +123,6 @@ void StorageManager::LoadDatabase() {
 		buffer_manager = make_unique<BufferManager>(
 		    fs, *block_manager, database.config.temporary_directory, database.config.maximum_memory);
 	} else {
-		if (!database.config.checkpoint_only) {
-			Checkpoint(wal_path);
-		}
 		// initialize the block manager while loading the current db file
 		auto sf = make_unique<SingleFileBlockManager>(fs, path, read_only, false,
 		                                              database.config.use_direct_io);
@@ -132,18 +137,23 @@ void StorageManager::LoadDatabase() {
 		// check if the WAL file exists
 		if (fs.FileExists(wal_path)) {
 			// replay the WAL
-			WriteAheadLog::Replay(database, wal_path);
-			if (database.config.checkpoint_only) {
-				assert(!read_only);
-				// checkpoint the database
-				checkpointer.CreateCheckpoint();
-				// remove the WAL
+			bool checkpointed = WriteAheadLog::Replay(database, wal_path);
+			if (checkpointed && !read_only) {
+				// the WAL was already written to the checkpoint: it can be removed
 				fs.RemoveFile(wal_path);
 			}
 		}
 	}
+	if (read_only) {
+		return;
+	}
 	// initialize the WAL file
-	if (!database.config.checkpoint_only && !read_only) {
-		wal.Initialize(wal_path);
+	wal.Initialize(wal_path);
+	if ((idx_t)wal.GetWALSize() > database.config.checkpoint_wal_size) {
+		// the replayed WAL is too large: checkpoint the database
+		ClientContext context(database);
+		context.transaction.BeginTransaction();
+		database.transaction_manager->Checkpoint(context);
+		context.transaction.Commit();
 	}
 }
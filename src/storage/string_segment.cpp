@@ -17,6 +17,9 @@ StringSegment::StringSegment(BufferManager &manager, idx_t row_start, block_id_t
 	// the vector_size is given in the size of the dictionary offsets
 	this->vector_size = STANDARD_VECTOR_SIZE * sizeof(int32_t) + sizeof(nullmask_t);
 	this->string_updates = nullptr;
+	this->dictionary_vectors = false;
+	// the dictionary offset of a segment that is loaded from disk is not known
+	this->dictionary_offset_known = block == INVALID_BLOCK;
 
 	this->block_id = block;
 	if (block_id == INVALID_BLOCK) {
@@ -74,7 +77,7 @@ void StringSegment::read_string(string_t *result_data, buffer_handle_set_t &hand
                                 size_t vector_index) {
 	if (string_updates && string_updates[vector_index]) {
 		auto &info = *string_updates[vector_index];
-		while (info.ids[update_idx] < src_idx) {
+		while (update_idx < info.count && info.ids[update_idx] < src_idx) {
 			//! We need to catch the update_idx up to the src_idx
 			update_idx++;
 		}
@@ -173,8 +176,49 @@ void StringSegment::FetchBaseData(ColumnScanState &state, idx_t vector_index, Ve
 	auto handle = state.primary_handle.get();
 	state.handles.clear();
 
+	auto count = GetVectorCount(vector_index);
+	if (dictionary_vectors && !(string_updates && string_updates[vector_index]) &&
+	    !(versions && versions[vector_index])) {
+		// identical strings share a dictionary entry: try to emit a dictionary vector
+		if (FetchDictionaryVector(state, handle->node->buffer, vector_index, result, count)) {
+			return;
+		}
+	}
 	// fetch the data from the base segment
-	FetchBaseData(state, handle->node->buffer, vector_index, result, GetVectorCount(vector_index));
+	FetchBaseData(state, handle->node->buffer, vector_index, result, count);
+}
+
+bool StringSegment::FetchDictionaryVector(ColumnScanState &state, data_ptr_t baseptr, idx_t vector_index,
+                                          Vector &result, idx_t count) {
+	auto base = baseptr + vector_index * vector_size;
+	auto &base_nullmask = *((nullmask_t *)base);
+	auto base_data = (int32_t *)(base + sizeof(nullmask_t));
+
+	// map every distinct dictionary offset to an entry in the dictionary vector
+	// NULL values all have dictionary offset 0, which is never used by an actual string
+	Vector dictionary(TypeId::VARCHAR);
+	auto dictionary_data = FlatVector::GetData<string_t>(dictionary);
+	auto &dictionary_nullmask = FlatVector::Nullmask(dictionary);
+	SelectionVector sel(STANDARD_VECTOR_SIZE);
+	unordered_map<int32_t, sel_t> entries;
+	idx_t dictionary_size = 0;
+	for (idx_t i = 0; i < count; i++) {
+		auto entry = entries.find(base_data[i]);
+		if (entry == entries.end()) {
+			if (dictionary_size >= count / 2) {
+				// too many distinct strings in this vector for a dictionary vector to be worth it
+				return false;
+			}
+			// NULL entries still get a valid (empty) string, as functions can be executed on them
+			dictionary_nullmask[dictionary_size] = base_nullmask[i];
+			dictionary_data[dictionary_size] = FetchStringFromDict(state.handles, baseptr, base_data[i]);
+			entry = entries.insert(make_pair(base_data[i], (sel_t)dictionary_size++)).first;
+		}
+		sel.set_index(i, entry->second);
+	}
+	result.Slice(dictionary, sel, count);
+	DictionaryVector::SetDictionarySize(result, dictionary_size);
+	return true;
 }
 
 void StringSegment::FetchBaseData(ColumnScanState &state, data_ptr_t baseptr, idx_t vector_index, Vector &result,
@@ -445,35 +489,6 @@ idx_t StringSegment::Append(SegmentStatistics &stats, Vector &data, idx_t offset
 	return tuple_count - initial_count;
 }
 
-static void update_min_max_string_segment(string value, char *__restrict min, char *__restrict max) {
-	//! we can only fit 8 bytes, so we might need to trim our string
-	size_t value_size = value.size() > 7 ? 7 : value.size();
-	//! This marks the min/max was not initialized
-	char marker = '1';
-	if (min[0] == '\0' && min[1] == marker && max[0] == '\0' && max[1] == marker) {
-		size_t min_end = value.copy(min, value_size);
-		size_t max_end = value.copy(max, value_size);
-		for (size_t i = min_end; i < 8; i++) {
-			min[i] = '\0';
-		}
-		for (size_t i = max_end; i < 8; i++) {
-			max[i] = '\0';
-		}
-	}
-	if (strcmp(value.data(), min) < 0) {
-		size_t min_end = value.copy(min, value_size);
-		for (size_t i = min_end; i < 8; i++) {
-			min[i] = '\0';
-		}
-	}
-	if (strcmp(value.data(), max) > 0) {
-		size_t max_end = value.copy(max, value_size);
-		for (size_t i = max_end; i < 8; i++) {
-			max[i] = '\0';
-		}
-	}
-}
-
 void StringSegment::AppendData(SegmentStatistics &stats, data_ptr_t target, data_ptr_t end, idx_t target_offset,
                                Vector &source, idx_t offset, idx_t count) {
 	VectorData adata;
@@ -482,9 +497,6 @@ void StringSegment::AppendData(SegmentStatistics &stats, data_ptr_t target, data
 	auto sdata = (string_t *)adata.data;
 	auto &result_nullmask = *((nullmask_t *)target);
 	auto result_data = (int32_t *)(target + sizeof(nullmask_t));
-	auto min = (char *)stats.minimum.get();
-	auto max = (char *)stats.maximum.get();
-
 	idx_t remaining_strings = STANDARD_VECTOR_SIZE - (this->tuple_count % STANDARD_VECTOR_SIZE);
 	for (idx_t i = 0; i < count; i++) {
 		auto source_idx = adata.sel->get_index(offset + i);
@@ -494,6 +506,7 @@ void StringSegment::AppendData(SegmentStatistics &stats, data_ptr_t target, data
 			result_data[target_idx] = 0;
 			result_nullmask[target_idx] = true;
 			stats.has_null = true;
+			stats.null_count++;
 		} else {
 			assert(dictionary_offset < Storage::BLOCK_SIZE);
 			// non-null value, check if we can fit it within the block
@@ -503,6 +516,16 @@ void StringSegment::AppendData(SegmentStatistics &stats, data_ptr_t target, data
 			if (string_length > stats.max_string_length) {
 				stats.max_string_length = string_length;
 			}
+			stats.UpdateStringMinMax(sdata[source_idx]);
+			if (string_dictionary && total_length < STRING_BLOCK_LIMIT) {
+				// the string might already be present in the dictionary: if so, refer to the existing entry
+				auto entry = string_dictionary->find(string(sdata[source_idx].GetData(), string_length));
+				if (entry != string_dictionary->end()) {
+					result_data[target_idx] = entry->second;
+					remaining_strings--;
+					continue;
+				}
+			}
 			// determine whether or not the string needs to be stored in an overflow block
 			// we never place small strings in the overflow blocks: the pointer would take more space than the
 			// string itself we always place big strings (>= STRING_BLOCK_LIMIT) in the overflow blocks we also have
@@ -514,8 +537,6 @@ void StringSegment::AppendData(SegmentStatistics &stats, data_ptr_t target, data
 				// string is too big for block: write to overflow blocks
 				block_id_t block;
 				int32_t offset;
-				//! Update min/max of column segment
-				update_min_max_string_segment(sdata[source_idx].GetData(), min, max);
 				// write the string into the current string block
 				WriteString(sdata[source_idx], block, offset);
 				dictionary_offset += BIG_STRING_MARKER_SIZE;
@@ -530,13 +551,15 @@ void StringSegment::AppendData(SegmentStatistics &stats, data_ptr_t target, data
 				assert(string_length < NumericLimits<uint16_t>::Maximum());
 				dictionary_offset += total_length;
 				auto dict_pos = end - dictionary_offset;
-				//! Update min/max of column segment
-				update_min_max_string_segment(sdata[source_idx].GetData(), min, max);
 				// first write the length as u16
 				uint16_t string_length_u16 = string_length;
 				memcpy(dict_pos, &string_length_u16, sizeof(uint16_t));
 				// now write the actual string data into the dictionary
 				memcpy(dict_pos + sizeof(uint16_t), sdata[source_idx].GetData(), string_length + 1);
+				if (string_dictionary) {
+					string_dictionary->insert(
+					    make_pair(string(sdata[source_idx].GetData(), string_length), (int32_t)dictionary_offset));
+				}
 			}
 			// place the dictionary offset into the set of vectors
 			assert(dictionary_offset <= Storage::BLOCK_SIZE);
@@ -673,7 +696,7 @@ void StringSegment::ReadStringMarker(data_ptr_t target, block_id_t &block_id, in
 //===--------------------------------------------------------------------===//
 string_update_info_t StringSegment::CreateStringUpdate(SegmentStatistics &stats, Vector &update, row_t *ids,
                                                        idx_t count, idx_t vector_offset) {
-	auto info = make_unique<StringUpdateInfo>();
+	auto info = make_unique<StringUpdateInfo>(count);
 	info->count = count;
 	auto strings = FlatVector::GetData<string_t>(update);
 	auto &update_nullmask = FlatVector::Nullmask(update);
@@ -681,9 +704,7 @@ string_update_info_t StringSegment::CreateStringUpdate(SegmentStatistics &stats,
 		info->ids[i] = ids[i] - vector_offset;
 		// copy the string into the block
 		if (!update_nullmask[i]) {
-			auto min = (char *)stats.minimum.get();
-			auto max = (char *)stats.maximum.get();
-			update_min_max_string_segment(strings[i].GetData(), min, max);
+			stats.UpdateStringMinMax(strings[i]);
 			WriteString(strings[i], info->block_ids[i], info->offsets[i]);
 		} else {
 			info->block_ids[i] = INVALID_BLOCK;
@@ -696,7 +717,7 @@ string_update_info_t StringSegment::CreateStringUpdate(SegmentStatistics &stats,
 string_update_info_t StringSegment::MergeStringUpdate(SegmentStatistics &stats, Vector &update, row_t *ids,
                                                       idx_t update_count, idx_t vector_offset,
                                                       StringUpdateInfo &update_info) {
-	auto info = make_unique<StringUpdateInfo>();
+	auto info = make_unique<StringUpdateInfo>(std::min((idx_t)STANDARD_VECTOR_SIZE, update_count + update_info.count));
 
 	// perform a merge between the new and old indexes
 	auto strings = FlatVector::GetData<string_t>(update);
@@ -704,9 +725,7 @@ string_update_info_t StringSegment::MergeStringUpdate(SegmentStatistics &stats,
 	//! Check if we need to update the segment's nullmask
 	for (idx_t i = 0; i < update_count; i++) {
 		if (!update_nullmask[i]) {
-			auto min = (char *)stats.minimum.get();
-			auto max = (char *)stats.maximum.get();
-			update_min_max_string_segment(strings[i].GetData(), min, max);
+			stats.UpdateStringMinMax(strings[i]);
 		}
 	}
 	auto pick_new = [&](idx_t id, idx_t idx, idx_t count) {
@@ -730,10 +749,89 @@ string_update_info_t StringSegment::MergeStringUpdate(SegmentStatistics &stats,
 	};
 
 	info->count =
-	    merge_loop(ids, update_info.ids, update_count, update_info.count, vector_offset, merge, pick_new, pick_old);
+	    merge_loop(ids, update_info.ids.get(), update_count, update_info.count, vector_offset, merge, pick_new, pick_old);
 	return info;
 }
 
+//===--------------------------------------------------------------------===//
+// Consolidate Updates
+//===--------------------------------------------------------------------===//
+idx_t StringSegment::ComputeDictionaryOffset(data_ptr_t baseptr) {
+	// every dictionary entry is referenced either by the base data or by an old version of an updated string
+	int32_t max_offset = 0;
+	for (idx_t vector_index = 0; vector_index < max_vector_count; vector_index++) {
+		auto base_data = (int32_t *)(baseptr + vector_index * vector_size + sizeof(nullmask_t));
+		auto count = GetVectorCount(vector_index);
+		for (idx_t i = 0; i < count; i++) {
+			max_offset = std::max(max_offset, base_data[i]);
+		}
+		for (auto info = versions ? versions[vector_index] : nullptr; info; info = info->next) {
+			auto info_data = (string_location_t *)info->tuple_data;
+			for (idx_t i = 0; i < info->N; i++) {
+				if (info_data[i].block_id == INVALID_BLOCK) {
+					max_offset = std::max(max_offset, info_data[i].offset);
+				}
+			}
+		}
+	}
+	return max_offset;
+}
+
+void StringSegment::ConsolidateUpdates(idx_t vector_index) {
+	if (!string_updates || !string_updates[vector_index]) {
+		return;
+	}
+	auto &info = *string_updates[vector_index];
+	auto handle = manager.Pin(block_id);
+	auto baseptr = handle->node->buffer;
+	if (!dictionary_offset_known) {
+		dictionary_offset = ComputeDictionaryOffset(baseptr);
+		dictionary_offset_known = true;
+	}
+
+	// figure out how much space the updated strings take in the dictionary: small strings are copied into the
+	// dictionary, for big strings a marker to their current location is placed there
+	buffer_handle_set_t handles;
+	idx_t required_space = 0;
+	for (idx_t i = 0; i < info.count; i++) {
+		if (info.block_ids[i] == INVALID_BLOCK) {
+			continue;
+		}
+		idx_t total_length = ReadString(handles, info.block_ids[i], info.offsets[i]).GetSize() + 1 + sizeof(uint16_t);
+		required_space += total_length < STRING_BLOCK_LIMIT ? total_length : BIG_STRING_MARKER_SIZE;
+	}
+	// keep enough space for a big string marker for every tuple that can still be appended to the last vector
+	idx_t remaining_tuples = (STANDARD_VECTOR_SIZE - tuple_count % STANDARD_VECTOR_SIZE) % STANDARD_VECTOR_SIZE;
+	if (required_space + remaining_tuples * BIG_STRING_MARKER_SIZE > RemainingSpace()) {
+		// not enough space in the block: keep the string updates
+		return;
+	}
+
+	auto end = baseptr + Storage::BLOCK_SIZE;
+	auto base_data = (int32_t *)(baseptr + vector_index * vector_size + sizeof(nullmask_t));
+	for (idx_t i = 0; i < info.count; i++) {
+		if (info.block_ids[i] == INVALID_BLOCK) {
+			// NULL value: the nullmask of the base data is already updated
+			base_data[info.ids[i]] = 0;
+			continue;
+		}
+		auto str = ReadString(handles, info.block_ids[i], info.offsets[i]);
+		idx_t total_length = str.GetSize() + 1 + sizeof(uint16_t);
+		if (total_length < STRING_BLOCK_LIMIT) {
+			dictionary_offset += total_length;
+			auto dict_pos = end - dictionary_offset;
+			uint16_t string_length_u16 = str.GetSize();
+			memcpy(dict_pos, &string_length_u16, sizeof(uint16_t));
+			memcpy(dict_pos + sizeof(uint16_t), str.GetData(), str.GetSize() + 1);
+		} else {
+			dictionary_offset += BIG_STRING_MARKER_SIZE;
+			WriteStringMarker(end - dictionary_offset, info.block_ids[i], info.offsets[i]);
+		}
+		base_data[info.ids[i]] = dictionary_offset;
+	}
+	string_updates[vector_index].reset();
+}
+
 //===--------------------------------------------------------------------===//
 // Update Info
 //===--------------------------------------------------------------------===//
@@ -1,4 +1,7 @@
 #include "duckdb/storage/table/column_segment.hpp"
+#include "duckdb/common/operator/comparison_operators.hpp"
+#include "duckdb/common/serializer.hpp"
+#include "duckdb/planner/table_filter.hpp"
 #include <cstring>
 
 using namespace duckdb;
@@ -9,66 +12,21 @@ ColumnSegment::ColumnSegment(TypeId type, ColumnSegmentType segment_type, idx_t
       stats(type, type_size) {
 }
 
-ColumnSegment::ColumnSegment(TypeId type, ColumnSegmentType segment_type, idx_t start, idx_t count, data_t stats_min[],
-                             data_t stats_max[])
+ColumnSegment::ColumnSegment(TypeId type, ColumnSegmentType segment_type, idx_t start, idx_t count,
+                             unique_ptr<SegmentStatistics> statistics)
     : SegmentBase(start, count), type(type), type_size(GetTypeIdSize(type)), segment_type(segment_type),
-      stats(type, type_size, stats_min, stats_max) {
+      stats(move(*statistics)) {
 }
 
 SegmentStatistics::SegmentStatistics(TypeId type, idx_t type_size) : type(type), type_size(type_size) {
 	Reset();
 }
 
-template <class T>
-static void set_min_max(data_t min_value_p[], data_t max_value_p[], data_ptr_t min_p, data_ptr_t max_p) {
-	memcpy(min_p, min_value_p, sizeof(T));
-	memcpy(max_p, max_value_p, sizeof(T));
-}
-
-SegmentStatistics::SegmentStatistics(TypeId type, idx_t type_size, data_t stats_min[], data_t stats_max[])
-    : type(type), type_size(type_size) {
-	Reset();
-	switch (type) {
-	case TypeId::BOOL:
-	case TypeId::INT8: {
-		set_min_max<int8_t>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	case TypeId::INT16: {
-		set_min_max<int16_t>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	case TypeId::INT32: {
-		set_min_max<int32_t>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	case TypeId::INT64: {
-		set_min_max<int64_t>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	case TypeId::INT128: {
-		set_min_max<hugeint_t>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	case TypeId::FLOAT: {
-		set_min_max<float>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	case TypeId::DOUBLE: {
-		set_min_max<double>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	case TypeId::INTERVAL: {
-		set_min_max<interval_t>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	case TypeId::VARCHAR: {
-		set_min_max<char[8]>(stats_min, stats_max, minimum.get(), maximum.get());
-		break;
-	}
-	default:
-		throw NotImplementedException("Unimplemented type for SEGMENT statistics");
-	}
+SegmentStatistics::SegmentStatistics(SegmentStatistics &&other)
+    : type(other.type), type_size(other.type_size), minimum(move(other.minimum)), maximum(move(other.maximum)),
+      min_string(move(other.min_string)), max_string(move(other.max_string)), has_null(other.has_null),
+      has_no_null(other.has_no_null), null_count(other.null_count), distinct_count(other.distinct_count),
+      max_string_length(other.max_string_length), has_overflow_strings(other.has_overflow_strings) {
 }
 
 template <class T> void initialize_max_min(data_ptr_t min, data_ptr_t max) {
@@ -77,13 +35,19 @@ template <class T> void initialize_max_min(data_ptr_t min, data_ptr_t max) {
 }
 
 void SegmentStatistics::Reset() {
-	idx_t min_max_size = type == TypeId::VARCHAR ? 8 : type_size;
-	minimum = unique_ptr<data_t[]>(new data_t[min_max_size]);
-	maximum = unique_ptr<data_t[]>(new data_t[min_max_size]);
+	minimum = unique_ptr<data_t[]>(new data_t[type_size]);
+	maximum = unique_ptr<data_t[]>(new data_t[type_size]);
+	{
+		lock_guard<mutex> guard(string_lock);
+		min_string = string();
+		max_string = string();
+	}
 	has_null = false;
+	has_no_null = false;
+	null_count = 0;
+	distinct_count = 0;
 	max_string_length = 0;
 	has_overflow_strings = false;
-	char padding = '\0';
 	switch (type) {
 	case TypeId::BOOL:
 	case TypeId::INT8:
@@ -107,28 +71,213 @@ void SegmentStatistics::Reset() {
 	case TypeId::DOUBLE:
 		initialize_max_min<double>(minimum.get(), maximum.get());
 		break;
-	case TypeId::VARCHAR: {
-		//! This marks the min/max was not initialized
-		char marker = '1';
-		memset(minimum.get(), padding, min_max_size);
-		memset(maximum.get(), padding, min_max_size);
-		minimum.get()[1] = marker;
-		maximum.get()[1] = marker;
+	case TypeId::VARCHAR:
+		// the min/max of strings are kept in min_string/max_string
 		break;
-	}
 	case TypeId::INTERVAL: {
-		auto min = (interval_t *) minimum.get();
-		auto max = (interval_t *) maximum.get();
+		auto min = (interval_t *)minimum.get();
+		auto max = (interval_t *)maximum.get();
 		min->months = NumericLimits<int32_t>::Maximum();
-		min->days   = NumericLimits<int32_t>::Maximum();
-		min->msecs  = NumericLimits<int64_t>::Maximum();
+		min->days = NumericLimits<int32_t>::Maximum();
+		min->msecs = NumericLimits<int64_t>::Maximum();
 
 		max->months = NumericLimits<int32_t>::Minimum();
-		max->days   = NumericLimits<int32_t>::Minimum();
-		max->msecs  = NumericLimits<int64_t>::Minimum();
+		max->days = NumericLimits<int32_t>::Minimum();
+		max->msecs = NumericLimits<int64_t>::Minimum();
 		break;
 	}
 	default:
 		throw NotImplementedException("Unimplemented type for SEGMENT statistics");
 	}
 }
+
+void SegmentStatistics::UpdateStringMinMax(string_t value) {
+	auto data = value.GetData();
+	lock_guard<mutex> guard(string_lock);
+	if (!has_no_null) {
+		// first string of the segment
+		min_string = string(data, value.GetSize());
+		max_string = min_string;
+		has_no_null = true;
+		return;
+	}
+	if (strcmp(data, min_string.c_str()) < 0) {
+		min_string = string(data, value.GetSize());
+	} else if (strcmp(data, max_string.c_str()) > 0) {
+		max_string = string(data, value.GetSize());
+	}
+}
+
+//===--------------------------------------------------------------------===//
+// Zonemap
+//===--------------------------------------------------------------------===//
+template <class T> static bool check_zonemap(ExpressionType comparison_type, T constant, T min, T max) {
+	switch (comparison_type) {
+	case ExpressionType::COMPARE_EQUAL:
+		return GreaterThanEquals::Operation(constant, min) && LessThanEquals::Operation(constant, max);
+	case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+		return LessThanEquals::Operation(constant, max);
+	case ExpressionType::COMPARE_GREATERTHAN:
+		return LessThan::Operation(constant, max);
+	case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+		return GreaterThanEquals::Operation(constant, min);
+	case ExpressionType::COMPARE_LESSTHAN:
+		return GreaterThan::Operation(constant, min);
+	default:
+		return true;
+	}
+}
+
+template <class T> static bool check_zonemap(ExpressionType comparison_type, T constant, data_ptr_t min, data_ptr_t max) {
+	return check_zonemap<T>(comparison_type, constant, *((T *)min), *((T *)max));
+}
+
+bool SegmentStatistics::CheckFilter(TableFilter &filter) {
+	switch (filter.comparison_type) {
+	case ExpressionType::OPERATOR_IS_NULL:
+		return has_null;
+	case ExpressionType::OPERATOR_IS_NOT_NULL:
+		return has_no_null;
+	default:
+		break;
+	}
+	if (!has_no_null) {
+		// all values are NULL: a comparison is never true
+		return false;
+	}
+	auto &constant = filter.constant;
+	if (constant.is_null || constant.type != type) {
+		return true;
+	}
+	switch (type) {
+	case TypeId::BOOL:
+	case TypeId::INT8:
+		return check_zonemap<int8_t>(filter.comparison_type, constant.value_.tinyint, minimum.get(), maximum.get());
+	case TypeId::INT16:
+		return check_zonemap<int16_t>(filter.comparison_type, constant.value_.smallint, minimum.get(), maximum.get());
+	case TypeId::INT32:
+		return check_zonemap<int32_t>(filter.comparison_type, constant.value_.integer, minimum.get(), maximum.get());
+	case TypeId::INT64:
+		return check_zonemap<int64_t>(filter.comparison_type, constant.value_.bigint, minimum.get(), maximum.get());
+	case TypeId::INT128:
+		return check_zonemap<hugeint_t>(filter.comparison_type, constant.value_.hugeint, minimum.get(),
+		                                maximum.get());
+	case TypeId::FLOAT:
+		return check_zonemap<float>(filter.comparison_type, constant.value_.float_, minimum.get(), maximum.get());
+	case TypeId::DOUBLE:
+		return check_zonemap<double>(filter.comparison_type, constant.value_.double_, minimum.get(), maximum.get());
+	case TypeId::INTERVAL:
+		return check_zonemap<interval_t>(filter.comparison_type, constant.value_.interval, minimum.get(),
+		                                 maximum.get());
+	case TypeId::VARCHAR: {
+		lock_guard<mutex> guard(string_lock);
+		return check_zonemap<string_t>(filter.comparison_type, string_t(constant.str_value),
+		                               string_t(min_string), string_t(max_string));
+	}
+	default:
+		// no zonemap for this type: the segment has to be scanned
+		return true;
+	}
+}
+
+//===--------------------------------------------------------------------===//
+// Min/Max Values
+//===--------------------------------------------------------------------===//
+static Value statistics_value(TypeId type, data_ptr_t data) {
+	switch (type) {
+	case TypeId::BOOL:
+		return Value::BOOLEAN(*((int8_t *)data));
+	case TypeId::INT8:
+		return Value::TINYINT(*((int8_t *)data));
+	case TypeId::INT16:
+		return Value::SMALLINT(*((int16_t *)data));
+	case TypeId::INT32:
+		return Value::INTEGER(*((int32_t *)data));
+	case TypeId::INT64:
+		return Value::BIGINT(*((int64_t *)data));
+	case TypeId::INT128:
+		return Value::HUGEINT(*((hugeint_t *)data));
+	case TypeId::FLOAT:
+		return Value::FLOAT(*((float *)data));
+	case TypeId::DOUBLE:
+		return Value::DOUBLE(*((double *)data));
+	case TypeId::INTERVAL:
+		return Value::INTERVAL(*((interval_t *)data));
+	default:
+		return Value();
+	}
+}
+
+Value SegmentStatistics::GetMinimum() {
+	if (!has_no_null) {
+		return Value();
+	}
+	if (type == TypeId::VARCHAR) {
+		lock_guard<mutex> guard(string_lock);
+		return Value(min_string);
+	}
+	return statistics_value(type, minimum.get());
+}
+
+Value SegmentStatistics::GetMaximum() {
+	if (!has_no_null) {
+		return Value();
+	}
+	if (type == TypeId::VARCHAR) {
+		lock_guard<mutex> guard(string_lock);
+		return Value(max_string);
+	}
+	return statistics_value(type, maximum.get());
+}
+
+//===--------------------------------------------------------------------===//
+// Serialization
+//===--------------------------------------------------------------------===//
+unique_ptr<SegmentStatistics> SegmentStatistics::Copy() {
+	auto result = make_unique<SegmentStatistics>(type, type_size);
+	memcpy(result->minimum.get(), minimum.get(), type_size);
+	memcpy(result->maximum.get(), maximum.get(), type_size);
+	{
+		lock_guard<mutex> guard(string_lock);
+		result->min_string = min_string;
+		result->max_string = max_string;
+	}
+	result->has_null = has_null;
+	result->has_no_null = has_no_null;
+	result->null_count = null_count;
+	result->distinct_count = distinct_count;
+	result->max_string_length = max_string_length;
+	result->has_overflow_strings = has_overflow_strings;
+	return result;
+}
+
+void SegmentStatistics::Serialize(Serializer &serializer) {
+	serializer.Write<bool>(has_null);
+	serializer.Write<bool>(has_no_null);
+	serializer.Write<idx_t>(null_count);
+	serializer.Write<idx_t>(distinct_count);
+	if (type == TypeId::VARCHAR) {
+		lock_guard<mutex> guard(string_lock);
+		serializer.WriteString(min_string);
+		serializer.WriteString(max_string);
+	} else {
+		serializer.WriteData(minimum.get(), type_size);
+		serializer.WriteData(maximum.get(), type_size);
+	}
+}
+
+unique_ptr<SegmentStatistics> SegmentStatistics::Deserialize(Deserializer &source, TypeId type) {
+	auto stats = make_unique<SegmentStatistics>(type, GetTypeIdSize(type));
+	stats->has_null = source.Read<bool>();
+	stats->has_no_null = source.Read<bool>();
+	stats->null_count = source.Read<idx_t>();
+	stats->distinct_count = source.Read<idx_t>();
+	if (type == TypeId::VARCHAR) {
+		stats->min_string = source.Read<string>();
+		stats->max_string = source.Read<string>();
+	} else {
+		source.ReadData(stats->minimum.get(), stats->type_size);
+		source.ReadData(stats->maximum.get(), stats->type_size);
+	}
+	return stats;
+}
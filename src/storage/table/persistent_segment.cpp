@@ -6,6 +6,7 @@
 #include "duckdb/storage/checkpoint/table_data_writer.hpp"
 #include "duckdb/storage/meta_block_reader.hpp"
 
+#include "duckdb/storage/compressed_segment.hpp"
 #include "duckdb/storage/numeric_segment.hpp"
 #include "duckdb/storage/string_segment.hpp"
 
@@ -13,13 +14,18 @@ using namespace duckdb;
 using namespace std;
 
 PersistentSegment::PersistentSegment(BufferManager &manager, block_id_t id, idx_t offset, TypeId type, idx_t start,
-                                     idx_t count, data_t stats_min[], data_t stats_max[])
-    : ColumnSegment(type, ColumnSegmentType::PERSISTENT, start, count, stats_min, stats_max), manager(manager),
-      block_id(id), offset(offset) {
+                                     idx_t count, unique_ptr<SegmentStatistics> statistics, bool compressed)
+    : ColumnSegment(type, ColumnSegmentType::PERSISTENT, start, count, move(statistics)), manager(manager),
+      block_id(id), offset(offset), compressed(compressed) {
 	assert(offset == 0);
 	if (type == TypeId::VARCHAR) {
-		data = make_unique<StringSegment>(manager, start, id);
-		data->max_vector_count = count / STANDARD_VECTOR_SIZE + (count % STANDARD_VECTOR_SIZE == 0 ? 0 : 1);
+		auto string_segment = make_unique<StringSegment>(manager, start, id);
+		string_segment->max_vector_count = count / STANDARD_VECTOR_SIZE + (count % STANDARD_VECTOR_SIZE == 0 ? 0 : 1);
+		// compressed string segments have a deduplicated dictionary
+		string_segment->dictionary_vectors = compressed;
+		data = move(string_segment);
+	} else if (compressed) {
+		data = make_unique<CompressedSegment>(manager, type, start, id, count);
 	} else {
 		data = make_unique<NumericSegment>(manager, type, start, id);
 	}
@@ -2,6 +2,8 @@
 #include "duckdb/transaction/transaction.hpp"
 #include "duckdb/common/vector_operations/vector_operations.hpp"
 
+#include <algorithm>
+
 using namespace duckdb;
 using namespace std;
 
@@ -162,3 +164,53 @@ void VersionManager::RevertAppend(row_t row_start, row_t row_end) {
 		info.erase(chunk_start);
 	}
 }
+
+void VersionManager::GetDeletedRows(vector<row_t> &result) {
+	auto read_lock = lock.GetSharedLock();
+
+	// visit the chunks in order so the rows are sorted
+	vector<idx_t> chunks;
+	for (auto &entry : info) {
+		chunks.push_back(entry.first);
+	}
+	sort(chunks.begin(), chunks.end());
+	for (auto &chunk_idx : chunks) {
+		auto &delete_info = (ChunkDeleteInfo &)*info[chunk_idx];
+		for (idx_t i = 0; i < STANDARD_VECTOR_SIZE; i++) {
+			if (delete_info.deleted[i] < TRANSACTION_ID_START) {
+				result.push_back(base_row + chunk_idx * STANDARD_VECTOR_SIZE + i);
+			}
+		}
+	}
+}
+
+void VersionManager::SetDeletedRows(const vector<row_t> &rows) {
+	auto write_lock = lock.GetExclusiveLock();
+	for (auto &row_id : rows) {
+		idx_t row = row_id - base_row;
+		idx_t chunk_idx = row / STANDARD_VECTOR_SIZE;
+		auto entry = info.find(chunk_idx);
+		ChunkDeleteInfo *delete_info;
+		if (entry == info.end()) {
+			auto new_info = make_unique<ChunkDeleteInfo>(*this, chunk_idx * STANDARD_VECTOR_SIZE);
+			delete_info = new_info.get();
+			info[chunk_idx] = move(new_info);
+		} else {
+			delete_info = (ChunkDeleteInfo *)entry->second.get();
+		}
+		// the row was deleted before any transaction that is still active started
+		delete_info->deleted[row - chunk_idx * STANDARD_VECTOR_SIZE] = 0;
+	}
+}
+
+bool VersionManager::DeletedBeforeCheckpoint(idx_t row) {
+	row -= base_row;
+	idx_t vector_index = row / STANDARD_VECTOR_SIZE;
+
+	auto entry = info.find(vector_index);
+	if (entry == info.end()) {
+		return false;
+	}
+	auto &delete_info = (ChunkDeleteInfo &)*entry->second;
+	return delete_info.deleted[row - vector_index * STANDARD_VECTOR_SIZE] == 0;
+}
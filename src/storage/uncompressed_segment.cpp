@@ -111,6 +111,22 @@ void UncompressedSegment::Update(ColumnData &column_data, SegmentStatistics &sta
         CheckForConflicts(versions[vector_index], transaction, ids, count, vector_offset, node);
     }
     Update(column_data, stats, transaction, update, ids, count, vector_index, vector_offset, node);
+
+    // the statistics have to cover both the old and the new values of the updated rows
+    auto &update_nullmask = FlatVector::Nullmask(update);
+    idx_t null_count = 0;
+    for (idx_t i = 0; i < count; i++) {
+        if (update_nullmask[i]) {
+            null_count++;
+        }
+    }
+    if (null_count > 0) {
+        stats.has_null = true;
+        stats.null_count += null_count;
+    }
+    if (null_count < count) {
+        stats.has_no_null = true;
+    }
 }
 
 UpdateInfo *UncompressedSegment::CreateUpdateInfo(ColumnData &column_data, Transaction &transaction, row_t *ids,
@@ -210,8 +226,42 @@ static void filterSelectionType(T *vec, T *predicate, SelectionVector &sel, idx_
     sel.Initialize(new_sel);
 }
 
+template <bool IS_NULL>
+static void filterNullSelection(SelectionVector &sel, idx_t &approved_tuple_count, nullmask_t &nullmask) {
+    SelectionVector new_sel(approved_tuple_count);
+    idx_t result_count = 0;
+    for (idx_t i = 0; i < approved_tuple_count; i++) {
+        auto idx = sel.get_index(i);
+        if (nullmask[idx] == IS_NULL) {
+            new_sel.set_index(result_count++, idx);
+        }
+    }
+    approved_tuple_count = result_count;
+    sel.Initialize(new_sel);
+}
+
+static bool hasNullFilter(vector<TableFilter> &tableFilters) {
+    for (auto &table_filter : tableFilters) {
+        if (table_filter.comparison_type == ExpressionType::OPERATOR_IS_NULL ||
+            table_filter.comparison_type == ExpressionType::OPERATOR_IS_NOT_NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void UncompressedSegment::filterSelection(SelectionVector &sel, Vector &result, TableFilter filter,
                                           idx_t &approved_tuple_count, nullmask_t &nullmask) {
+    switch (filter.comparison_type) {
+        case ExpressionType::OPERATOR_IS_NULL:
+            filterNullSelection<true>(sel, approved_tuple_count, nullmask);
+            return;
+        case ExpressionType::OPERATOR_IS_NOT_NULL:
+            filterNullSelection<false>(sel, approved_tuple_count, nullmask);
+            return;
+        default:
+            break;
+    }
     // the inplace loops take the result as the last parameter
     switch (result.type) {
         case TypeId::INT8: {
@@ -246,6 +296,14 @@ void UncompressedSegment::filterSelection(SelectionVector &sel, Vector &result,
                                          nullmask);
             break;
         }
+        case TypeId::INT128: {
+            auto result_flat = FlatVector::GetData<hugeint_t>(result);
+            auto predicate_vector = Vector(Value::HUGEINT(filter.constant.value_.hugeint));
+            auto predicate = FlatVector::GetData<hugeint_t>(predicate_vector);
+            filterSelectionType<hugeint_t>(result_flat, predicate, sel, approved_tuple_count, filter.comparison_type,
+                                           nullmask);
+            break;
+        }
         case TypeId::FLOAT: {
             auto result_flat = FlatVector::GetData<float>(result);
             auto predicate_vector = Vector(filter.constant.value_.float_);
@@ -278,16 +336,18 @@ void UncompressedSegment::filterSelection(SelectionVector &sel, Vector &result,
 void UncompressedSegment::Select(Transaction &transaction, Vector &result, vector<TableFilter> &tableFilters,
                                  SelectionVector &sel, idx_t &approved_tuple_count, ColumnScanState &state) {
     auto read_lock = lock.GetSharedLock();
-    if (versions && versions[state.vector_index]) {
+    if ((versions && versions[state.vector_index]) || hasNullFilter(tableFilters)) {
+        // scan the vector (including any updates) and filter the result, the nullmask of the result also reflects
+        // updates that changed NULL values
         Scan(transaction, state, state.vector_index, result, false);
-        auto vector_index = state.vector_index;
-        // pin the buffer for this segment
-        auto handle = manager.Pin(block_id);
-        auto data = handle->node->buffer;
-        auto offset = vector_index * vector_size;
-        auto source_nullmask = (nullmask_t *) (data + offset);
+        // the scan can produce a dictionary (string segments) or constant (compressed segments) vector: the filters
+        // below operate on flat vectors
+        idx_t vector_count =
+            std::min((idx_t)STANDARD_VECTOR_SIZE, tuple_count - state.vector_index * STANDARD_VECTOR_SIZE);
+        result.Normalify(vector_count);
+        auto &result_nullmask = FlatVector::Nullmask(result);
         for (auto &table_filter : tableFilters) {
-            filterSelection(sel, result, table_filter, approved_tuple_count, *source_nullmask);
+            filterSelection(sel, result, table_filter, approved_tuple_count, result_nullmask);
         }
     } else {
         //! Select the data from the base table
@@ -330,7 +390,13 @@ void UncompressedSegment::IndexScan(ColumnScanState &state, idx_t vector_index,
         state.locks.push_back(lock.GetSharedLock());
     }
     if (versions && versions[vector_index]) {
-        throw TransactionException("Cannot create index with outstanding updates");
+        // the base data holds the most recent values: these can only be indexed if they are all committed
+        for (auto info = versions[vector_index]; info; info = info->next) {
+            if (info->version_number >= TRANSACTION_ID_START) {
+                throw TransactionException("Cannot create index with outstanding updates");
+            }
+            state.max_update_id = max(state.max_update_id, info->version_number);
+        }
     }
     FetchBaseData(state, vector_index, result);
 }
@@ -351,6 +417,9 @@ void UncompressedSegment::CleanupUpdate(UpdateInfo *info) {
         info->segment->versions[info->vector_index] = info->next;
         if (info->next) {
             info->next->prev = nullptr;
+        } else {
+            // the version chain is empty: no transaction can see older values of the vector anymore
+            ConsolidateUpdates(info->vector_index);
         }
     }
 }
@@ -1,5 +1,7 @@
 #include "duckdb/storage/write_ahead_log.hpp"
 #include "duckdb/storage/data_table.hpp"
+#include "duckdb/storage/storage_manager.hpp"
+#include "duckdb/storage/block_manager.hpp"
 #include "duckdb/common/serializer/buffered_file_reader.hpp"
 #include "duckdb/catalog/catalog_entry/schema_catalog_entry.hpp"
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
@@ -22,13 +24,18 @@ using namespace std;
 class ReplayState {
 public:
 	ReplayState(DuckDB &db, ClientContext &context, Deserializer &source)
-	    : db(db), context(context), source(source), current_table(nullptr) {
+	    : db(db), context(context), source(source), current_table(nullptr), deserialize_only(false),
+	      checkpoint_id(INVALID_BLOCK) {
 	}
 
 	DuckDB &db;
 	ClientContext &context;
 	Deserializer &source;
 	TableCatalogEntry *current_table;
+	//! Whether or not to only deserialize the entries, without applying them to the database
+	bool deserialize_only;
+	//! The meta block of the last checkpoint marker in the WAL (if any)
+	block_id_t checkpoint_id;
 
 public:
 	void ReplayEntry(WALType entry_type);
@@ -52,20 +59,52 @@ private:
 	void ReplayInsert();
 	void ReplayDelete();
 	void ReplayUpdate();
-};
 
-void WriteAheadLog::Replay(DuckDB &database, string &path) {
-	BufferedFileReader reader(database.GetFileSystem(), path.c_str());
+	void ReplayCheckpoint();
+};
 
-	if (reader.Finished()) {
+bool WriteAheadLog::Replay(DuckDB &database, string &path) {
+	auto initial_reader = make_unique<BufferedFileReader>(database.GetFileSystem(), path.c_str());
+	if (initial_reader->Finished()) {
 		// WAL is empty
-		return;
+		return false;
 	}
 
 	ClientContext context(database);
 	context.transaction.SetAutoCommit(false);
 	context.transaction.BeginTransaction();
 
+	// first deserialize the WAL to look for a checkpoint marker
+	ReplayState checkpoint_state(database, context, *initial_reader);
+	checkpoint_state.deserialize_only = true;
+	try {
+		while (true) {
+			// read the current entry
+			WALType entry_type = initial_reader->Read<WALType>();
+			if (entry_type == WALType::WAL_FLUSH) {
+				// check if the file is exhausted
+				if (initial_reader->Finished()) {
+					// we finished reading the file: break
+					break;
+				}
+			} else {
+				// deserialize the entry
+				checkpoint_state.ReplayEntry(entry_type);
+			}
+		}
+	} catch (std::exception &ex) {
+		// corrupt WAL: the entries after the corruption are ignored by the replay below as well
+	}
+	initial_reader.reset();
+	if (checkpoint_state.checkpoint_id != INVALID_BLOCK &&
+	    checkpoint_state.checkpoint_id == database.storage->block_manager->GetMetaBlock()) {
+		// the contents of the WAL were already written to the current checkpoint: there is no need to replay it
+		context.transaction.Rollback();
+		return true;
+	}
+
+	// we need to replay the WAL
+	BufferedFileReader reader(database.GetFileSystem(), path.c_str());
 	ReplayState state(database, context, reader);
 
 	// replay the WAL
@@ -98,6 +137,7 @@ void WriteAheadLog::Replay(DuckDB &database, string &path) {
 		// exception thrown in WAL replay: rollback
 		context.transaction.Rollback();
 	}
+	return false;
 }
 
 //===--------------------------------------------------------------------===//
@@ -147,6 +187,9 @@ void ReplayState::ReplayEntry(WALType entry_type) {
 	case WALType::UPDATE_TUPLE:
 		ReplayUpdate();
 		break;
+	case WALType::CHECKPOINT:
+		ReplayCheckpoint();
+		break;
 	default:
 		throw Exception("Invalid WAL entry type!");
 	}
@@ -157,6 +200,9 @@ void ReplayState::ReplayEntry(WALType entry_type) {
 //===--------------------------------------------------------------------===//
 void ReplayState::ReplayCreateTable() {
 	auto info = TableCatalogEntry::Deserialize(source);
+	if (deserialize_only) {
+		return;
+	}
 
 	// bind the constraints to the table again
 	Binder binder(context);
@@ -171,12 +217,18 @@ void ReplayState::ReplayDropTable() {
 	info.type = CatalogType::TABLE;
 	info.schema = source.Read<string>();
 	info.name = source.Read<string>();
+	if (deserialize_only) {
+		return;
+	}
 
 	db.catalog->DropEntry(context, &info);
 }
 
 void ReplayState::ReplayAlter() {
 	auto info = AlterInfo::Deserialize(source);
+	if (deserialize_only) {
+		return;
+	}
 	if (info->type != AlterType::ALTER_TABLE) {
 		throw Exception("Expected ALTER TABLE!");
 	}
@@ -189,6 +241,9 @@ void ReplayState::ReplayAlter() {
 //===--------------------------------------------------------------------===//
 void ReplayState::ReplayCreateView() {
 	auto entry = ViewCatalogEntry::Deserialize(source);
+	if (deserialize_only) {
+		return;
+	}
 
 	db.catalog->CreateView(context, entry.get());
 }
@@ -198,6 +253,9 @@ void ReplayState::ReplayDropView() {
 	info.type = CatalogType::VIEW;
 	info.schema = source.Read<string>();
 	info.name = source.Read<string>();
+	if (deserialize_only) {
+		return;
+	}
 	db.catalog->DropEntry(context, &info);
 }
 
@@ -207,6 +265,9 @@ void ReplayState::ReplayDropView() {
 void ReplayState::ReplayCreateSchema() {
 	CreateSchemaInfo info;
 	info.schema = source.Read<string>();
+	if (deserialize_only) {
+		return;
+	}
 
 	db.catalog->CreateSchema(context, &info);
 }
@@ -216,6 +277,9 @@ void ReplayState::ReplayDropSchema() {
 
 	info.type = CatalogType::SCHEMA;
 	info.name = source.Read<string>();
+	if (deserialize_only) {
+		return;
+	}
 
 	db.catalog->DropEntry(context, &info);
 }
@@ -225,6 +289,9 @@ void ReplayState::ReplayDropSchema() {
 //===--------------------------------------------------------------------===//
 void ReplayState::ReplayCreateSequence() {
 	auto entry = SequenceCatalogEntry::Deserialize(source);
+	if (deserialize_only) {
+		return;
+	}
 
 	db.catalog->CreateSequence(context, entry.get());
 }
@@ -234,6 +301,9 @@ void ReplayState::ReplayDropSequence() {
 	info.type = CatalogType::SEQUENCE;
 	info.schema = source.Read<string>();
 	info.name = source.Read<string>();
+	if (deserialize_only) {
+		return;
+	}
 
 	db.catalog->DropEntry(context, &info);
 }
@@ -243,6 +313,9 @@ void ReplayState::ReplaySequenceValue() {
 	auto name = source.Read<string>();
 	auto usage_count = source.Read<uint64_t>();
 	auto counter = source.Read<int64_t>();
+	if (deserialize_only) {
+		return;
+	}
 
 	// fetch the sequence from the catalog
 	auto seq = db.catalog->GetEntry<SequenceCatalogEntry>(context, schema, name);
@@ -258,48 +331,52 @@ void ReplayState::ReplaySequenceValue() {
 void ReplayState::ReplayUseTable() {
 	auto schema_name = source.Read<string>();
 	auto table_name = source.Read<string>();
+	if (deserialize_only) {
+		return;
+	}
 	current_table = db.catalog->GetEntry<TableCatalogEntry>(context, schema_name, table_name);
 }
 
 void ReplayState::ReplayInsert() {
+	DataChunk chunk;
+	chunk.Deserialize(source);
+	if (deserialize_only) {
+		return;
+	}
 	if (!current_table) {
 		throw Exception("Corrupt WAL: insert without table");
 	}
-	DataChunk chunk;
-	chunk.Deserialize(source);
 
 	// append to the current table
 	current_table->storage->Append(*current_table, context, chunk);
 }
 
 void ReplayState::ReplayDelete() {
+	DataChunk chunk;
+	chunk.Deserialize(source);
+	if (deserialize_only) {
+		return;
+	}
 	if (!current_table) {
 		throw Exception("Corrupt WAL: delete without table");
 	}
-	DataChunk chunk;
-	chunk.Deserialize(source);
 
 	assert(chunk.column_count() == 1 && chunk.data[0].type == ROW_TYPE);
-	row_t row_ids[1];
-	Vector row_identifiers(ROW_TYPE, (data_ptr_t)row_ids);
-
-	auto source_ids = FlatVector::GetData<row_t>(chunk.data[0]);
 	// delete the tuples from the current table
-	for (idx_t i = 0; i < chunk.size(); i++) {
-		row_ids[0] = source_ids[i];
-		current_table->storage->Delete(*current_table, context, row_identifiers, 1);
-	}
+	current_table->storage->Delete(*current_table, context, chunk.data[0], chunk.size());
 }
 
 void ReplayState::ReplayUpdate() {
-	if (!current_table) {
-		throw Exception("Corrupt WAL: update without table");
-	}
-
 	idx_t column_index = source.Read<column_t>();
 
 	DataChunk chunk;
 	chunk.Deserialize(source);
+	if (deserialize_only) {
+		return;
+	}
+	if (!current_table) {
+		throw Exception("Corrupt WAL: update without table");
+	}
 
 	vector<column_t> column_ids{column_index};
 	if (column_index >= current_table->columns.size()) {
@@ -313,3 +390,11 @@ void ReplayState::ReplayUpdate() {
 	// now perform the update
 	current_table->storage->Update(*current_table, context, row_ids, column_ids, chunk);
 }
+
+//===--------------------------------------------------------------------===//
+// Replay Checkpoint
+//===--------------------------------------------------------------------===//
+void ReplayState::ReplayCheckpoint() {
+	// the marker has no effect on the database: it is only used to detect WALs that were already checkpointed
+	checkpoint_id = source.Read<block_id_t>();
+}
@@ -1,15 +1,20 @@
 #include "duckdb/storage/write_ahead_log.hpp"
 #include "duckdb/main/database.hpp"
+#include "duckdb/common/exception.hpp"
 #include "duckdb/catalog/catalog_entry/schema_catalog_entry.hpp"
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/catalog/catalog_entry/view_catalog_entry.hpp"
 #include "duckdb/parser/parsed_data/alter_table_info.hpp"
+#include <chrono>
 #include <cstring>
+#include <thread>
 
 using namespace duckdb;
 using namespace std;
 
-WriteAheadLog::WriteAheadLog(DuckDB &database) : initialized(false), database(database) {
+WriteAheadLog::WriteAheadLog(DuckDB &database)
+    : initialized(false), database(database), flushed_sequence(0), sync_in_progress(false), synced_sequence(0),
+      sync_failed(false) {
 }
 
 void WriteAheadLog::Initialize(string &path) {
@@ -139,6 +144,14 @@ void WriteAheadLog::WriteAlter(AlterInfo &info) {
 	info.Serialize(*writer);
 }
 
+//===--------------------------------------------------------------------===//
+// CHECKPOINT
+//===--------------------------------------------------------------------===//
+void WriteAheadLog::WriteCheckpoint(block_id_t meta_block) {
+	writer->Write<WALType>(WALType::CHECKPOINT);
+	writer->Write<block_id_t>(meta_block);
+}
+
 //===--------------------------------------------------------------------===//
 // FLUSH
 //===--------------------------------------------------------------------===//
@@ -148,3 +161,51 @@ void WriteAheadLog::Flush() {
 	// flushes all changes made to the WAL to disk
 	writer->Sync();
 }
+
+idx_t WriteAheadLog::FlushCommit() {
+	// write an empty entry
+	writer->Write<WALType>(WALType::WAL_FLUSH);
+	// hand the entries to the file system: they are synced to disk together with the entries of other commits
+	writer->Flush();
+	return ++flushed_sequence;
+}
+
+void WriteAheadLog::SyncCommit(idx_t commit_sequence, bool wait_for_group) {
+	unique_lock<mutex> lock(sync_lock);
+	while (synced_sequence < commit_sequence) {
+		if (sync_failed) {
+			// a previous sync failed: we cannot know which of the flushed entries made it to disk, and retrying the
+			// sync does not tell us either, so no commit after the failed sync can be made durable anymore
+			throw IOException("Failed to sync the write-ahead log, the database is invalidated: %s",
+			                  sync_error.c_str());
+		}
+		if (sync_in_progress) {
+			// another committer is syncing the WAL: wait for it to finish, it might have synced our commit as well
+			sync_finished.wait(lock);
+			continue;
+		}
+		// sync the WAL for all commits that are flushed so far
+		sync_in_progress = true;
+		lock.unlock();
+		auto delay = database.config.group_commit_delay;
+		if (wait_for_group && delay > 0) {
+			std::this_thread::sleep_for(std::chrono::microseconds(delay));
+		}
+		// all commits up to this sequence number have been handed to the file system before the sync starts
+		idx_t sync_sequence = flushed_sequence;
+		try {
+			writer->handle->Sync();
+		} catch (std::exception &ex) {
+			lock.lock();
+			sync_in_progress = false;
+			sync_failed = true;
+			sync_error = ex.what();
+			sync_finished.notify_all();
+			continue;
+		}
+		lock.lock();
+		sync_in_progress = false;
+		synced_sequence = max(synced_sequence, sync_sequence);
+		sync_finished.notify_all();
+	}
+}
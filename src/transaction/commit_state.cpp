@@ -5,6 +5,7 @@
 #include "duckdb/storage/data_table.hpp"
 #include "duckdb/storage/write_ahead_log.hpp"
 #include "duckdb/storage/uncompressed_segment.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/common/serializer/buffered_deserializer.hpp"
 #include "duckdb/parser/parsed_data/alter_table_info.hpp"
 
@@ -12,11 +13,13 @@ using namespace duckdb;
 using namespace std;
 
 CommitState::CommitState(transaction_t commit_id, WriteAheadLog *log)
-    : log(log), commit_id(commit_id), current_table_info(nullptr) {
+    : log(log), commit_id(commit_id), current_table_info(nullptr), update_column(nullptr) {
 }
 
 void CommitState::SwitchTable(DataTableInfo *table_info, UndoFlags new_op) {
 	if (current_table_info != table_info) {
+		// the collected deletes and updates belong to the previous table
+		Flush();
 		// write the current table to the log
 		log->WriteSetTable(table_info->schema, table_info->table);
 		current_table_info = table_info;
@@ -25,6 +28,7 @@ void CommitState::SwitchTable(DataTableInfo *table_info, UndoFlags new_op) {
 
 void CommitState::WriteCatalogEntry(CatalogEntry *entry, data_ptr_t dataptr) {
 	assert(log);
+	Flush();
 	// look at the type of the parent entry
 	auto parent = entry->parent;
 	switch (parent->type) {
@@ -94,44 +98,77 @@ void CommitState::WriteDelete(DeleteInfo *info) {
 	assert(log);
 	// switch to the current table, if necessary
 	SwitchTable(info->table->info.get(), UndoFlags::DELETE_TUPLE);
+	FlushUpdate();
 
 	if (!delete_chunk) {
 		delete_chunk = make_unique<DataChunk>();
 		vector<TypeId> delete_types = {ROW_TYPE};
 		delete_chunk->Initialize(delete_types);
 	}
-	auto rows = FlatVector::GetData<row_t>(delete_chunk->data[0]);
+	if (delete_chunk->size() + info->count > STANDARD_VECTOR_SIZE) {
+		FlushDelete();
+	}
+	// add the deleted rows to the delete chunk
+	auto rows = FlatVector::GetData<row_t>(delete_chunk->data[0]) + delete_chunk->size();
 	for (idx_t i = 0; i < info->count; i++) {
 		rows[i] = info->base_row + info->rows[i];
 	}
-	delete_chunk->SetCardinality(info->count);
-	log->WriteDelete(*delete_chunk);
+	delete_chunk->SetCardinality(delete_chunk->size() + info->count);
 }
 
 void CommitState::WriteUpdate(UpdateInfo *info) {
 	assert(log);
 	// switch to the current table, if necessary
 	SwitchTable(&info->column_data->table_info, UndoFlags::UPDATE_TUPLE);
+	FlushDelete();
 
-	update_chunk = make_unique<DataChunk>();
-	vector<TypeId> update_types = {info->column_data->type, ROW_TYPE};
-	update_chunk->Initialize(update_types);
+	if (update_column != info->column_data || update_chunk->size() + info->N > STANDARD_VECTOR_SIZE) {
+		FlushUpdate();
+	}
+	if (!update_chunk || update_chunk->data[0].type != info->column_data->type) {
+		update_chunk = make_unique<DataChunk>();
+		vector<TypeId> update_types = {info->column_data->type, ROW_TYPE};
+		update_chunk->Initialize(update_types);
+	}
+	update_column = info->column_data;
 
 	// fetch the updated values from the base table
+	Vector values(info->column_data->type);
 	ColumnScanState state;
 	info->segment->InitializeScan(state);
-	info->segment->Fetch(state, info->vector_index, update_chunk->data[0]);
+	info->segment->Fetch(state, info->vector_index, values);
 
-	// write the row ids into the chunk
+	// add the values and the row ids to the update chunk
+	idx_t offset = update_chunk->size();
+	SelectionVector sel(info->tuples);
+	VectorOperations::Copy(values, update_chunk->data[0], sel, info->N, 0, offset);
 	auto row_ids = FlatVector::GetData<row_t>(update_chunk->data[1]);
 	idx_t start = info->segment->row_start + info->vector_index * STANDARD_VECTOR_SIZE;
 	for (idx_t i = 0; i < info->N; i++) {
-		row_ids[info->tuples[i]] = start + info->tuples[i];
+		row_ids[offset + i] = start + info->tuples[i];
 	}
-	SelectionVector sel(info->tuples);
-	update_chunk->Slice(sel, info->N);
+	update_chunk->SetCardinality(offset + info->N);
+}
+
+void CommitState::FlushDelete() {
+	if (!delete_chunk || delete_chunk->size() == 0) {
+		return;
+	}
+	log->WriteDelete(*delete_chunk);
+	delete_chunk->Reset();
+}
+
+void CommitState::FlushUpdate() {
+	if (!update_chunk || update_chunk->size() == 0) {
+		return;
+	}
+	log->WriteUpdate(*update_chunk, update_column->column_idx);
+	update_chunk->Reset();
+}
 
-	log->WriteUpdate(*update_chunk, info->column_data->column_idx);
+void CommitState::Flush() {
+	FlushDelete();
+	FlushUpdate();
 }
 
 template <bool HAS_LOG> void CommitState::CommitEntry(UndoFlags type, data_ptr_t data) {
@@ -24,6 +24,7 @@ void Transaction::PushCatalogEntry(CatalogEntry *entry, data_ptr_t extra_data, i
 	if (extra_data_size > 0) {
 		alloc_size += extra_data_size + sizeof(idx_t);
 	}
+	lock_guard<mutex> lock(undo_lock);
 	auto baseptr = undo_buffer.CreateEntry(UndoFlags::CATALOG_ENTRY, alloc_size);
 	// store the pointer to the catalog entry
 	*((CatalogEntry **)baseptr) = entry;
@@ -39,6 +40,7 @@ void Transaction::PushCatalogEntry(CatalogEntry *entry, data_ptr_t extra_data, i
 }
 
 void Transaction::PushDelete(DataTable *table, ChunkInfo *vinfo, row_t rows[], idx_t count, idx_t base_row) {
+	lock_guard<mutex> lock(undo_lock);
 	auto delete_info =
 	    (DeleteInfo *)undo_buffer.CreateEntry(UndoFlags::DELETE_TUPLE, sizeof(DeleteInfo) + sizeof(row_t) * count);
 	delete_info->vinfo = vinfo;
@@ -49,6 +51,7 @@ void Transaction::PushDelete(DataTable *table, ChunkInfo *vinfo, row_t rows[], i
 }
 
 UpdateInfo *Transaction::CreateUpdateInfo(idx_t type_size, idx_t entries) {
+	lock_guard<mutex> lock(undo_lock);
 	auto update_info = (UpdateInfo *)undo_buffer.CreateEntry(
 	    UndoFlags::UPDATE_TUPLE, sizeof(UpdateInfo) + (sizeof(sel_t) + type_size) * entries);
 	update_info->max = entries;
@@ -59,7 +62,11 @@ UpdateInfo *Transaction::CreateUpdateInfo(idx_t type_size, idx_t entries) {
 	return update_info;
 }
 
-string Transaction::Commit(WriteAheadLog *log, transaction_t commit_id) noexcept {
+bool Transaction::ChangesMade() {
+	return undo_buffer.ChangesMade() || storage.ChangesMade() || sequence_usage.size() > 0;
+}
+
+string Transaction::Commit(WriteAheadLog *log, transaction_t commit_id, idx_t &wal_sequence) noexcept {
 	this->commit_id = commit_id;
 
 	UndoBuffer::IteratorState iterator_state;
@@ -68,7 +75,7 @@ string Transaction::Commit(WriteAheadLog *log, transaction_t commit_id) noexcept
 	if (log) {
 		initial_wal_size = log->GetWALSize();
 	}
-	bool changes_made = undo_buffer.ChangesMade() || storage.ChangesMade() || sequence_usage.size() > 0;
+	bool changes_made = ChangesMade();
 	try {
 		// commit the undo buffer
 		undo_buffer.Commit(iterator_state, log, commit_id);
@@ -78,9 +85,9 @@ string Transaction::Commit(WriteAheadLog *log, transaction_t commit_id) noexcept
 			for (auto &entry : sequence_usage) {
 				log->WriteSequenceValue(entry.first, entry.second);
 			}
-			// flush the WAL
+			// flush the WAL, the caller syncs it to disk
 			if (changes_made) {
-				log->Flush();
+				wal_sequence = log->FlushCommit();
 			}
 		}
 		return string();
@@ -6,6 +6,8 @@
 #include "duckdb/common/types/timestamp.hpp"
 #include "duckdb/catalog/catalog.hpp"
 #include "duckdb/catalog/dependency_manager.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/database.hpp"
 #include "duckdb/storage/storage_manager.hpp"
 #include "duckdb/transaction/transaction.hpp"
 
@@ -28,45 +30,92 @@ TransactionManager::~TransactionManager() {
 }
 
 Transaction *TransactionManager::StartTransaction() {
-	// obtain the transaction lock during this function
-	lock_guard<mutex> lock(transaction_lock);
+	auto log = storage.GetWriteAheadLog();
+	idx_t wal_sequence = 0;
+	Transaction *transaction_ptr;
+	{
+		// obtain the transaction lock while starting the transaction
+		lock_guard<mutex> lock(transaction_lock);
 
-	if (current_start_timestamp >= TRANSACTION_ID_START) {
-		throw Exception("Cannot start more transactions, ran out of "
-		                "transaction identifiers!");
-	}
+		if (current_start_timestamp >= TRANSACTION_ID_START) {
+			throw Exception("Cannot start more transactions, ran out of "
+			                "transaction identifiers!");
+		}
 
-	// obtain the start time and transaction ID of this transaction
-	transaction_t start_time = current_start_timestamp++;
-	transaction_t transaction_id = current_transaction_id++;
-	timestamp_t start_timestamp = Timestamp::GetCurrentTimestamp();
+		// obtain the start time and transaction ID of this transaction
+		transaction_t start_time = current_start_timestamp++;
+		transaction_t transaction_id = current_transaction_id++;
+		timestamp_t start_timestamp = Timestamp::GetCurrentTimestamp();
 
-	// create the actual transaction
-	auto transaction = make_unique<Transaction>(start_time, transaction_id, start_timestamp);
-	auto transaction_ptr = transaction.get();
+		// create the actual transaction
+		auto transaction = make_unique<Transaction>(start_time, transaction_id, start_timestamp);
+		transaction_ptr = transaction.get();
 
-	// store it in the set of active transactions
-	active_transactions.push_back(move(transaction));
+		// store it in the set of active transactions
+		active_transactions.push_back(move(transaction));
+		if (log) {
+			// every commit this transaction can see has been flushed to the WAL at this point
+			wal_sequence = log->GetFlushedSequence();
+		}
+	}
+	if (wal_sequence > 0) {
+		// the commits this transaction can see might not be synced to disk yet: wait for their sync before the
+		// transaction can read them, so a commit is only visible once it is durable
+		try {
+			log->SyncCommit(wal_sequence, false);
+		} catch (...) {
+			RollbackTransaction(transaction_ptr);
+			throw;
+		}
+	}
 	return transaction_ptr;
 }
 
 string TransactionManager::CommitTransaction(Transaction *transaction) {
-	// obtain the transaction lock during this function
-	lock_guard<mutex> lock(transaction_lock);
+	auto log = storage.GetWriteAheadLog();
+	idx_t wal_sequence = 0;
+	bool other_transactions_active;
+	string error;
+	{
+		// obtain the transaction lock while committing the transaction
+		lock_guard<mutex> lock(transaction_lock);
 
-	// obtain a commit id for the transaction
-	transaction_t commit_id = current_start_timestamp++;
-	// commit the UndoBuffer of the transaction
-	string error = transaction->Commit(storage.GetWriteAheadLog(), commit_id);
-	if (!error.empty()) {
-		// commit unsuccessful: rollback the transaction instead
-		transaction->commit_id = 0;
-		transaction->Rollback();
-	}
+		// obtain a commit id for the transaction
+		transaction_t commit_id = current_start_timestamp++;
+		// commit the UndoBuffer of the transaction
+		error = transaction->Commit(log, commit_id, wal_sequence);
+		if (!error.empty()) {
+			// commit unsuccessful: rollback the transaction instead
+			transaction->commit_id = 0;
+			transaction->Rollback();
+		}
 
-	// commit successful: remove the transaction id from the list of active transactions
-	// potentially resulting in garbage collection
-	RemoveTransaction(transaction);
+		// commit successful: remove the transaction id from the list of active transactions
+		// potentially resulting in garbage collection
+		RemoveTransaction(transaction);
+		other_transactions_active = active_transactions.size() > 0;
+		if (error.empty() && !other_transactions_active) {
+			// this was the last active transaction: checkpoint if the WAL has grown too large
+			if (log && (idx_t)log->GetWALSize() > storage.database.config.checkpoint_wal_size) {
+				try {
+					CheckpointInternal();
+				} catch (...) {
+					// the checkpoint failed: the committed changes are still in the WAL, so we can try again later
+				}
+			}
+		}
+	}
+	if (error.empty() && wal_sequence > 0) {
+		// the entries of the transaction are in the WAL (in commit order), but not necessarily on disk yet: sync them
+		// outside of the transaction lock, so concurrent commits can be synced together with a single sync
+		// transactions that start in the meantime wait for the sync before they can see the commit (StartTransaction)
+		// if the sync fails the database is invalidated: no transaction can start anymore, so the commit is never seen
+		try {
+			log->SyncCommit(wal_sequence, other_transactions_active);
+		} catch (std::exception &ex) {
+			return ex.what();
+		}
+	}
 	return error;
 }
 
@@ -176,6 +225,51 @@ void TransactionManager::RemoveTransaction(Transaction *transaction) noexcept {
 	}
 }
 
+void TransactionManager::Checkpoint(ClientContext &context, bool vacuum, TableCatalogEntry *vacuum_table) {
+	auto statement = vacuum ? "VACUUM" : "CHECKPOINT";
+	auto &current = Transaction::GetTransaction(context);
+	if (current.ChangesMade()) {
+		throw TransactionException("Cannot %s: the current transaction has outstanding changes", statement);
+	}
+	lock_guard<mutex> lock(transaction_lock);
+	for (auto &transaction : active_transactions) {
+		if (transaction.get() != &current) {
+			throw TransactionException("Cannot %s: there are other transactions active, try again later", statement);
+		}
+	}
+	if (!context.transaction.IsAutoCommit()) {
+		// the checkpoint makes all committed changes visible: this is only allowed if the current transaction can
+		// already see all of them
+		for (auto &transaction : recently_committed_transactions) {
+			if (transaction->commit_id > current.start_time) {
+				throw TransactionException("Cannot %s: the current transaction cannot see all committed changes, "
+				                           "restart the transaction and try again",
+				                           statement);
+			}
+		}
+	}
+	CheckpointInternal(vacuum, vacuum_table);
+}
+
+void TransactionManager::CheckpointInternal(bool vacuum, TableCatalogEntry *vacuum_table) {
+	auto log = storage.GetWriteAheadLog();
+	if (log) {
+		// the checkpoint writes all committed changes to the database file: the commits that are not synced yet have to
+		// be synced first, if their sync fails they must not end up in the database file either
+		log->SyncCommit(log->GetFlushedSequence(), false);
+	}
+	// there are no other transactions left that can see old versions of the data: clean up all committed transactions
+	for (auto &transaction : recently_committed_transactions) {
+		transaction->Cleanup();
+		transaction->highest_active_query = current_query_number;
+		old_transactions.push_back(move(transaction));
+	}
+	recently_committed_transactions.clear();
+	// now write the checkpoint using a transaction that can see all committed changes
+	Transaction transaction(current_start_timestamp++, current_transaction_id++, Timestamp::GetCurrentTimestamp());
+	storage.CreateCheckpoint(transaction, vacuum, vacuum_table);
+}
+
 void TransactionManager::AddCatalogSet(ClientContext &context, unique_ptr<CatalogSet> catalog_set) {
 	// remove the dependencies from all entries of the CatalogSet
 	Catalog::GetCatalog(context).dependency_manager->ClearDependencies(*catalog_set);
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "test_helpers.hpp"
+
+#include <thread>
+
+using namespace duckdb;
+using namespace std;
+
+static constexpr int GROUP_COMMIT_THREAD_COUNT = 8;
+static constexpr int GROUP_COMMIT_INSERT_COUNT = 50;
+
+static void insert_committed_rows(DuckDB *db, bool *correct, int threadnr) {
+	correct[threadnr] = true;
+	Connection con(*db);
+	for (int i = 0; i < GROUP_COMMIT_INSERT_COUNT; i++) {
+		// every insert is committed on its own
+		auto result = con.Query("INSERT INTO integers VALUES (" + to_string(threadnr) + ", " + to_string(i) + ")");
+		if (!result->success) {
+			correct[threadnr] = false;
+		}
+	}
+}
+
+static void test_group_commit(DBConfig &config) {
+	string dbdir = TestCreatePath("group_commit");
+	DeleteDatabase(dbdir);
+	{
+		DuckDB db(dbdir, &config);
+		Connection con(db);
+		REQUIRE_NO_FAIL(con.Query("CREATE TABLE integers(thread INTEGER, i INTEGER)"));
+
+		bool correct[GROUP_COMMIT_THREAD_COUNT];
+		thread threads[GROUP_COMMIT_THREAD_COUNT];
+		for (int i = 0; i < GROUP_COMMIT_THREAD_COUNT; i++) {
+			threads[i] = thread(insert_committed_rows, &db, correct, i);
+		}
+		for (int i = 0; i < GROUP_COMMIT_THREAD_COUNT; i++) {
+			threads[i].join();
+			REQUIRE(correct[i]);
+		}
+	}
+	// all commits were synced to disk before they returned: they are all there after restarting
+	{
+		DuckDB db(dbdir, &config);
+		Connection con(db);
+		auto result = con.Query("SELECT COUNT(*), COUNT(DISTINCT thread), SUM(i) FROM integers");
+		REQUIRE(CHECK_COLUMN(result, 0, {GROUP_COMMIT_THREAD_COUNT * GROUP_COMMIT_INSERT_COUNT}));
+		REQUIRE(CHECK_COLUMN(result, 1, {GROUP_COMMIT_THREAD_COUNT}));
+		REQUIRE(CHECK_COLUMN(result, 2,
+		                     {GROUP_COMMIT_THREAD_COUNT * GROUP_COMMIT_INSERT_COUNT * (GROUP_COMMIT_INSERT_COUNT - 1) / 2}));
+	}
+	DeleteDatabase(dbdir);
+}
+
+TEST_CASE("Test concurrent commits that are synced to the WAL together", "[persistence]") {
+	auto config = GetTestConfig();
+	// do not checkpoint: the commits have to be replayed from the WAL
+	config->checkpoint_wal_size = (idx_t)-1;
+
+	SECTION("Without group commit delay") {
+		config->group_commit_delay = 0;
+		test_group_commit(*config);
+	}
+	SECTION("With group commit delay") {
+		config->group_commit_delay = 200;
+		test_group_commit(*config);
+	}
+	SECTION("With checkpoints") {
+		config->checkpoint_wal_size = 0;
+		config->group_commit_delay = 200;
+		test_group_commit(*config);
+	}
+}
+
+class FailingSyncFileSystem : public FileSystem {
+public:
+	FailingSyncFileSystem(bool &fail_sync) : fail_sync(fail_sync) {
+	}
+
+	void FileSync(FileHandle &handle) override {
+		if (fail_sync && StringUtil::EndsWith(handle.path, ".wal")) {
+			throw IOException("Injected sync failure");
+		}
+		FileSystem::FileSync(handle);
+	}
+
+private:
+	bool &fail_sync;
+};
+
+TEST_CASE("Test a commit of which the WAL sync fails", "[persistence]") {
+	string dbdir = TestCreatePath("group_commit_sync_failure");
+	DeleteDatabase(dbdir);
+	bool fail_sync = false;
+	auto config = GetTestConfig();
+	config->checkpoint_wal_size = (idx_t)-1;
+	config->file_system = make_unique_base<FileSystem, FailingSyncFileSystem>(fail_sync);
+	{
+		DuckDB db(dbdir, config.get());
+		Connection con(db), con2(db);
+		REQUIRE_NO_FAIL(con.Query("CREATE TABLE integers(i INTEGER)"));
+		REQUIRE_NO_FAIL(con.Query("INSERT INTO integers VALUES (1)"));
+
+		// the commit cannot be made durable: it fails
+		fail_sync = true;
+		REQUIRE_FAIL(con.Query("INSERT INTO integers VALUES (2)"));
+		fail_sync = false;
+		// the database is invalidated: no transaction can start anymore, so the failed commit is never seen
+		REQUIRE_FAIL(con.Query("SELECT * FROM integers"));
+		REQUIRE_FAIL(con2.Query("SELECT * FROM integers"));
+		REQUIRE_FAIL(con2.Query("INSERT INTO integers VALUES (3)"));
+	}
+	DeleteDatabase(dbdir);
+}
@@ -0,0 +1,339 @@
+# Generates nested.parquet and nested_large.parquet: files with nested (LIST/STRUCT/MAP) and repeated columns in the
+# different list encodings allowed by the Parquet format. The files are written without any dependencies (plain
+# encoding, uncompressed pages, RLE/bit-packed levels) so the exact layout of the levels is under our control.
+import random
+import struct
+
+# thrift compact protocol
+T_TRUE, T_FALSE, T_BYTE, T_I16, T_I32, T_I64, T_DOUBLE, T_BINARY, T_LIST, T_SET, T_MAP, T_STRUCT = range(1, 13)
+
+
+def varint(n):
+    out = bytearray()
+    while True:
+        if n < 0x80:
+            out.append(n)
+            return bytes(out)
+        out.append((n & 0x7F) | 0x80)
+        n >>= 7
+
+
+def zigzag(n):
+    return (n << 1) ^ (n >> 63)
+
+
+def encode_value(ttype, value):
+    if ttype in (T_I16, T_I32, T_I64):
+        return varint(zigzag(value))
+    if ttype == T_BINARY:
+        if isinstance(value, str):
+            value = value.encode('utf8')
+        return varint(len(value)) + value
+    if ttype == T_STRUCT:
+        return encode_struct(value)
+    if ttype == T_LIST:
+        elem_type, elems = value
+        header = bytes([(len(elems) << 4) | elem_type]) if len(elems) < 15 else bytes([0xF0 | elem_type]) + varint(len(elems))
+        return header + b''.join(encode_value(elem_type, e) for e in elems)
+    raise Exception('unsupported thrift type')
+
+
+def encode_struct(fields):
+    # fields: list of (field id, type, value) in increasing field id order, None values are omitted
+    out = bytearray()
+    last_id = 0
+    for field_id, ttype, value in fields:
+        if value is None:
+            continue
+        if 0 < field_id - last_id <= 15:
+            out.append(((field_id - last_id) << 4) | ttype)
+        else:
+            out.append(ttype)
+            out += varint(zigzag(field_id))
+        out += encode_value(ttype, value)
+        last_id = field_id
+    out.append(0)
+    return bytes(out)
+
+
+# parquet enums
+BOOLEAN, INT32, INT64, INT96, FLOAT, DOUBLE, BYTE_ARRAY = range(7)
+REQUIRED, OPTIONAL, REPEATED = range(3)
+UTF8, MAP, MAP_KEY_VALUE, LIST = range(4)
+PLAIN, RLE = 0, 3
+
+
+# schema
+class Node:
+    def __init__(self, name, repetition, children=None, ptype=None, converted=None):
+        self.name = name
+        self.repetition = repetition
+        self.children = children or []
+        self.ptype = ptype
+        self.converted = converted
+
+    def leaves(self):
+        if not self.children:
+            return [self]
+        return [leaf for child in self.children for leaf in child.leaves()]
+
+
+def leaf(name, repetition, ptype, converted=None):
+    return Node(name, repetition, ptype=ptype, converted=converted)
+
+
+def group(name, repetition, children, converted=None):
+    return Node(name, repetition, children, converted=converted)
+
+
+def list3(name, repetition, element):
+    # three-level list: <repetition> group <name> (LIST) { repeated group list { <element> } }
+    element.name = 'element'
+    return group(name, repetition, [group('list', REPEATED, [element])], LIST)
+
+
+def assign_levels(node, path=(), rep=0, define=0):
+    node.path = path + (node.name,)
+    node.max_rep = rep + (1 if node.repetition == REPEATED else 0)
+    node.max_def = define + (0 if node.repetition == REQUIRED else 1)
+    for child in node.children:
+        assign_levels(child, node.path, node.max_rep, node.max_def)
+
+
+# Dremel shredding of a record into the (repetition level, definition level, value) triples of the leaves
+def shred(node, value, rep, define, out):
+    if node.repetition == REPEATED:
+        if not value:
+            shred_missing(node, rep, define, out)
+            return
+        for idx, item in enumerate(value):
+            shred_present(node, item, rep if idx == 0 else node.max_rep, define + 1, out)
+    elif node.repetition == OPTIONAL:
+        if value is None:
+            shred_missing(node, rep, define, out)
+            return
+        shred_present(node, value, rep, define + 1, out)
+    else:
+        shred_present(node, value, rep, define, out)
+
+
+def shred_present(node, value, rep, define, out):
+    if not node.children:
+        out[id(node)].append((rep, define, value))
+        return
+    for child in node.children:
+        shred(child, value.get(child.name), rep, define, out)
+
+
+def shred_missing(node, rep, define, out):
+    for l in node.leaves():
+        out[id(l)].append((rep, define, None))
+
+
+# encoding
+def bit_width(max_level):
+    return max_level.bit_length()
+
+
+def encode_levels(levels, width):
+    # RLE/bit-packing hybrid: runs of at least 8 equal values are run-length encoded, other values are bit-packed
+    out = bytearray()
+    idx = 0
+    while idx < len(levels):
+        run = 1
+        while idx + run < len(levels) and levels[idx + run] == levels[idx]:
+            run += 1
+        if run >= 8:
+            out += varint(run << 1)
+            out += levels[idx].to_bytes((width + 7) // 8, 'little')
+            idx += run
+        else:
+            values = levels[idx:idx + 8] + [0] * (8 - len(levels[idx:idx + 8]))
+            packed = 0
+            for pos, v in enumerate(values):
+                packed |= v << (pos * width)
+            out += varint((1 << 1) | 1)
+            out += packed.to_bytes(width, 'little')
+            idx += 8
+    return struct.pack('<I', len(out)) + bytes(out)
+
+
+def encode_plain(ptype, values):
+    if ptype == INT32:
+        return b''.join(struct.pack('<i', v) for v in values)
+    if ptype == INT64:
+        return b''.join(struct.pack('<q', v) for v in values)
+    if ptype == DOUBLE:
+        return b''.join(struct.pack('<d', v) for v in values)
+    if ptype == BYTE_ARRAY:
+        return b''.join(struct.pack('<I', len(v.encode('utf8'))) + v.encode('utf8') for v in values)
+    raise Exception('unsupported type')
+
+
+def encode_page(node, triples):
+    body = bytearray()
+    if node.max_rep > 0:
+        body += encode_levels([t[0] for t in triples], bit_width(node.max_rep))
+    if node.max_def > 0:
+        body += encode_levels([t[1] for t in triples], bit_width(node.max_def))
+    body += encode_plain(node.ptype, [t[2] for t in triples if t[1] == node.max_def])
+    header = encode_struct([
+        (1, T_I32, 0),  # DATA_PAGE
+        (2, T_I32, len(body)),
+        (3, T_I32, len(body)),
+        (5, T_STRUCT, [(1, T_I32, len(triples)), (2, T_I32, PLAIN), (3, T_I32, RLE), (4, T_I32, RLE)]),
+    ])
+    return header + bytes(body)
+
+
+def schema_elements(node, is_root=False):
+    fields = []
+    if not node.children:
+        fields.append((1, T_I32, node.ptype))
+    if not is_root:
+        fields.append((3, T_I32, node.repetition))
+    fields.append((4, T_BINARY, node.name))
+    if node.children:
+        fields.append((5, T_I32, len(node.children)))
+    if node.converted is not None:
+        fields.append((6, T_I32, node.converted))
+    elements = [fields]
+    for child in node.children:
+        elements += schema_elements(child)
+    return elements
+
+
+def write_file(file_name, columns, records, group_size, page_size):
+    root = group('schema', REQUIRED, columns)
+    assign_levels(root)
+    leaves = root.leaves()
+    out = bytearray(b'PAR1')
+    row_groups = []
+    for group_start in range(0, len(records), group_size):
+        group_records = records[group_start:group_start + group_size]
+        # pages start at record boundaries and contain page_size records
+        pages = [{id(l): [] for l in leaves} for _ in range(0, len(group_records), page_size)]
+        for idx, record in enumerate(group_records):
+            for column in columns:
+                shred(column, record.get(column.name), 0, 0, pages[idx // page_size])
+        column_chunks = []
+        for l in leaves:
+            offset = len(out)
+            num_values = 0
+            for page in pages:
+                out += encode_page(l, page[id(l)])
+                num_values += len(page[id(l)])
+            size = len(out) - offset
+            meta_data = [
+                (1, T_I32, l.ptype),
+                (2, T_LIST, (T_I32, [PLAIN, RLE])),
+                (3, T_LIST, (T_BINARY, list(l.path[1:]))),
+                (4, T_I32, 0),  # UNCOMPRESSED
+                (5, T_I64, num_values),
+                (6, T_I64, size),
+                (7, T_I64, size),
+                (9, T_I64, offset),
+            ]
+            column_chunks.append([(2, T_I64, offset), (3, T_STRUCT, meta_data)])
+        total_size = sum(c[1][2][5][2] for c in column_chunks)
+        row_groups.append([
+            (1, T_LIST, (T_STRUCT, column_chunks)),
+            (2, T_I64, total_size),
+            (3, T_I64, len(group_records)),
+        ])
+    footer = encode_struct([
+        (1, T_I32, 1),
+        (2, T_LIST, (T_STRUCT, schema_elements(root, True))),
+        (3, T_I64, len(records)),
+        (4, T_LIST, (T_STRUCT, row_groups)),
+        (6, T_BINARY, 'duckdb nested.py'),
+    ])
+    out += footer + struct.pack('<I', len(footer)) + b'PAR1'
+    with open(file_name, 'wb') as f:
+        f.write(out)
+
+
+# helpers to convert logical values into the structure of the schema
+def l3(values, convert=lambda x: x):
+    return None if values is None else {'list': [{'element': convert(v)} for v in values]}
+
+
+def as_map(values):
+    return None if values is None else {'key_value': [{'key': k, 'value': v} for k, v in values]}
+
+
+def person(name, tags):
+    return {'name': name, 'tags': None if tags is None else {'array': tags}}
+
+
+nested_columns = [
+    leaf('id', REQUIRED, INT32),
+    list3('int_list', OPTIONAL, leaf('element', OPTIONAL, INT32)),
+    group('s', OPTIONAL, [leaf('a', OPTIONAL, INT32), leaf('b', OPTIONAL, BYTE_ARRAY, UTF8)]),
+    list3('struct_list', OPTIONAL,
+          group('element', OPTIONAL, [leaf('x', OPTIONAL, INT32), leaf('y', OPTIONAL, BYTE_ARRAY, UTF8)])),
+    list3('nested_list', OPTIONAL, list3('element', OPTIONAL, leaf('element', OPTIONAL, INT64))),
+    leaf('bare', REPEATED, INT32),
+    group('m', OPTIONAL, [group('key_value', REPEATED,
+                                [leaf('key', REQUIRED, BYTE_ARRAY, UTF8), leaf('value', OPTIONAL, INT32)],
+                                MAP_KEY_VALUE)], MAP),
+    leaf('req', REQUIRED, INT64),
+    group('person', OPTIONAL, [leaf('name', REQUIRED, BYTE_ARRAY, UTF8),
+                               group('tags', OPTIONAL, [leaf('array', REPEATED, BYTE_ARRAY, UTF8)], LIST)]),
+]
+
+nested_rows = [
+    (1, [1, 2, 3], (10, 'ten'), [(1, 'a'), (2, 'b')], [[1, 2], [3]], [1, 2], [('k1', 1), ('k2', 2)], 100,
+     ('alice', ['x', 'y'])),
+    (2, None, None, None, None, [], None, 200, None),
+    (3, [], (None, None), [], [], [3], [], 300, ('bob', [])),
+    (4, [None], (30, None), [None], [None], [4, 5, 6], [('k3', None)], 400, ('carol', None)),
+    (5, [4, None, 5], (None, 'fifty'), [(None, None), (5, None), None], [[], None, [4, None]], [], [('k4', 4)],
+     500, ('dave', ['z'])),
+    (6, [6], (60, 'sixty'), [(6, 'f')], [[5, 6, 7]], [7], None, 600, ('eve', ['u', 'v', 'w'])),
+    (7, [7, 8, 9, 10], None, [(7, 'g'), (8, 'h'), (9, 'i')], [[8], [9], [10]], [8, 9], [('k5', 5), ('k6', None)],
+     700, None),
+    (8, None, (80, 'eighty'), None, [[11, 12]], [], [], 800, ('frank', [])),
+    (9, [], (90, 'ninety'), [(10, 'j')], None, [10], [('k7', 7)], 900, ('grace', ['t'])),
+    (10, [11, 12], (None, None), [], [[], []], [11, 12, 13], None, 1000, ('heidi', ['s', 'r'])),
+]
+
+
+def nested_record(row):
+    id_, int_list, s, struct_list, nested_list, bare, m, req, p = row
+    return {
+        'id': id_,
+        'int_list': l3(int_list),
+        's': None if s is None else {'a': s[0], 'b': s[1]},
+        'struct_list': l3(struct_list, lambda e: None if e is None else {'x': e[0], 'y': e[1]}),
+        'nested_list': l3(nested_list, lambda e: l3(e)),
+        'bare': bare,
+        'm': as_map(m),
+        'req': req,
+        'person': None if p is None else person(p[0], p[1]),
+    }
+
+
+write_file('nested.parquet', nested_columns, [nested_record(r) for r in nested_rows], 6, 2)
+
+# a larger file to test lists that span multiple chunks and vectors
+random.seed(42)
+large_columns = [
+    leaf('id', REQUIRED, INT32),
+    list3('ints', OPTIONAL, leaf('element', OPTIONAL, INT32)),
+    group('st', OPTIONAL, [leaf('a', OPTIONAL, INT64), list3('l', OPTIONAL, leaf('element', REQUIRED, DOUBLE))]),
+    list3('ll', OPTIONAL, list3('element', OPTIONAL, leaf('element', OPTIONAL, INT64))),
+]
+large_records = []
+for i in range(3000):
+    def rand_list(max_len, value):
+        r = random.random()
+        if r < 0.05:
+            return None
+        return [None if random.random() < 0.1 else value() for _ in range(random.randint(0, max_len))]
+    ints = rand_list(6, lambda: random.randint(-100, 100))
+    st = None if i % 7 == 3 else {'a': None if i % 5 == 0 else i, 'l': l3([float(i + k) for k in range(i % 4)])}
+    ll = rand_list(4, lambda: rand_list(3, lambda: random.randint(0, 1000)))
+    large_records.append({'id': i, 'ints': l3(ints), 'st': st, 'll': l3(ll, lambda e: l3(e))})
+
+write_file('nested_large.parquet', large_columns, large_records, 2000, 500)
@@ -0,0 +1,56 @@
+#include "catch.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "test_helpers.hpp"
+
+using namespace duckdb;
+using namespace std;
+
+static int64_t get_database_size(FileSystem &fs, string path) {
+	auto handle = fs.OpenFile(path, FileFlags::READ);
+	return fs.GetFileSize(*handle);
+}
+
+TEST_CASE("Test automatically vacuuming tables during checkpoints", "[storage]") {
+	FileSystem fs;
+	auto config = GetTestConfig();
+	config->auto_vacuum = true;
+	config->auto_vacuum_threshold = 0.5;
+	unique_ptr<QueryResult> result;
+	auto storage_database = TestCreatePath("auto_vacuum_test");
+
+	DeleteDatabase(storage_database);
+	{
+		DuckDB db(storage_database, config.get());
+		Connection con(db);
+		REQUIRE_NO_FAIL(con.Query("CREATE TABLE integers AS SELECT i FROM range(0, 100000) tbl(i)"));
+		REQUIRE_NO_FAIL(con.Query("CHECKPOINT"));
+
+		// less than half of the rows are deleted: the checkpoint keeps them
+		REQUIRE_NO_FAIL(con.Query("DELETE FROM integers WHERE i < 40000"));
+		REQUIRE_NO_FAIL(con.Query("CHECKPOINT"));
+		result = con.Query("SELECT MAX(start + count) FROM pragma_storage_info('integers')");
+		REQUIRE(CHECK_COLUMN(result, 0, {100000}));
+
+		// now more than half of the rows are deleted: the checkpoint removes them
+		REQUIRE_NO_FAIL(con.Query("DELETE FROM integers WHERE i < 60000"));
+		REQUIRE_NO_FAIL(con.Query("CHECKPOINT"));
+		result = con.Query("SELECT MAX(start + count) FROM pragma_storage_info('integers')");
+		REQUIRE(CHECK_COLUMN(result, 0, {40000}));
+		result = con.Query("SELECT COUNT(*), SUM(i) FROM integers");
+		REQUIRE(CHECK_COLUMN(result, 0, {40000}));
+		REQUIRE(CHECK_COLUMN(result, 1, {Value::HUGEINT(3199980000)}));
+	}
+	auto size = get_database_size(fs, storage_database);
+	{
+		// the blocks freed by the vacuum are reused: re-inserting the deleted rows does not grow the database
+		DuckDB db(storage_database, config.get());
+		Connection con(db);
+		REQUIRE_NO_FAIL(con.Query("INSERT INTO integers SELECT i FROM range(0, 60000) tbl(i)"));
+		REQUIRE_NO_FAIL(con.Query("CHECKPOINT"));
+		result = con.Query("SELECT COUNT(*), SUM(i) FROM integers");
+		REQUIRE(CHECK_COLUMN(result, 0, {100000}));
+		REQUIRE(CHECK_COLUMN(result, 1, {Value::HUGEINT(4999950000)}));
+	}
+	REQUIRE(get_database_size(fs, storage_database) <= size);
+	DeleteDatabase(storage_database);
+}